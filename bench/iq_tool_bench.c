@@ -0,0 +1,607 @@
+/**
+ * @file iq_tool_bench.c
+ * @brief Micro-benchmarks for the pipeline's hot kernels.
+ *
+ * Every kernel is run in isolation on an in-memory block of samples, through
+ * the same create/apply functions the pipeline uses, until a minimum amount of
+ * wall time has elapsed. For each kernel the tool reports throughput in
+ * megasamples per second, nanoseconds per sample and, where a cycle counter is
+ * available, bytes touched per CPU cycle.
+ *
+ * Results are printed as a table and can also be written as JSON (--json) so
+ * they can be compared across commits.
+ *
+ * Build with -DBUILD_BENCHMARKS=ON (and CMAKE_BUILD_TYPE=Release for meaningful
+ * numbers), then run build/iq_tool_bench.
+ */
+
+#include "constants.h"
+#include "app_context.h"
+#include "argparse.h"
+#include "log.h"
+#include "utils.h"
+#include "memory_arena.h"
+#include "sample_convert.h"
+#include "dc_block.h"
+#include "iq_correct.h"
+#include "frequency_shift.h"
+#include "filter.h"
+#include "resampler.h"
+#include "agc.h"
+#include "queue.h"
+#include "ring_buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_CYCLE_COUNTER 1
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define BENCH_HAVE_CYCLE_COUNTER 1
+#else
+#define BENCH_HAVE_CYCLE_COUNTER 0
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// signal_handler.c expects the executable to own the console mutex.
+pthread_mutex_t g_console_mutex;
+
+// --- Benchmark Tuning ---
+#define BENCH_DEFAULT_BLOCK_SAMPLES   16384
+#define BENCH_DEFAULT_MIN_TIME_SEC    0.5
+#define BENCH_SAMPLE_RATE_HZ          2048000
+#define BENCH_FFT_FILTER_TAPS         255   // Fits the smallest FFT size below (block 256)
+#define BENCH_ARENA_BYTES             (16 * 1024 * 1024)
+#define BENCH_MAX_RESULTS             128
+#define BENCH_QUEUE_CAPACITY          1024
+#define BENCH_QUEUE_ITEMS_PER_RUN     (256 * 1024)
+#define BENCH_RING_CAPACITY_BYTES     (64 * 1024 * 1024)
+#define BENCH_RING_BLOCK_BYTES        (64 * 1024)
+#define BENCH_RING_BLOCKS_PER_RUN     512
+
+// --- Type Definitions ---
+
+typedef struct BenchCase BenchCase;
+
+/**
+ * @struct BenchState
+ * @brief Everything one benchmark case works on. Reset before each case.
+ */
+typedef struct {
+    const BenchCase* bench;
+    size_t           block_samples;
+    complex_float_t* signal;        ///< Read-only test signal.
+    complex_float_t* work;          ///< In-place / output buffer.
+    complex_float_t* scratch;       ///< Second output buffer (FFT filter, resampler).
+    void*            raw;           ///< Packed samples for the format conversions.
+    size_t           work_capacity; ///< Samples in work and scratch.
+    MemoryArena      arena;
+    SampleChunk      chunk;
+    resampler_t*     resampler;
+    Queue            queue;
+    RingBuffer*      ring;
+    unsigned long long items_per_run; ///< Samples (or items) processed by one call of run().
+} BenchState;
+
+/**
+ * @struct BenchCase
+ * @brief One benchmarked kernel and its parameters.
+ */
+struct BenchCase {
+    const char* name;
+    bool  (*setup)(BenchState* state);
+    void  (*run)(BenchState* state);
+    void  (*teardown)(BenchState* state);
+    format_t format;        ///< Format under test for conversions.
+    int      param;         ///< Taps, FFT size, AGC profile or producer count.
+    float    ratio;         ///< Resampling ratio.
+    size_t   bytes_per_sample; ///< Bytes read plus written per sample (0 = derive from format).
+};
+
+typedef struct {
+    const char*        name;
+    double             msps;
+    double             ns_per_sample;
+    double             bytes_per_cycle;   ///< < 0 if no cycle counter is available.
+    unsigned long long samples;
+    double             seconds;
+} BenchResult;
+
+// --- Private Data ---
+static AppConfig    s_config;
+static AppResources s_resources;
+static BenchResult  s_results[BENCH_MAX_RESULTS];
+static int          s_num_results = 0;
+
+// --- Private Helper Functions ---
+
+static inline unsigned long long _read_cycles(void) {
+#if BENCH_HAVE_CYCLE_COUNTER
+    return (unsigned long long)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void _reset_app_state(void) {
+    memset(&s_config, 0, sizeof(s_config));
+    memset(&s_resources, 0, sizeof(s_resources));
+    s_resources.config = &s_config;
+    s_resources.source_info.samplerate = BENCH_SAMPLE_RATE_HZ;
+    s_config.target_rate = BENCH_SAMPLE_RATE_HZ;
+    s_config.no_resample = true;    // Keeps the user filter in the pre-resample stage.
+}
+
+static void _fill_test_signal(complex_float_t* out, size_t n) {
+    // A tone plus a little pseudo-random noise: exercises every bit without clipping.
+    uint32_t seed = 0x12345678u;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise_i = ((float)(seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        seed = seed * 1664525u + 1013904223u;
+        float noise_q = ((float)(seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        float phase = 2.0f * (float)M_PI * 0.0371f * (float)i;
+        out[i] = (0.4f * cosf(phase) + noise_i) + (0.4f * sinf(phase) + noise_q) * I;
+    }
+}
+
+// --- Kernel Cases ---
+
+static void teardown_nothing(BenchState* state) {
+    (void)state;
+}
+
+static bool setup_convert(BenchState* state) {
+    return convert_cf32_to_block(state->signal, state->raw, state->block_samples, state->bench->format);
+}
+
+static void run_convert_to_cf32(BenchState* state) {
+    convert_block_to_cf32(state->raw, state->work, state->block_samples, state->bench->format, 1.0f);
+}
+
+static void run_convert_from_cf32(BenchState* state) {
+    convert_cf32_to_block(state->signal, state->raw, state->block_samples, state->bench->format);
+}
+
+static bool setup_dc_block(BenchState* state) {
+    s_config.dc_block.enable = true;
+    memcpy(state->work, state->signal, state->block_samples * sizeof(complex_float_t));
+    return dc_block_create(&s_config, &s_resources);
+}
+
+static void run_dc_block(BenchState* state) {
+    dc_block_apply(&s_resources, state->work, (int)state->block_samples);
+}
+
+static void teardown_dc_block(BenchState* state) {
+    (void)state;
+    dc_block_destroy(&s_resources);
+}
+
+static bool setup_iq_correct(BenchState* state) {
+    s_config.iq_correction.enable = true;
+    memcpy(state->work, state->signal, state->block_samples * sizeof(complex_float_t));
+    return iq_correct_init(&s_config, &s_resources, &state->arena);
+}
+
+static void run_iq_correct(BenchState* state) {
+    iq_correct_apply(&s_resources, state->work, (int)state->block_samples);
+}
+
+static void teardown_iq_correct(BenchState* state) {
+    (void)state;
+    iq_correct_destroy(&s_resources);
+}
+
+static bool setup_nco(BenchState* state) {
+    (void)state;
+    s_resources.nco_shift_hz = 100000.0;
+    return freq_shift_create(&s_config, &s_resources) && s_resources.pre_resample_nco != NULL;
+}
+
+static void run_nco(BenchState* state) {
+    freq_shift_apply(s_resources.pre_resample_nco, s_resources.nco_shift_hz, state->signal, state->work, (unsigned int)state->block_samples);
+}
+
+static void teardown_nco(BenchState* state) {
+    (void)state;
+    freq_shift_destroy_ncos(&s_resources);
+}
+
+static bool _setup_filter(BenchState* state, bool asymmetric, bool use_fft) {
+    const BenchCase* bench = state->bench;
+    if (asymmetric) {
+        // An offset passband needs complex taps.
+        s_config.filter_requests[0] = (FilterRequest){ FILTER_TYPE_PASSBAND, 300000.0f, 200000.0f };
+    } else {
+        s_config.filter_requests[0] = (FilterRequest){ FILTER_TYPE_LOWPASS, 200000.0f, 0.0f };
+    }
+    s_config.num_filter_requests = 1;
+    if (use_fft) {
+        s_config.filter_taps_arg = BENCH_FFT_FILTER_TAPS;
+        s_config.filter_fft_size_arg = bench->param;
+        s_config.filter_type_str_arg = "fft";
+        s_config.filter_type_request = FILTER_TYPE_FFT;
+    } else {
+        s_config.filter_taps_arg = bench->param;
+        s_config.filter_type_str_arg = "fir";
+        s_config.filter_type_request = FILTER_TYPE_FIR;
+    }
+    if (!filter_create(&s_config, &s_resources, &state->arena)) {
+        return false;
+    }
+    memcpy(state->work, state->signal, state->block_samples * sizeof(complex_float_t));
+    return true;
+}
+
+static bool setup_fir_symmetric(BenchState* state)   { return _setup_filter(state, false, false); }
+static bool setup_fir_asymmetric(BenchState* state)  { return _setup_filter(state, true, false); }
+static bool setup_fft_symmetric(BenchState* state)   { return _setup_filter(state, false, true); }
+static bool setup_fft_asymmetric(BenchState* state)  { return _setup_filter(state, true, true); }
+
+static void run_filter(BenchState* state) {
+    SampleChunk* chunk = &state->chunk;
+    chunk->current_input_buffer = state->work;
+    chunk->current_output_buffer = state->scratch;
+    chunk->frames_read = (int64_t)state->block_samples;
+    filter_apply(&s_resources, chunk, false);
+}
+
+static void teardown_filter(BenchState* state) {
+    (void)state;
+    filter_destroy(&s_resources);
+}
+
+static bool setup_resampler(BenchState* state) {
+    state->resampler = create_resampler(&s_config, &s_resources, state->bench->ratio);
+    return state->resampler != NULL;
+}
+
+static void run_resampler(BenchState* state) {
+    unsigned int frames_out = 0;
+    resampler_execute(state->resampler, state->signal, (unsigned int)state->block_samples, state->scratch, &frames_out);
+}
+
+static void teardown_resampler(BenchState* state) {
+    destroy_resampler(state->resampler);
+    state->resampler = NULL;
+}
+
+static bool setup_agc(BenchState* state) {
+    s_config.output_agc.enable = true;
+    s_config.output_agc.profile = (AgcProfile)state->bench->param;
+    memcpy(state->work, state->signal, state->block_samples * sizeof(complex_float_t));
+    return agc_create(&s_config, &s_resources);
+}
+
+static void run_agc(BenchState* state) {
+    agc_apply(&s_resources, state->work, (unsigned int)state->block_samples);
+}
+
+static void teardown_agc(BenchState* state) {
+    (void)state;
+    agc_destroy(&s_resources);
+}
+
+// --- Queue and Ring Buffer Cases ---
+
+typedef struct {
+    BenchState*        state;
+    unsigned long long count;   ///< Items (queue) or blocks (ring) to produce.
+} ProducerArgs;
+
+static void* _queue_producer(void* arg) {
+    ProducerArgs* args = (ProducerArgs*)arg;
+    for (unsigned long long i = 0; i < args->count; i++) {
+        // Any non-NULL pointer will do; NULL is the queue's shutdown value.
+        if (!queue_enqueue(&args->state->queue, args->state)) break;
+    }
+    return NULL;
+}
+
+static void* _ring_producer(void* arg) {
+    ProducerArgs* args = (ProducerArgs*)arg;
+    const unsigned char* block = (const unsigned char*)args->state->signal;
+    for (unsigned long long i = 0; i < args->count; i++) {
+        size_t written = 0;
+        while (written < BENCH_RING_BLOCK_BYTES) {
+            size_t n = ring_buffer_write(args->state->ring, block + written, BENCH_RING_BLOCK_BYTES - written);
+            if (n == 0) {
+                sched_yield(); // Full; let the consumer drain it.
+            }
+            written += n;
+        }
+    }
+    return NULL;
+}
+
+static bool setup_queue(BenchState* state) {
+    state->items_per_run = BENCH_QUEUE_ITEMS_PER_RUN;
+    return queue_init(&state->queue, BENCH_QUEUE_CAPACITY, &state->arena);
+}
+
+static void run_queue(BenchState* state) {
+    const int producers = state->bench->param;
+    pthread_t threads[2];
+    ProducerArgs args = { state, state->items_per_run / (unsigned long long)producers };
+
+    for (int i = 0; i < producers; i++) {
+        pthread_create(&threads[i], NULL, _queue_producer, &args);
+    }
+    for (unsigned long long i = 0; i < args.count * (unsigned long long)producers; i++) {
+        queue_dequeue(&state->queue);
+    }
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void teardown_queue(BenchState* state) {
+    queue_destroy(&state->queue);
+}
+
+static bool setup_ring(BenchState* state) {
+    state->ring = ring_buffer_create(BENCH_RING_CAPACITY_BYTES);
+    state->items_per_run = (unsigned long long)BENCH_RING_BLOCKS_PER_RUN * BENCH_RING_BLOCK_BYTES / sizeof(complex_float_t);
+    return state->ring != NULL;
+}
+
+static void run_ring(BenchState* state) {
+    const int producers = state->bench->param;
+    pthread_t threads[2];
+    ProducerArgs args = { state, BENCH_RING_BLOCKS_PER_RUN / (unsigned long long)producers };
+    unsigned char* sink = (unsigned char*)state->scratch;
+
+    for (int i = 0; i < producers; i++) {
+        pthread_create(&threads[i], NULL, _ring_producer, &args);
+    }
+    size_t remaining = (size_t)(args.count * (unsigned long long)producers) * BENCH_RING_BLOCK_BYTES;
+    while (remaining > 0) {
+        size_t want = remaining < BENCH_RING_BLOCK_BYTES ? remaining : BENCH_RING_BLOCK_BYTES;
+        size_t got = ring_buffer_read(state->ring, sink, want);
+        if (got == 0) break;
+        remaining -= got;
+    }
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void teardown_ring(BenchState* state) {
+    ring_buffer_destroy(state->ring);
+    state->ring = NULL;
+}
+
+// --- Case Table ---
+
+#define CONVERT_CASES(fmt, label) \
+    { "convert_to_cf32/" label,   setup_convert, run_convert_to_cf32,   teardown_nothing, fmt, 0, 0.0f, 0 }, \
+    { "convert_from_cf32/" label, setup_convert, run_convert_from_cf32, teardown_nothing, fmt, 0, 0.0f, 0 }
+
+static const BenchCase s_cases[] = {
+    CONVERT_CASES(CU8, "cu8"),
+    CONVERT_CASES(CS8, "cs8"),
+    CONVERT_CASES(CU16, "cu16"),
+    CONVERT_CASES(CS16, "cs16"),
+    CONVERT_CASES(SC16Q11, "sc16q11"),
+    CONVERT_CASES(CS24, "cs24"),
+    CONVERT_CASES(CU32, "cu32"),
+    CONVERT_CASES(CS32, "cs32"),
+    CONVERT_CASES(CF32, "cf32"),
+
+    { "dc_block",              setup_dc_block,       run_dc_block,   teardown_dc_block,   FORMAT_UNKNOWN, 0,    0.0f, 16 },
+    { "iq_correct_apply",      setup_iq_correct,     run_iq_correct, teardown_iq_correct, FORMAT_UNKNOWN, 0,    0.0f, 16 },
+    { "nco_mix",               setup_nco,            run_nco,        teardown_nco,        FORMAT_UNKNOWN, 0,    0.0f, 16 },
+
+    { "fir_symmetric/65",      setup_fir_symmetric,  run_filter,     teardown_filter,     FORMAT_UNKNOWN, 65,   0.0f, 16 },
+    { "fir_symmetric/257",     setup_fir_symmetric,  run_filter,     teardown_filter,     FORMAT_UNKNOWN, 257,  0.0f, 16 },
+    { "fir_asymmetric/65",     setup_fir_asymmetric, run_filter,     teardown_filter,     FORMAT_UNKNOWN, 65,   0.0f, 16 },
+    { "fir_asymmetric/257",    setup_fir_asymmetric, run_filter,     teardown_filter,     FORMAT_UNKNOWN, 257,  0.0f, 16 },
+
+    { "fft_symmetric/512",     setup_fft_symmetric,  run_filter,     teardown_filter,     FORMAT_UNKNOWN, 512,  0.0f, 16 },
+    { "fft_symmetric/2048",    setup_fft_symmetric,  run_filter,     teardown_filter,     FORMAT_UNKNOWN, 2048, 0.0f, 16 },
+    { "fft_symmetric/8192",    setup_fft_symmetric,  run_filter,     teardown_filter,     FORMAT_UNKNOWN, 8192, 0.0f, 16 },
+    { "fft_asymmetric/512",    setup_fft_asymmetric, run_filter,     teardown_filter,     FORMAT_UNKNOWN, 512,  0.0f, 16 },
+    { "fft_asymmetric/2048",   setup_fft_asymmetric, run_filter,     teardown_filter,     FORMAT_UNKNOWN, 2048, 0.0f, 16 },
+    { "fft_asymmetric/8192",   setup_fft_asymmetric, run_filter,     teardown_filter,     FORMAT_UNKNOWN, 8192, 0.0f, 16 },
+
+    // Ratios: 4:1 and 2:1 decimation, 2.048 MHz -> NRSC-5 rate, 1:2 interpolation.
+    { "resample/0.25",         setup_resampler,      run_resampler,  teardown_resampler,  FORMAT_UNKNOWN, 0,    0.25f,      16 },
+    { "resample/0.5",          setup_resampler,      run_resampler,  teardown_resampler,  FORMAT_UNKNOWN, 0,    0.5f,       16 },
+    { "resample/0.7267",       setup_resampler,      run_resampler,  teardown_resampler,  FORMAT_UNKNOWN, 0,    0.7267456f, 16 },
+    { "resample/2.0",          setup_resampler,      run_resampler,  teardown_resampler,  FORMAT_UNKNOWN, 0,    2.0f,       16 },
+
+    { "agc/dx",                setup_agc,            run_agc,        teardown_agc,        FORMAT_UNKNOWN, AGC_PROFILE_DX,      0.0f, 16 },
+    { "agc/local",             setup_agc,            run_agc,        teardown_agc,        FORMAT_UNKNOWN, AGC_PROFILE_LOCAL,   0.0f, 16 },
+    { "agc/digital",           setup_agc,            run_agc,        teardown_agc,        FORMAT_UNKNOWN, AGC_PROFILE_DIGITAL, 0.0f, 16 },
+
+    // Queue "samples" are chunk hand-offs; ring samples are 8-byte cf32 frames (written then read).
+    { "queue/1-producer",      setup_queue,          run_queue,      teardown_queue,      FORMAT_UNKNOWN, 1,    0.0f, 2 * sizeof(void*) },
+    { "queue/2-producers",     setup_queue,          run_queue,      teardown_queue,      FORMAT_UNKNOWN, 2,    0.0f, 2 * sizeof(void*) },
+    { "ring_buffer/1-producer", setup_ring,          run_ring,       teardown_ring,       FORMAT_UNKNOWN, 1,    0.0f, 16 },
+    { "ring_buffer/2-producers", setup_ring,         run_ring,       teardown_ring,       FORMAT_UNKNOWN, 2,    0.0f, 16 },
+};
+
+// --- Runner ---
+
+static bool _run_case(const BenchCase* bench, BenchState* state, double min_time_sec) {
+    _reset_app_state();
+    state->bench = bench;
+    state->items_per_run = state->block_samples;
+    memset(&state->chunk, 0, sizeof(state->chunk));
+
+    if (!mem_arena_init(&state->arena, BENCH_ARENA_BYTES)) {
+        return false;
+    }
+    if (!bench->setup(state)) {
+        log_error("Benchmark '%s': setup failed.", bench->name);
+        mem_arena_destroy(&state->arena);
+        return false;
+    }
+
+    bench->run(state); // Warm caches and lazily-built state.
+
+    unsigned long long runs = 0;
+    unsigned long long start_ns = get_monotonic_time_ns();
+    unsigned long long start_cycles = _read_cycles();
+    unsigned long long elapsed_ns = 0;
+    do {
+        bench->run(state);
+        runs++;
+        elapsed_ns = get_monotonic_time_ns() - start_ns;
+    } while ((double)elapsed_ns < min_time_sec * 1e9);
+    unsigned long long cycles = _read_cycles() - start_cycles;
+
+    bench->teardown(state);
+    mem_arena_destroy(&state->arena);
+
+    size_t bytes_per_sample = bench->bytes_per_sample;
+    if (bytes_per_sample == 0) {
+        bytes_per_sample = get_bytes_per_sample(bench->format) + sizeof(complex_float_t);
+    }
+
+    if (s_num_results >= BENCH_MAX_RESULTS) {
+        return false;
+    }
+    BenchResult* result = &s_results[s_num_results++];
+    result->name = bench->name;
+    result->samples = runs * state->items_per_run;
+    result->seconds = (double)elapsed_ns / 1e9;
+    result->msps = (double)result->samples / result->seconds / 1e6;
+    result->ns_per_sample = (double)elapsed_ns / (double)result->samples;
+    result->bytes_per_cycle = (BENCH_HAVE_CYCLE_COUNTER && cycles > 0)
+                            ? (double)(result->samples * bytes_per_sample) / (double)cycles
+                            : -1.0;
+
+    if (result->bytes_per_cycle >= 0.0) {
+        printf("%-28s %10.2f MS/s %10.3f ns/sample %8.3f B/cycle\n",
+               result->name, result->msps, result->ns_per_sample, result->bytes_per_cycle);
+    } else {
+        printf("%-28s %10.2f MS/s %10.3f ns/sample %8s B/cycle\n",
+               result->name, result->msps, result->ns_per_sample, "n/a");
+    }
+    fflush(stdout);
+    return true;
+}
+
+static bool _write_json(const char* path, size_t block_samples, double min_time_sec) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        log_error("Failed to create JSON file '%s': %s", path, strerror(errno));
+        return false;
+    }
+
+#ifdef GIT_HASH
+    const char* version = GIT_HASH;
+#else
+    const char* version = "unknown";
+#endif
+
+    fprintf(f, "{\n  \"version\": \"%s\",\n  \"block_samples\": %zu,\n  \"min_time_sec\": %.3f,\n", version, block_samples, min_time_sec);
+    fprintf(f, "  \"cycle_counter\": %s,\n  \"results\": [\n", BENCH_HAVE_CYCLE_COUNTER ? "\"tsc\"" : "null");
+    for (int i = 0; i < s_num_results; i++) {
+        const BenchResult* r = &s_results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"msps\": %.4f, \"ns_per_sample\": %.4f, ", r->name, r->msps, r->ns_per_sample);
+        if (r->bytes_per_cycle >= 0.0) {
+            fprintf(f, "\"bytes_per_cycle\": %.4f, ", r->bytes_per_cycle);
+        } else {
+            fprintf(f, "\"bytes_per_cycle\": null, ");
+        }
+        fprintf(f, "\"samples\": %llu, \"seconds\": %.4f}%s\n", r->samples, r->seconds, (i + 1 < s_num_results) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+
+    bool ok = (ferror(f) == 0);
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        log_error("Failed to write JSON file '%s'.", path);
+    }
+    return ok;
+}
+
+// --- Main Entry Point ---
+
+int main(int argc, const char* argv[]) {
+    const char* json_path = NULL;
+    const char* filter_str = NULL;
+    float min_time_arg = 0.0f;
+    int block_samples_arg = 0;
+
+    static const char* const usages[] = {
+        "iq_tool_bench [options]",
+        NULL,
+    };
+    struct argparse_option options[] = {
+        OPT_HELP(),
+        OPT_GROUP("Benchmark Options"),
+        OPT_STRING(0, "json", &json_path, "Also write the results as JSON to this file.", NULL, 0, 0),
+        OPT_STRING(0, "filter", &filter_str, "Only run benchmarks whose name contains this string.", NULL, 0, 0),
+        OPT_FLOAT(0, "min-time", &min_time_arg, "Minimum measured time per benchmark in seconds. (Default: 0.5)", NULL, 0, 0),
+        OPT_INTEGER(0, "block-samples", &block_samples_arg, "Samples processed per kernel call. (Default: 16384)", NULL, 0, 0),
+        OPT_END(),
+    };
+    struct argparse argparse;
+    argparse_init(&argparse, options, usages, 0);
+    argparse_describe(&argparse, "\nMicro-benchmarks for the iq_tool DSP kernels and inter-thread buffers.", NULL);
+    argparse_parse(&argparse, argc, argv);
+
+    pthread_mutex_init(&g_console_mutex, NULL);
+    log_set_level(LOG_WARN); // Kernel setup is chatty at INFO.
+
+    double min_time_sec = (min_time_arg > 0.0f) ? (double)min_time_arg : BENCH_DEFAULT_MIN_TIME_SEC;
+
+    BenchState state;
+    memset(&state, 0, sizeof(state));
+    state.block_samples = (block_samples_arg > 0) ? (size_t)block_samples_arg : BENCH_DEFAULT_BLOCK_SAMPLES;
+
+    // Room for the largest FFT remainder and for 2x interpolation, and for one ring block.
+    state.work_capacity = state.block_samples * 2 + 8192;
+    if (state.work_capacity * sizeof(complex_float_t) < BENCH_RING_BLOCK_BYTES) {
+        state.work_capacity = BENCH_RING_BLOCK_BYTES / sizeof(complex_float_t);
+    }
+    state.signal = (complex_float_t*)malloc(state.work_capacity * sizeof(complex_float_t));
+    state.work = (complex_float_t*)malloc(state.work_capacity * sizeof(complex_float_t));
+    state.scratch = (complex_float_t*)malloc(state.work_capacity * sizeof(complex_float_t));
+    state.raw = malloc(state.block_samples * sizeof(complex_float_t));
+    if (!state.signal || !state.work || !state.scratch || !state.raw) {
+        log_fatal("Failed to allocate benchmark buffers.");
+        return EXIT_FAILURE;
+    }
+    _fill_test_signal(state.signal, state.work_capacity);
+
+    printf("Block size: %zu samples, minimum %.2f s per benchmark.\n\n", state.block_samples, min_time_sec);
+
+    bool all_ok = true;
+    for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++) {
+        if (filter_str && !strstr(s_cases[i].name, filter_str)) {
+            continue;
+        }
+        if (!_run_case(&s_cases[i], &state, min_time_sec)) {
+            all_ok = false;
+        }
+    }
+
+    if (json_path && !_write_json(json_path, state.block_samples, min_time_sec)) {
+        all_ok = false;
+    }
+
+    free(state.signal);
+    free(state.work);
+    free(state.scratch);
+    free(state.raw);
+    mem_scratch_release();
+    pthread_mutex_destroy(&g_console_mutex);
+
+    return all_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
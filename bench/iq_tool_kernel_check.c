@@ -0,0 +1,731 @@
+/**
+ * @file iq_tool_kernel_check.c
+ * @brief Cross-checks the DSP kernels against golden reference implementations.
+ *
+ * Every kernel variant the pipeline can select (every sample format
+ * conversion, the direct format-to-format transcoder, DC block, I/Q
+ * correction, both NCO mixing directions, and the FIR and FFT filters with
+ * real and complex taps) is run through its normal entry point on randomized
+ * input. The output is compared with a plain, double-precision implementation
+ * of the same operation written here. The frequency shift is also run as the
+ * --segments jobs would run it, and the joined output is compared with a
+ * single run. For each kernel the tool reports the maximum absolute error and
+ * the SNR of the output against the reference, and fails if either is outside
+ * the kernel's bound.
+ *
+ * Running this against a normal build checks the optimized paths (fast-math,
+ * vectorization, liquid-dsp's SIMD dot products, the NCO lookup table, the FFT
+ * filter). Running it against a -DREFERENCE_KERNELS=ON build checks the
+ * scalar paths themselves.
+ *
+ * Build with -DBUILD_KERNEL_TESTS=ON; the check is registered with CTest.
+ */
+
+#include "constants.h"
+#include "app_context.h"
+#include "argparse.h"
+#include "log.h"
+#include "utils.h"
+#include "memory_arena.h"
+#include "sample_convert.h"
+#include "transcode.h"
+#include "dc_block.h"
+#include "iq_correct.h"
+#include "frequency_shift.h"
+#include "filter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <liquid.h>
+#else
+#include <liquid/liquid.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// signal_handler.c expects the executable to own the console mutex.
+pthread_mutex_t g_console_mutex;
+
+// --- Harness Tuning ---
+#define CHECK_DEFAULT_SAMPLES     65536
+#define CHECK_DEFAULT_SEED        0x5EEDC0DEULL
+#define CHECK_SAMPLE_RATE_HZ      2048000
+#define CHECK_ARENA_BYTES         (16 * 1024 * 1024)
+#define CHECK_CONVERT_GAIN        0.75f
+#define CHECK_INPUT_AMPLITUDE     0.9     // Random input range for the DSP kernels
+#define CHECK_CLIP_AMPLITUDE      1.1     // Drives the output conversions into clipping
+#define CHECK_IQ_MAG              0.037f
+#define CHECK_IQ_PHASE            -0.021f
+#define CHECK_NCO_SHIFT_HZ        123456.7
+#define CHECK_SEGMENT_ORIGIN      (1ULL << 26) // Samples into the run where the segmented block starts
+#define CHECK_NUM_SEGMENTS        3
+#define CHECK_FILTER_TAPS         127
+#define CHECK_FILTER_FFT_SIZE     512     // Block of 256 covers the 127 taps
+#define CHECK_FILTER_MAX_CHUNK    4096
+
+// Output conversions may round a value sitting on a .5 boundary either way.
+#define ONE_LSB(scale)            (1.0001 / (double)(scale))
+
+// --- Type Definitions ---
+
+typedef struct KernelCheck KernelCheck;
+
+/**
+ * @struct CheckState
+ * @brief Buffers shared by all checks. `actual` and `expected` hold interleaved I/Q.
+ */
+typedef struct {
+    const KernelCheck* check;
+    size_t             num_samples;
+    unsigned long long rng_state;
+    complex_float_t*   input;     ///< Random test signal.
+    complex_float_t*   work;      ///< Kernel output (in-place kernels, FFT scratch).
+    void*              raw;       ///< Packed samples for the format conversions.
+    double*            actual;    ///< Output of the kernel under test.
+    double*            expected;  ///< Output of the golden reference.
+    size_t             num_compared; ///< Complex samples filled in actual/expected.
+    MemoryArena        arena;
+} CheckState;
+
+/**
+ * @struct KernelCheck
+ * @brief One kernel variant and the bounds its output must meet.
+ */
+struct KernelCheck {
+    const char* kernel;
+    const char* variant;
+    bool   (*run)(CheckState* state);
+    format_t format;        ///< Format under test for conversions.
+    int      param;         ///< Shift direction, filter shape/implementation, or transcoder output format.
+    double   max_abs_err;
+    double   min_snr_db;
+};
+
+/**
+ * @struct FormatSpec
+ * @brief How a packed format maps to [-1, 1], as documented by sample_convert.c.
+ */
+typedef struct {
+    format_t format;
+    double   scale;      ///< Full-scale value used when writing.
+    double   offset;     ///< Zero level of unsigned formats.
+    double   min_val;
+    double   max_val;
+    double   read_norm;  ///< Multiplier used when reading.
+    bool     is_signed;
+} FormatSpec;
+
+enum {
+    FILTER_CHECK_FIR = 0,
+    FILTER_CHECK_FFT = 1,
+    FILTER_CHECK_COMPLEX = 2,  ///< Flag: offset passband, complex taps.
+};
+
+// --- Private Data ---
+static AppConfig    s_config;
+static AppResources s_resources;
+
+static const FormatSpec s_formats[] = {
+    { CS8,     127.0,        0.0,          -128.0,        127.0,         1.0 / 128.0,        true  },
+    { CU8,     127.0,        127.5,        0.0,           255.0,         1.0 / 128.0,        false },
+    { CS16,    32767.0,      0.0,          -32768.0,      32767.0,       1.0 / 32768.0,      true  },
+    { SC16Q11, 2048.0,       0.0,          -32768.0,      32767.0,       1.0 / 2048.0,       true  },
+    { CU16,    32767.0,      32767.5,      0.0,           65535.0,       1.0 / 32768.0,      false },
+    { CS24,    8388607.0,    0.0,          -8388608.0,    8388607.0,     1.0 / 8388608.0,    true  },
+    { CS32,    2147483647.0, 0.0,          -2147483648.0, 2147483647.0,  1.0 / 2147483648.0, true  },
+    { CU32,    2147483647.0, 2147483647.5, 0.0,           4294967295.0,  1.0 / 2147483648.0, false },
+};
+
+// --- Private Helper Functions ---
+
+static void _reset_app_state(void) {
+    memset(&s_config, 0, sizeof(s_config));
+    memset(&s_resources, 0, sizeof(s_resources));
+    s_resources.config = &s_config;
+    s_resources.source_info.samplerate = CHECK_SAMPLE_RATE_HZ;
+    s_config.target_rate = CHECK_SAMPLE_RATE_HZ;
+    s_config.no_resample = true;    // Keeps the user filter in the pre-resample stage.
+}
+
+static unsigned long long _next_random(CheckState* state) {
+    // xorshift64*
+    unsigned long long x = state->rng_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    state->rng_state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double _random_uniform(CheckState* state, double amplitude) {
+    return ((double)(_next_random(state) >> 11) / 9007199254740992.0 * 2.0 - 1.0) * amplitude;
+}
+
+static void _fill_random_signal(CheckState* state, double amplitude) {
+    for (size_t i = 0; i < state->num_samples; i++) {
+        float re = (float)_random_uniform(state, amplitude);
+        float im = (float)_random_uniform(state, amplitude);
+        state->input[i] = re + im * I;
+    }
+}
+
+static const FormatSpec* _find_format(format_t format) {
+    for (size_t i = 0; i < sizeof(s_formats) / sizeof(s_formats[0]); i++) {
+        if (s_formats[i].format == format) {
+            return &s_formats[i];
+        }
+    }
+    return NULL;
+}
+
+static void _store_actual_cf32(CheckState* state, const complex_float_t* samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        state->actual[2 * i]     = (double)crealf(samples[i]);
+        state->actual[2 * i + 1] = (double)cimagf(samples[i]);
+    }
+    state->num_compared = count;
+}
+
+/**
+ * @brief Reads packed component `index` of a raw buffer as an integer-valued double.
+ */
+static double _read_packed(const void* raw, size_t index, format_t format) {
+    const unsigned char* bytes = (const unsigned char*)raw;
+    switch (format) {
+        case CS8:  { int8_t v;   memcpy(&v, bytes + index, sizeof(v));     return (double)v; }
+        case CU8:  { uint8_t v;  memcpy(&v, bytes + index, sizeof(v));     return (double)v; }
+        case CS16:
+        case SC16Q11: { int16_t v; memcpy(&v, bytes + index * 2, sizeof(v)); return (double)v; }
+        case CU16: { uint16_t v; memcpy(&v, bytes + index * 2, sizeof(v)); return (double)v; }
+        case CS24: {
+            const unsigned char* p = bytes + index * 3;
+            int32_t v = (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16));
+            if (v & 0x800000) v -= 0x1000000;
+            return (double)v;
+        }
+        case CS32: { int32_t v;  memcpy(&v, bytes + index * 4, sizeof(v)); return (double)v; }
+        case CU32: { uint32_t v; memcpy(&v, bytes + index * 4, sizeof(v)); return (double)v; }
+        default:   return 0.0;
+    }
+}
+
+// --- Golden References ---
+
+/** @brief Reference quantizer: scale, round half away from zero (signed) or half up (unsigned), clamp. */
+static double _reference_quantize(double x, const FormatSpec* spec) {
+    double v = x * spec->scale + spec->offset;
+    if (spec->is_signed) {
+        v = (v > 0.0) ? v + 0.5 : v - 0.5;
+        if (v > spec->max_val) v = spec->max_val;
+        if (v < spec->min_val) v = spec->min_val;
+        return trunc(v);
+    }
+    if (v > spec->max_val) v = spec->max_val;
+    if (v < 0.0) v = 0.0;
+    return floor(v + 0.5);
+}
+
+// --- Kernel Checks ---
+
+static bool run_convert_to_cf32(CheckState* state) {
+    format_t format = state->check->format;
+    size_t n = state->num_samples;
+
+    if (format == CF32) {
+        _fill_random_signal(state, CHECK_CLIP_AMPLITUDE);
+        memcpy(state->raw, state->input, n * sizeof(complex_float_t));
+    } else {
+        // Every bit pattern is a valid sample, so random bytes cover the full range.
+        unsigned char* bytes = (unsigned char*)state->raw;
+        for (size_t i = 0; i < n * get_bytes_per_sample(format); i++) {
+            bytes[i] = (unsigned char)(_next_random(state) >> 56);
+        }
+    }
+
+    if (!convert_block_to_cf32(state->raw, state->work, n, format, CHECK_CONVERT_GAIN)) {
+        return false;
+    }
+    _store_actual_cf32(state, state->work, n);
+
+    const double gain = (double)CHECK_CONVERT_GAIN;
+    if (format == CF32) {
+        for (size_t i = 0; i < n; i++) {
+            state->expected[2 * i]     = (double)crealf(state->input[i]) * gain;
+            state->expected[2 * i + 1] = (double)cimagf(state->input[i]) * gain;
+        }
+        return true;
+    }
+
+    const FormatSpec* spec = _find_format(format);
+    for (size_t i = 0; i < 2 * n; i++) {
+        state->expected[i] = (_read_packed(state->raw, i, format) - spec->offset) * spec->read_norm * gain;
+    }
+    return true;
+}
+
+static bool run_convert_from_cf32(CheckState* state) {
+    format_t format = state->check->format;
+    size_t n = state->num_samples;
+
+    _fill_random_signal(state, CHECK_CLIP_AMPLITUDE);
+    if (!convert_cf32_to_block(state->input, state->raw, n, format)) {
+        return false;
+    }
+
+    if (format == CF32) {
+        _store_actual_cf32(state, (const complex_float_t*)state->raw, n);
+        for (size_t i = 0; i < n; i++) {
+            state->expected[2 * i]     = (double)crealf(state->input[i]);
+            state->expected[2 * i + 1] = (double)cimagf(state->input[i]);
+        }
+        return true;
+    }
+
+    // Both sides are compared as quantized values mapped back to full scale,
+    // so a one-LSB rounding difference shows up as an error of 1/scale.
+    const FormatSpec* spec = _find_format(format);
+    for (size_t i = 0; i < n; i++) {
+        double x[2] = { (double)crealf(state->input[i]), (double)cimagf(state->input[i]) };
+        for (int c = 0; c < 2; c++) {
+            size_t k = 2 * i + (size_t)c;
+            state->actual[k]   = (_read_packed(state->raw, k, format) - spec->offset) / spec->scale;
+            state->expected[k] = (_reference_quantize(x[c], spec) - spec->offset) / spec->scale;
+        }
+    }
+    state->num_compared = n;
+    return true;
+}
+
+/**
+ * @brief The transcoder must reproduce the cf32 path exactly, so the reference
+ *        here is convert_block_to_cf32() followed by convert_cf32_to_block().
+ */
+static bool run_transcode(CheckState* state) {
+    format_t in_format = state->check->format;
+    format_t out_format = (format_t)state->check->param;
+    size_t n = state->num_samples;
+    size_t out_bytes = get_bytes_per_sample(out_format);
+
+    if (in_format == CF32) {
+        _fill_random_signal(state, CHECK_CLIP_AMPLITUDE);
+        memcpy(state->raw, state->input, n * sizeof(complex_float_t));
+    } else {
+        unsigned char* bytes = (unsigned char*)state->raw;
+        for (size_t i = 0; i < n * get_bytes_per_sample(in_format); i++) {
+            bytes[i] = (unsigned char)(_next_random(state) >> 56);
+        }
+    }
+
+    unsigned char* actual = (unsigned char*)mem_arena_alloc(&state->arena, n * out_bytes, false);
+    unsigned char* expected = (unsigned char*)mem_arena_alloc(&state->arena, n * out_bytes, false);
+    Transcoder* tc = transcode_create(in_format, out_format, CHECK_CONVERT_GAIN);
+    if (!actual || !expected || !tc) {
+        transcode_destroy(tc);
+        return false;
+    }
+    bool ok = transcode_block(tc, state->raw, in_format, actual, n);
+    transcode_destroy(tc);
+    if (!ok ||
+        !convert_block_to_cf32(state->raw, state->work, n, in_format, CHECK_CONVERT_GAIN) ||
+        !convert_cf32_to_block(state->work, expected, n, out_format)) {
+        return false;
+    }
+
+    if (out_format == CF32) {
+        _store_actual_cf32(state, (const complex_float_t*)actual, n);
+        const complex_float_t* ref = (const complex_float_t*)expected;
+        for (size_t i = 0; i < n; i++) {
+            state->expected[2 * i]     = (double)crealf(ref[i]);
+            state->expected[2 * i + 1] = (double)cimagf(ref[i]);
+        }
+        return true;
+    }
+
+    const FormatSpec* spec = _find_format(out_format);
+    for (size_t i = 0; i < 2 * n; i++) {
+        state->actual[i]   = (_read_packed(actual, i, out_format) - spec->offset) / spec->scale;
+        state->expected[i] = (_read_packed(expected, i, out_format) - spec->offset) / spec->scale;
+    }
+    state->num_compared = n;
+    return true;
+}
+
+static bool run_dc_block(CheckState* state) {
+    size_t n = state->num_samples;
+    s_config.dc_block.enable = true;
+    if (!dc_block_create(&s_config, &s_resources)) {
+        return false;
+    }
+
+    // The reference is H(z) = g (1 - z^-1) / (1 - (1 - alpha) z^-1). The overall
+    // gain g is taken from the first tap of the kernel's impulse response.
+    complex_float_t impulse = 1.0f;
+    dc_block_apply(&s_resources, &impulse, 1);
+    double g = (double)crealf(impulse);
+    dc_block_reset(&s_resources);
+
+    _fill_random_signal(state, CHECK_INPUT_AMPLITUDE);
+    memcpy(state->work, state->input, n * sizeof(complex_float_t));
+    dc_block_apply(&s_resources, state->work, (int)n);
+    dc_block_destroy(&s_resources);
+    _store_actual_cf32(state, state->work, n);
+
+    double alpha = (double)(float)(2.0 * M_PI * DC_BLOCK_CUTOFF_HZ / s_resources.source_info.samplerate);
+    double pole = 1.0 - alpha;
+    double prev_x[2] = { 0.0, 0.0 }, prev_y[2] = { 0.0, 0.0 };
+    for (size_t i = 0; i < n; i++) {
+        double x[2] = { (double)crealf(state->input[i]), (double)cimagf(state->input[i]) };
+        for (int c = 0; c < 2; c++) {
+            double y = g * (x[c] - prev_x[c]) + pole * prev_y[c];
+            prev_x[c] = x[c];
+            prev_y[c] = y;
+            state->expected[2 * i + (size_t)c] = y;
+        }
+    }
+    return true;
+}
+
+static bool run_iq_correct(CheckState* state) {
+    size_t n = state->num_samples;
+    s_config.iq_correction.enable = true;
+    if (!iq_correct_init(&s_config, &s_resources, &state->arena)) {
+        return false;
+    }
+    iq_correct_set_factors(&s_resources, CHECK_IQ_MAG, CHECK_IQ_PHASE);
+
+    _fill_random_signal(state, CHECK_INPUT_AMPLITUDE);
+    memcpy(state->work, state->input, n * sizeof(complex_float_t));
+    iq_correct_apply(&s_resources, state->work, (int)n);
+    iq_correct_destroy(&s_resources);
+    _store_actual_cf32(state, state->work, n);
+
+    const double mag = (double)CHECK_IQ_MAG, phase = (double)CHECK_IQ_PHASE;
+    for (size_t i = 0; i < n; i++) {
+        double re = (double)crealf(state->input[i]), im = (double)cimagf(state->input[i]);
+        state->expected[2 * i]     = re * (1.0 + mag);
+        state->expected[2 * i + 1] = im + phase * re;
+    }
+    return true;
+}
+
+static bool run_freq_shift(CheckState* state) {
+    size_t n = state->num_samples;
+    double shift_hz = (state->check->param >= 0) ? CHECK_NCO_SHIFT_HZ : -CHECK_NCO_SHIFT_HZ;
+    s_resources.nco_shift_hz = shift_hz;
+    if (!freq_shift_create(&s_config, &s_resources) || !s_resources.pre_resample_nco) {
+        return false;
+    }
+
+    _fill_random_signal(state, CHECK_INPUT_AMPLITUDE);
+    freq_shift_apply(s_resources.pre_resample_nco, shift_hz, state->input, state->work, (unsigned int)n);
+    freq_shift_destroy_ncos(&s_resources);
+    _store_actual_cf32(state, state->work, n);
+
+    // Same single-precision step as the kernel, so only the oscillator itself is measured.
+    double step = (double)(float)(2.0 * M_PI * fabs(shift_hz) / (double)s_resources.source_info.samplerate);
+    double sign = (shift_hz >= 0.0) ? 1.0 : -1.0;
+    for (size_t i = 0; i < n; i++) {
+        double phase = sign * fmod(step * (double)i, 2.0 * M_PI);
+        double c = cos(phase), s = sin(phase);
+        double re = (double)crealf(state->input[i]), im = (double)cimagf(state->input[i]);
+        state->expected[2 * i]     = re * c - im * s;
+        state->expected[2 * i + 1] = re * s + im * c;
+    }
+    return true;
+}
+
+/**
+ * @brief Shifts a block far into the run as --segments jobs would, and compares the join with one oscillator.
+ *
+ * The reference is the same oscillator stepped through CHECK_SEGMENT_ORIGIN
+ * samples, so any error in a job's starting phase grows with the origin.
+ */
+static bool run_freq_shift_segments(CheckState* state) {
+    size_t n = state->num_samples;
+    double shift_hz = (state->check->param >= 0) ? CHECK_NCO_SHIFT_HZ : -CHECK_NCO_SHIFT_HZ;
+    _fill_random_signal(state, CHECK_INPUT_AMPLITUDE);
+
+    s_resources.nco_shift_hz = shift_hz;
+    if (!freq_shift_create(&s_config, &s_resources) || !s_resources.pre_resample_nco) {
+        return false;
+    }
+    for (unsigned long long i = 0; i < CHECK_SEGMENT_ORIGIN; i++) {
+        nco_crcf_step((nco_crcf)s_resources.pre_resample_nco);
+    }
+    freq_shift_apply(s_resources.pre_resample_nco, shift_hz, state->input, state->work, (unsigned int)n);
+    freq_shift_destroy_ncos(&s_resources);
+    for (size_t i = 0; i < n; i++) {
+        state->expected[2 * i]     = (double)crealf(state->work[i]);
+        state->expected[2 * i + 1] = (double)cimagf(state->work[i]);
+    }
+
+    // Each job gets a fresh oscillator, started at its place in the run.
+    size_t start = 0;
+    for (int seg = 0; seg < CHECK_NUM_SEGMENTS; seg++) {
+        size_t jitter = n / (2 * CHECK_NUM_SEGMENTS) + 1;
+        size_t len = (seg == CHECK_NUM_SEGMENTS - 1) ? n - start
+                                                     : n / CHECK_NUM_SEGMENTS - (size_t)(_next_random(state) % jitter);
+        s_config.segment_job.active = true;
+        s_config.segment_job.input_origin = CHECK_SEGMENT_ORIGIN + start;
+        if (!freq_shift_create(&s_config, &s_resources) || !s_resources.pre_resample_nco) {
+            return false;
+        }
+        freq_shift_apply(s_resources.pre_resample_nco, shift_hz, state->input + start, state->work + start, (unsigned int)len);
+        freq_shift_destroy_ncos(&s_resources);
+        start += len;
+    }
+    _store_actual_cf32(state, state->work, n);
+    return true;
+}
+
+static bool _create_check_filter(CheckState* state, bool complex_taps, bool use_fft) {
+    _reset_app_state();
+    if (complex_taps) {
+        // An offset passband needs complex taps.
+        s_config.filter_requests[0] = (FilterRequest){ FILTER_TYPE_PASSBAND, 300000.0f, 200000.0f };
+    } else {
+        s_config.filter_requests[0] = (FilterRequest){ FILTER_TYPE_LOWPASS, 200000.0f, 0.0f };
+    }
+    s_config.num_filter_requests = 1;
+    s_config.filter_taps_arg = CHECK_FILTER_TAPS;
+    if (use_fft) {
+        s_config.filter_fft_size_arg = CHECK_FILTER_FFT_SIZE;
+        s_config.filter_type_str_arg = "fft";
+        s_config.filter_type_request = FILTER_TYPE_FFT;
+    } else {
+        s_config.filter_type_str_arg = "fir";
+        s_config.filter_type_request = FILTER_TYPE_FIR;
+    }
+    return filter_create(&s_config, &s_resources, &state->arena);
+}
+
+static bool run_filter(CheckState* state) {
+    size_t n = state->num_samples;
+    bool complex_taps = (state->check->param & FILTER_CHECK_COMPLEX) != 0;
+    bool use_fft = (state->check->param & FILTER_CHECK_FFT) != 0;
+
+    // The taps are recovered from the FIR filter's impulse response, which is
+    // exact: every output is a single tap times 1.0.
+    complex_float_t taps[CHECK_FILTER_TAPS];
+    if (!_create_check_filter(state, complex_taps, false)) {
+        return false;
+    }
+    memset(taps, 0, sizeof(taps));
+    taps[0] = 1.0f;
+    SampleChunk chunk;
+    memset(&chunk, 0, sizeof(chunk));
+    chunk.current_input_buffer = taps;
+    chunk.current_output_buffer = state->work;
+    chunk.frames_read = CHECK_FILTER_TAPS;
+    filter_apply(&s_resources, &chunk, false);
+    filter_destroy(&s_resources);
+
+    if (!_create_check_filter(state, complex_taps, use_fft)) {
+        return false;
+    }
+
+    // Feed the signal in irregular chunks to exercise the FFT remainder handling.
+    _fill_random_signal(state, CHECK_INPUT_AMPLITUDE);
+    complex_float_t* in_chunk = (complex_float_t*)state->raw;
+    size_t consumed = 0, produced = 0;
+    while (consumed < n) {
+        size_t len = 1 + (size_t)(_next_random(state) % CHECK_FILTER_MAX_CHUNK);
+        if (len > n - consumed) len = n - consumed;
+        memcpy(in_chunk, state->input + consumed, len * sizeof(complex_float_t));
+        chunk.current_input_buffer = in_chunk;
+        chunk.current_output_buffer = state->work + produced;
+        chunk.frames_read = (int64_t)len;
+        unsigned int frames_out = filter_apply(&s_resources, &chunk, false);
+        // The FIR filter works in place; the FFT filter writes to the output buffer.
+        if (s_resources.user_filter_type_actual == FILTER_IMPL_FIR_SYMMETRIC ||
+            s_resources.user_filter_type_actual == FILTER_IMPL_FIR_ASYMMETRIC) {
+            memcpy(state->work + produced, in_chunk, frames_out * sizeof(complex_float_t));
+        }
+        consumed += len;
+        produced += frames_out;
+    }
+    filter_destroy(&s_resources);
+    _store_actual_cf32(state, state->work, produced);
+
+    for (size_t i = 0; i < produced; i++) {
+        double acc_re = 0.0, acc_im = 0.0;
+        for (size_t k = 0; k < CHECK_FILTER_TAPS && k <= i; k++) {
+            double h_re = (double)crealf(taps[k]), h_im = (double)cimagf(taps[k]);
+            double x_re = (double)crealf(state->input[i - k]), x_im = (double)cimagf(state->input[i - k]);
+            acc_re += h_re * x_re - h_im * x_im;
+            acc_im += h_re * x_im + h_im * x_re;
+        }
+        state->expected[2 * i]     = acc_re;
+        state->expected[2 * i + 1] = acc_im;
+    }
+    return true;
+}
+
+// --- The Check Table ---
+
+#define CONVERT_CHECKS(fmt, name, lsb) \
+    { "convert_to_cf32",   name, run_convert_to_cf32,   fmt, 0, 1e-5, 120.0 }, \
+    { "convert_from_cf32", name, run_convert_from_cf32, fmt, 0, lsb,  60.0 }
+
+static const KernelCheck s_checks[] = {
+    CONVERT_CHECKS(CS8,     "cs8",     ONE_LSB(127.0)),
+    CONVERT_CHECKS(CU8,     "cu8",     ONE_LSB(127.0)),
+    CONVERT_CHECKS(CS16,    "cs16",    ONE_LSB(32767.0)),
+    CONVERT_CHECKS(SC16Q11, "sc16q11", ONE_LSB(2048.0)),
+    CONVERT_CHECKS(CU16,    "cu16",    ONE_LSB(32767.0)),
+    CONVERT_CHECKS(CS24,    "cs24",    ONE_LSB(8388607.0)),
+    CONVERT_CHECKS(CS32,    "cs32",    ONE_LSB(2147483647.0)),
+    CONVERT_CHECKS(CU32,    "cu32",    ONE_LSB(2147483647.0)),
+    CONVERT_CHECKS(CF32,    "cf32",    0.0),
+    // The transcoder must match the cf32 path bit for bit.
+    { "transcode",  "cu8_cs16",      run_transcode,  CU8,     CS16,    0.0, 0.0 },
+    { "transcode",  "cs8_cu8",       run_transcode,  CS8,     CU8,     0.0, 0.0 },
+    { "transcode",  "cs16_cs8",      run_transcode,  CS16,    CS8,     0.0, 0.0 },
+    { "transcode",  "cs16_cs16",     run_transcode,  CS16,    CS16,    0.0, 0.0 },
+    { "transcode",  "sc16q11_cs16",  run_transcode,  SC16Q11, CS16,    0.0, 0.0 },
+    { "transcode",  "sc16q11_copy",  run_transcode,  SC16Q11, SC16Q11, 0.0, 0.0 },
+    { "transcode",  "cu8_cs24",      run_transcode,  CU8,     CS24,    0.0, 0.0 },
+    { "transcode",  "cu16_cs24",     run_transcode,  CU16,    CS24,    0.0, 0.0 },
+    { "transcode",  "cs16_cu32",     run_transcode,  CS16,    CU32,    0.0, 0.0 },
+    { "transcode",  "cs16_cf32",     run_transcode,  CS16,    CF32,    0.0, 0.0 },
+    { "transcode",  "cs24_cs16",     run_transcode,  CS24,    CS16,    0.0, 0.0 },
+    { "transcode",  "cf32_sc16q11",  run_transcode,  CF32,    SC16Q11, 0.0, 0.0 },
+    { "dc_block",   "iirfilt",       run_dc_block,   CF32, 0,  1e-3, 80.0 },
+    { "iq_correct", "apply",         run_iq_correct, CF32, 0,  1e-6, 120.0 },
+    // The default NCO uses a sine lookup table, which limits it to roughly 50 dB.
+    { "nco_mix",    "up",            run_freq_shift, CF32, 1,  2e-2, 40.0 },
+    { "nco_mix",    "down",          run_freq_shift, CF32, -1, 2e-2, 40.0 },
+    // Only the starting phase differs from the single run, by less than its float rounding.
+    { "nco_mix",    "segments_up",   run_freq_shift_segments, CF32, 1,  1e-4, 80.0 },
+    { "nco_mix",    "segments_down", run_freq_shift_segments, CF32, -1, 1e-4, 80.0 },
+    { "filter",     "fir_symmetric", run_filter,     CF32, FILTER_CHECK_FIR,                        1e-4, 90.0 },
+    { "filter",     "fft_symmetric", run_filter,     CF32, FILTER_CHECK_FFT,                        1e-4, 90.0 },
+    { "filter",     "fir_complex",   run_filter,     CF32, FILTER_CHECK_FIR | FILTER_CHECK_COMPLEX, 1e-4, 90.0 },
+    { "filter",     "fft_complex",   run_filter,     CF32, FILTER_CHECK_FFT | FILTER_CHECK_COMPLEX, 1e-4, 90.0 },
+};
+
+// --- Running a Check ---
+
+static bool _run_check(const KernelCheck* check, CheckState* state, bool verbose) {
+    _reset_app_state();
+    state->check = check;
+    state->num_compared = 0;
+
+    if (!mem_arena_init(&state->arena, CHECK_ARENA_BYTES)) {
+        return false;
+    }
+    bool ran = check->run(state);
+    mem_arena_destroy(&state->arena);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s/%s", check->kernel, check->variant);
+    if (!ran || state->num_compared == 0) {
+        printf("%-32s %14s %10s  FAIL (kernel did not run)\n", name, "-", "-");
+        return false;
+    }
+
+    double max_abs_err = 0.0, signal_power = 0.0, error_power = 0.0;
+    size_t worst_index = 0;
+    for (size_t i = 0; i < 2 * state->num_compared; i++) {
+        double err = state->actual[i] - state->expected[i];
+        if (fabs(err) > max_abs_err || isnan(err)) {
+            max_abs_err = isnan(err) ? INFINITY : fabs(err);
+            worst_index = i / 2;
+        }
+        signal_power += state->expected[i] * state->expected[i];
+        error_power += err * err;
+    }
+    double snr_db = (error_power > 0.0) ? 10.0 * log10(signal_power / error_power) : INFINITY;
+
+    bool ok = (max_abs_err <= check->max_abs_err) && (snr_db >= check->min_snr_db);
+    printf("%-32s %14.3e %10.1f  %s\n", name, max_abs_err, snr_db, ok ? "ok" : "FAIL");
+    if (!ok || verbose) {
+        printf("    bounds: max error %.3e, SNR %.1f dB; worst sample %zu of %zu\n",
+               check->max_abs_err, check->min_snr_db, worst_index, state->num_compared);
+    }
+    return ok;
+}
+
+// --- Main Entry Point ---
+
+int main(int argc, const char* argv[]) {
+    const char* filter_str = NULL;
+    int samples_arg = 0;
+    const char* seed_str = NULL;
+    int verbose = 0;
+
+    static const char* const usages[] = {
+        "iq_tool_kernel_check [options]",
+        NULL,
+    };
+    struct argparse_option options[] = {
+        OPT_HELP(),
+        OPT_GROUP("Check Options"),
+        OPT_STRING(0, "filter", &filter_str, "Only run checks whose name contains this string.", NULL, 0, 0),
+        OPT_INTEGER(0, "samples", &samples_arg, "Random samples per check. (Default: 65536)", NULL, 0, 0),
+        OPT_STRING(0, "seed", &seed_str, "Seed for the random inputs (decimal or 0x hex).", NULL, 0, 0),
+        OPT_BOOLEAN(0, "verbose", &verbose, "Print the bounds of every check, not only failing ones.", NULL, 0, 0),
+        OPT_END(),
+    };
+    struct argparse argparse;
+    argparse_init(&argparse, options, usages, 0);
+    argparse_describe(&argparse, "\nCross-checks the iq_tool DSP kernels against golden reference implementations.", NULL);
+    argparse_parse(&argparse, argc, argv);
+
+    pthread_mutex_init(&g_console_mutex, NULL);
+    log_set_level(LOG_WARN); // Kernel setup is chatty at INFO.
+
+    CheckState state;
+    memset(&state, 0, sizeof(state));
+    state.num_samples = (samples_arg > 0) ? (size_t)samples_arg : CHECK_DEFAULT_SAMPLES;
+    unsigned long long seed = seed_str ? strtoull(seed_str, NULL, 0) : CHECK_DEFAULT_SEED;
+    if (seed == 0) seed = CHECK_DEFAULT_SEED; // xorshift cannot leave zero
+
+    // The FFT filter may hold back up to one block, and writes whole blocks.
+    size_t work_capacity = state.num_samples + CHECK_FILTER_FFT_SIZE + CHECK_FILTER_MAX_CHUNK;
+    state.input = (complex_float_t*)malloc(state.num_samples * sizeof(complex_float_t));
+    state.work = (complex_float_t*)malloc(work_capacity * sizeof(complex_float_t));
+    state.raw = malloc((state.num_samples > CHECK_FILTER_MAX_CHUNK ? state.num_samples : CHECK_FILTER_MAX_CHUNK) * sizeof(complex_float_t));
+    state.actual = (double*)malloc(work_capacity * 2 * sizeof(double));
+    state.expected = (double*)malloc(work_capacity * 2 * sizeof(double));
+    if (!state.input || !state.work || !state.raw || !state.actual || !state.expected) {
+        log_fatal("Failed to allocate check buffers.");
+        return EXIT_FAILURE;
+    }
+
+    printf("%s kernels, %zu samples per check, seed 0x%llx.\n\n",
+           DSP_REFERENCE_KERNELS ? "Reference" : "Optimized", state.num_samples, seed);
+    printf("%-32s %14s %10s  %s\n", "Kernel", "Max Error", "SNR (dB)", "Result");
+
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(s_checks) / sizeof(s_checks[0]); i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s/%s", s_checks[i].kernel, s_checks[i].variant);
+        if (filter_str && !strstr(name, filter_str)) {
+            continue;
+        }
+        state.rng_state = seed + i; // Each check gets its own, reproducible input.
+        if (!_run_check(&s_checks[i], &state, verbose != 0)) {
+            failures++;
+        }
+    }
+
+    printf("\n%s\n", failures ? "Some kernels are outside their bounds." : "All kernels match their references.");
+
+    free(state.input);
+    free(state.work);
+    free(state.raw);
+    free(state.actual);
+    free(state.expected);
+    mem_scratch_release();
+    pthread_mutex_destroy(&g_console_mutex);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
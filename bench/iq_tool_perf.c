@@ -0,0 +1,669 @@
+/**
+ * @file iq_tool_perf.c
+ * @brief End-to-end performance regression suite for iq_tool.
+ *
+ * Each case runs the real iq_tool executable with the synthetic signal
+ * generator as its input, through one representative processing chain, and
+ * writes the result to a raw file. For every case the driver records:
+ *
+ *   - throughput, as input megasamples per second of wall time (best of N runs),
+ *   - peak resident set size of the iq_tool process,
+ *   - a checksum of the output file (which must be identical across runs),
+ *   - the SNR of the generated tone as it appears in the output.
+ *
+ * Throughput, peak RSS and the checksum are compared against a checked-in
+ * baseline (bench/perf_baseline.txt). A case fails if it is slower or larger
+ * than the baseline by more than the allowed tolerance, if its checksum differs
+ * from a recorded one, or if the output SNR falls below the case's bound.
+ *
+ * A case with no recorded baseline only has its SNR checked. If every case
+ * that ran passed but one of them had no baseline, the driver exits with
+ * PERF_EXIT_SKIPPED, which CTest reports as skipped rather than passed.
+ *
+ * The suite is registered with CTest when configured with -DBUILD_PERF_TESTS=ON.
+ * Run `iq_tool_perf --update-baseline` (or the perf_baseline target) on the
+ * reference machine to re-record the baseline after an intended change.
+ */
+
+#include "argparse.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// --- Suite Tuning ---
+#define PERF_DEFAULT_REPEAT             3
+#define PERF_DEFAULT_MAX_SLOWDOWN_PCT   15.0    // Allowed throughput drop vs. baseline
+#define PERF_DEFAULT_MAX_RSS_GROWTH_PCT 20.0    // Allowed peak RSS growth vs. baseline
+#define PERF_MAX_CASE_ARGS              24
+#define PERF_MAX_BASELINE_ENTRIES       64
+#define PERF_SNR_BLOCK_FRAMES           4096
+#define PERF_PATH_MAX                   1024
+#define PERF_FNV_OFFSET_BASIS           0xcbf29ce484222325ULL
+#define PERF_FNV_PRIME                  0x100000001b3ULL
+#define PERF_EXIT_SKIPPED               77      // Automake/CTest convention for a skipped test
+
+// --- Type Definitions ---
+
+/**
+ * @struct PerfCase
+ * @brief One end-to-end configuration and the correctness bound its output must meet.
+ *
+ * Every case generates a clean tone at `tone_hz`, so the output SNR measures the
+ * damage done by the processing chain itself.
+ */
+typedef struct {
+    const char* name;
+    const char* description;
+    double input_rate_hz;
+    double duration_sec;
+    double tone_hz;
+    const char* args[PERF_MAX_CASE_ARGS]; ///< Case-specific iq_tool options, NULL-terminated
+    const char* output_format;            ///< cu8, cs16 or cf32
+    double output_rate_hz;
+    double settle_fraction;               ///< Leading part of the output skipped (filter/AGC transients)
+    double min_snr_db;
+} PerfCase;
+
+/**
+ * @struct PerfResult
+ * @brief What one case measured.
+ */
+typedef struct {
+    double msps;
+    long peak_rss_kb;
+    uint64_t checksum;
+    double snr_db;
+    long long output_frames;
+} PerfResult;
+
+/**
+ * @struct BaselineEntry
+ * @brief One line of the baseline file. Zero or "-" fields are not checked.
+ */
+typedef struct {
+    char name[64];
+    double msps;
+    long peak_rss_kb;
+    bool has_checksum;
+    uint64_t checksum;
+} BaselineEntry;
+
+// --- The Cases ---
+
+static const PerfCase s_cases[] = {
+    {
+        "nrsc5", "NRSC-5 preset (cu8, 1488375 Hz, digital AGC)",
+        2048000.0, 8.0, 100000.0,
+        { "--preset", "cu8-nrsc5", NULL },
+        "cu8", 1488375.0, 0.25, 30.0,
+    },
+    {
+        "decimate", "Heavy decimation (10 MHz -> 250 kHz)",
+        10000000.0, 4.0, 50000.0,
+        { "--output-rate", "250000", "--output-sample-format", "cf32", NULL },
+        "cf32", 250000.0, 0.25, 40.0,
+    },
+    {
+        "fft_filter", "Long FFT filter (4095 taps, low-pass 200 kHz)",
+        2048000.0, 8.0, 100000.0,
+        { "--no-resample", "--lowpass", "200000", "--filter-type", "fft", "--filter-taps", "4095",
+          "--output-sample-format", "cs16", NULL },
+        "cs16", 2048000.0, 0.25, 40.0,
+    },
+    {
+        "agc_iq", "AGC with I/Q correction and DC block on an impaired tone",
+        2048000.0, 8.0, 150000.0,
+        { "--no-resample", "--gen-iq-gain-imbalance", "1.0", "--gen-iq-phase-imbalance", "5.0",
+          "--gen-dc-offset", "0.05", "--iq-correction", "--dc-block", "--output-agc", "--agc-profile", "local",
+          "--output-sample-format", "cs16", NULL },
+        "cs16", 2048000.0, 0.5, 30.0,
+    },
+    {
+        "passthrough", "Raw passthrough (cs16 in, cs16 out)",
+        2048000.0, 16.0, 100000.0,
+        { "--raw-passthrough", "--no-resample", "--output-sample-format", "cs16", NULL },
+        "cs16", 2048000.0, 0.0, 60.0,
+    },
+};
+
+#define PERF_NUM_CASES (sizeof(s_cases) / sizeof(s_cases[0]))
+
+// --- Helpers ---
+
+static double _now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static const PerfCase* _find_case(const char* name) {
+    for (size_t i = 0; i < PERF_NUM_CASES; i++) {
+        if (strcmp(s_cases[i].name, name) == 0) {
+            return &s_cases[i];
+        }
+    }
+    return NULL;
+}
+
+static size_t _bytes_per_frame(const char* format) {
+    if (strcmp(format, "cu8") == 0) return 2;
+    if (strcmp(format, "cs16") == 0) return 4;
+    if (strcmp(format, "cf32") == 0) return 8;
+    return 0;
+}
+
+// --- Running iq_tool ---
+
+/**
+ * @brief Runs iq_tool once for a case, measuring wall time and the child's peak RSS.
+ *        The child's console output goes to `log_path`.
+ */
+static bool _run_iq_tool(const char* iq_tool, const PerfCase* pc, const char* output_path, const char* log_path,
+                         double* wall_sec, long* peak_rss_kb) {
+    char rate_str[32], freq_str[32], duration_str[32];
+    snprintf(rate_str, sizeof(rate_str), "%.0f", pc->input_rate_hz);
+    snprintf(freq_str, sizeof(freq_str), "%.0f", pc->tone_hz);
+    snprintf(duration_str, sizeof(duration_str), "%.3f", pc->duration_sec);
+
+    const char* argv[PERF_MAX_CASE_ARGS + 20];
+    int argc = 0;
+    argv[argc++] = iq_tool;
+    argv[argc++] = "--input";
+    argv[argc++] = "generator";
+    argv[argc++] = "--gen-signal";
+    argv[argc++] = "tone";
+    argv[argc++] = "--gen-sample-format";
+    argv[argc++] = "cs16";
+    argv[argc++] = "--gen-rate";
+    argv[argc++] = rate_str;
+    argv[argc++] = "--gen-freq";
+    argv[argc++] = freq_str;
+    argv[argc++] = "--gen-duration";
+    argv[argc++] = duration_str;
+    for (int i = 0; pc->args[i]; i++) {
+        argv[argc++] = pc->args[i];
+    }
+    argv[argc++] = "--output";
+    argv[argc++] = "raw-file";
+    argv[argc++] = output_path;
+    argv[argc] = NULL;
+
+    // A stale output file would make iq_tool ask before overwriting it.
+    unlink(output_path);
+
+    // Anything still buffered would otherwise be written twice, once by the child.
+    fflush(stdout);
+    fflush(stderr);
+
+    double start = _now_sec();
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "fork failed: %s\n", strerror(errno));
+        return false;
+    }
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_RDONLY);
+        int log_fd = open(log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (null_fd >= 0) dup2(null_fd, STDIN_FILENO);
+        if (log_fd >= 0) {
+            dup2(log_fd, STDOUT_FILENO);
+            dup2(log_fd, STDERR_FILENO);
+        }
+        execv(iq_tool, (char* const*)argv);
+        fprintf(stderr, "execv '%s' failed: %s\n", iq_tool, strerror(errno));
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    while (wait4(pid, &status, 0, &usage) < 0) {
+        if (errno != EINTR) {
+            fprintf(stderr, "wait4 failed: %s\n", strerror(errno));
+            return false;
+        }
+    }
+    *wall_sec = _now_sec() - start;
+
+#ifdef __APPLE__
+    *peak_rss_kb = (long)(usage.ru_maxrss / 1024); // Bytes on macOS
+#else
+    *peak_rss_kb = (long)usage.ru_maxrss;          // Kilobytes on Linux/BSD
+#endif
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "iq_tool failed for case '%s' (status %d). See %s\n", pc->name, status, log_path);
+        return false;
+    }
+    return true;
+}
+
+// --- Output Analysis ---
+
+/**
+ * @brief Checksums the output file and measures the SNR of the expected tone in it.
+ *
+ * The tone is fitted block by block (complex amplitude by least squares), so a
+ * slowly varying gain from the AGC is not counted as noise. Everything left
+ * over after the fit (images, spurs, quantization, filter ripple) is.
+ */
+static bool _analyze_output(const PerfCase* pc, const char* output_path, PerfResult* result) {
+    size_t frame_bytes = _bytes_per_frame(pc->output_format);
+    if (frame_bytes == 0) {
+        fprintf(stderr, "Unsupported output format '%s' in case '%s'.\n", pc->output_format, pc->name);
+        return false;
+    }
+
+    FILE* f = fopen(output_path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open output '%s': %s\n", output_path, strerror(errno));
+        return false;
+    }
+
+    fseeko(f, 0, SEEK_END);
+    long long total_frames = (long long)(ftello(f) / (off_t)frame_bytes);
+    fseeko(f, 0, SEEK_SET);
+    long long first_frame = (long long)((double)total_frames * pc->settle_fraction);
+
+    static unsigned char raw[PERF_SNR_BLOCK_FRAMES * 8];
+    double re[PERF_SNR_BLOCK_FRAMES], im[PERF_SNR_BLOCK_FRAMES];
+    double cycles_per_frame = pc->tone_hz / pc->output_rate_hz;
+    double signal_power = 0.0, residual_power = 0.0;
+    uint64_t hash = PERF_FNV_OFFSET_BASIS;
+    long long frame_index = 0;
+
+    size_t frames_read;
+    while ((frames_read = fread(raw, frame_bytes, PERF_SNR_BLOCK_FRAMES, f)) > 0) {
+        for (size_t i = 0; i < frames_read * frame_bytes; i++) {
+            hash = (hash ^ raw[i]) * PERF_FNV_PRIME;
+        }
+
+        for (size_t i = 0; i < frames_read; i++) {
+            if (frame_bytes == 2) {
+                re[i] = ((double)raw[2 * i] - 127.5) / 127.5;
+                im[i] = ((double)raw[2 * i + 1] - 127.5) / 127.5;
+            } else if (frame_bytes == 4) {
+                int16_t s[2];
+                memcpy(s, raw + 4 * i, sizeof(s));
+                re[i] = (double)s[0] / 32768.0;
+                im[i] = (double)s[1] / 32768.0;
+            } else {
+                float s[2];
+                memcpy(s, raw + 8 * i, sizeof(s));
+                re[i] = (double)s[0];
+                im[i] = (double)s[1];
+            }
+        }
+
+        // Only full blocks past the settling period are scored.
+        if (frame_index >= first_frame && frames_read == PERF_SNR_BLOCK_FRAMES) {
+            double a_re = 0.0, a_im = 0.0;
+            for (size_t i = 0; i < frames_read; i++) {
+                double phase = 2.0 * M_PI * fmod(cycles_per_frame * (double)(frame_index + (long long)i), 1.0);
+                double c = cos(phase), s = sin(phase);
+                a_re += re[i] * c + im[i] * s;  // x * e^{-j phase}
+                a_im += im[i] * c - re[i] * s;
+            }
+            a_re /= (double)frames_read;
+            a_im /= (double)frames_read;
+
+            double residual = 0.0;
+            for (size_t i = 0; i < frames_read; i++) {
+                double phase = 2.0 * M_PI * fmod(cycles_per_frame * (double)(frame_index + (long long)i), 1.0);
+                double c = cos(phase), s = sin(phase);
+                double e_re = re[i] - (a_re * c - a_im * s);
+                double e_im = im[i] - (a_re * s + a_im * c);
+                residual += e_re * e_re + e_im * e_im;
+            }
+            signal_power += (a_re * a_re + a_im * a_im) * (double)frames_read;
+            residual_power += residual;
+        }
+        frame_index += (long long)frames_read;
+    }
+
+    bool ok = (ferror(f) == 0);
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "Failed to read output '%s'.\n", output_path);
+        return false;
+    }
+
+    result->checksum = hash;
+    result->output_frames = total_frames;
+    if (signal_power <= 0.0) {
+        result->snr_db = -INFINITY;
+    } else if (residual_power <= 0.0) {
+        result->snr_db = INFINITY;
+    } else {
+        result->snr_db = 10.0 * log10(signal_power / residual_power);
+    }
+    return true;
+}
+
+// --- Baseline File ---
+
+static int _load_baseline(const char* path, BaselineEntry* entries, int max_entries) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) && count < max_entries) {
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        BaselineEntry* e = &entries[count];
+        char checksum_str[32] = "-";
+        memset(e, 0, sizeof(*e));
+        if (sscanf(p, "%63s %lf %ld %31s", e->name, &e->msps, &e->peak_rss_kb, checksum_str) < 3) {
+            fprintf(stderr, "Ignoring malformed baseline line: %s", line);
+            continue;
+        }
+        if (strcmp(checksum_str, "-") != 0) {
+            e->has_checksum = true;
+            e->checksum = strtoull(checksum_str, NULL, 16);
+        }
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static bool _save_baseline(const char* path, const BaselineEntry* entries, int count) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Cannot write baseline '%s': %s\n", path, strerror(errno));
+        return false;
+    }
+
+    fprintf(f, "# iq_tool end-to-end performance baseline, read by iq_tool_perf.\n");
+    fprintf(f, "# Re-record on the reference machine with: iq_tool_perf --iq-tool <path> --update-baseline\n");
+    fprintf(f, "# A value of 0 (or - for the checksum) disables that check for the case.\n");
+    fprintf(f, "# A case with no recorded value is reported as skipped until the baseline is recorded.\n");
+    fprintf(f, "#\n# %-12s %12s %14s  %s\n", "case", "msps", "peak_rss_kb", "checksum");
+    for (int i = 0; i < count; i++) {
+        const BaselineEntry* e = &entries[i];
+        fprintf(f, "%-14s %12.3f %14ld  ", e->name, e->msps, e->peak_rss_kb);
+        if (e->has_checksum) {
+            fprintf(f, "%016llx\n", (unsigned long long)e->checksum);
+        } else {
+            fprintf(f, "-\n");
+        }
+    }
+
+    bool ok = (ferror(f) == 0);
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+static BaselineEntry* _find_baseline(BaselineEntry* entries, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+// --- Running a Case ---
+
+static bool _run_case(const PerfCase* pc, const char* iq_tool, const char* work_dir, int repeat, bool keep_output,
+                      PerfResult* result) {
+    char output_path[PERF_PATH_MAX], log_path[PERF_PATH_MAX];
+    snprintf(output_path, sizeof(output_path), "%s/perf_%s.%s", work_dir, pc->name, pc->output_format);
+    snprintf(log_path, sizeof(log_path), "%s/perf_%s.log", work_dir, pc->name);
+
+    printf("[%s] %s\n", pc->name, pc->description);
+
+    double best_wall = INFINITY;
+    long peak_rss_kb = 0;
+    bool have_checksum = false;
+    uint64_t first_checksum = 0;
+
+    for (int run = 0; run < repeat; run++) {
+        double wall = 0.0;
+        long rss = 0;
+        if (!_run_iq_tool(iq_tool, pc, output_path, log_path, &wall, &rss)) {
+            return false;
+        }
+        if (!_analyze_output(pc, output_path, result)) {
+            return false;
+        }
+        if (wall < best_wall) best_wall = wall;
+        if (rss > peak_rss_kb) peak_rss_kb = rss;
+
+        if (have_checksum && result->checksum != first_checksum) {
+            fprintf(stderr, "[%s] FAIL: output differs between runs (%016llx vs %016llx).\n", pc->name,
+                    (unsigned long long)first_checksum, (unsigned long long)result->checksum);
+            return false;
+        }
+        first_checksum = result->checksum;
+        have_checksum = true;
+    }
+
+    if (!keep_output) {
+        unlink(output_path);
+    }
+
+    result->msps = (pc->input_rate_hz * pc->duration_sec) / best_wall / 1e6;
+    result->peak_rss_kb = peak_rss_kb;
+
+    printf("[%s] %.2f MS/s, peak RSS %ld KB, %lld output frames, SNR %.1f dB, checksum %016llx\n", pc->name,
+           result->msps, result->peak_rss_kb, result->output_frames, result->snr_db,
+           (unsigned long long)result->checksum);
+    fflush(stdout);
+    return true;
+}
+
+/**
+ * @brief Returns true if a baseline entry records at least one value to compare against.
+ */
+static bool _baseline_is_recorded(const BaselineEntry* base) {
+    return base && (base->msps > 0.0 || base->peak_rss_kb > 0 || base->has_checksum);
+}
+
+/**
+ * @brief Compares a case's result against its bound and its baseline entry.
+ */
+static bool _check_case(const PerfCase* pc, const PerfResult* result, const BaselineEntry* base,
+                        double max_slowdown_pct, double max_rss_growth_pct) {
+    bool ok = true;
+
+    if (!(result->snr_db >= pc->min_snr_db)) {
+        fprintf(stderr, "[%s] FAIL: output SNR %.1f dB is below the %.1f dB bound.\n", pc->name, result->snr_db,
+                pc->min_snr_db);
+        ok = false;
+    }
+
+    if (!base) {
+        return ok;
+    }
+
+    if (base->msps > 0.0) {
+        double floor_msps = base->msps * (1.0 - max_slowdown_pct / 100.0);
+        if (result->msps < floor_msps) {
+            fprintf(stderr, "[%s] FAIL: throughput %.2f MS/s is %.1f%% below the baseline %.2f MS/s (limit %.0f%%).\n",
+                    pc->name, result->msps, 100.0 * (1.0 - result->msps / base->msps), base->msps, max_slowdown_pct);
+            ok = false;
+        }
+    }
+
+    if (base->peak_rss_kb > 0) {
+        double ceiling_kb = (double)base->peak_rss_kb * (1.0 + max_rss_growth_pct / 100.0);
+        if ((double)result->peak_rss_kb > ceiling_kb) {
+            fprintf(stderr, "[%s] FAIL: peak RSS %ld KB is %.1f%% above the baseline %ld KB (limit %.0f%%).\n",
+                    pc->name, result->peak_rss_kb,
+                    100.0 * ((double)result->peak_rss_kb / (double)base->peak_rss_kb - 1.0), base->peak_rss_kb,
+                    max_rss_growth_pct);
+            ok = false;
+        }
+    }
+
+    if (base->has_checksum && base->checksum != result->checksum) {
+        fprintf(stderr, "[%s] FAIL: output checksum %016llx does not match the golden %016llx.\n", pc->name,
+                (unsigned long long)result->checksum, (unsigned long long)base->checksum);
+        ok = false;
+    }
+
+    return ok;
+}
+
+// --- Main Entry Point ---
+
+int main(int argc, const char* argv[]) {
+    const char* iq_tool = NULL;
+    const char* case_name = NULL;
+    const char* baseline_path = NULL;
+    const char* work_dir = ".";
+    int repeat = 0;
+    float max_slowdown_arg = 0.0f;
+    float max_rss_growth_arg = 0.0f;
+    int update_baseline = 0;
+    int record_checksums = 0;
+    int keep_output = 0;
+    int list_cases = 0;
+
+    static const char* const usages[] = {
+        "iq_tool_perf --iq-tool <path> [options]",
+        NULL,
+    };
+    struct argparse_option options[] = {
+        OPT_HELP(),
+        OPT_GROUP("Suite Options"),
+        OPT_STRING(0, "iq-tool", &iq_tool, "Path of the iq_tool executable under test.", NULL, 0, 0),
+        OPT_STRING(0, "case", &case_name, "Run only this case. (Default: all)", NULL, 0, 0),
+        OPT_STRING(0, "baseline", &baseline_path, "Baseline file to compare against (or update).", NULL, 0, 0),
+        OPT_STRING(0, "work-dir", &work_dir, "Directory for output files and logs. (Default: .)", NULL, 0, 0),
+        OPT_INTEGER(0, "repeat", &repeat, "Runs per case; the fastest counts. (Default: 3)", NULL, 0, 0),
+        OPT_FLOAT(0, "max-slowdown", &max_slowdown_arg, "Allowed throughput drop vs. baseline, in percent. (Default: 15)", NULL, 0, 0),
+        OPT_FLOAT(0, "max-rss-growth", &max_rss_growth_arg, "Allowed peak RSS growth vs. baseline, in percent. (Default: 20)", NULL, 0, 0),
+        OPT_BOOLEAN(0, "update-baseline", &update_baseline, "Record the measured results into the baseline file instead of checking.", NULL, 0, 0),
+        OPT_BOOLEAN(0, "record-checksums", &record_checksums, "With --update-baseline, also record golden output checksums.", NULL, 0, 0),
+        OPT_BOOLEAN(0, "keep-output", &keep_output, "Keep each case's output file.", NULL, 0, 0),
+        OPT_BOOLEAN(0, "list", &list_cases, "List the cases and exit.", NULL, 0, 0),
+        OPT_END(),
+    };
+    struct argparse argparse;
+    argparse_init(&argparse, options, usages, 0);
+    argparse_describe(&argparse, "\nEnd-to-end performance regression suite for iq_tool.", NULL);
+    argparse_parse(&argparse, argc, argv);
+
+    if (list_cases) {
+        for (size_t i = 0; i < PERF_NUM_CASES; i++) {
+            printf("%-14s %s\n", s_cases[i].name, s_cases[i].description);
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (!iq_tool) {
+        fprintf(stderr, "Missing required argument: --iq-tool <path>\n");
+        return EXIT_FAILURE;
+    }
+    if (update_baseline && !baseline_path) {
+        fprintf(stderr, "Option --update-baseline requires --baseline <file>.\n");
+        return EXIT_FAILURE;
+    }
+    if (case_name && !_find_case(case_name)) {
+        fprintf(stderr, "Unknown case '%s'. Use --list to see the cases.\n", case_name);
+        return EXIT_FAILURE;
+    }
+
+    if (repeat <= 0) repeat = PERF_DEFAULT_REPEAT;
+    double max_slowdown_pct = (max_slowdown_arg > 0.0f) ? (double)max_slowdown_arg : PERF_DEFAULT_MAX_SLOWDOWN_PCT;
+    double max_rss_growth_pct = (max_rss_growth_arg > 0.0f) ? (double)max_rss_growth_arg : PERF_DEFAULT_MAX_RSS_GROWTH_PCT;
+
+    BaselineEntry baseline[PERF_MAX_BASELINE_ENTRIES];
+    int num_baseline = 0;
+    if (baseline_path) {
+        num_baseline = _load_baseline(baseline_path, baseline, PERF_MAX_BASELINE_ENTRIES);
+        if (num_baseline < 0) {
+            if (!update_baseline) {
+                fprintf(stderr, "Cannot read baseline '%s': %s\n", baseline_path, strerror(errno));
+                return EXIT_FAILURE;
+            }
+            num_baseline = 0;
+        }
+    }
+
+    bool all_ok = true;
+    bool any_unrecorded = false;
+    for (size_t i = 0; i < PERF_NUM_CASES; i++) {
+        const PerfCase* pc = &s_cases[i];
+        if (case_name && strcmp(pc->name, case_name) != 0) {
+            continue;
+        }
+
+        PerfResult result;
+        memset(&result, 0, sizeof(result));
+        if (!_run_case(pc, iq_tool, work_dir, repeat, keep_output, &result)) {
+            all_ok = false;
+            continue;
+        }
+
+        BaselineEntry* base = _find_baseline(baseline, num_baseline, pc->name);
+        if (!update_baseline) {
+            if (!_baseline_is_recorded(base)) {
+                printf("[%s] SKIP: no recorded baseline; throughput, RSS and checksum not compared.\n", pc->name);
+                any_unrecorded = true;
+            }
+            if (!_check_case(pc, &result, base, max_slowdown_pct, max_rss_growth_pct)) {
+                all_ok = false;
+            }
+            continue;
+        }
+
+        // Correctness bounds still apply when re-recording.
+        if (!_check_case(pc, &result, NULL, max_slowdown_pct, max_rss_growth_pct)) {
+            all_ok = false;
+            continue;
+        }
+        if (!base) {
+            if (num_baseline >= PERF_MAX_BASELINE_ENTRIES) {
+                fprintf(stderr, "Baseline file has too many entries.\n");
+                return EXIT_FAILURE;
+            }
+            base = &baseline[num_baseline++];
+            memset(base, 0, sizeof(*base));
+            snprintf(base->name, sizeof(base->name), "%s", pc->name);
+        }
+        base->msps = result.msps;
+        base->peak_rss_kb = result.peak_rss_kb;
+        if (record_checksums) {
+            base->has_checksum = true;
+            base->checksum = result.checksum;
+        }
+    }
+
+    if (update_baseline && all_ok) {
+        if (!_save_baseline(baseline_path, baseline, num_baseline)) {
+            return EXIT_FAILURE;
+        }
+        printf("Baseline written to %s\n", baseline_path);
+    }
+
+    if (!all_ok) {
+        return EXIT_FAILURE;
+    }
+    return any_unrecorded ? PERF_EXIT_SKIPPED : EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file analysis_tap.h
+ * @brief Defines a lock-free snapshot ring for feeding side-channel analysis threads.
+ *
+ * An analysis tap lets a pipeline stage publish fixed-size windows of samples
+ * to any number of lower-priority consumers (the I/Q optimizer, meters,
+ * spectrum displays) without giving them access to the main chunk pool.
+ *
+ * - The producer never blocks and never waits for consumers. It always
+ *   overwrites the oldest slot (drop-oldest), and it skips publishing
+ *   entirely if the previous window was published less than the configured
+ *   interval ago (rate limiting).
+ * - Each consumer keeps its own AnalysisTapReader cursor, so consumers are
+ *   independent of each other. A slow consumer just skips windows.
+ * - Slots are protected by per-slot sequence numbers (a seqlock), so a reader
+ *   that races with the producer retries instead of seeing a torn window.
+ */
+
+#ifndef ANALYSIS_TAP_H_
+#define ANALYSIS_TAP_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "common_types.h"
+
+// --- Type Definitions ---
+
+typedef struct AnalysisTap AnalysisTap;
+
+/**
+ * @struct AnalysisTapReader
+ * @brief Per-consumer read position. Initialize with analysis_tap_subscribe().
+ */
+typedef struct {
+    unsigned long long cursor;    ///< Sequence number of the last window read.
+    unsigned long long dropped;   ///< Windows overwritten before this reader got to them.
+} AnalysisTapReader;
+
+/**
+ * @enum AnalysisTapReadResult
+ * @brief The outcome of a read attempt.
+ */
+typedef enum {
+    ANALYSIS_TAP_READ_OK,       ///< A window was copied to the caller's buffer.
+    ANALYSIS_TAP_READ_EMPTY,    ///< No new window is available yet.
+    ANALYSIS_TAP_READ_CLOSED    ///< The tap was closed and every window has been read.
+} AnalysisTapReadResult;
+
+
+// --- Function Declarations ---
+
+/**
+ * @brief Creates an analysis tap.
+ * @param window_samples The number of complex samples in each published window.
+ * @param min_interval_ms The minimum time between two published windows. 0 disables rate limiting.
+ * @return A pointer to the new tap, or NULL on memory allocation failure.
+ */
+AnalysisTap* analysis_tap_create(size_t window_samples, unsigned int min_interval_ms);
+
+/**
+ * @brief Destroys a tap. All producers and consumers must have stopped.
+ * @param tap The tap to destroy. NULL is ignored.
+ */
+void analysis_tap_destroy(AnalysisTap* tap);
+
+/**
+ * @brief Gets the number of complex samples in each window.
+ * @param tap The tap.
+ * @return The window size in samples.
+ */
+size_t analysis_tap_get_window_samples(const AnalysisTap* tap);
+
+/**
+ * @brief Publishes the first window_samples samples of a block. (Producer-side Function)
+ *
+ * Never blocks. Only one thread may publish to a given tap.
+ *
+ * @param tap The tap.
+ * @param samples The samples to copy.
+ * @param num_samples The number of samples available. Blocks shorter than one window are ignored.
+ * @return true if a window was published, false if it was skipped (rate limit or short block).
+ */
+bool analysis_tap_publish(AnalysisTap* tap, const complex_float_t* samples, size_t num_samples);
+
+/**
+ * @brief Marks the tap as closed so consumers stop waiting for new windows.
+ *
+ * Safe to call from any thread, more than once, and from the shutdown path.
+ *
+ * @param tap The tap. NULL is ignored.
+ */
+void analysis_tap_close(AnalysisTap* tap);
+
+/**
+ * @brief Initializes a reader so it only sees windows published from now on.
+ * @param tap The tap.
+ * @param reader The reader to initialize.
+ */
+void analysis_tap_subscribe(AnalysisTap* tap, AnalysisTapReader* reader);
+
+/**
+ * @brief Copies the next unread window into the caller's buffer. (Consumer-side Function)
+ *
+ * Never blocks. If the reader has fallen behind by more than the ring size,
+ * it jumps to the oldest window still available and counts the rest as dropped.
+ *
+ * @param tap The tap.
+ * @param reader The caller's reader.
+ * @param out A buffer of at least analysis_tap_get_window_samples() samples.
+ * @return The outcome of the read.
+ */
+AnalysisTapReadResult analysis_tap_read(AnalysisTap* tap, AnalysisTapReader* reader, complex_float_t* out);
+
+/**
+ * @brief Like analysis_tap_read(), but sleeps and polls until a window is available or the tap is closed.
+ * @param tap The tap.
+ * @param reader The caller's reader.
+ * @param out A buffer of at least analysis_tap_get_window_samples() samples.
+ * @return ANALYSIS_TAP_READ_OK or ANALYSIS_TAP_READ_CLOSED.
+ */
+AnalysisTapReadResult analysis_tap_wait_read(AnalysisTap* tap, AnalysisTapReader* reader, complex_float_t* out);
+
+#endif // ANALYSIS_TAP_H_
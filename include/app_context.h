@@ -13,9 +13,12 @@
 #include "presets_loader.h"
 #include "constants.h"
 #include "resampler.h" // For resampler_t
+#include <stdatomic.h>
 
 // --- Forward Declarations ---
 struct RingBuffer;
+struct AnalysisTap;
+struct Telemetry;
 
 // --- Type Definitions ---
 
@@ -59,6 +62,45 @@ typedef struct {
     float freq2_hz;
 } FilterRequest;
 
+/**
+ * @enum RangeValueUnit
+ * @brief How a --start or --duration value was given on the command line.
+ */
+typedef enum {
+    RANGE_VALUE_UNSET,
+    RANGE_VALUE_SAMPLES,
+    RANGE_VALUE_SECONDS,
+    RANGE_VALUE_UTC        ///< An absolute UTC date and time (--start only).
+} RangeValueUnit;
+
+/**
+ * @struct RangeValue
+ * @brief A parsed --start or --duration value, resolved to frames by the input module.
+ */
+typedef struct {
+    RangeValueUnit     unit;
+    unsigned long long samples;  ///< For RANGE_VALUE_SAMPLES.
+    double             seconds;  ///< Seconds for RANGE_VALUE_SECONDS, Unix time for RANGE_VALUE_UTC.
+} RangeValue;
+
+/**
+ * @struct SegmentJob
+ * @brief The share of a --segments run handed to one job (see segment.h).
+ *
+ * Parsed from the internal --segment-job option, which only the parent
+ * process puts on a job's command line.
+ */
+typedef struct {
+    bool               active;
+    unsigned int       index;          ///< The segment number, echoed in progress reports.
+    unsigned long long input_origin;   ///< First input frame of the job, counted from the start of the run.
+    unsigned long long output_origin;  ///< Output frame the job's first output frame stands for.
+    unsigned long long skip_frames;    ///< Warm-up output frames to discard.
+    unsigned long long write_frames;   ///< Output frames to write after the warm-up, 0 for all.
+    unsigned long long write_offset;   ///< File offset of the first byte written.
+    int                report_fd;      ///< Pipe for progress reports to the parent.
+} SegmentJob;
+
 /**
  * @struct AppConfig
  * @brief Stores all user-defined configuration settings for the application.
@@ -87,6 +129,12 @@ typedef struct AppConfig {
     DcBlockConfig      dc_block;
     OutputAgcConfig    output_agc;
 
+    // --- Input Range (file inputs) ---
+    const char* start_str_arg;
+    const char* duration_str_arg;
+    RangeValue  range_start;
+    RangeValue  range_duration;
+
     // --- Internal State from CLI Parsing ---
     FilterRequest filter_requests[MAX_FILTER_CHAIN];
     int         num_filter_requests;
@@ -115,6 +163,35 @@ typedef struct AppConfig {
         bool   bias_t_enable;
     } sdr;
 
+    // --- Memory & Pipeline Sizing Arguments ---
+    const char* memory_budget_str_arg;
+    const char* arena_size_str_arg;
+    const char* sdr_buffer_size_str_arg;
+    const char* writer_buffer_size_str_arg;
+    int         pipeline_chunks_arg;
+    int         chunk_samples_arg;
+    int         use_huge_pages;
+    int         lock_memory;
+    int         mmap_input;
+    int         read_ahead_depth;
+    int         write_behind_depth;
+    int         direct_io;
+    const char* stdout_pipe_size_str_arg;
+    int         stdout_zero_copy;
+    int         segments;
+    const char* segment_job_str_arg;
+    SegmentJob  segment_job;
+
+    // --- Diagnostics Arguments ---
+    const char* stats_json_path;
+    const char* trace_path;
+    int         perf_counters;
+    unsigned long long memory_budget_bytes;   ///< 0 if no budget was given.
+    size_t      arena_size_bytes;             ///< 0 if not overridden.
+    size_t      sdr_buffer_size_bytes;        ///< 0 if not overridden.
+    size_t      writer_buffer_size_bytes;     ///< 0 if not overridden.
+    size_t      stdout_pipe_size_bytes;       ///< The stdout pipe capacity to request (--stdout-pipe-size).
+
     // --- Resolved Final Configuration ---
     OutputType  output_type;
     format_t    output_format;
@@ -160,9 +237,9 @@ typedef struct {
  * @brief Holds all allocated objects and state for the I/Q correction module.
  */
 typedef struct {
-    IqCorrectionFactors factors_buffer[2];
-    int                 active_buffer_idx;
-    pthread_mutex_t     iq_factors_mutex;
+    // The current IqCorrectionFactors, packed into one 64-bit word so that the
+    // optimizer can publish them and the pre-processor can read them without a lock.
+    atomic_ullong       published_factors;
     void*               fft_plan; // Opaque pointer
     complex_float_t*    fft_buffer;
     complex_float_t*    fft_shift_buffer;
@@ -170,7 +247,7 @@ typedef struct {
     float*              window_coeffs;
     float               average_power;
     float               power_range;
-    complex_float_t*    optimization_accum_buffer;
+    complex_float_t*    optimization_accum_buffer; ///< Window read from the analysis tap by the optimizer thread.
     int                 samples_in_accum;
     double              last_optimization_time;
 } IqCorrectionResources;
@@ -216,11 +293,13 @@ typedef struct AppResources {
     DcBlockResources      dc_block;
     FilterImplementationType user_filter_type_actual;
     void*           user_filter_object; // Opaque pointer to the final filter (FIR or FFT)
+    unsigned int    user_filter_taps;   // Length of the combined filter, 0 if there is none
     unsigned int    user_filter_block_size;
     complex_float_t* pre_fft_remainder_buffer;
     unsigned int     pre_fft_remainder_len;
     complex_float_t* post_fft_remainder_buffer;
     unsigned int     post_fft_remainder_len;
+    struct Transcoder* transcoder;      ///< Set when the run is a pure format conversion; replaces the DSP threads.
 
     // --- Output AGC State ---
     void*           output_agc_object;
@@ -240,6 +319,10 @@ typedef struct AppResources {
     void*           input_module_private_data;
     void*           output_module_private_data;
     bool            pacing_is_required;
+    bool            input_is_mapped;     ///< The file reader hands out pointers into a mapping instead of filling raw_input_data.
+    unsigned long long input_start_frame; ///< First frame of a --start range in the input file, 0 otherwise.
+    const unsigned char* input_auxi_chunk;       ///< The input WAV's raw 'auxi' chunk, copied into WAV outputs (NULL if none).
+    size_t          input_auxi_chunk_bytes;
 
     // --- Memory Management ---
     MemoryArena     setup_arena;
@@ -250,6 +333,23 @@ typedef struct AppResources {
     void*           writer_local_buffer;
     unsigned int    max_out_samples;
 
+    // --- Pipeline Sizing Plan (resolved at runtime, see pipeline.c) ---
+    size_t          arena_size_bytes;
+    size_t          pipeline_num_chunks;
+    size_t          pipeline_chunk_base_samples;
+    size_t          pipeline_chunk_pool_bytes;
+    size_t          sdr_input_buffer_bytes;
+    size_t          writer_input_buffer_bytes;
+    size_t          writer_backpressure_threshold_bytes;
+    bool            page_faults_available;
+    unsigned long long page_faults_minor;     ///< Faults taken while the pipeline threads ran, including first touches of the buffers.
+    unsigned long long page_faults_major;
+    unsigned long long page_faults_first_touch_max; ///< Pages spanned by the chunk pool and rings: the most first touches can add.
+    bool            latency_available;
+    double          latency_p50_ms;           ///< Capture-to-output latency percentiles.
+    double          latency_p99_ms;
+    double          latency_p999_ms;
+
     // --- Threading & Pipeline ---
     PipelineMode    pipeline_mode;
     ThreadFlags     threads_to_create;
@@ -263,18 +363,22 @@ typedef struct AppResources {
     Queue*          resampler_output_queue;
     Queue*          post_processor_input_queue;
     Queue*          post_processor_output_queue;
+    Queue*          transcoder_input_queue;
+    Queue*          transcoder_output_queue;
     Queue*          writer_input_queue;
-    Queue*          iq_optimization_data_queue;
+    struct AnalysisTap* iq_analysis_tap;
+    struct Telemetry* telemetry;            ///< Stage timing and latency; exported by --stats-json.
     Queue*          free_sample_chunk_queue;
     struct RingBuffer* writer_input_buffer;
 
     // --- Progress & State Tracking ---
-    pthread_mutex_t progress_mutex;
-    double          last_sdr_heartbeat_time;
-    bool            error_occurred;
-    bool            end_of_stream_reached;
-    unsigned long long total_frames_read;
-    unsigned long long total_output_frames;
+    // These are updated from the capture callback, reader and writer threads,
+    // so they are atomics rather than fields guarded by a shared lock.
+    atomic_ullong   last_sdr_heartbeat_ms;    ///< Coarse monotonic time of the last SDR data, 0 if none yet.
+    atomic_bool     error_occurred;
+    atomic_bool     end_of_stream_reached;
+    atomic_ullong   total_frames_read;
+    atomic_ullong   total_output_frames;
     long long       final_output_size_bytes;
     long long       expected_total_output_frames;
     time_t          start_time;
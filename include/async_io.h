@@ -0,0 +1,97 @@
+/**
+ * @file async_io.h
+ * @brief Defines the asynchronous positional I/O layer behind --read-ahead and --write-behind.
+ *
+ * A small submit/wait interface for reads and writes at explicit file
+ * offsets, with two backends:
+ *  - io_uring (Linux), driven through the raw system calls so no extra
+ *    library is needed.
+ *  - A small pool of pread()/pwrite() worker threads, used where io_uring is
+ *    not available or is blocked (older kernels, some containers).
+ *
+ * A request is complete when all of its bytes have been transferred, a read
+ * reaches the end of the file, or an error occurs. Short transfers are
+ * resubmitted internally. One thread owns an AsyncIo instance: it alone
+ * submits and waits.
+ *
+ * POSIX only. On Windows async_io_create() returns NULL.
+ */
+
+#ifndef ASYNC_IO_H_
+#define ASYNC_IO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+// --- Type Definitions ---
+
+typedef struct AsyncIo AsyncIo;
+
+typedef enum {
+    ASYNC_IO_READ,
+    ASYNC_IO_WRITE
+} AsyncIoOp;
+
+/**
+ * @struct AsyncIoRequest
+ * @brief One positional read or write. Owned by the caller; must stay valid until waited for.
+ */
+typedef struct AsyncIoRequest {
+    AsyncIoOp          op;
+    unsigned char*     buffer;
+    size_t             length;
+    unsigned long long offset;
+    size_t             done;   ///< Bytes transferred (valid after async_io_wait()).
+    int                error;  ///< errno of a failed transfer, 0 otherwise.
+
+    // --- Private to async_io.c ---
+    int                    state;
+    struct AsyncIoRequest* next_pending;
+#ifndef _WIN32
+    struct iovec           iov;
+#endif
+} AsyncIoRequest;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Creates an I/O context for a file descriptor.
+ * @param fd The file to read or write. Not closed by async_io_destroy().
+ * @param depth The largest number of requests the caller keeps in flight.
+ * @param direct_io true if fd was opened with O_DIRECT. A read that reaches
+ *        an unaligned end of file then completes instead of failing.
+ * @return The context, or NULL if neither backend could be started.
+ */
+AsyncIo* async_io_create(int fd, unsigned int depth, bool direct_io);
+
+/**
+ * @brief Starts a request. Never blocks on the transfer itself; with io_uring
+ *        it may wait for another request to complete if the kernel is busy.
+ */
+void async_io_submit(AsyncIo* aio, AsyncIoRequest* request);
+
+/**
+ * @brief Waits until a previously submitted request is complete.
+ *
+ * If the io_uring ring fails while the kernel owns the request, the request is
+ * cancelled and still waited for. Only if the ring cannot complete it at all
+ * does this return with the error set while the buffer may still be in use.
+ */
+void async_io_wait(AsyncIo* aio, AsyncIoRequest* request);
+
+/**
+ * @brief Returns the backend in use: "io_uring" or "thread pool".
+ */
+const char* async_io_backend_name(const AsyncIo* aio);
+
+/**
+ * @brief Frees the context. Every submitted request must have been waited for.
+ * @param aio The context (may be NULL).
+ */
+void async_io_destroy(AsyncIo* aio);
+
+#endif // ASYNC_IO_H_
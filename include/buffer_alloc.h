@@ -0,0 +1,58 @@
+/**
+ * @file buffer_alloc.h
+ * @brief Defines the allocator used for the pipeline's large, long-lived buffers.
+ *
+ * The chunk data pool and the I/O ring buffers are the only allocations in the
+ * application measured in hundreds of megabytes, and they are touched on every
+ * sample. This module gives them a common allocation backend that can be
+ * switched at runtime:
+ *
+ *  - Default: 64-byte aligned heap memory.
+ *  - Huge pages: 2 MB pages via MAP_HUGETLB, falling back to a 2 MB aligned
+ *    mapping advised for transparent huge pages when no hugetlbfs pages are
+ *    reserved. This greatly reduces TLB pressure on multi-hundred-MB buffers.
+ *  - Locking: optionally mlock() every buffer so an SDR capture can never
+ *    stall on a page fault or be swapped out.
+ *
+ * Every pointer returned is aligned to BUFFER_ALLOC_ALIGNMENT.
+ */
+
+#ifndef BUFFER_ALLOC_H_
+#define BUFFER_ALLOC_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// --- Function Declarations ---
+
+/**
+ * @brief Selects the allocation backend for all subsequent buffer_alloc() calls.
+ *
+ * Must be called before the pipeline allocates its buffers. Buffers that were
+ * already allocated keep the backend they were created with.
+ *
+ * @param use_huge_pages If true, back buffers with 2 MB pages where possible.
+ * @param lock_memory If true, lock buffers into RAM with mlock().
+ */
+void buffer_alloc_configure(bool use_huge_pages, bool lock_memory);
+
+/**
+ * @brief Allocates a large, BUFFER_ALLOC_ALIGNMENT-aligned buffer using the configured backend.
+ * @param size The number of bytes to allocate.
+ * @return A pointer to the buffer, or NULL on failure. Must be released with buffer_free().
+ */
+void* buffer_alloc(size_t size);
+
+/**
+ * @brief Frees a buffer returned by buffer_alloc(). NULL is ignored.
+ * @param ptr The buffer to free.
+ */
+void buffer_free(void* ptr);
+
+/**
+ * @brief Describes the backend actually in effect, for the configuration summary.
+ * @return A constant string such as "Huge Pages (hugetlbfs), Locked".
+ */
+const char* buffer_alloc_describe(void);
+
+#endif // BUFFER_ALLOC_H_
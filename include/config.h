@@ -49,6 +49,13 @@ bool validate_filter_options(struct AppConfig *config);
  */
 bool validate_iq_correction_options(struct AppConfig *config);
 
+/**
+ * @brief Parses --start and --duration and checks that the input supports them.
+ * @param config The application configuration struct.
+ * @return true if valid, false otherwise.
+ */
+bool validate_input_range_options(struct AppConfig *config);
+
 /**
  * @brief Performs high-level validation, checking for logical conflicts between different options.
  * @param config The application configuration struct.
@@ -56,4 +63,25 @@ bool validate_iq_correction_options(struct AppConfig *config);
  */
 bool validate_option_combinations(struct AppConfig *config);
 
+/**
+ * @brief Parses and range-checks the memory budget and pipeline sizing overrides.
+ * @param config The application configuration struct.
+ * @return true if valid, false otherwise.
+ */
+bool validate_memory_options(struct AppConfig *config);
+
+/**
+ * @brief Validates the file and stdout I/O options (--mmap-input, --read-ahead, --write-behind and the like).
+ * @param config The application configuration struct.
+ * @return true if valid, false otherwise.
+ */
+bool validate_io_options(struct AppConfig *config);
+
+/**
+ * @brief Validates --segments and parses the internal --segment-job option.
+ * @param config The application configuration struct.
+ * @return true if valid, false otherwise.
+ */
+bool validate_segment_options(struct AppConfig *config);
+
 #endif // CONFIG_H_
@@ -37,23 +37,108 @@
  * are heavily used by DSP libraries like liquid-dsp.
  *
  * Trade-off: A larger alignment may waste a few bytes per allocation but can
- * provide significant performance gains. 32 bytes is a safe default for
- * modern CPUs with AVX/AVX2 support.
+ * provide significant performance gains. 64 bytes matches the cache line size
+ * and the AVX-512 register width, so aligned vector loads never split a line.
  */
-#define MEM_ARENA_ALIGNMENT 32
+#define MEM_ARENA_ALIGNMENT 64
+
+/**
+ * @def BUFFER_ALLOC_ALIGNMENT
+ * @brief The alignment of the large pipeline buffers (chunk pool and ring buffers).
+ *
+ * Purpose: Same reasoning as MEM_ARENA_ALIGNMENT. Every sub-buffer carved out of
+ * the chunk pool is also padded to this boundary.
+ */
+#define BUFFER_ALLOC_ALIGNMENT 64
+
+/**
+ * @def BUFFER_ALLOC_HUGE_PAGE_SIZE
+ * @brief The huge page size used when --huge-pages is enabled.
+ *
+ * Purpose: Large buffers backed by 2 MB pages need 512x fewer TLB entries than
+ * with 4 KB pages, which matters when every sample touches a new cache line.
+ *
+ * Trade-off: Each buffer is rounded up to a multiple of this size.
+ */
+#define BUFFER_ALLOC_HUGE_PAGE_SIZE (2 * 1024 * 1024) // 2 MB
+
+/**
+ * @def FILE_MAP_VERIFY_BYTES
+ * @brief The number of bytes compared between sf_read_raw() and a direct read of the input.
+ *
+ * Purpose: --mmap-input and --read-ahead derive the data offset from libsndfile's
+ * file position. Comparing the first bytes of both views catches a wrong offset
+ * before any sample is processed.
+ */
+#define FILE_MAP_VERIFY_BYTES 4096
+
+/**
+ * @def FILE_READAHEAD_MAX_DEPTH
+ * @brief The largest accepted value for --read-ahead (reads in flight).
+ *
+ * Purpose: Every read in flight holds a sample chunk. The reader only takes
+ * chunks that are free, so it cannot starve the pipeline, but a deeper queue
+ * than this gains nothing on any storage device.
+ */
+#define FILE_READAHEAD_MAX_DEPTH 64
+
+/**
+ * @def FILE_WRITER_MAX_DEPTH
+ * @brief The largest accepted value for --write-behind (writes in flight).
+ *
+ * Purpose: Each write in flight owns one IO_OUTPUT_WRITER_CHUNK_SIZE block, so
+ * this also caps the engine's memory at 64 MB.
+ */
+#define FILE_WRITER_MAX_DEPTH 64
+
+/**
+ * @def FILE_SPLICE_STEP_BYTES
+ * @brief The most bytes moved by one copy_file_range()/splice()/sendfile() call.
+ *
+ * Purpose: --raw-passthrough from a file copies the sample data in the kernel.
+ * Between steps the copy reports progress and checks for Ctrl+C, so a step
+ * should be long enough to amortize the system call but short enough to
+ * keep both responsive.
+ */
+#define FILE_SPLICE_STEP_BYTES (8 * 1024 * 1024) // 8 MB
+
+/**
+ * @def ASYNC_IO_MAX_THREADS
+ * @brief The number of pread()/pwrite() workers used when io_uring is unavailable.
+ */
+#define ASYNC_IO_MAX_THREADS 4
+
+/**
+ * @def ASYNC_IO_DIRECT_ALIGNMENT
+ * @brief Buffer, offset and length alignment for --direct-io reads and writes.
+ *
+ * Purpose: O_DIRECT requires all three to be multiples of the device's logical
+ * block size. 4096 bytes covers both 512-byte and 4K-native devices.
+ */
+#define ASYNC_IO_DIRECT_ALIGNMENT 4096
 
 /**
  * @def MEM_ARENA_SIZE_BYTES
- * @brief The size of the single memory arena for all startup allocations.
+ * @brief The initial block size of the memory arena for all startup allocations.
  *
  * Purpose: To hold all DSP objects, configuration strings, and other setup data,
  * eliminating hundreds of small `malloc` calls at startup.
  *
- * Trade-off: Must be large enough to hold all initialization data. 16MB is
- * a very safe starting point.
+ * Trade-off: The arena chains further blocks of this size when it runs out, so
+ * this only needs to cover the common case. 16MB is a very safe starting point.
  */
 #define MEM_ARENA_SIZE_BYTES (16 * 1024 * 1024) // 16 MB
 
+/**
+ * @def MEM_SCRATCH_BLOCK_SIZE_BYTES
+ * @brief The block size of each thread's scratch arena.
+ *
+ * Purpose: Scratch arenas hold temporary DSP work (filter design intermediates,
+ * calibration buffers) that is released with a mark/reset. Requests larger than
+ * this get a dedicated block.
+ */
+#define MEM_SCRATCH_BLOCK_SIZE_BYTES (1024 * 1024) // 1 MB
+
 /**
  * @def IO_SDR_INPUT_BUFFER_BYTES
  * @brief The size of the ring buffer between the SDR capture thread and the reader thread.
@@ -85,6 +170,38 @@
  */
 #define IO_OUTPUT_WRITER_CHUNK_SIZE (1024 * 1024) // 1 MB
 
+/**
+ * @def IO_STDOUT_PIPE_SIZE_BYTES
+ * @brief The capacity requested for a stdout pipe with F_SETPIPE_SZ (Linux).
+ *
+ * Purpose: The default 64 KB pipe holds only one or two chunks, so the consumer
+ * (e.g., nrsc5) is woken for every small write. A larger pipe lets it read in
+ * big gulps and absorbs short stalls on either side.
+ *
+ * Trade-off: Unprivileged processes are capped by /proc/sys/fs/pipe-max-size
+ * (1 MB by default). Data sitting in the pipe adds latency for a live consumer.
+ */
+#define IO_STDOUT_PIPE_SIZE_BYTES (1024 * 1024) // 1 MB
+
+/**
+ * @def IO_STDOUT_MIN_PIPE_SIZE_BYTES
+ * @brief The smallest accepted --stdout-pipe-size. The kernel rounds smaller requests up to one page.
+ */
+#define IO_STDOUT_MIN_PIPE_SIZE_BYTES 4096
+
+/**
+ * @def IO_STDOUT_MAX_BATCH_CHUNKS
+ * @brief The most ready chunks the stdout writer gathers into one writev()/vmsplice().
+ */
+#define IO_STDOUT_MAX_BATCH_CHUNKS 32
+
+/**
+ * @def IO_STDOUT_DRAIN_TIMEOUT_MS
+ * @brief How long the stdout writer waits at the end of the stream for the
+ *        consumer to read the chunks gifted with --stdout-zero-copy.
+ */
+#define IO_STDOUT_DRAIN_TIMEOUT_MS 10000
+
 /**
  * @def IO_WRITER_BUFFER_HIGH_WATER_MARK
  * @brief The fullness threshold (as a fraction, 0.0-1.0) for the writer buffer
@@ -128,6 +245,36 @@
  */
 #define RESAMPLER_OUTPUT_SAFETY_MARGIN  128
 
+/**
+ * @def PIPELINE_MIN_NUM_CHUNKS
+ * @brief The smallest pipeline depth the memory planner will shrink to.
+ *
+ * Purpose: The values above are defaults. They can be overridden on the command
+ * line (--pipeline-chunks, --chunk-samples, --sdr-buffer-size, --writer-buffer-size,
+ * --arena-size) or scaled down automatically to fit a --memory-budget. These
+ * minimums stop the planner from producing a pipeline that can no longer keep
+ * every stage busy.
+ */
+#define PIPELINE_MIN_NUM_CHUNKS 16
+
+/**
+ * @def PIPELINE_MIN_CHUNK_SAMPLES
+ * @brief The smallest chunk size (in samples) the memory planner will shrink to.
+ */
+#define PIPELINE_MIN_CHUNK_SAMPLES 1024
+
+/**
+ * @def IO_MIN_RING_BUFFER_BYTES
+ * @brief The smallest size the memory planner will use for either I/O ring buffer.
+ */
+#define IO_MIN_RING_BUFFER_BYTES (4 * 1024 * 1024) // 4 MB
+
+/**
+ * @def MEM_ARENA_MIN_SIZE_BYTES
+ * @brief The smallest setup arena that can be requested with --arena-size.
+ */
+#define MEM_ARENA_MIN_SIZE_BYTES (1024 * 1024) // 1 MB
+
 // =============================================================================
 // == Tier 3: DSP Algorithm Quality & Tuning
 // =============================================================================
@@ -148,6 +295,25 @@
 // The cutoff frequency for the DC blocking high-pass filter.
 #define DC_BLOCK_CUTOFF_HZ 10.0f
 
+// --- Reference Kernels (-DREFERENCE_KERNELS=ON) ---
+// A reference build keeps every DSP stage on its plain scalar path: no
+// -ffast-math, no auto-vectorization, precise sin/cos oscillators instead of
+// the NCO lookup table, and time-domain FIR filtering even when FFT is
+// requested. Optimized variants are cross-checked against these paths by
+// iq_tool_kernel_check.
+#ifdef IQ_TOOL_REFERENCE_KERNELS
+#define DSP_REFERENCE_KERNELS 1
+#define DSP_OSCILLATOR_TYPE   LIQUID_VCO
+#else
+#define DSP_REFERENCE_KERNELS 0
+#define DSP_OSCILLATOR_TYPE   LIQUID_NCO
+#endif
+
+// --- Direct Format Conversion (transcode.c) ---
+// Frames converted through cf32 per step. 1024 frames keep the 8 KB of cf32
+// samples in L1 between the input and output conversions.
+#define TRANSCODE_BLOCK_FRAMES 1024
+
 // --- Filter Design & Analysis Tuning ---
 #define FILTER_MINIMUM_TAPS 21
 #define FILTER_GAIN_ZERO_THRESHOLD 1e-9f
@@ -160,6 +326,40 @@
 #define IQ_MAX_PASSES                    25
 #define IQ_CORRECTION_POWER_THRESHOLD_DB 20.0f
 #define IQ_CORRECTION_SMOOTHING_FACTOR   0.05f
+// The optimizer only runs every IQ_CORRECTION_INTERVAL_MS, so windows are
+// published to its analysis tap a few times per interval and no faster.
+#define IQ_CORRECTION_TAP_INTERVAL_MS    (IQ_CORRECTION_INTERVAL_MS / 4)
+
+// --- Pipeline Telemetry (--stats-json) ---
+// How often queue and ring buffer occupancy is sampled into the histograms.
+#define TELEMETRY_OCCUPANCY_SAMPLE_MS    10
+// How often a snapshot line is appended to the stats file.
+#define TELEMETRY_SNAPSHOT_INTERVAL_MS   1000
+// Number of occupancy histogram buckets (each covers 1/N of the capacity).
+#define TELEMETRY_HISTOGRAM_BUCKETS      10
+// Maximum number of queues and ring buffers that can be tracked.
+#define TELEMETRY_MAX_TRACKED_BUFFERS    8
+// Latency histograms are log-linear: each power of two is split into
+// 2^SUB_BUCKET_BITS linear buckets, giving ~6% worst-case percentile error.
+#define TELEMETRY_LATENCY_SUB_BUCKET_BITS 4
+// Number of power-of-two ranges. 2^40 ns is ~18 minutes; anything larger is clamped.
+#define TELEMETRY_LATENCY_MAJOR_BUCKETS   40
+// Capacity of the side index that carries chunk timestamps across the writer ring buffer.
+#define TELEMETRY_LATENCY_INDEX_SIZE      1024
+
+// --- Trace Export (--trace) ---
+// Events buffered per thread before further events are dropped (40 bytes each).
+#define TRACE_EVENTS_PER_THREAD           (256 * 1024)
+
+// --- Hardware Performance Counters (--perf-counters) ---
+// Maximum number of threads whose counter results are kept for the summary.
+#define PERF_COUNTERS_MAX_THREADS         16
+
+// --- Analysis Tap Tuning ---
+// Number of windows kept in each analysis tap ring. Older windows are overwritten.
+#define ANALYSIS_TAP_NUM_SLOTS           4
+// How often a waiting consumer polls its tap for a new window.
+#define ANALYSIS_TAP_POLL_INTERVAL_MS    10
 
 // --- Output AGC Tuning Parameters ---
 
@@ -238,6 +438,33 @@
 #define SPYSERVER_STREAM_BUFFER_BYTES (16 * 1024 * 1024) // 16 MB buffer for network jitter
 #define SPYSERVER_PREBUFFER_HIGH_WATER_MARK 0.5f // Start processing when buffer is 50% full
 
+// --- Signal Generator Input ---
+#define GENERATOR_DEFAULT_SAMPLE_RATE_HZ  2048000.0
+#define GENERATOR_DEFAULT_FREQ_HZ         100000.0
+#define GENERATOR_DEFAULT_AMPLITUDE       0.5
+#define GENERATOR_DEFAULT_OFDM_CARRIERS   64
+#define GENERATOR_MAX_OFDM_CARRIERS       1024
+#define GENERATOR_OFDM_SYMBOLS            32     // Distinct symbols in the pre-computed OFDM loop
+#define GENERATOR_CHIRP_PERIOD_SECONDS    0.1    // Time for one full -freq to +freq sweep
+
+// --- Simulated SDR Input ---
+#define SIMSDR_DEFAULT_SAMPLE_RATE_HZ     2048000.0
+#define SIMSDR_DEFAULT_BURST_SAMPLES      16384   // Samples per driver callback
+#define SIMSDR_MAX_BURST_SAMPLES          (1024 * 1024)
+#define SIMSDR_SLEEP_SLICE_MS             100     // Longest uninterrupted sleep, so stop requests are seen promptly
+
+// --- Stdin Input ---
+#define STDIN_READ_BYTES                  (1024 * 1024) // Largest single read(); the pipe is grown to match
+#define STDIN_POLL_SLICE_MS               100     // Longest wait for data, so stop requests are seen promptly
+#define STDIN_RING_WAIT_US                1000    // Back-off while the SDR input buffer is full
+
+// --- Parallel Segments (--segments) ---
+#define SEGMENT_MAX_JOBS                  64      // Largest accepted --segments
+#define SEGMENT_MIN_SECONDS               1.0     // Shortest segment worth a job of its own
+#define SEGMENT_DC_BLOCK_TIME_CONSTANTS   20.0    // The DC blocker's start-up error falls below float precision
+#define SEGMENT_RESAMPLER_DELAY_FACTOR    4.0     // Warm-up, in multiples of the resampler's group delay
+#define SEGMENT_REPORT_POLL_MS            100     // Longest wait for a progress report from the jobs
+
 // =============================================================================
 // == Tier 5: Sanity Checks & Hard Limits
 // =============================================================================
@@ -0,0 +1,114 @@
+/**
+ * @file file_map.h
+ * @brief Defines the memory-mapped reader for file inputs (--mmap-input).
+ *
+ * libsndfile still opens the file and parses its header. This module then
+ * locates the sample data inside the file and maps it read-only with
+ * MADV_SEQUENTIAL. The file reader hands each chunk a pointer into the mapping
+ * instead of copying the samples into the chunk, and the pre-processor
+ * converts straight from the page cache.
+ *
+ * The same data-offset discovery also serves the read-ahead engine
+ * (file_readahead.h), which reads the sample data with its own descriptor.
+ *
+ * The mapping is POSIX only. On other platforms, and whenever the data cannot
+ * be mapped, the caller falls back to sf_read_raw().
+ *
+ * The mapped file must not be truncated while it is being read: touching a
+ * page past the new end of the file raises SIGBUS.
+ */
+
+#ifndef FILE_MAP_H_
+#define FILE_MAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sndfile.h> // Needed for the SNDFILE* type in the function signatures
+#include "input_range.h"
+
+// --- Type Definitions ---
+
+/**
+ * @struct FileMap
+ * @brief A read-only mapping of the sample data region of an input file.
+ */
+typedef struct FileMap {
+    const unsigned char* data;       ///< First byte of sample data, inside the mapping.
+    unsigned long long   data_bytes; ///< Size of the sample data, a whole number of frames.
+    unsigned long long   position;   ///< Bytes of sample data already handed out.
+    size_t               frame_bytes;
+    void*                map_base;   ///< Page-aligned start of the mapping (NULL if not mapped).
+    size_t               map_length;
+} FileMap;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Opens a file with libsndfile through a descriptor the caller keeps.
+ *
+ * Equivalent to sf_open(), except that the descriptor stays visible so the
+ * sample data can later be located with file_map_locate_data() or mapped with
+ * file_map_open_sndfile(). libsndfile closes the descriptor in sf_close().
+ *
+ * @param path The file to open.
+ * @param sfinfo In/out format information, as for sf_open().
+ * @param[out] out_fd The descriptor libsndfile reads from, or -1 on failure.
+ * @return The libsndfile handle, or NULL on failure (see sf_strerror(NULL)).
+ */
+SNDFILE* file_map_sf_open(const char* path, SF_INFO* sfinfo, int* out_fd);
+
+/**
+ * @brief Finds the byte range of the sample data in a file opened with file_map_sf_open().
+ *
+ * libsndfile locates the data: after seeking to frame 0, the descriptor is
+ * positioned at the first sample byte. The first FILE_MAP_VERIFY_BYTES of the
+ * range are checked against sf_read_raw(). A header that claims more frames
+ * than the file holds is clamped to the file size. The result is then narrowed
+ * to the frames selected by --start and --duration. The libsndfile handle is
+ * left at frame 0.
+ *
+ * @param infile The libsndfile handle.
+ * @param fd The descriptor returned by file_map_sf_open().
+ * @param frame_bytes The size of one I/Q frame in bytes.
+ * @param range The frames to locate.
+ * @param[out] out_offset The file offset of the first byte of the range.
+ * @param[out] out_bytes The size of the range, a whole number of frames.
+ * @return false (after logging a warning) if the range cannot be trusted.
+ */
+bool file_map_locate_data(SNDFILE* infile, int fd, size_t frame_bytes, const InputRange* range,
+                          unsigned long long* out_offset, unsigned long long* out_bytes);
+
+/**
+ * @brief Maps the sample data of a file opened with file_map_sf_open().
+ *
+ * The data is located with file_map_locate_data().
+ *
+ * Logs a warning and returns false if the data cannot be mapped. The caller
+ * then keeps reading through libsndfile.
+ *
+ * @param map The mapping to initialize.
+ * @param infile The libsndfile handle.
+ * @param fd The descriptor returned by file_map_sf_open().
+ * @param frame_bytes The size of one I/Q frame in bytes.
+ * @param range The frames to map.
+ * @return true if the data is mapped.
+ */
+bool file_map_open_sndfile(FileMap* map, SNDFILE* infile, int fd, size_t frame_bytes, const InputRange* range);
+
+/**
+ * @brief Returns a pointer to the next block of sample data and advances past it.
+ *
+ * @param map The mapping.
+ * @param max_bytes The largest block to return. Rounded down to whole frames.
+ * @param[out] out_data Set to the start of the block inside the mapping.
+ * @return The size of the block in bytes, 0 at the end of the data.
+ */
+size_t file_map_next(FileMap* map, size_t max_bytes, const unsigned char** out_data);
+
+/**
+ * @brief Unmaps the file. Safe to call on a mapping that was never opened.
+ * @param map The mapping.
+ */
+void file_map_close(FileMap* map);
+
+#endif // FILE_MAP_H_
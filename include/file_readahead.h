@@ -0,0 +1,81 @@
+/**
+ * @file file_readahead.h
+ * @brief Defines the asynchronous read-ahead engine for file inputs (--read-ahead).
+ *
+ * With a synchronous sf_read_raw() the reader thread waits for every read to
+ * finish before it can hand the chunk on, so disk latency adds directly to the
+ * pipeline's critical path. This engine keeps a configurable number of large
+ * reads in flight, each targeting a free sample chunk, and hands the chunks
+ * downstream in file order as the reads complete.
+ *
+ * The reads go through async_io.h: io_uring on Linux, or a small pool of
+ * pread() worker threads where io_uring is unavailable.
+ *
+ * With --direct-io the file is opened with O_DIRECT. Reads then go through
+ * aligned bounce buffers, one per read slot, and the page cache is bypassed.
+ *
+ * libsndfile still parses the header; the sample data range comes from
+ * file_map_locate_data(). The engine is POSIX only. Elsewhere the caller falls
+ * back to sf_read_raw().
+ */
+
+#ifndef FILE_READAHEAD_H_
+#define FILE_READAHEAD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "module.h"
+
+// --- Type Definitions ---
+
+typedef struct FileReadahead FileReadahead;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Creates a read-ahead engine for a byte range of a file.
+ *
+ * The engine opens the file with its own descriptor, so that O_DIRECT does
+ * not affect libsndfile. If O_DIRECT is refused (e.g. on tmpfs) the engine
+ * warns and uses buffered reads.
+ *
+ * @param path The input file.
+ * @param data_offset The file offset of the first sample byte.
+ * @param data_bytes The size of the sample data, a whole number of frames.
+ * @param frame_bytes The size of one I/Q frame in bytes.
+ * @param max_read_bytes The largest single read the caller will request.
+ * @param depth The number of reads to keep in flight (1..FILE_READAHEAD_MAX_DEPTH).
+ * @param direct_io true to open the file with O_DIRECT.
+ * @return The engine, or NULL (after logging a warning) if it cannot be created.
+ */
+FileReadahead* file_readahead_create(const char* path, unsigned long long data_offset, unsigned long long data_bytes,
+                                     size_t frame_bytes, size_t max_read_bytes, unsigned int depth, bool direct_io);
+
+/**
+ * @brief Runs the reader thread's loop on top of the engine.
+ *
+ * Takes free chunks, keeps up to `depth` reads in flight into them, and
+ * enqueues each chunk on the reader output queue in file order. Honors the
+ * writer back-pressure threshold like the synchronous readers, sends the
+ * final end-of-stream chunk, and waits for every read in flight before it
+ * returns.
+ *
+ * @param ctx The module context.
+ * @param ra The engine.
+ * @param passthrough true to read into final_output_data (--raw-passthrough)
+ *        instead of raw_input_data.
+ */
+void file_readahead_run_reader(ModuleContext* ctx, FileReadahead* ra, bool passthrough);
+
+/**
+ * @brief Returns a short description of the engine for the summary, e.g. "io_uring, depth 8, O_DIRECT".
+ */
+const char* file_readahead_describe(const FileReadahead* ra);
+
+/**
+ * @brief Stops the engine and frees it. Must not be called with reads in flight.
+ * @param ra The engine (may be NULL).
+ */
+void file_readahead_destroy(FileReadahead* ra);
+
+#endif // FILE_READAHEAD_H_
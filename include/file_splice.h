@@ -0,0 +1,63 @@
+/**
+ * @file file_splice.h
+ * @brief Defines the in-kernel copy used by --raw-passthrough from file inputs.
+ *
+ * With --raw-passthrough the samples are written exactly as they were read, so
+ * for a file input there is no reason for them to enter user space at all.
+ * The sample data range located by file_map_locate_data() is handed to the
+ * output descriptor with splice() when the output is a pipe, and with
+ * copy_file_range() (or sendfile() where that is refused) otherwise. On a
+ * filesystem that supports reflinks, copy_file_range() may not copy the data
+ * at all.
+ *
+ * The copy is Linux only, and is only offered by outputs that write the
+ * samples verbatim (raw-file without --write-behind, and stdout). In every
+ * other case the input falls back to the chunk path.
+ */
+
+#ifndef FILE_SPLICE_H_
+#define FILE_SPLICE_H_
+
+#include <stdbool.h>
+#include <sndfile.h>
+#include "module.h"
+#include "input_range.h"
+
+// --- Function Declarations ---
+
+/**
+ * @brief Copies a byte range of an input file to an output descriptor in the kernel.
+ *
+ * Called by an output module's copy_from_file hook. Progress is reported as the
+ * output writers do, and the copy stops early on Ctrl+C. A write error after
+ * the first byte is fatal.
+ *
+ * @param ctx The application context.
+ * @param in_fd The input file. Its file offset is not used or changed.
+ * @param offset The file offset of the first byte to copy.
+ * @param length The number of bytes to copy.
+ * @param out_fd The output descriptor. Written at its current file offset.
+ * @param total_bytes_written The output module's byte counter, advanced as data is copied.
+ * @param writer_name The name used in error messages, e.g. "Writer (raw-file)".
+ * @return The number of bytes copied, or -1 if the kernel cannot copy between
+ *         these descriptors. Nothing has been written in that case.
+ */
+long long file_splice_to_output(ModuleContext* ctx, int in_fd, unsigned long long offset, unsigned long long length,
+                                int out_fd, long long* total_bytes_written, const char* writer_name);
+
+/**
+ * @brief Runs a --raw-passthrough file input entirely in the kernel, if the output allows it.
+ *
+ * Locates the sample data and offers it to the output module's copy_from_file
+ * hook. When the copy happens, the end of stream is sent down the pipeline as
+ * the chunk path would, and the reader has nothing left to do.
+ *
+ * @param ctx The application context.
+ * @param infile The libsndfile handle, left at frame 0 if the copy is not made.
+ * @param in_fd The descriptor returned by file_map_sf_open().
+ * @param range The frames to copy.
+ * @return true if the input has been handled, false if the caller should read it in chunks.
+ */
+bool file_splice_run_passthrough(ModuleContext* ctx, SNDFILE* infile, int in_fd, const InputRange* range);
+
+#endif // FILE_SPLICE_H_
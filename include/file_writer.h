@@ -0,0 +1,111 @@
+/**
+ * @file file_writer.h
+ * @brief Defines the asynchronous write-behind engine for file outputs (--write-behind).
+ *
+ * The writer thread fills large aligned blocks and hands each full block to
+ * async_io.h, which keeps up to `depth` writes in flight. The writer thread
+ * only waits when it needs a block back that is still being written, so disk
+ * latency is hidden behind the next blocks' worth of processing.
+ *
+ * With --direct-io the output descriptor is switched to O_DIRECT and the page
+ * cache is bypassed. A multi-gigabyte capture then does not evict the cache
+ * other jobs rely on. When the output length is known the file is also
+ * preallocated, so the file system can lay it out in few extents.
+ *
+ * The engine writes the file sequentially from offset 0. POSIX only; callers
+ * fall back to stdio writes when file_writer_create() returns NULL.
+ */
+
+#ifndef FILE_WRITER_H_
+#define FILE_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "module.h"
+
+// --- Type Definitions ---
+
+typedef struct FileWriter FileWriter;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Creates a write-behind engine for an open, empty regular file.
+ *
+ * If O_DIRECT is refused (e.g. on tmpfs) the engine warns and writes through
+ * the page cache.
+ *
+ * @param fd The output file, opened for writing. Not closed by the engine.
+ * @param depth The number of block writes to keep in flight (1..FILE_WRITER_MAX_DEPTH).
+ * @param block_bytes The size of one write. Rounded up to ASYNC_IO_DIRECT_ALIGNMENT.
+ * @param direct_io true to switch fd to O_DIRECT.
+ * @param expected_bytes The final size of the file, or 0 if unknown. Used to preallocate.
+ * @return The engine, or NULL (after logging a warning) if it cannot be created.
+ */
+FileWriter* file_writer_create(int fd, unsigned int depth, size_t block_bytes, bool direct_io,
+                               unsigned long long expected_bytes);
+
+/**
+ * @brief Returns the free space at the end of the block being filled.
+ *
+ * Waits for the block's previous write if it is still in flight. The caller
+ * writes up to `*out_space` bytes there and then calls file_writer_commit().
+ *
+ * @param fw The engine.
+ * @param[out] out_space The number of bytes that may be written at the returned pointer.
+ * @return The write position, or NULL (with errno set) if an earlier write failed.
+ */
+unsigned char* file_writer_get_buffer(FileWriter* fw, size_t* out_space);
+
+/**
+ * @brief Appends bytes written into the buffer from file_writer_get_buffer().
+ *
+ * Submits the block once it is full.
+ *
+ * @return false (with errno set) if an earlier write failed.
+ */
+bool file_writer_commit(FileWriter* fw, size_t bytes);
+
+/**
+ * @brief Copies bytes into the engine. Convenience wrapper around get_buffer/commit.
+ * @return false (with errno set) if a write failed.
+ */
+bool file_writer_write(FileWriter* fw, const void* data, size_t bytes);
+
+/**
+ * @brief Writes the partial last block, waits for every write, and trims the file.
+ *
+ * Afterwards the descriptor is back in buffered mode and holds exactly the
+ * bytes appended, so the caller may pwrite() into it (e.g. to patch a header).
+ *
+ * @return false (with errno set) if any write failed.
+ */
+bool file_writer_finish(FileWriter* fw);
+
+/**
+ * @brief Runs the writer thread's loop on top of the engine.
+ *
+ * Reads the writer ring buffer straight into the engine's blocks, with no
+ * intermediate copy, and reports progress and telemetry like the stdio
+ * writers. At end of stream it calls file_writer_finish(), so a write that
+ * fails late still fails the run.
+ *
+ * @param ctx The module context.
+ * @param fw The engine.
+ * @param[in,out] total_bytes_written The output module's byte counter.
+ * @param writer_name The prefix for error messages, e.g. "Writer (raw-file)".
+ */
+void file_writer_run_writer(ModuleContext* ctx, FileWriter* fw, long long* total_bytes_written, const char* writer_name);
+
+/**
+ * @brief Returns a short description of the engine for the summary, e.g. "io_uring, depth 8, O_DIRECT".
+ */
+const char* file_writer_describe(const FileWriter* fw);
+
+/**
+ * @brief Frees the engine. Waits for any write still in flight first.
+ * @param fw The engine (may be NULL).
+ */
+void file_writer_destroy(FileWriter* fw);
+
+#endif // FILE_WRITER_H_
@@ -5,7 +5,7 @@
 
 #include <stdbool.h>
 #include "app_context.h" // Needed for AppResources
-#include "utils.h"       // Needed for get_monotonic_time_sec
+#include "utils.h"       // Needed for get_monotonic_time_coarse_ms
 
 // --- Common Implementations for the InputModuleInterface Interface ---
 
@@ -32,12 +32,13 @@ static inline bool _input_source_has_known_length_false(void) {
  * successfully receives data from the hardware. This signals to the watchdog
  * thread that the SDR is alive and not deadlocked.
  *
+ * It runs inside driver callbacks, so it uses a coarse clock and a relaxed
+ * atomic store rather than a lock. The watchdog only needs second-level accuracy.
+ *
  * @param resources A pointer to the application's resources.
  */
 static inline void sdr_input_update_heartbeat(AppResources* resources) {
-    pthread_mutex_lock(&resources->progress_mutex);
-    resources->last_sdr_heartbeat_time = get_monotonic_time_sec();
-    pthread_mutex_unlock(&resources->progress_mutex);
+    atomic_store_explicit(&resources->last_sdr_heartbeat_ms, get_monotonic_time_coarse_ms(), memory_order_relaxed);
 }
 
 #endif // INPUT_COMMON_H_
@@ -0,0 +1,75 @@
+// include/input_generator.h
+
+#ifndef INPUT_GENERATOR_H_
+#define INPUT_GENERATOR_H_
+
+#include "module.h"
+#include "argparse.h"
+#include "common_types.h"
+#include <stddef.h>
+
+struct MemoryArena;
+
+/**
+ * @struct GeneratorSource
+ * @brief The running state of the signal selected by the --gen-* signal options.
+ *        Opaque to client code.
+ */
+typedef struct GeneratorSource GeneratorSource;
+
+/**
+ * @brief Returns a pointer to the InputModuleInterface struct that implements
+ *        the input source interface for the synthetic signal generator.
+ *
+ * The generator produces test signals (tones, chirps, noise, OFDM-like
+ * multi-carrier signals) entirely in memory, so the pipeline can be measured
+ * without a disk or an SDR in the way.
+ */
+InputModuleInterface* get_generator_input_module_api(void);
+
+/**
+ * @brief Returns the command-line options specific to the Signal Generator module.
+ */
+const struct argparse_option* generator_get_cli_options(int* count);
+
+/**
+ * @brief Returns the --gen-* options that shape the signal itself.
+ *
+ * These apply to every input that synthesizes a signal (the generator, and
+ * sim-sdr without --sim-file), so they are registered once and bound for each.
+ */
+const struct argparse_option* generator_get_signal_cli_options(int* count);
+
+/**
+ * @brief Validates the --gen-* signal options for a signal at the given sample rate.
+ * @param sample_rate_hz The rate the signal will be generated at.
+ * @return true if the options are valid, false (after logging) otherwise.
+ */
+bool generator_validate_signal_options(double sample_rate_hz);
+
+/**
+ * @brief Creates the state for the signal selected by the --gen-* options.
+ *
+ * generator_validate_signal_options() must have succeeded first. Everything,
+ * including the OFDM symbol table, is allocated from the arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param sample_rate_hz The rate the signal is generated at.
+ * @return The new source, or NULL on allocation failure.
+ */
+GeneratorSource* generator_source_create(struct MemoryArena* arena, double sample_rate_hz);
+
+/**
+ * @brief Generates the next block of the signal as cf32.
+ * @param source The source created by generator_source_create().
+ * @param out Receives num_frames samples.
+ * @param num_frames The number of samples to generate.
+ */
+void generator_source_generate(GeneratorSource* source, complex_float_t* out, size_t num_frames);
+
+/**
+ * @brief Adds the signal (and its SNR, when noise is added) to an input summary.
+ */
+void generator_add_signal_summary(InputSummaryInfo* info);
+
+#endif // INPUT_GENERATOR_H_
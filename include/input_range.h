@@ -0,0 +1,61 @@
+/**
+ * @file input_range.h
+ * @brief Defines the sample range selected with --start and --duration.
+ *
+ * The options are parsed by validate_input_range_options() and resolved here
+ * once a file input knows its sample rate, length, and (for WAV files with
+ * SDR metadata) the UTC time of its first sample. The input then seeks, or
+ * offsets its mapping, read-ahead, or kernel copy, straight to the first
+ * frame and stops after the last one.
+ */
+
+#ifndef INPUT_RANGE_H_
+#define INPUT_RANGE_H_
+
+#include <stdbool.h>
+#include <time.h>
+#include "module.h"
+
+struct AppConfig;
+
+// --- Type Definitions ---
+
+/**
+ * @struct InputRange
+ * @brief The frames of a file input that will be processed.
+ */
+typedef struct {
+    unsigned long long first_frame;
+    unsigned long long num_frames;
+    unsigned long long total_frames; ///< The length of the whole input.
+    bool               limited;      ///< --start or --duration was given.
+} InputRange;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Resolves --start and --duration to a frame range of a file input.
+ *
+ * Without either option the range is the whole file. A duration that runs
+ * past the end of the file is cut short with a warning.
+ *
+ * @param config The application configuration.
+ * @param sample_rate_hz The input sample rate.
+ * @param total_frames The length of the input in frames.
+ * @param start_time_known true if start_time_unix holds the UTC time of the first frame.
+ * @param start_time_unix The UTC time of the first frame, for a --start given as a UTC time.
+ * @param[out] out_range The resolved range.
+ * @return false (after logging a fatal error) if the range is empty or cannot be resolved.
+ */
+bool input_range_resolve(const struct AppConfig* config, double sample_rate_hz, long long total_frames,
+                         bool start_time_known, time_t start_time_unix, InputRange* out_range);
+
+/**
+ * @brief Adds an "Input Range" line describing a --start/--duration range to the input summary.
+ * @param info The summary being built.
+ * @param range The resolved range.
+ * @param sample_rate_hz The input sample rate.
+ */
+void input_range_add_summary_item(InputSummaryInfo* info, const InputRange* range, double sample_rate_hz);
+
+#endif // INPUT_RANGE_H_
@@ -0,0 +1,26 @@
+// include/input_simsdr.h
+
+#ifndef INPUT_SIMSDR_H_
+#define INPUT_SIMSDR_H_
+
+#include "module.h"
+#include "argparse.h"
+
+/**
+ * @brief Returns a pointer to the InputModuleInterface struct that implements
+ *        the input source interface for the simulated SDR device.
+ *
+ * The simulated SDR replays a raw I/Q file (or the signal generator's --gen-*
+ * signal) through the same driver callback pattern as the real SDR modules,
+ * paced to real time with configurable burst size, jitter and injected stalls. It runs the buffered and
+ * real-time SDR pipeline modes, the packet serializer and the watchdog on a
+ * machine with no SDR hardware attached.
+ */
+InputModuleInterface* get_simsdr_input_module_api(void);
+
+/**
+ * @brief Returns the command-line options specific to the simulated SDR module.
+ */
+const struct argparse_option* simsdr_get_cli_options(int* count);
+
+#endif // INPUT_SIMSDR_H_
@@ -0,0 +1,24 @@
+// include/input_stdin.h
+
+#ifndef INPUT_STDIN_H_
+#define INPUT_STDIN_H_
+
+#include "module.h"
+#include "argparse.h"
+
+/**
+ * @brief Returns a pointer to the InputModuleInterface struct that implements
+ *        the input source interface for raw I/Q samples piped into stdin.
+ *
+ * The stream has no known length. It runs in the buffered SDR pipeline mode:
+ * a capture thread drains stdin with large reads into the SDR input buffer, so
+ * a bursty producer (e.g., `rtl_sdr -`) is absorbed rather than blocked.
+ */
+InputModuleInterface* get_stdin_input_module_api(void);
+
+/**
+ * @brief Returns the command-line options specific to the stdin module.
+ */
+const struct argparse_option* stdin_get_cli_options(int* count);
+
+#endif // INPUT_STDIN_H_
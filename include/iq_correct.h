@@ -43,6 +43,18 @@ bool iq_correct_init(AppConfig* config, AppResources* resources, MemoryArena* ar
  */
 void iq_correct_apply(AppResources* resources, complex_float_t* samples, int num_samples);
 
+/**
+ * @brief Overrides the current correction factors.
+ *
+ * The optimizer normally owns the factors; this is used to apply known
+ * factors, e.g. by the kernel cross-check harness.
+ *
+ * @param resources Pointer to the application resources.
+ * @param mag The gain adjustment (the I channel is scaled by 1 + mag).
+ * @param phase The phase adjustment (phase * I is added to Q).
+ */
+void iq_correct_set_factors(AppResources* resources, float mag, float phase);
+
 /**
  * @brief Runs one pass of the I/Q imbalance optimization algorithm.
  *
@@ -67,7 +79,8 @@ void iq_correct_destroy(AppResources* resources);
 /**
  * @brief Performs a synchronous, one-shot I/Q calibration pass for file-based inputs.
  * This should be called by file-based input modules during their pre-stream phase.
- * It reads from the file, runs the optimization, and rewinds the file.
+ * It reads from the current position of the file, runs the optimization, and
+ * seeks back to that position.
  *
  * @param ctx The application context.
  * @param infile The handle to the open input file (e.g., from libsndfile).
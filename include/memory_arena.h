@@ -5,29 +5,70 @@
 #include <stdbool.h>
 #include <pthread.h>
 
-// --- Struct Definition ---
+// --- Struct Definitions ---
+
+/**
+ * @struct MemArenaBlock
+ * @brief One block in an arena's chain. Opaque to client code.
+ */
+typedef struct MemArenaBlock MemArenaBlock;
 
 /**
  * @struct MemoryArena
- * @brief Manages a single large block of memory for fast, contiguous allocations.
+ * @brief Manages a chain of large memory blocks for fast, contiguous allocations.
+ *
+ * The arena starts with a single block of the requested capacity and chains
+ * additional blocks on demand, so it never fails just because the initial
+ * estimate was too small. An optional capacity limit (see mem_arena_set_limit())
+ * bounds that growth. Allocations are never freed individually; everything
+ * is released at once by mem_arena_destroy().
  *
  * This struct should be treated as an opaque handle by client code and only
  * manipulated through the mem_arena_* functions.
  */
 typedef struct MemoryArena {
-    void*  memory;      ///< Pointer to the start of the large allocated memory block.
-    size_t capacity;    ///< The total size in bytes of the memory block.
-    size_t offset;      ///< The current offset in bytes for the next allocation (the "bump pointer").
-    pthread_mutex_t mutex; ///< Mutex to make allocations thread-safe.
+    MemArenaBlock* first;       ///< The first block in the chain.
+    MemArenaBlock* current;     ///< The block currently being bump-allocated from.
+    size_t block_size;          ///< The default size of each newly chained block.
+    size_t capacity;            ///< The total size in bytes of all blocks in the chain.
+    size_t limit;               ///< The most capacity the chain may grow to, or 0 for no limit.
+    size_t used;                ///< The total bytes handed out (including alignment padding).
+    int    num_blocks;          ///< The number of blocks in the chain.
+    pthread_mutex_t mutex;      ///< Mutex to make allocations thread-safe.
 } MemoryArena;
 
+/**
+ * @struct ScratchArena
+ * @brief A per-thread arena for temporary work, with no locking.
+ *
+ * Each thread owns exactly one scratch arena, obtained with mem_scratch_get().
+ * Temporary allocations are bracketed by mem_scratch_mark() and
+ * mem_scratch_reset(), so the same memory is reused by every caller instead
+ * of permanently consuming setup memory.
+ */
+typedef struct ScratchArena {
+    MemArenaBlock* first;
+    MemArenaBlock* current;
+    size_t block_size;
+} ScratchArena;
+
+/**
+ * @struct ScratchMark
+ * @brief A saved position in a ScratchArena, used to roll back temporary allocations.
+ */
+typedef struct ScratchMark {
+    MemArenaBlock* block;
+    size_t offset;
+} ScratchMark;
+
 
 // --- Function Declarations ---
 
 /**
- * @brief Initializes a memory arena with a specified capacity.
+ * @brief Initializes a memory arena with a specified initial capacity.
  * @param arena Pointer to the MemoryArena struct to initialize.
- * @param capacity The total size of the memory block to allocate.
+ * @param capacity The size of the first block. Subsequent blocks use the same size
+ *                 unless a single allocation needs more.
  * @return true on success, false on memory allocation failure.
  */
 bool mem_arena_init(MemoryArena* arena, size_t capacity);
@@ -35,20 +76,72 @@ bool mem_arena_init(MemoryArena* arena, size_t capacity);
 /**
  * @brief Allocates a block of memory from the arena.
  *
- * This function is now thread-safe. It is intended for use during the
- * setup phase of the application.
+ * This function is thread-safe. It is intended for allocations that live
+ * until the end of the run; use the scratch arena for temporary work.
  *
  * @param arena Pointer to the initialized MemoryArena.
  * @param size The number of bytes to allocate.
  * @param zero_memory If true, the allocated memory will be zero-initialized.
- * @return A void pointer to the allocated memory, or NULL if the arena is full.
+ * @return A void pointer to the allocated memory, or NULL if the system is out of memory.
  */
 void* mem_arena_alloc(MemoryArena* arena, size_t size, bool zero_memory);
 
 /**
- * @brief Destroys a memory arena, freeing its main memory block.
+ * @brief Caps how far the arena may grow.
+ *
+ * Blocks that already exist are kept even if they exceed the limit; only
+ * further growth is refused, and the allocation that needed it fails.
+ *
+ * @param arena Pointer to the initialized MemoryArena.
+ * @param limit The largest total capacity, in bytes, or 0 to remove the limit.
+ */
+void mem_arena_set_limit(MemoryArena* arena, size_t limit);
+
+/**
+ * @brief Destroys a memory arena, freeing every block in its chain.
  * @param arena Pointer to the MemoryArena to destroy.
  */
 void mem_arena_destroy(MemoryArena* arena);
 
+/**
+ * @brief Returns the calling thread's scratch arena, creating it on first use.
+ *
+ * The arena is released automatically when the thread exits. The main thread
+ * must call mem_scratch_release() explicitly before the program ends.
+ *
+ * @return The calling thread's scratch arena, or NULL if it could not be created.
+ */
+ScratchArena* mem_scratch_get(void);
+
+/**
+ * @brief Records the current position of a scratch arena.
+ * @param scratch The calling thread's scratch arena.
+ * @return A mark to pass to mem_scratch_reset().
+ */
+ScratchMark mem_scratch_mark(const ScratchArena* scratch);
+
+/**
+ * @brief Allocates temporary memory from a scratch arena.
+ * @param scratch The calling thread's scratch arena.
+ * @param size The number of bytes to allocate.
+ * @param zero_memory If true, the allocated memory will be zero-initialized.
+ * @return A pointer aligned to MEM_ARENA_ALIGNMENT, or NULL on allocation failure.
+ */
+void* mem_scratch_alloc(ScratchArena* scratch, size_t size, bool zero_memory);
+
+/**
+ * @brief Releases every allocation made since a mark was taken.
+ *
+ * Blocks are kept for reuse, so a reset never returns memory to the system.
+ *
+ * @param scratch The calling thread's scratch arena.
+ * @param mark A mark previously returned by mem_scratch_mark() on the same arena.
+ */
+void mem_scratch_reset(ScratchArena* scratch, ScratchMark mark);
+
+/**
+ * @brief Frees the calling thread's scratch arena, if it has one.
+ */
+void mem_scratch_release(void);
+
 #endif // MEMORY_ARENA_H_
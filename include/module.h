@@ -168,6 +168,26 @@ typedef struct OutputModuleInterface {
      */
     size_t (*write_chunk)(struct ModuleContext* ctx, const void* buffer, size_t bytes_to_write);
 
+    /**
+     * @brief (Optional) Copies a byte range of an input file to the output in the kernel.
+     * Used by --raw-passthrough from file inputs (see file_splice.h). May be NULL.
+     * @param ctx The application context.
+     * @param in_fd The input file descriptor.
+     * @param offset The file offset of the first sample byte.
+     * @param length The number of bytes to copy.
+     * @return The number of bytes copied, or -1 if nothing was written and the
+     *         input should be read in chunks instead.
+     */
+    long long (*copy_from_file)(struct ModuleContext* ctx, int in_fd, unsigned long long offset, unsigned long long length);
+
+    /**
+     * @brief (Optional) Has parallel jobs write the payload straight into the output file.
+     * Used by --segments (see segment.h). May be NULL if the output cannot be written out of order.
+     * @param ctx The application context.
+     * @return The number of payload bytes written, or -1 on failure.
+     */
+    long long (*write_segments)(struct ModuleContext* ctx);
+
     // Finalizes the output (e.g., updates WAV headers) and closes handles
     void (*finalize_output)(struct ModuleContext* ctx);
 
@@ -33,6 +33,7 @@ typedef struct Module {
     void (*set_default_config)(struct AppConfig* config); ///< Pointer to the default config function.
     const struct argparse_option* (*get_cli_options)(int* count); ///< Pointer to the CLI option function.
     bool requires_output_path; ///< For output modules, indicates if a file path argument is needed.
+    bool uses_generated_signal; ///< For input modules, reads the shared --gen-* signal options.
 } Module;
 
 
@@ -90,15 +91,18 @@ bool module_manager_is_sdr_module(const char* name, struct MemoryArena* arena);
  *
  * This function iterates through all known modules and appends their argparse_option
  * structs to the destination buffer. It intelligently "disables" options for
- * inactive modules by setting their value pointers to NULL.
+ * inactive modules by setting their value pointers to NULL. The shared --gen-*
+ * signal options are added once, after the first module that reads them, and
+ * stay bound when any such module is active.
  *
  * @param dest_buffer The argparse_option array to be filled.
  * @param total_opts_ptr A pointer to the running count of options in the buffer.
  * @param max_opts The capacity of the destination buffer.
  * @param active_input_type The name of the currently active input module.
  * @param arena The memory arena, needed to initialize the module list.
+ * @return false (after logging a fatal error) if the options do not fit in the buffer.
  */
-void module_manager_populate_cli_options(
+bool module_manager_populate_cli_options(
     struct argparse_option* dest_buffer,
     int* total_opts_ptr,
     int max_opts,
@@ -0,0 +1,21 @@
+/**
+ * @file output_null.h
+ * @brief Defines the public interface for the null output module.
+ *
+ * The null output discards every sample while counting the bytes it would
+ * have written. Combined with the signal generator input, it measures the
+ * throughput of the processing pipeline alone, with no I/O.
+ */
+
+#ifndef OUTPUT_NULL_H_
+#define OUTPUT_NULL_H_
+
+#include "module.h"
+
+/**
+ * @brief Returns a pointer to the OutputModuleInterface struct that implements
+ *        the output module interface for the null (discard) output.
+ */
+OutputModuleInterface* get_null_output_module_api(void);
+
+#endif // OUTPUT_NULL_H_
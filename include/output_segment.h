@@ -0,0 +1,23 @@
+/**
+ * @file output_segment.h
+ * @brief Defines the output module used by a --segments job.
+ *
+ * A job does not create its output. It opens the file the parent created,
+ * drops the output of its warm-up frames, and writes its share at the offset
+ * the parent assigned, reporting progress through a pipe. It is selected by
+ * setup when the internal --segment-job option is present, in place of the
+ * module named by --output, and is not listed as a user-selectable module.
+ */
+
+#ifndef OUTPUT_SEGMENT_H_
+#define OUTPUT_SEGMENT_H_
+
+#include "module.h"
+
+/**
+ * @brief Returns a pointer to the OutputModuleInterface struct that implements
+ *        the output module interface for one --segments job.
+ */
+OutputModuleInterface* get_segment_output_module_api(void);
+
+#endif // OUTPUT_SEGMENT_H_
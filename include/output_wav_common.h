@@ -5,13 +5,20 @@
  * This header defines the common functions and data structures used by both
  * the standard WAV writer and the RF64 WAV writer to avoid code duplication.
  * It is not intended to be included by modules outside of the WAV writers.
+ *
+ * The writer is native: the header is written once up front, the payload is
+ * streamed as-is (through --write-behind when enabled), and the header sizes
+ * are patched when the output is finalized.
  */
 
 #ifndef OUTPUT_WAV_COMMON_H_
 #define OUTPUT_WAV_COMMON_H_
 
-#include "module.h"     // For ModuleContext
-#include <sndfile.h>    // For SNDFILE*
+#include "module.h"       // For ModuleContext
+#include "common_types.h" // For format_t, OutputType
+#include "file_writer.h"
+#include <stdio.h>
+#include <stdint.h>
 
 // --- Forward Declaration ---
 // This tells the compiler that a struct named AppConfig exists, allowing us
@@ -22,11 +29,20 @@ struct AppConfig;
 
 /**
  * @struct WavCommonData
- * @brief Holds the private state for any libsndfile-based writer.
+ * @brief Holds the private state for the WAV and RF64 writers.
  */
 typedef struct {
-    SNDFILE* handle;
-    long long total_bytes_written;
+    FILE* handle;
+    FileWriter* write_behind;           ///< Non-NULL with --write-behind; replaces stdio writes.
+    OutputType container;               ///< OUTPUT_TYPE_WAV or OUTPUT_TYPE_WAV_RF64.
+    format_t format;
+    uint32_t sample_rate;
+    const unsigned char* auxi_chunk;    ///< Copied from the input, or NULL.
+    size_t auxi_chunk_bytes;
+    bool auxi_rewritten;                ///< The chunk's times or frequencies were updated for this output.
+    unsigned char* header;
+    size_t header_bytes;
+    long long total_bytes_written;      ///< Payload bytes, excluding the header.
 } WavCommonData;
 
 
@@ -34,16 +50,19 @@ typedef struct {
 
 /**
  * @brief Validates that the selected sample format is compatible with WAV output.
+ *
+ * cu8, cs16, cs24 and cf32 are written as-is. cs8 is switched to cu8, since
+ * 8-bit WAV samples are unsigned by definition.
  */
 bool wav_common_validate_options(struct AppConfig* config);
 
 /**
  * @brief The core initialization logic for opening a WAV or RF64 file.
  * @param ctx The module context.
- * @param sf_format_flag The specific libsndfile format flag (e.g., SF_FORMAT_WAV or SF_FORMAT_RF64).
+ * @param container OUTPUT_TYPE_WAV (upgraded to RF64 only if it outgrows 4 GB) or OUTPUT_TYPE_WAV_RF64.
  * @return true on success, false on failure.
  */
-bool wav_common_initialize(ModuleContext* ctx, int sf_format_flag);
+bool wav_common_initialize(ModuleContext* ctx, OutputType container);
 
 /**
  * @brief The main writer thread loop, common to both WAV and RF64.
@@ -56,8 +75,18 @@ void* wav_common_run_writer(ModuleContext* ctx);
 size_t wav_common_write_chunk(ModuleContext* ctx, const void* buffer, size_t bytes_to_write);
 
 /**
- * @brief Finalizes the WAV/RF64 file by closing the handle and updating final size.
+ * @brief Has the --segments jobs write the payload after the header. The header is patched on finalize as usual.
+ */
+long long wav_common_write_segments(ModuleContext* ctx);
+
+/**
+ * @brief Finalizes the WAV/RF64 file by patching the header sizes and closing it.
  */
 void wav_common_finalize_output(ModuleContext* ctx);
 
+/**
+ * @brief Adds the common summary lines (sample encoding, metadata, write-behind).
+ */
+void wav_common_add_summary_items(const ModuleContext* ctx, OutputSummaryInfo* info);
+
 #endif // OUTPUT_WAV_COMMON_H_
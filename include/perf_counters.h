@@ -0,0 +1,92 @@
+/**
+ * @file perf_counters.h
+ * @brief Defines the optional per-thread hardware performance counter collector.
+ *
+ * When enabled with --perf-counters, every thread started by the thread
+ * manager opens a group of Linux perf events (cycles, instructions, cache
+ * misses, branch misses) for itself as it starts, and reads them just before
+ * it exits. The results are kept per thread name and printed in the final
+ * summary as IPC and cycles per input sample.
+ *
+ * Only user-space events are counted, so the collector works with the default
+ * perf_event_paranoid setting. If perf events are not available at all (not
+ * Linux, not permitted, or inside a VM without a PMU), the collector logs one
+ * warning and every call becomes a no-op. Individual events that the CPU does
+ * not support are simply reported as unavailable.
+ */
+
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <stdbool.h>
+
+// --- Type Definitions ---
+
+typedef enum {
+    PERF_COUNTER_CYCLES,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_CACHE_MISSES,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+} PerfCounterId;
+
+/**
+ * @struct PerfThreadCounters
+ * @brief The open event group of one thread. Lives on that thread's stack.
+ */
+typedef struct {
+    const char* name;
+    int         fds[PERF_COUNTER_COUNT];  ///< -1 for events that could not be opened.
+    int         group_fd;                 ///< The group leader (cycles), or -1 if nothing is being counted.
+} PerfThreadCounters;
+
+/**
+ * @struct PerfCounterResult
+ * @brief Final counts for one thread, scaled for multiplexing.
+ */
+typedef struct {
+    const char*        name;
+    unsigned long long values[PERF_COUNTER_COUNT];
+    bool               valid[PERF_COUNTER_COUNT];
+} PerfCounterResult;
+
+
+// --- Function Declarations ---
+
+/**
+ * @brief Enables counting for threads started from now on, and clears previous results.
+ *
+ * Probes once whether perf events can be opened. On failure, logs a warning
+ * and leaves the collector disabled.
+ *
+ * @return true if counters will be collected.
+ */
+bool perf_counters_enable(void);
+
+/**
+ * @brief Opens the event group for the calling thread. Does nothing if the collector is disabled.
+ * @param counters Storage for the calling thread's events.
+ * @param name The thread's name. Must outlive the collector (a string literal).
+ */
+void perf_counters_thread_begin(PerfThreadCounters* counters, const char* name);
+
+/**
+ * @brief Reads and closes the calling thread's events and stores the result.
+ * @param counters The storage passed to perf_counters_thread_begin().
+ */
+void perf_counters_thread_end(PerfThreadCounters* counters);
+
+/**
+ * @brief Gets the number of threads with stored results.
+ * @return The number of results.
+ */
+int perf_counters_get_result_count(void);
+
+/**
+ * @brief Gets one thread's stored result.
+ * @param index The result index, from 0 to perf_counters_get_result_count() - 1.
+ * @return A pointer to the result, valid until the next perf_counters_enable().
+ */
+const PerfCounterResult* perf_counters_get_result(int index);
+
+#endif // PERF_COUNTERS_H_
@@ -17,6 +17,7 @@ void* reader_thread_func(void* arg);
 void* pre_processor_thread_func(void* arg);
 void* resampler_thread_func(void* arg);
 void* post_processor_thread_func(void* arg);
+void* transcoder_thread_func(void* arg);
 void* writer_thread_func(void* arg);
 
 #endif // PIPELINE_THREADS_H_
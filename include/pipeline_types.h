@@ -35,6 +35,7 @@ typedef struct SampleChunk {
     complex_float_t* complex_sample_buffer_a;     ///< Generic complex float sample buffer #1 for ping-pong.
     complex_float_t* complex_sample_buffer_b;     ///< Generic complex float sample buffer #2 for ping-pong.
     unsigned char*   final_output_data;           ///< Buffer for the final, converted output data.
+    const void*      mapped_input_data;           ///< Raw data inside a memory-mapped input file (--mmap-input); replaces raw_input_data.
 
     // --- State Pointers for Data Flow ---
     complex_float_t* current_input_buffer;        ///< Points to the buffer containing valid data for the current stage.
@@ -52,6 +53,7 @@ typedef struct SampleChunk {
     bool         is_last_chunk;               ///< Flag indicating this is the final chunk in a stream.
     bool         stream_discontinuity_event;  ///< Flag indicating a stream reset (e.g., SDR overrun).
     size_t       input_bytes_per_sample_pair; ///< The size of a single I/Q pair from the source.
+    unsigned long long capture_time_ns;       ///< Monotonic time the samples entered the pipeline (0 if unstamped).
 } SampleChunk;
 
 /**
@@ -82,5 +82,15 @@ void* queue_try_dequeue(Queue* queue);
  */
 void queue_signal_shutdown(Queue* queue);
 
+/**
+ * @brief Gets the number of items currently in the queue.
+ *
+ * The value may be stale by the time it is used. Intended for monitoring only.
+ *
+ * @param queue Pointer to the Queue.
+ * @return The number of items in the queue.
+ */
+size_t queue_get_count(Queue* queue);
+
 
 #endif // QUEUE_H_
@@ -42,6 +42,11 @@ void destroy_resampler(resampler_t* resampler);
  */
 void resampler_reset(resampler_t* resampler);
 
+/**
+ * @brief Returns the group delay of the resampler, as reported by liquid-dsp (output samples).
+ */
+float resampler_get_delay(resampler_t* resampler);
+
 /**
  * @brief Executes the resampler on a block of samples.
  */
@@ -65,6 +65,16 @@ bool sdr_packet_serializer_write_interleaved_chunk(struct RingBuffer* buffer, ui
  */
 bool sdr_packet_serializer_write_reset_event(struct RingBuffer* buffer);
 
+/**
+ * @brief Returns the ring buffer space one interleaved packet occupies.
+ * Producers that must not drop data wait for this much free space before writing.
+ *
+ * @param num_samples The number of I/Q samples in the packet.
+ * @param bytes_per_sample_pair The size of one I/Q sample pair.
+ * @return The header plus payload size in bytes.
+ */
+size_t sdr_packet_serializer_packet_bytes(uint32_t num_samples, size_t bytes_per_sample_pair);
+
 
 // --- Deserialization Function (Reading from the Stream) ---
 
@@ -0,0 +1,64 @@
+/**
+ * @file segment.h
+ * @brief Defines parallel segmented processing of one file input (--segments).
+ *
+ * The pipeline is a chain of single threads, so one run of a long recording
+ * is bounded by its slowest stage. With --segments N the input is split into
+ * N contiguous ranges and each range is processed by its own copy of the
+ * program, started with --start/--duration and the internal --segment-job
+ * option. The jobs write straight into their own part of the output file, so
+ * the result is one file with no merge step.
+ *
+ * Every job except the first starts a little early and every job except the
+ * last runs a little long. The extra "warm-up" frames settle the DC block,
+ * the resampler and the user filter; their output is dropped, so the joins
+ * match a single run. Segment boundaries fall on a whole number of resampler
+ * periods, and the frequency shifter starts each job at the phase a single
+ * run would have there.
+ *
+ * The parent keeps the job of the output module: it creates the file and
+ * writes (and later patches) any header. It is Linux and other POSIX only.
+ */
+
+#ifndef SEGMENT_H_
+#define SEGMENT_H_
+
+#include <stdbool.h>
+#include "module.h"
+
+struct AppConfig;
+struct AppResources;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Runs an initialized application as parallel segment jobs.
+ *
+ * Plans the segments and hands them to the output module's write_segments
+ * hook. If the input is too short to split, it runs the normal pipeline.
+ *
+ * @param config The application configuration.
+ * @param resources The application resources, after initialize_application().
+ * @param argc The argument count the program was started with.
+ * @param argv The arguments the program was started with, passed on to the jobs.
+ * @return true if every job completed, false otherwise.
+ */
+bool segment_run(struct AppConfig* config, struct AppResources* resources, int argc, char* argv[]);
+
+/**
+ * @brief Starts the planned segment jobs and waits for them to write the output payload.
+ *
+ * Called by an output module's write_segments hook. The payload region is
+ * reserved up front, progress is reported through the progress callback, and
+ * the file is cut to the payload that was written contiguously.
+ *
+ * @param ctx The application context.
+ * @param out_fd The open output file.
+ * @param payload_offset The file offset of the first payload byte (the header size).
+ * @param[in,out] total_bytes_written The module's payload byte counter, advanced by the bytes written.
+ * @return The number of payload bytes written, or -1 if a job failed.
+ */
+long long segment_write_output(ModuleContext* ctx, int out_fd, unsigned long long payload_offset,
+                               long long* total_bytes_written);
+
+#endif // SEGMENT_H_
@@ -0,0 +1,188 @@
+/**
+ * @file telemetry.h
+ * @brief Defines the per-stage pipeline telemetry collector and its JSON export.
+ *
+ * Every pipeline thread reports when it starts and finishes work on a chunk.
+ * Time between finishing one chunk and starting the next is counted as
+ * "blocked" (waiting on an empty input queue or a full output queue), time in
+ * between as "busy". The DSP chains additionally report the time spent in each
+ * processing step, which gives a per-step ns/sample figure.
+ *
+ * Each chunk carries the monotonic time its samples entered the pipeline (SDR
+ * callback or file read). Stages record capture-to-exit latency into
+ * log-linear histograms, from which p50/p99/p99.9 are derived. The writer ring
+ * buffer carries no chunk boundaries, so the post-processor pushes each chunk's
+ * end offset and timestamp into a small side index that the writer drains as
+ * bytes reach the output.
+ *
+ * When a stats file is given (--stats-json), a background sampler thread also
+ * records queue and ring buffer occupancy into histograms, and periodically
+ * appends a JSON snapshot (one object per line). A final summary object is
+ * appended when the pipeline stops.
+ *
+ * All reporting functions accept a NULL Telemetry pointer and do nothing, so
+ * call sites do not need to check whether telemetry is enabled.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "pipeline_types.h"
+
+struct RingBuffer;
+
+// --- Type Definitions ---
+
+/**
+ * @enum TelemetryStage
+ * @brief The pipeline threads that report busy/blocked time.
+ */
+typedef enum {
+    TELEMETRY_STAGE_SDR_CAPTURE,
+    TELEMETRY_STAGE_READER,
+    TELEMETRY_STAGE_PRE_PROCESSOR,
+    TELEMETRY_STAGE_RESAMPLER,
+    TELEMETRY_STAGE_POST_PROCESSOR,
+    TELEMETRY_STAGE_TRANSCODER,
+    TELEMETRY_STAGE_WRITER,
+    TELEMETRY_STAGE_COUNT
+} TelemetryStage;
+
+/**
+ * @enum TelemetryStep
+ * @brief The individual steps timed inside the pipeline stages.
+ */
+typedef enum {
+    TELEMETRY_STEP_CONVERT_INPUT,
+    TELEMETRY_STEP_DC_BLOCK,
+    TELEMETRY_STEP_IQ_CORRECT,
+    TELEMETRY_STEP_PRE_FREQ_SHIFT,
+    TELEMETRY_STEP_PRE_FILTER,
+    TELEMETRY_STEP_RESAMPLE,
+    TELEMETRY_STEP_POST_FILTER,
+    TELEMETRY_STEP_POST_FREQ_SHIFT,
+    TELEMETRY_STEP_AGC,
+    TELEMETRY_STEP_CONVERT_OUTPUT,
+    TELEMETRY_STEP_TRANSCODE,
+    TELEMETRY_STEP_PIPE_STALL,      ///< The stdout writer waiting for room in a full pipe.
+    TELEMETRY_STEP_COUNT
+} TelemetryStep;
+
+typedef struct Telemetry Telemetry;
+
+
+// --- Function Declarations ---
+
+/**
+ * @brief Creates a telemetry collector.
+ * @param json_path The JSON Lines file to write snapshots and the final summary to,
+ *                  or NULL to only keep counters in memory.
+ * @return A pointer to the collector, or NULL on failure.
+ */
+Telemetry* telemetry_create(const char* json_path);
+
+/**
+ * @brief Registers a queue whose occupancy should be sampled.
+ * @param tel The collector.
+ * @param name A short, stable name used as the JSON key (must outlive the collector).
+ * @param queue The queue. NULL is ignored.
+ */
+void telemetry_register_queue(Telemetry* tel, const char* name, Queue* queue);
+
+/**
+ * @brief Registers a ring buffer whose occupancy should be sampled.
+ * @param tel The collector.
+ * @param name A short, stable name used as the JSON key (must outlive the collector).
+ * @param ring The ring buffer. NULL is ignored.
+ */
+void telemetry_register_ring_buffer(Telemetry* tel, const char* name, struct RingBuffer* ring);
+
+/**
+ * @brief Starts the clock and, if exporting, the sampler thread. Call just before the pipeline threads start.
+ * @param tel The collector.
+ * @return true on success.
+ */
+bool telemetry_start(Telemetry* tel);
+
+/**
+ * @brief Stops the sampler thread and writes the final summary, if exporting. Call after all pipeline threads have exited.
+ * @param tel The collector.
+ */
+void telemetry_stop(Telemetry* tel);
+
+/**
+ * @brief Closes the output file and frees the collector.
+ * @param tel The collector. NULL is ignored.
+ */
+void telemetry_destroy(Telemetry* tel);
+
+/**
+ * @brief Marks the start of work on a chunk. Time since the stage's previous
+ *        telemetry_stage_end_work() call is counted as blocked.
+ * @param tel The collector, or NULL.
+ * @param stage The calling thread's stage. Each stage must be reported by a single thread.
+ */
+void telemetry_stage_begin_work(Telemetry* tel, TelemetryStage stage);
+
+/**
+ * @brief Marks the end of work on a chunk. Time since telemetry_stage_begin_work() is counted as busy.
+ * @param tel The collector, or NULL.
+ * @param stage The calling thread's stage.
+ * @param samples The number of complex samples the stage processed.
+ */
+void telemetry_stage_end_work(Telemetry* tel, TelemetryStage stage, size_t samples);
+
+/**
+ * @brief Returns the current timestamp for step timing.
+ * @param tel The collector, or NULL.
+ * @return Nanoseconds on the monotonic clock, or 0 if tel is NULL.
+ */
+unsigned long long telemetry_step_begin(const Telemetry* tel);
+
+/**
+ * @brief Records the duration of one DSP step.
+ * @param tel The collector, or NULL.
+ * @param step The step that just finished.
+ * @param start_ns The value returned by telemetry_step_begin() or the previous telemetry_step_end().
+ * @param samples The number of complex samples processed.
+ * @return The current timestamp, to chain consecutive steps without an extra clock read.
+ */
+unsigned long long telemetry_step_end(Telemetry* tel, TelemetryStep step, unsigned long long start_ns, size_t samples);
+
+/**
+ * @brief Records the latency of a chunk leaving a stage.
+ * @param tel The collector, or NULL.
+ * @param stage The calling thread's stage.
+ * @param capture_ns The chunk's capture timestamp. 0 (unstamped) is ignored.
+ */
+void telemetry_record_latency(Telemetry* tel, TelemetryStage stage, unsigned long long capture_ns);
+
+/**
+ * @brief Notes that a chunk's bytes end at the given offset of the writer ring buffer stream. (Producer-side Function)
+ * @param tel The collector, or NULL.
+ * @param stream_end_bytes Total bytes written to the ring buffer, including this chunk.
+ * @param capture_ns The chunk's capture timestamp.
+ */
+void telemetry_latency_index_push(Telemetry* tel, unsigned long long stream_end_bytes, unsigned long long capture_ns);
+
+/**
+ * @brief Records writer latency for every indexed chunk that has now been fully written. (Consumer-side Function)
+ * @param tel The collector, or NULL.
+ * @param stream_bytes_written Total bytes the writer has consumed from the ring buffer.
+ */
+void telemetry_latency_index_advance(Telemetry* tel, unsigned long long stream_bytes_written);
+
+/**
+ * @brief Gets latency percentiles for a stage.
+ * @param tel The collector, or NULL.
+ * @param stage The stage.
+ * @param[out] p50_ms Median latency in milliseconds.
+ * @param[out] p99_ms 99th percentile latency in milliseconds.
+ * @param[out] p999_ms 99.9th percentile latency in milliseconds.
+ * @return true if any latency was recorded for the stage.
+ */
+bool telemetry_get_latency_ms(const Telemetry* tel, TelemetryStage stage, double* p50_ms, double* p99_ms, double* p999_ms);
+
+#endif // TELEMETRY_H_
@@ -18,14 +18,25 @@
 
 // --- Type Definitions ---
 
+/**
+ * @struct ManagedThreadStart
+ * @brief What a managed thread runs, kept alive until the thread is joined.
+ */
+typedef struct {
+    const char* name;
+    void*       (*func)(void*);
+    void*       context;
+} ManagedThreadStart;
+
 /**
  * @struct ThreadManager
  * @brief The manager struct that holds thread handles and state.
  */
 typedef struct {
-    pthread_t thread_handles[MAX_MANAGED_THREADS];
-    int       num_threads_started;
-    void*     thread_context; // A generic context pointer to pass to all threads.
+    pthread_t          thread_handles[MAX_MANAGED_THREADS];
+    ManagedThreadStart thread_starts[MAX_MANAGED_THREADS];
+    int                num_threads_started;
+    void*              thread_context; // A generic context pointer to pass to all threads.
 } ThreadManager;
 
 
@@ -45,7 +56,7 @@ void thread_manager_init(ThreadManager* manager, void* context);
  * This function immediately creates a new thread to execute the given function.
  *
  * @param manager A pointer to the initialized ThreadManager.
- * @param name The name of the thread for logging.
+ * @param name The name of the thread for logging and the --trace output. Must outlive the thread.
  * @param func The function pointer for the thread to execute.
  * @return true if the thread was spawned successfully, false otherwise.
  */
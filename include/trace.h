@@ -0,0 +1,64 @@
+/**
+ * @file trace.h
+ * @brief Defines the Chrome trace-event recorder behind --trace.
+ *
+ * When enabled, every thread that records an event gets its own fixed-size
+ * event buffer. Recording only appends to the calling thread's buffer, so it
+ * takes no locks and never blocks; if a buffer fills up, further events from
+ * that thread are counted and dropped. Nothing is written until trace_finish(),
+ * which runs after all pipeline threads have exited and serializes every buffer
+ * as a Chrome trace-event JSON file that chrome://tracing and Perfetto can load.
+ *
+ * The recorder is process-wide. When it is not enabled, trace_span() returns
+ * after a single flag check.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// --- Function Declarations ---
+
+/**
+ * @brief Enables tracing and creates the output file.
+ * @param path The file to write the trace to when trace_finish() is called.
+ * @return true on success, false if the file could not be created.
+ */
+bool trace_init(const char* path);
+
+/**
+ * @brief Checks whether tracing is enabled.
+ * @return true if trace_init() succeeded and trace_finish() has not been called.
+ */
+bool trace_is_enabled(void);
+
+/**
+ * @brief Names the calling thread in the trace. Threads that are never named
+ *        (e.g. SDR driver callback threads) are shown as "Thread <n>".
+ * @param name The display name. Must outlive the recorder (a string literal).
+ */
+void trace_set_thread_name(const char* name);
+
+/**
+ * @brief Records a completed span on the calling thread.
+ * @param category The span category ("stage", "step", "wait", ...). Must be a string literal.
+ * @param name The span name. Must be a string literal.
+ * @param start_ns Start time from get_monotonic_time_ns().
+ * @param end_ns End time from get_monotonic_time_ns().
+ * @param samples The number of samples the span covered, or 0 if not applicable.
+ */
+void trace_span(const char* category, const char* name, unsigned long long start_ns, unsigned long long end_ns, size_t samples);
+
+/**
+ * @brief Writes all recorded events to the trace file and disables tracing.
+ *
+ * Must only be called once every thread that recorded events has exited.
+ * Does nothing if tracing was not enabled.
+ *
+ * @return true if the file was written successfully.
+ */
+bool trace_finish(void);
+
+#endif // TRACE_H_
@@ -0,0 +1,68 @@
+/**
+ * @file transcode.h
+ * @brief Defines the direct sample format conversion used when no DSP stage is enabled.
+ *
+ * When a run only changes the sample format (--no-resample with no filter,
+ * frequency shift, DC block, I/Q correction or AGC), the pipeline replaces the
+ * pre-processor, resampler and post-processor threads with a single transcoder
+ * thread that converts each chunk straight into its output format.
+ *
+ * The output is identical to the cf32 path. Samples go through cf32 in blocks
+ * that stay in L1, so the full-size cf32 buffers and the two extra queue hops
+ * of the DSP threads are skipped. cf32 outputs are converted directly into the
+ * output buffer, pairs whose round trip changes nothing are copied, and cs24
+ * output from 8- and 16-bit inputs uses a lookup table.
+ */
+
+#ifndef TRANSCODE_H_
+#define TRANSCODE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "common_types.h"
+
+// --- Type Definitions ---
+
+typedef struct Transcoder Transcoder;
+
+// --- Function Declarations ---
+
+/**
+ * @brief Creates a transcoder for one output format.
+ *
+ * The kernel for input_format is prepared up front. If a later block arrives
+ * in another format (an SDR may switch packet formats), its kernel is
+ * prepared on that block.
+ *
+ * @param input_format The expected input format.
+ * @param output_format The format written to the output.
+ * @param gain The linear gain applied on input, as in convert_block_to_cf32().
+ * @return The transcoder, or NULL if the format pair is unhandled or out of memory.
+ */
+Transcoder* transcode_create(format_t input_format, format_t output_format, float gain);
+
+/**
+ * @brief Converts a block of samples from input_format to the transcoder's output format.
+ *
+ * @param tc The transcoder.
+ * @param input_buffer The packed input samples.
+ * @param input_format The format of the input samples. May change between calls.
+ * @param output_buffer The destination for num_frames samples in the output format.
+ * @param num_frames The number of frames (I/Q pairs) to convert.
+ * @return true on success, false if the format is unhandled or a table could not be allocated.
+ */
+bool transcode_block(Transcoder* tc, const void* restrict input_buffer, format_t input_format,
+                     void* restrict output_buffer, size_t num_frames);
+
+/**
+ * @brief Returns how the last converted input format was handled, e.g. "copy" or "lookup table".
+ */
+const char* transcode_describe(const Transcoder* tc);
+
+/**
+ * @brief Frees the transcoder and its table.
+ * @param tc The transcoder (may be NULL).
+ */
+void transcode_destroy(Transcoder* tc);
+
+#endif // TRANSCODE_H_
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <time.h>
 #include "app_context.h"
 #include "module.h"
 #include "memory_arena.h"
@@ -25,6 +26,27 @@
  */
 double get_monotonic_time_sec(void);
 
+/**
+ * @brief Gets a high-resolution monotonic timestamp in nanoseconds.
+ *
+ * Used for per-chunk latency stamps and stage timing, where integer
+ * arithmetic on timestamps from different threads must be exact.
+ *
+ * @return Nanoseconds since an arbitrary fixed point.
+ */
+unsigned long long get_monotonic_time_ns(void);
+
+/**
+ * @brief Gets a cheap, coarse monotonic timestamp in milliseconds.
+ *
+ * Resolution is typically 1-10 ms. Intended for hot paths such as SDR
+ * callbacks, where the cost of a high-resolution clock read matters more
+ * than its precision.
+ *
+ * @return Milliseconds since an arbitrary fixed point.
+ */
+unsigned long long get_monotonic_time_coarse_ms(void);
+
 /**
  * @brief Clears the standard input buffer up to the next newline or EOF.
  */
@@ -103,4 +125,64 @@ bool utils_check_nyquist_warning(double freq_to_check_hz, double sample_rate_hz,
  */
 bool utils_check_file_exists(const char* full_path);
 
+/**
+ * @brief Parses a human-readable byte size (e.g., "512M", "1.5G", "64KiB") into bytes.
+ *
+ * Units are binary (K = 1024). A bare number is interpreted as bytes.
+ *
+ * @param str The string to parse.
+ * @param out_bytes Receives the parsed size in bytes.
+ * @return true on success, false if the string is not a valid size.
+ */
+bool utils_parse_size_string(const char* str, unsigned long long* out_bytes);
+
+/**
+ * @brief Converts a broken-down UTC time to seconds since the Unix epoch.
+ *
+ * The inverse of gmtime(): unlike mktime(), the local time zone is ignored.
+ * Fields are normalized in place and tm_isdst is cleared.
+ *
+ * @param tm The UTC time to convert.
+ * @return The Unix time, or (time_t)-1 if it cannot be represented.
+ */
+time_t utils_timegm(struct tm* tm);
+
+/**
+ * @brief Advances an xorshift64* generator and returns its next value.
+ *
+ * Fast and reproducible from a fixed seed. Good enough for test signals and
+ * simulated jitter, not for anything that needs real randomness.
+ *
+ * @param state The generator state. Must be seeded with a non-zero value.
+ * @return The next 64-bit pseudo-random value.
+ */
+uint64_t utils_rng_next(uint64_t* state);
+
+/**
+ * @brief Reads the process-wide minor and major page fault counters.
+ *
+ * Minor faults include the first touch of every page and TLB-related remaps;
+ * major faults required disk I/O (e.g., swapped-out buffers).
+ *
+ * @param minor_faults Receives the cumulative minor fault count.
+ * @param major_faults Receives the cumulative major fault count.
+ * @return true on success, false if the platform does not provide the counters.
+ */
+bool utils_get_page_fault_counts(unsigned long long* minor_faults, unsigned long long* major_faults);
+
+/**
+ * @brief Grows a pipe's kernel buffer with F_SETPIPE_SZ (Linux).
+ *
+ * Without CAP_SYS_RESOURCE a pipe cannot exceed /proc/sys/fs/pipe-max-size, so
+ * a refused request is retried at that limit. A pipe that is already at least
+ * as large is left alone.
+ *
+ * @param fd A descriptor for either end of the pipe.
+ * @param wanted_bytes The capacity to request.
+ * @param name The stream name for log messages (e.g., "stdout").
+ * @return The pipe's capacity afterwards, or 0 if fd is not a pipe or the
+ *         platform cannot size pipes.
+ */
+size_t utils_grow_pipe(int fd, size_t wanted_bytes, const char* name);
+
 #endif // UTILS_H_
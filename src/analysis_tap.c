@@ -0,0 +1,168 @@
+/**
+ * @file analysis_tap.c
+ * @brief Implements the lock-free analysis snapshot ring.
+ */
+
+#include "analysis_tap.h"
+#include "constants.h"
+#include "utils.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// --- Private Definitions ---
+
+/**
+ * @struct AnalysisTapSlot
+ * @brief One window in the ring.
+ *
+ * `seq` is 2*n while the slot holds window n, and 2*n+1 while window n is
+ * being written. Readers check it before and after copying the samples.
+ */
+typedef struct {
+    atomic_ullong    seq;
+    complex_float_t* samples;
+} AnalysisTapSlot;
+
+struct AnalysisTap {
+    AnalysisTapSlot    slots[ANALYSIS_TAP_NUM_SLOTS];
+    size_t             window_samples;
+    unsigned int       min_interval_ms;
+    unsigned long long last_publish_ms;     ///< Producer-private.
+    atomic_ullong      published_count;     ///< Sequence number of the newest complete window.
+    atomic_bool        closed;
+};
+
+// --- Public Function Implementations ---
+
+AnalysisTap* analysis_tap_create(size_t window_samples, unsigned int min_interval_ms) {
+    AnalysisTap* tap = (AnalysisTap*)calloc(1, sizeof(AnalysisTap));
+    if (!tap) {
+        log_fatal("Failed to allocate memory for analysis tap.");
+        return NULL;
+    }
+
+    for (int i = 0; i < ANALYSIS_TAP_NUM_SLOTS; i++) {
+        tap->slots[i].samples = (complex_float_t*)malloc(window_samples * sizeof(complex_float_t));
+        if (!tap->slots[i].samples) {
+            log_fatal("Failed to allocate memory for analysis tap window of %zu samples.", window_samples);
+            analysis_tap_destroy(tap);
+            return NULL;
+        }
+        atomic_init(&tap->slots[i].seq, 0);
+    }
+
+    tap->window_samples = window_samples;
+    tap->min_interval_ms = min_interval_ms;
+    tap->last_publish_ms = 0;
+    atomic_init(&tap->published_count, 0);
+    atomic_init(&tap->closed, false);
+
+    log_debug("Analysis tap created with %d windows of %zu samples (min interval %u ms).",
+              ANALYSIS_TAP_NUM_SLOTS, window_samples, min_interval_ms);
+    return tap;
+}
+
+void analysis_tap_destroy(AnalysisTap* tap) {
+    if (!tap) return;
+    for (int i = 0; i < ANALYSIS_TAP_NUM_SLOTS; i++) {
+        free(tap->slots[i].samples);
+    }
+    free(tap);
+}
+
+size_t analysis_tap_get_window_samples(const AnalysisTap* tap) {
+    return tap->window_samples;
+}
+
+bool analysis_tap_publish(AnalysisTap* tap, const complex_float_t* samples, size_t num_samples) {
+    if (num_samples < tap->window_samples) {
+        return false;
+    }
+
+    if (tap->min_interval_ms > 0) {
+        unsigned long long now_ms = get_monotonic_time_coarse_ms();
+        if (tap->last_publish_ms != 0 && now_ms - tap->last_publish_ms < tap->min_interval_ms) {
+            return false;
+        }
+        tap->last_publish_ms = now_ms;
+    }
+
+    // Only this thread writes published_count, so a relaxed load is sufficient.
+    unsigned long long n = atomic_load_explicit(&tap->published_count, memory_order_relaxed) + 1;
+    AnalysisTapSlot* slot = &tap->slots[(n - 1) % ANALYSIS_TAP_NUM_SLOTS];
+
+    atomic_store_explicit(&slot->seq, 2 * n + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(slot->samples, samples, tap->window_samples * sizeof(complex_float_t));
+    atomic_store_explicit(&slot->seq, 2 * n, memory_order_release);
+
+    atomic_store_explicit(&tap->published_count, n, memory_order_release);
+    return true;
+}
+
+void analysis_tap_close(AnalysisTap* tap) {
+    if (!tap) return;
+    atomic_store_explicit(&tap->closed, true, memory_order_release);
+}
+
+void analysis_tap_subscribe(AnalysisTap* tap, AnalysisTapReader* reader) {
+    reader->cursor = atomic_load_explicit(&tap->published_count, memory_order_acquire);
+    reader->dropped = 0;
+}
+
+AnalysisTapReadResult analysis_tap_read(AnalysisTap* tap, AnalysisTapReader* reader, complex_float_t* out) {
+    for (;;) {
+        // Read 'closed' first: if it is set, every window was published before it.
+        bool closed = atomic_load_explicit(&tap->closed, memory_order_acquire);
+        unsigned long long newest = atomic_load_explicit(&tap->published_count, memory_order_acquire);
+
+        if (newest <= reader->cursor) {
+            return closed ? ANALYSIS_TAP_READ_CLOSED : ANALYSIS_TAP_READ_EMPTY;
+        }
+
+        // Drop-oldest: if the reader fell behind, skip to the oldest window still in the ring.
+        unsigned long long wanted = reader->cursor + 1;
+        if (newest - reader->cursor > ANALYSIS_TAP_NUM_SLOTS) {
+            wanted = newest - ANALYSIS_TAP_NUM_SLOTS + 1;
+        }
+
+        AnalysisTapSlot* slot = &tap->slots[(wanted - 1) % ANALYSIS_TAP_NUM_SLOTS];
+        unsigned long long seq_before = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq_before != 2 * wanted) {
+            continue; // Overwritten or being written; re-read the newest position.
+        }
+
+        memcpy(out, slot->samples, tap->window_samples * sizeof(complex_float_t));
+        atomic_thread_fence(memory_order_acquire);
+        unsigned long long seq_after = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        if (seq_after != seq_before) {
+            continue; // The producer lapped us during the copy.
+        }
+
+        reader->dropped += wanted - reader->cursor - 1;
+        reader->cursor = wanted;
+        return ANALYSIS_TAP_READ_OK;
+    }
+}
+
+AnalysisTapReadResult analysis_tap_wait_read(AnalysisTap* tap, AnalysisTapReader* reader, complex_float_t* out) {
+    for (;;) {
+        AnalysisTapReadResult result = analysis_tap_read(tap, reader, out);
+        if (result != ANALYSIS_TAP_READ_EMPTY) {
+            return result;
+        }
+#ifdef _WIN32
+        Sleep(ANALYSIS_TAP_POLL_INTERVAL_MS);
+#else
+        usleep(ANALYSIS_TAP_POLL_INTERVAL_MS * 1000);
+#endif
+    }
+}
@@ -0,0 +1,548 @@
+/**
+ * @file async_io.c
+ * @brief Implements the io_uring and thread-pool backends of the async I/O layer.
+ */
+
+#include "async_io.h"
+#include "constants.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#endif
+
+#if !defined(_WIN32) && defined(__linux__) && defined(HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define ASYNC_IO_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef _WIN32
+
+AsyncIo* async_io_create(int fd, unsigned int depth, bool direct_io) {
+    (void)fd;
+    (void)depth;
+    (void)direct_io;
+    return NULL;
+}
+
+void async_io_submit(AsyncIo* aio, AsyncIoRequest* request) {
+    (void)aio;
+    request->error = ENOSYS;
+}
+
+void async_io_wait(AsyncIo* aio, AsyncIoRequest* request) {
+    (void)aio;
+    (void)request;
+}
+
+const char* async_io_backend_name(const AsyncIo* aio) {
+    (void)aio;
+    return "unavailable";
+}
+
+void async_io_destroy(AsyncIo* aio) {
+    (void)aio;
+}
+
+#else
+
+// --- Private Definitions ---
+
+enum {
+    REQUEST_IDLE,
+    REQUEST_PENDING,  ///< Queued for a worker (thread pool only).
+    REQUEST_RUNNING,  ///< Being transferred by a worker or by the kernel.
+    REQUEST_DONE
+};
+
+#ifdef ASYNC_IO_HAVE_IO_URING
+/**
+ * @struct Uring
+ * @brief The mapped submission and completion rings of an io_uring instance.
+ */
+typedef struct {
+    int                  ring_fd;
+    unsigned*            sq_head;
+    unsigned*            sq_tail;
+    unsigned*            sq_mask;
+    unsigned*            sq_array;
+    unsigned*            cq_head;
+    unsigned*            cq_tail;
+    unsigned*            cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void*                sq_ring;
+    size_t               sq_ring_length;
+    void*                cq_ring;
+    size_t               cq_ring_length;
+    size_t               sqes_length;
+    unsigned             in_flight;  ///< Entries the kernel has taken but not yet completed.
+} Uring;
+#endif
+
+struct AsyncIo {
+    int  fd;
+    bool direct_io;
+    bool use_uring;
+
+#ifdef ASYNC_IO_HAVE_IO_URING
+    Uring uring;
+#endif
+
+    // Thread pool
+    pthread_t       workers[ASYNC_IO_MAX_THREADS];
+    unsigned int    num_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t  work_available;
+    pthread_cond_t  work_done;
+    AsyncIoRequest* pending_head;
+    AsyncIoRequest* pending_tail;
+    bool            stopping;
+};
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Records the result of one transfer call and decides whether the request needs another.
+ * @return true if the request is finished (complete, end of file, or failed).
+ */
+static bool _request_account(const AsyncIo* aio, AsyncIoRequest* request, long long result) {
+    if (result < 0) {
+        int err = (int)-result;
+        if (err == EINTR || err == EAGAIN) {
+            return false;
+        }
+        // O_DIRECT refuses the unaligned offset that follows a short read at the
+        // end of the file. Everything up to that point has been read.
+        if (err == EINVAL && aio->direct_io && request->op == ASYNC_IO_READ && request->done > 0) {
+            return true;
+        }
+        request->error = err;
+        return true;
+    }
+    if (result == 0) {
+        if (request->op == ASYNC_IO_WRITE) {
+            request->error = EIO; // A write that makes no progress would loop forever.
+        }
+        return true; // End of file for reads.
+    }
+    request->done += (size_t)result;
+    return request->done >= request->length;
+}
+
+static void _request_transfer_blocking(const AsyncIo* aio, AsyncIoRequest* request) {
+    for (;;) {
+        unsigned char* buffer = request->buffer + request->done;
+        size_t remaining = request->length - request->done;
+        off_t offset = (off_t)(request->offset + request->done);
+        ssize_t n = (request->op == ASYNC_IO_READ) ? pread(aio->fd, buffer, remaining, offset)
+                                                   : pwrite(aio->fd, buffer, remaining, offset);
+        if (_request_account(aio, request, (n < 0) ? -(long long)errno : (long long)n)) {
+            return;
+        }
+    }
+}
+
+// --- Thread Pool Backend ---
+
+static void* _async_io_worker(void* arg) {
+    AsyncIo* aio = (AsyncIo*)arg;
+
+    pthread_mutex_lock(&aio->lock);
+    while (!aio->stopping) {
+        // Requests are served in submission order.
+        AsyncIoRequest* request = aio->pending_head;
+        if (!request) {
+            pthread_cond_wait(&aio->work_available, &aio->lock);
+            continue;
+        }
+        aio->pending_head = request->next_pending;
+        if (!aio->pending_head) {
+            aio->pending_tail = NULL;
+        }
+
+        request->state = REQUEST_RUNNING;
+        pthread_mutex_unlock(&aio->lock);
+        _request_transfer_blocking(aio, request);
+        pthread_mutex_lock(&aio->lock);
+        request->state = REQUEST_DONE;
+        pthread_cond_broadcast(&aio->work_done);
+    }
+    pthread_mutex_unlock(&aio->lock);
+    return NULL;
+}
+
+static bool _threads_start(AsyncIo* aio, unsigned int depth) {
+    if (pthread_mutex_init(&aio->lock, NULL) != 0) {
+        return false;
+    }
+    pthread_cond_init(&aio->work_available, NULL);
+    pthread_cond_init(&aio->work_done, NULL);
+
+    unsigned int wanted = (depth < ASYNC_IO_MAX_THREADS) ? depth : ASYNC_IO_MAX_THREADS;
+    for (unsigned int i = 0; i < wanted; i++) {
+        if (pthread_create(&aio->workers[i], NULL, _async_io_worker, aio) != 0) {
+            break;
+        }
+        aio->num_workers++;
+    }
+    if (aio->num_workers == 0) {
+        pthread_cond_destroy(&aio->work_available);
+        pthread_cond_destroy(&aio->work_done);
+        pthread_mutex_destroy(&aio->lock);
+        return false;
+    }
+    return true;
+}
+
+static void _threads_stop(AsyncIo* aio) {
+    pthread_mutex_lock(&aio->lock);
+    aio->stopping = true;
+    pthread_cond_broadcast(&aio->work_available);
+    pthread_mutex_unlock(&aio->lock);
+    for (unsigned int i = 0; i < aio->num_workers; i++) {
+        pthread_join(aio->workers[i], NULL);
+    }
+    pthread_cond_destroy(&aio->work_available);
+    pthread_cond_destroy(&aio->work_done);
+    pthread_mutex_destroy(&aio->lock);
+}
+
+// --- io_uring Backend ---
+
+#ifdef ASYNC_IO_HAVE_IO_URING
+
+static bool _uring_setup(AsyncIo* aio, unsigned int depth) {
+    Uring* ring = &aio->uring;
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int ring_fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+    if (ring_fd < 0) {
+        log_debug("io_uring_setup failed (%s); using the I/O thread pool.", strerror(errno));
+        return false;
+    }
+    ring->ring_fd = ring_fd;
+
+    ring->sq_ring_length = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_length = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && ring->cq_ring_length > ring->sq_ring_length) {
+        ring->sq_ring_length = ring->cq_ring_length;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        close(ring_fd);
+        return false;
+    }
+    if (single_mmap) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            munmap(ring->sq_ring, ring->sq_ring_length);
+            close(ring_fd);
+            return false;
+        }
+    }
+    ring->sqes_length = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = (struct io_uring_sqe*)mmap(NULL, ring->sqes_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ring != ring->sq_ring) {
+            munmap(ring->cq_ring, ring->cq_ring_length);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_length);
+        close(ring_fd);
+        return false;
+    }
+
+    char* sq = (char*)ring->sq_ring;
+    char* cq = (char*)ring->cq_ring;
+    ring->sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return true;
+}
+
+static void _uring_teardown(AsyncIo* aio) {
+    Uring* ring = &aio->uring;
+    munmap(ring->sqes, ring->sqes_length);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_length);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_length);
+    close(ring->ring_fd);
+}
+
+/**
+ * @return The number of entries the kernel took from the submission ring, or a negative errno.
+ */
+static int _uring_enter(AsyncIo* aio, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    for (;;) {
+        long ret = syscall(__NR_io_uring_enter, aio->uring.ring_fd, to_submit, min_complete, flags, NULL, 0);
+        if (ret >= 0) {
+            return (int)ret;
+        }
+        if (errno != EINTR) {
+            return -errno;
+        }
+    }
+}
+
+static int _uring_reap(AsyncIo* aio);
+
+/**
+ * @brief Appends one entry to the submission ring and hands it to the kernel.
+ *
+ * Without SQPOLL the kernel only reads the ring inside io_uring_enter(), so an
+ * entry it did not take can be withdrawn by moving the tail back. If the
+ * kernel is busy (a full completion ring, or short of memory), completions
+ * are reaped to make room and the submission is retried.
+ *
+ * @return 0 once the kernel owns the entry, or a negative errno if it never will.
+ */
+static int _uring_push(AsyncIo* aio, const struct io_uring_sqe* entry) {
+    Uring* ring = &aio->uring;
+
+    // Only the owning thread submits, so the tail needs no atomic read-modify-write.
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    ring->sqes[index] = *entry;
+    ring->sq_array[index] = index;
+    atomic_store_explicit((_Atomic unsigned*)ring->sq_tail, tail + 1, memory_order_release);
+
+    for (;;) {
+        unsigned head = atomic_load_explicit((_Atomic unsigned*)ring->sq_head, memory_order_acquire);
+        unsigned queued = *ring->sq_tail - head;
+        if (queued == 0) {
+            return 0;
+        }
+        int ret = _uring_enter(aio, queued, 0, 0);
+        if (ret > 0) {
+            ring->in_flight += (unsigned)ret;
+            continue;
+        }
+        if (ret == 0) {
+            ret = -EAGAIN;
+        }
+        if ((ret == -EBUSY || ret == -EAGAIN) && ring->in_flight > 0) {
+            // Reaping may resubmit a short transfer, which also submits this entry.
+            int reap_ret = _uring_reap(aio);
+            if (reap_ret == 0) {
+                continue;
+            }
+            ret = reap_ret;
+        }
+        // Entries pushed while reaping are resolved by now, so this one is last in the ring.
+        atomic_store_explicit((_Atomic unsigned*)ring->sq_tail, *ring->sq_tail - 1, memory_order_release);
+        return ret;
+    }
+}
+
+/**
+ * @brief Queues the untransferred part of a request and submits it to the kernel.
+ */
+static void _uring_submit(AsyncIo* aio, AsyncIoRequest* request) {
+    request->iov.iov_base = request->buffer + request->done;
+    request->iov.iov_len = request->length - request->done;
+
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = (request->op == ASYNC_IO_READ) ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe.fd = aio->fd;
+    sqe.addr = (unsigned long long)(uintptr_t)&request->iov;
+    sqe.len = 1;
+    sqe.off = request->offset + request->done;
+    sqe.user_data = (unsigned long long)(uintptr_t)request;
+
+    int ret = _uring_push(aio, &sqe);
+    if (ret < 0) {
+        // The kernel never took the entry, so the buffer is the caller's again.
+        request->error = -ret;
+        request->state = REQUEST_DONE;
+    }
+}
+
+/**
+ * @brief Asks the kernel to cancel a request. Its completion is still reaped as usual.
+ * @return 0, or a negative errno if the cancellation could not be submitted.
+ */
+static int _uring_cancel(AsyncIo* aio, const AsyncIoRequest* request) {
+    struct io_uring_sqe sqe;
+    memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    sqe.fd = -1;
+    sqe.addr = (unsigned long long)(uintptr_t)request;
+    sqe.user_data = 0; // Not a request; its own completion is ignored.
+    return _uring_push(aio, &sqe);
+}
+
+/**
+ * @brief Reaps completions, waiting for at least one if none are ready.
+ * @return 0, or a negative errno if the ring itself failed.
+ */
+static int _uring_reap(AsyncIo* aio) {
+    Uring* ring = &aio->uring;
+    unsigned head = *ring->cq_head;
+    unsigned tail = atomic_load_explicit((_Atomic unsigned*)ring->cq_tail, memory_order_acquire);
+    if (head == tail) {
+        int ret = _uring_enter(aio, 0, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            return ret;
+        }
+        tail = atomic_load_explicit((_Atomic unsigned*)ring->cq_tail, memory_order_acquire);
+    }
+
+    while (head != tail) {
+        const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+        AsyncIoRequest* request = (AsyncIoRequest*)(uintptr_t)cqe->user_data;
+        long long result = cqe->res;
+        head++;
+        atomic_store_explicit((_Atomic unsigned*)ring->cq_head, head, memory_order_release);
+        ring->in_flight--;
+
+        if (!request) {
+            continue; // A cancellation.
+        }
+        if (_request_account(aio, request, result)) {
+            request->state = REQUEST_DONE;
+        } else {
+            _uring_submit(aio, request); // Short transfer: queue the remainder.
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Waits for a request on the io_uring backend.
+ *
+ * The kernel owns the buffer of a running request, so a reap error does not
+ * release it: the request is cancelled and reaping continues until the
+ * kernel completes it. Only if the ring can no longer deliver completions at
+ * all is the request given up, left running with the error recorded.
+ */
+static void _uring_wait(AsyncIo* aio, AsyncIoRequest* request) {
+    int first_error = 0;
+    while (request->state != REQUEST_DONE) {
+        int ret = _uring_reap(aio);
+        if (ret == 0 || ret == -EBUSY || ret == -EAGAIN) {
+            continue;
+        }
+        if (first_error == 0) {
+            first_error = -ret;
+            log_warn("io_uring: reaping failed (%s); cancelling the outstanding request.", strerror(first_error));
+            if (_uring_cancel(aio, request) == 0) {
+                continue;
+            }
+        }
+        log_error("io_uring: the ring failed (%s); a request buffer may still be in use by the kernel.", strerror(-ret));
+        request->error = first_error;
+        return;
+    }
+    if (first_error != 0) {
+        request->error = first_error; // Report the failure, not the cancellation.
+    }
+    request->state = REQUEST_IDLE;
+}
+
+#endif // ASYNC_IO_HAVE_IO_URING
+
+// --- Public Function Implementations ---
+
+AsyncIo* async_io_create(int fd, unsigned int depth, bool direct_io) {
+    if (fd < 0 || depth == 0) {
+        return NULL;
+    }
+    AsyncIo* aio = (AsyncIo*)calloc(1, sizeof(AsyncIo));
+    if (!aio) {
+        return NULL;
+    }
+    aio->fd = fd;
+    aio->direct_io = direct_io;
+
+#ifdef ASYNC_IO_HAVE_IO_URING
+    aio->use_uring = _uring_setup(aio, depth);
+#endif
+    if (!aio->use_uring && !_threads_start(aio, depth)) {
+        free(aio);
+        return NULL;
+    }
+    return aio;
+}
+
+void async_io_submit(AsyncIo* aio, AsyncIoRequest* request) {
+    request->done = 0;
+    request->error = 0;
+    request->next_pending = NULL;
+
+#ifdef ASYNC_IO_HAVE_IO_URING
+    if (aio->use_uring) {
+        request->state = REQUEST_RUNNING;
+        _uring_submit(aio, request);
+        return;
+    }
+#endif
+    pthread_mutex_lock(&aio->lock);
+    request->state = REQUEST_PENDING;
+    if (aio->pending_tail) {
+        aio->pending_tail->next_pending = request;
+    } else {
+        aio->pending_head = request;
+    }
+    aio->pending_tail = request;
+    pthread_cond_signal(&aio->work_available);
+    pthread_mutex_unlock(&aio->lock);
+}
+
+void async_io_wait(AsyncIo* aio, AsyncIoRequest* request) {
+#ifdef ASYNC_IO_HAVE_IO_URING
+    if (aio->use_uring) {
+        _uring_wait(aio, request);
+        return;
+    }
+#endif
+    pthread_mutex_lock(&aio->lock);
+    while (request->state != REQUEST_DONE) {
+        pthread_cond_wait(&aio->work_done, &aio->lock);
+    }
+    request->state = REQUEST_IDLE;
+    pthread_mutex_unlock(&aio->lock);
+}
+
+const char* async_io_backend_name(const AsyncIo* aio) {
+    return aio->use_uring ? "io_uring" : "thread pool";
+}
+
+void async_io_destroy(AsyncIo* aio) {
+    if (!aio) {
+        return;
+    }
+#ifdef ASYNC_IO_HAVE_IO_URING
+    if (aio->use_uring) {
+        _uring_teardown(aio);
+    }
+#endif
+    if (aio->num_workers > 0) {
+        _threads_stop(aio);
+    }
+    free(aio);
+}
+
+#endif // _WIN32
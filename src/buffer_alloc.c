@@ -0,0 +1,227 @@
+/**
+ * @file buffer_alloc.c
+ * @brief Implements the huge-page / locked / aligned allocator for pipeline buffers.
+ */
+
+#include "buffer_alloc.h"
+#include "constants.h"
+#include "log.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// --- Private Definitions ---
+
+typedef enum {
+    BUFFER_KIND_HEAP,
+    BUFFER_KIND_MMAP
+} BufferKind;
+
+/**
+ * @struct BufferHeader
+ * @brief Bookkeeping stored in the BUFFER_ALLOC_ALIGNMENT bytes just before
+ *        every pointer handed out, so buffer_free() knows how to release it.
+ */
+typedef struct {
+    void*      base;    ///< Start of the underlying allocation or mapping.
+    size_t     length;  ///< Length of the underlying allocation or mapping.
+    BufferKind kind;
+    bool       locked;
+} BufferHeader;
+
+// --- Private Data ---
+static bool s_use_huge_pages = false;
+static bool s_lock_memory = false;
+static bool s_lock_warning_issued = false;
+static int  s_hugetlb_buffers = 0;
+static int  s_thp_buffers = 0;
+static int  s_heap_buffers = 0;
+static int  s_locked_buffers = 0;
+static int  s_lock_failures = 0;
+static char s_description[96];
+
+// --- Private Helper Functions ---
+
+static size_t _round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static void* _finish_allocation(void* base, size_t length, BufferKind kind) {
+    BufferHeader* header = (BufferHeader*)base;
+    header->base = base;
+    header->length = length;
+    header->kind = kind;
+    header->locked = false;
+
+#ifndef _WIN32
+    if (s_lock_memory) {
+        if (mlock(base, length) == 0) {
+            header->locked = true;
+            s_locked_buffers++;
+        } else {
+            s_lock_failures++;
+            if (!s_lock_warning_issued) {
+                log_warn("Could not lock %zu bytes into RAM (%s). Check 'ulimit -l' or grant CAP_IPC_LOCK.", length, strerror(errno));
+                s_lock_warning_issued = true;
+            }
+        }
+    }
+#endif
+
+    return (char*)base + BUFFER_ALLOC_ALIGNMENT;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Maps a buffer backed by huge pages.
+ *
+ * Tries explicitly reserved hugetlbfs pages first. If none are available, it
+ * maps a region aligned to the huge page size and advises the kernel to back
+ * it with transparent huge pages instead.
+ */
+static void* _alloc_huge(size_t total) {
+    size_t length = _round_up(total, BUFFER_ALLOC_HUGE_PAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+    void* base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+        s_hugetlb_buffers++;
+        return _finish_allocation(base, length, BUFFER_KIND_MMAP);
+    }
+    log_debug("MAP_HUGETLB mapping of %zu bytes failed (%s). Falling back to transparent huge pages.", length, strerror(errno));
+#endif
+
+    // Over-map by one huge page so the region can be trimmed to a 2 MB boundary.
+    size_t padded_length = length + BUFFER_ALLOC_HUGE_PAGE_SIZE;
+    char* raw = (char*)mmap(NULL, padded_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == (char*)MAP_FAILED) {
+        log_error("Failed to map %zu bytes for a pipeline buffer: %s", padded_length, strerror(errno));
+        return NULL;
+    }
+
+    char* aligned = (char*)_round_up((size_t)(uintptr_t)raw, BUFFER_ALLOC_HUGE_PAGE_SIZE);
+    size_t head = (size_t)(aligned - raw);
+    size_t tail = padded_length - head - length;
+    if (head > 0) munmap(raw, head);
+    if (tail > 0) munmap(aligned + length, tail);
+
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, length, MADV_HUGEPAGE) != 0) {
+        log_debug("madvise(MADV_HUGEPAGE) failed: %s", strerror(errno));
+    }
+#endif
+    s_thp_buffers++;
+    return _finish_allocation(aligned, length, BUFFER_KIND_MMAP);
+}
+#endif
+
+static void* _alloc_heap(size_t total) {
+    void* base = NULL;
+#ifdef _WIN32
+    base = _aligned_malloc(total, BUFFER_ALLOC_ALIGNMENT);
+#else
+    if (posix_memalign(&base, BUFFER_ALLOC_ALIGNMENT, total) != 0) {
+        base = NULL;
+    }
+#endif
+    if (!base) {
+        return NULL;
+    }
+    s_heap_buffers++;
+    return _finish_allocation(base, total, BUFFER_KIND_HEAP);
+}
+
+// --- Public Function Implementations ---
+
+void buffer_alloc_configure(bool use_huge_pages, bool lock_memory) {
+#ifdef _WIN32
+    if (use_huge_pages || lock_memory) {
+        log_warn("Huge pages and memory locking are not supported on Windows. Using the default allocator.");
+    }
+    use_huge_pages = false;
+    lock_memory = false;
+#endif
+    s_use_huge_pages = use_huge_pages;
+    s_lock_memory = lock_memory;
+
+    // The description reflects only the buffers allocated under this configuration.
+    s_hugetlb_buffers = 0;
+    s_thp_buffers = 0;
+    s_heap_buffers = 0;
+    s_locked_buffers = 0;
+    s_lock_failures = 0;
+}
+
+void* buffer_alloc(size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+
+    // Reserve one alignment unit in front of the buffer for the header.
+    size_t total = size + BUFFER_ALLOC_ALIGNMENT;
+    void* ptr = NULL;
+
+#ifndef _WIN32
+    if (s_use_huge_pages) {
+        ptr = _alloc_huge(total);
+    }
+#endif
+    if (!ptr) {
+        ptr = _alloc_heap(total);
+    }
+    return ptr;
+}
+
+void buffer_free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    BufferHeader* header = (BufferHeader*)((char*)ptr - BUFFER_ALLOC_ALIGNMENT);
+    void* base = header->base;
+    size_t length = header->length;
+
+#ifdef _WIN32
+    (void)length;
+    _aligned_free(base);
+#else
+    if (header->locked) {
+        munlock(base, length);
+    }
+    if (header->kind == BUFFER_KIND_MMAP) {
+        munmap(base, length);
+    } else {
+        free(base);
+    }
+#endif
+}
+
+const char* buffer_alloc_describe(void) {
+    const char* backend;
+    if (s_hugetlb_buffers > 0 && s_thp_buffers == 0 && s_heap_buffers == 0) {
+        backend = "Huge Pages (hugetlbfs)";
+    } else if (s_thp_buffers > 0 && s_hugetlb_buffers == 0 && s_heap_buffers == 0) {
+        backend = "Huge Pages (transparent)";
+    } else if (s_hugetlb_buffers > 0 || s_thp_buffers > 0) {
+        backend = "Huge Pages (mixed)";
+    } else {
+        backend = "Heap (64-byte aligned)";
+    }
+
+    const char* lock_state = "";
+    if (s_lock_memory) {
+        lock_state = (s_lock_failures == 0 && s_locked_buffers > 0) ? ", Locked" : ", Lock Failed";
+    }
+
+    snprintf(s_description, sizeof(s_description), "%s%s", backend, lock_state);
+    return s_description;
+}
@@ -25,7 +25,8 @@ static int g_original_argc = 0;
 static const char** g_original_argv = NULL;
 
 // MODIFIED: Moved these definitions to file scope to be accessible by all functions.
-#define MAX_STATIC_OPTIONS 128
+// Core and module options. Exceeding it is a fatal internal error, not a silent truncation.
+#define MAX_STATIC_OPTIONS 256
 #define MAX_TOTAL_OPTIONS (MAX_STATIC_OPTIONS + MAX_PRESETS)
 
 // --- Forward Declarations ---
@@ -55,7 +56,9 @@ void print_usage(const char *prog_name, AppConfig *config, MemoryArena* arena) {
 
     // Build the full options list to generate complete help text.
     // Pass NULL for active_input_type to ensure all module options are included in the help text.
-    build_cli_options(all_options, MAX_TOTAL_OPTIONS, config, arena, NULL);
+    if (build_cli_options(all_options, MAX_TOTAL_OPTIONS, config, arena, NULL) < 0) {
+        return;
+    }
 
     argparse_init(&argparse, all_options, usages, 0);
     argparse_describe(&argparse, "\nResamples an I/Q file or a stream from an SDR device to a specified format and sample rate.", NULL);
@@ -67,9 +70,9 @@ static int version_cb(struct argparse *self, const struct argparse_option *optio
     (void)option;
 
 #ifdef GIT_HASH
-    fprintf(stdout, "%s version %s\n", APP_NAME, GIT_HASH);
+    fprintf(stdout, "%s version %s%s\n", APP_NAME, GIT_HASH, DSP_REFERENCE_KERNELS ? " (reference kernels)" : "");
 #else
-    fprintf(stdout, "%s version unknown\n", APP_NAME);
+    fprintf(stdout, "%s version unknown%s\n", APP_NAME, DSP_REFERENCE_KERNELS ? " (reference kernels)" : "");
 #endif
 
     exit(EXIT_SUCCESS);
@@ -83,10 +86,13 @@ static int build_cli_options(struct argparse_option* options_buffer, int max_opt
 
     struct argparse_option generic_options[] = {
         OPT_GROUP("Required Input & Output"),
-        OPT_STRING('i', "input", &config->input_type_str, "Specifies the input type {wav|raw-file|rtlsdr|sdrplay|hackrf|bladerf|spyserver-client}", NULL, 0, 0),
-        OPT_STRING('o', "output", &config->output_module_str, "Specifies the output type {wav|raw|stdout} and optional file path", NULL, 0, 0),
+        OPT_STRING('i', "input", &config->input_type_str, "Specifies the input type {wav|raw-file|rtlsdr|sdrplay|hackrf|bladerf|spyserver-client|generator|sim-sdr|stdin}", NULL, 0, 0),
+        OPT_STRING('o', "output", &config->output_module_str, "Specifies the output type {wav|raw|stdout|null} and optional file path", NULL, 0, 0),
         OPT_GROUP("Output Options"),
         OPT_STRING(0, "output-sample-format", &config->output_sample_format_name, "Sample format for output data {cs8|cu8|cs16|...}", NULL, 0, 0),
+        OPT_GROUP("Input Range Options (wav and raw-file inputs)"),
+        OPT_STRING(0, "start", &config->start_str_arg, "Start at a sample (e.g., 48000), a time offset (e.g., 1.5s), or a UTC time from the WAV metadata (e.g., 2024-05-01T13:45:10Z)", NULL, 0, 0),
+        OPT_STRING(0, "duration", &config->duration_str_arg, "Process only this many samples (e.g., 96000) or seconds (e.g., 10s)", NULL, 0, 0),
         OPT_GROUP("Processing Options"),
         OPT_FLOAT(0, "output-rate", &config->user_defined_target_rate_arg, "Output sample rate in Hz. (Required if no preset or --no-resample is used)", NULL, 0, 0),
         OPT_FLOAT(0, "gain-multiplier", &config->gain, "Apply a linear gain multiplier to input samples", NULL, 0, 0),
@@ -142,6 +148,37 @@ static int build_cli_options(struct argparse_option* options_buffer, int max_opt
         OPT_BOOLEAN(0, "sdr-bias-t", &config->sdr.bias_t_enable, "(Optional) Enable Bias-T power.", NULL, 0, 0),
     };
 
+    struct argparse_option memory_options[] = {
+        OPT_GROUP("Memory & Pipeline Sizing Options (Advanced)"),
+        OPT_STRING(0, "memory-budget", &config->memory_budget_str_arg, "Cap total pipeline memory (e.g., 256M, 1G). Buffers are scaled down to fit.", NULL, 0, 0),
+        OPT_INTEGER(0, "pipeline-chunks", &config->pipeline_chunks_arg, "Number of sample chunks in flight. (Default: 512)", NULL, 0, 0),
+        OPT_INTEGER(0, "chunk-samples", &config->chunk_samples_arg, "Samples read per chunk. (Default: 16384)", NULL, 0, 0),
+        OPT_STRING(0, "sdr-buffer-size", &config->sdr_buffer_size_str_arg, "Size of the SDR capture ring buffer. (Default: 256M)", NULL, 0, 0),
+        OPT_STRING(0, "writer-buffer-size", &config->writer_buffer_size_str_arg, "Size of the file writer ring buffer. (Default: 1G)", NULL, 0, 0),
+        OPT_STRING(0, "arena-size", &config->arena_size_str_arg, "Initial size of the setup memory arena; it grows as needed, within any --memory-budget. (Default: 16M)", NULL, 0, 0),
+        OPT_BOOLEAN(0, "huge-pages", &config->use_huge_pages, "Back the chunk pool and ring buffers with 2 MB huge pages.", NULL, 0, 0),
+        OPT_BOOLEAN(0, "lock-memory", &config->lock_memory, "Lock pipeline buffers into RAM (mlock) so capture never page-faults.", NULL, 0, 0),
+    };
+
+    struct argparse_option io_options[] = {
+        OPT_GROUP("I/O Options (Advanced)"),
+        OPT_BOOLEAN(0, "mmap-input", &config->mmap_input, "Memory-map WAV and raw file inputs instead of copying them into each chunk.", NULL, 0, 0),
+        OPT_INTEGER(0, "read-ahead", &config->read_ahead_depth, "Keep N reads in flight for WAV and raw file inputs (io_uring, or pread workers).", NULL, 0, 0),
+        OPT_INTEGER(0, "write-behind", &config->write_behind_depth, "Keep N writes in flight for raw and WAV file outputs, preallocating the file when its size is known.", NULL, 0, 0),
+        OPT_BOOLEAN(0, "direct-io", &config->direct_io, "Use O_DIRECT for --read-ahead inputs and --write-behind outputs, bypassing the page cache.", NULL, 0, 0),
+        OPT_STRING(0, "stdout-pipe-size", &config->stdout_pipe_size_str_arg, "Grow a stdout pipe to this size (Linux, capped by fs.pipe-max-size). (Default: 1M)", NULL, 0, 0),
+        OPT_BOOLEAN(0, "stdout-zero-copy", &config->stdout_zero_copy, "Gift output pages to a stdout pipe with vmsplice() instead of copying (Linux; the consumer must read() them).", NULL, 0, 0),
+        OPT_INTEGER(0, "segments", &config->segments, "Split a wav or raw-file input into N segments processed by parallel jobs into one output file.", NULL, 0, 0),
+        OPT_STRING(0, "segment-job", &config->segment_job_str_arg, NULL, NULL, 0, 0),
+    };
+
+    struct argparse_option diagnostic_options[] = {
+        OPT_GROUP("Diagnostics Options"),
+        OPT_STRING(0, "stats-json", &config->stats_json_path, "Write per-stage pipeline statistics to a JSON Lines file.", NULL, 0, 0),
+        OPT_STRING(0, "trace", &config->trace_path, "Write a Chrome/Perfetto trace of per-chunk pipeline activity to a JSON file.", NULL, 0, 0),
+        OPT_BOOLEAN(0, "perf-counters", &config->perf_counters, "Report per-thread IPC and cycles/sample from hardware counters (Linux).", NULL, 0, 0),
+    };
+
     struct argparse_option final_options[] = {
         OPT_GROUP("Help & Version"),
         OPT_BOOLEAN('v', "version", NULL, "show program's version number and exit", version_cb, 0, OPT_NONEG),
@@ -165,14 +202,19 @@ static int build_cli_options(struct argparse_option* options_buffer, int max_opt
     APPEND_OPTIONS_MEMCPY(&options_buffer[total_opts], agc_options, sizeof(agc_options) / sizeof(agc_options[0]));
     APPEND_OPTIONS_MEMCPY(&options_buffer[total_opts], filter_options, sizeof(filter_options) / sizeof(filter_options[0]));
     APPEND_OPTIONS_MEMCPY(&options_buffer[total_opts], sdr_general_options, sizeof(sdr_general_options) / sizeof(sdr_general_options[0]));
+    APPEND_OPTIONS_MEMCPY(&options_buffer[total_opts], memory_options, sizeof(memory_options) / sizeof(memory_options[0]));
+    APPEND_OPTIONS_MEMCPY(&options_buffer[total_opts], io_options, sizeof(io_options) / sizeof(io_options[0]));
+    APPEND_OPTIONS_MEMCPY(&options_buffer[total_opts], diagnostic_options, sizeof(diagnostic_options) / sizeof(diagnostic_options[0]));
 
-    module_manager_populate_cli_options(
+    if (!module_manager_populate_cli_options(
         options_buffer,
         &total_opts,
         max_options,
         active_input_type,
         arena
-    );
+    )) {
+        return -1;
+    }
 
     if (config->num_presets > 0) {
         struct argparse_option preset_header[] = { OPT_GROUP("Available Presets") };
@@ -318,6 +360,10 @@ static bool validate_and_process_args(AppConfig *config, int non_opt_argc, const
     if (!validate_filter_options(config)) return false;
     if (!validate_iq_correction_options(config)) return false;
     if (!validate_option_combinations(config)) return false;
+    if (!validate_input_range_options(config)) return false;
+    if (!validate_memory_options(config)) return false;
+    if (!validate_io_options(config)) return false;
+    if (!validate_segment_options(config)) return false;
 
     return true;
 }
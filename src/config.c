@@ -9,6 +9,7 @@
 #include <math.h>
 #include <ctype.h>
 #include <limits.h>
+#include <time.h>
 
 #ifdef _WIN32
 #define strcasecmp _stricmp
@@ -154,7 +155,8 @@ bool validate_output_type_and_sample_format(AppConfig *config) {
         // For file output, default to WAV_RF64 but make it explicit to the user.
         config->output_type = OUTPUT_TYPE_WAV_RF64;
         log_info("Defaulting to 'wav-rf64' container for large file support.");
-    } else if (strcasecmp(config->output_module_str, "stdout") == 0) {
+    } else if (strcasecmp(config->output_module_str, "stdout") == 0 ||
+               strcasecmp(config->output_module_str, "null") == 0) {
         config->output_type = OUTPUT_TYPE_RAW;
     }
 
@@ -165,6 +167,9 @@ bool validate_output_type_and_sample_format(AppConfig *config) {
         if (config->output_filename_arg) {
             config->output_sample_format_name = "cs16";
             log_info("No output sample format specified; defaulting to 'cs16' for file output.");
+        } else if (strcasecmp(config->output_module_str, "null") == 0) {
+            // Nothing consumes the data, so any format will do.
+            config->output_sample_format_name = "cs16";
         } else {
             // For stdout, the format MUST be specified as we cannot guess the consumer's needs.
             log_fatal("Missing required argument: you must specify an --output-sample-format when using '--output stdout'.");
@@ -180,8 +185,9 @@ bool validate_output_type_and_sample_format(AppConfig *config) {
     }
 
     if (config->output_type == OUTPUT_TYPE_WAV || config->output_type == OUTPUT_TYPE_WAV_RF64) {
-        if (config->output_format != CS16 && config->output_format != CU8) {
-            log_fatal("Invalid sample format '%s' for WAV container. Only 'cs16' and 'cu8' are supported for WAV output.", config->output_sample_format_name);
+        if (config->output_format != CU8 && config->output_format != CS8 && config->output_format != CS16 &&
+            config->output_format != CS24 && config->output_format != CF32) {
+            log_fatal("Invalid sample format '%s' for WAV container. Supported formats: cu8, cs8, cs16, cs24, cf32.", config->output_sample_format_name);
             return false;
         }
     }
@@ -253,6 +259,118 @@ bool validate_iq_correction_options(AppConfig *config) {
     return true;
 }
 
+/**
+ * @brief Parses an absolute UTC time such as "2024-05-01T13:45:10.5Z" into Unix seconds.
+ * @return true on success, false if the string is not a date and time.
+ */
+static bool parse_utc_time(const char* value_str, double* out_unix_seconds) {
+    int year, month, day, hour, minute, second;
+    char separator;
+    int consumed = 0;
+    if (sscanf(value_str, "%4d-%2d-%2d%c%2d:%2d:%2d%n", &year, &month, &day, &separator, &hour, &minute, &second, &consumed) != 7 ||
+        (separator != 'T' && separator != 't' && separator != ' ')) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60 ||
+        hour < 0 || minute < 0 || second < 0) {
+        return false;
+    }
+
+    const char* rest = value_str + consumed;
+    double fraction = 0.0;
+    if (*rest == '.') {
+        char* endptr;
+        fraction = strtod(rest, &endptr);
+        if (endptr == rest + 1) {
+            return false;
+        }
+        rest = endptr;
+    }
+    if (*rest == 'Z' || *rest == 'z') {
+        rest++;
+    } else if (strcasecmp(rest, " UTC") == 0) {
+        rest += 4;
+    }
+    if (*rest != '\0') {
+        return false;
+    }
+
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    t.tm_year = year - 1900;
+    t.tm_mon = month - 1;
+    t.tm_mday = day;
+    t.tm_hour = hour;
+    t.tm_min = minute;
+    t.tm_sec = second;
+    time_t seconds = utils_timegm(&t);
+    if (seconds == (time_t)-1) {
+        return false;
+    }
+    *out_unix_seconds = (double)seconds + fraction;
+    return true;
+}
+
+/**
+ * @brief Parses a --start or --duration value: a sample count ("48000"), seconds
+ *        ("1.5s"), or, where allowed, an absolute UTC time ("2024-05-01T13:45:10Z").
+ * @return true on success (or if the option was not given), false on a parse error.
+ */
+static bool parse_range_value(const char* value_str, const char* arg_name, bool allow_utc, RangeValue* out_value) {
+    memset(out_value, 0, sizeof(*out_value));
+    if (!value_str) {
+        return true;
+    }
+
+    if (allow_utc && parse_utc_time(value_str, &out_value->seconds)) {
+        out_value->unit = RANGE_VALUE_UTC;
+        return true;
+    }
+
+    char* endptr;
+    if (isdigit((unsigned char)value_str[0])) {
+        errno = 0;
+        unsigned long long samples = strtoull(value_str, &endptr, 10);
+        if (errno == 0 && *endptr == '\0') {
+            out_value->unit = RANGE_VALUE_SAMPLES;
+            out_value->samples = samples;
+            return true;
+        }
+
+        double seconds = strtod(value_str, &endptr);
+        if ((*endptr == 's' || *endptr == 'S') && endptr[1] == '\0' && isfinite(seconds)) {
+            out_value->unit = RANGE_VALUE_SECONDS;
+            out_value->seconds = seconds;
+            return true;
+        }
+    }
+
+    log_fatal("Invalid value for %s: '%s'. Expected a sample count (e.g., 48000), seconds (e.g., 1.5s)%s.",
+              arg_name, value_str, allow_utc ? ", or a UTC time (e.g., 2024-05-01T13:45:10Z)" : "");
+    return false;
+}
+
+bool validate_input_range_options(AppConfig *config) {
+    if (!config->start_str_arg && !config->duration_str_arg) {
+        return true;
+    }
+
+    if (strcasecmp(config->input_type_str, "wav") != 0 && strcasecmp(config->input_type_str, "raw-file") != 0) {
+        log_fatal("Options --start and --duration apply to 'wav' and 'raw-file' inputs only.");
+        return false;
+    }
+
+    if (!parse_range_value(config->start_str_arg, "--start", true, &config->range_start)) return false;
+    if (!parse_range_value(config->duration_str_arg, "--duration", false, &config->range_duration)) return false;
+
+    if ((config->range_duration.unit == RANGE_VALUE_SAMPLES && config->range_duration.samples == 0) ||
+        (config->range_duration.unit == RANGE_VALUE_SECONDS && config->range_duration.seconds <= 0.0)) {
+        log_fatal("--duration must be greater than zero.");
+        return false;
+    }
+    return true;
+}
+
 bool validate_option_combinations(AppConfig *config) {
     // --- Validate Filter Implementation Options ---
     if (config->filter_type_str_arg) {
@@ -397,3 +515,171 @@ bool validate_option_combinations(AppConfig *config) {
 
     return true;
 }
+
+/**
+ * @brief Parses a size option such as "--writer-buffer-size 64M" into bytes.
+ * @return true on success (or if the option was not given), false on a parse or range error.
+ */
+static bool parse_size_option(const char* value_str, const char* arg_name, unsigned long long min_bytes, unsigned long long* out_bytes) {
+    *out_bytes = 0;
+    if (!value_str) {
+        return true;
+    }
+    if (!utils_parse_size_string(value_str, out_bytes) || *out_bytes == 0) {
+        log_fatal("Invalid value for %s: '%s'. Expected a size such as '64M' or '1G'.", arg_name, value_str);
+        return false;
+    }
+    if (*out_bytes < min_bytes) {
+        char min_buf[40];
+        log_fatal("Value for %s is too small. The minimum is %s.", arg_name, format_file_size((long long)min_bytes, min_buf, sizeof(min_buf)));
+        return false;
+    }
+    return true;
+}
+
+bool validate_memory_options(AppConfig *config) {
+    unsigned long long parsed;
+
+    if (!parse_size_option(config->memory_budget_str_arg, "--memory-budget", 1, &parsed)) return false;
+    config->memory_budget_bytes = parsed;
+
+    if (!parse_size_option(config->arena_size_str_arg, "--arena-size", MEM_ARENA_MIN_SIZE_BYTES, &parsed)) return false;
+    config->arena_size_bytes = (size_t)parsed;
+
+    if (!parse_size_option(config->sdr_buffer_size_str_arg, "--sdr-buffer-size", IO_MIN_RING_BUFFER_BYTES, &parsed)) return false;
+    config->sdr_buffer_size_bytes = (size_t)parsed;
+
+    if (!parse_size_option(config->writer_buffer_size_str_arg, "--writer-buffer-size", IO_MIN_RING_BUFFER_BYTES, &parsed)) return false;
+    config->writer_buffer_size_bytes = (size_t)parsed;
+
+    if (config->pipeline_chunks_arg != 0 && config->pipeline_chunks_arg < PIPELINE_MIN_NUM_CHUNKS) {
+        log_fatal("--pipeline-chunks must be at least %d.", PIPELINE_MIN_NUM_CHUNKS);
+        return false;
+    }
+
+    if (config->chunk_samples_arg != 0) {
+        if (config->chunk_samples_arg < PIPELINE_MIN_CHUNK_SAMPLES || config->chunk_samples_arg > MAX_ALLOWED_FFT_BLOCK_SIZE) {
+            log_fatal("--chunk-samples must be between %d and %d.", PIPELINE_MIN_CHUNK_SAMPLES, MAX_ALLOWED_FFT_BLOCK_SIZE);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool validate_io_options(AppConfig *config) {
+    unsigned long long parsed;
+
+    if (config->read_ahead_depth < 0 || config->read_ahead_depth > FILE_READAHEAD_MAX_DEPTH) {
+        log_fatal("--read-ahead must be between 1 and %d.", FILE_READAHEAD_MAX_DEPTH);
+        return false;
+    }
+    if (config->read_ahead_depth > 0 && config->mmap_input) {
+        log_fatal("--read-ahead and --mmap-input cannot be used together.");
+        return false;
+    }
+    if (config->write_behind_depth < 0 || config->write_behind_depth > FILE_WRITER_MAX_DEPTH) {
+        log_fatal("--write-behind must be between 1 and %d.", FILE_WRITER_MAX_DEPTH);
+        return false;
+    }
+    if (config->write_behind_depth > 0 && (strcasecmp(config->output_module_str, "stdout") == 0 ||
+                                           strcasecmp(config->output_module_str, "null") == 0)) {
+        log_warn("--write-behind applies to file outputs only. Ignoring it.");
+        config->write_behind_depth = 0;
+    }
+    if (config->direct_io && config->read_ahead_depth == 0 && config->write_behind_depth == 0) {
+        log_fatal("--direct-io requires --read-ahead or --write-behind.");
+        return false;
+    }
+
+    if (!parse_size_option(config->stdout_pipe_size_str_arg, "--stdout-pipe-size", IO_STDOUT_MIN_PIPE_SIZE_BYTES, &parsed)) return false;
+    config->stdout_pipe_size_bytes = (parsed > 0) ? (size_t)parsed : IO_STDOUT_PIPE_SIZE_BYTES;
+    if (config->stdout_pipe_size_bytes > INT_MAX) {
+        log_fatal("--stdout-pipe-size is too large.");
+        return false;
+    }
+    if (config->stdout_zero_copy && strcasecmp(config->output_module_str, "stdout") != 0) {
+        log_warn("--stdout-zero-copy applies to stdout output only. Ignoring it.");
+        config->stdout_zero_copy = 0;
+    }
+#ifdef _WIN32
+    if (config->read_ahead_depth > 0) {
+        log_warn("--read-ahead is not supported on Windows. Using libsndfile reads.");
+        config->read_ahead_depth = 0;
+    }
+    if (config->write_behind_depth > 0) {
+        log_warn("--write-behind is not supported on Windows. Using buffered writes.");
+        config->write_behind_depth = 0;
+    }
+    config->direct_io = 0;
+    if (config->stdout_zero_copy) {
+        log_warn("--stdout-zero-copy is not supported on Windows. Using copying writes.");
+        config->stdout_zero_copy = 0;
+    }
+#endif
+
+    return true;
+}
+
+bool validate_segment_options(AppConfig *config) {
+    if (config->segment_job_str_arg) {
+        SegmentJob* job = &config->segment_job;
+        int consumed = 0;
+        if (sscanf(config->segment_job_str_arg, "%u:%llu:%llu:%llu:%llu:%llu:%d%n", &job->index, &job->input_origin,
+                   &job->output_origin, &job->skip_frames, &job->write_frames, &job->write_offset, &job->report_fd, &consumed) != 7 ||
+            config->segment_job_str_arg[consumed] != '\0') {
+            log_fatal("Invalid internal --segment-job value '%s'.", config->segment_job_str_arg);
+            return false;
+        }
+        job->active = true;
+        config->segments = 0;
+        // The parent owns the run; its jobs must not all write the same report files.
+        config->stats_json_path = NULL;
+        config->trace_path = NULL;
+        return true;
+    }
+
+    if (config->segments < 0 || config->segments > SEGMENT_MAX_JOBS) {
+        log_fatal("--segments must be between 1 and %d.", SEGMENT_MAX_JOBS);
+        return false;
+    }
+    if (config->segments <= 1) {
+        config->segments = 0;
+        return true;
+    }
+
+#ifdef _WIN32
+    log_warn("--segments is not supported on Windows. Processing the input in one pass.");
+    config->segments = 0;
+    return true;
+#else
+    if (strcasecmp(config->input_type_str, "wav") != 0 && strcasecmp(config->input_type_str, "raw-file") != 0) {
+        log_fatal("Option --segments applies to 'wav' and 'raw-file' inputs only.");
+        return false;
+    }
+    if (strcasecmp(config->output_module_str, "stdout") == 0 || strcasecmp(config->output_module_str, "null") == 0) {
+        log_fatal("Option --segments needs a file output. Segments are written out of order.");
+        return false;
+    }
+    if (config->raw_passthrough) {
+        log_warn("--segments does not apply to --raw-passthrough, which only copies bytes. Ignoring it.");
+        config->segments = 0;
+        return true;
+    }
+    // Each segment would adapt on its own, so the joins would not line up.
+    if (config->output_agc.enable || config->iq_correction.enable) {
+        log_fatal("Option --segments cannot be combined with --output-agc or --iq-correction, which adapt over the whole stream.");
+        return false;
+    }
+    if (config->write_behind_depth > 0) {
+        log_warn("--write-behind does not apply to --segments, whose jobs write their own parts of the file. Ignoring it.");
+        config->write_behind_depth = 0;
+    }
+    if (config->stats_json_path || config->trace_path) {
+        log_warn("--stats-json and --trace are not written for a --segments run. Ignoring them.");
+        config->stats_json_path = NULL;
+        config->trace_path = NULL;
+    }
+    return true;
+#endif
+}
@@ -0,0 +1,217 @@
+/**
+ * @file file_map.c
+ * @brief Implements the memory-mapped reader for file inputs.
+ */
+
+#include "file_map.h"
+#include "constants.h"
+#include "log.h"
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+// --- Public Function Implementations ---
+
+#ifdef _WIN32
+
+SNDFILE* file_map_sf_open(const char* path, SF_INFO* sfinfo, int* out_fd) {
+    (void)path;
+    (void)sfinfo;
+    *out_fd = -1;
+    return NULL;
+}
+
+bool file_map_locate_data(SNDFILE* infile, int fd, size_t frame_bytes, const InputRange* range,
+                          unsigned long long* out_offset, unsigned long long* out_bytes) {
+    (void)infile;
+    (void)fd;
+    (void)frame_bytes;
+    (void)range;
+    *out_offset = 0;
+    *out_bytes = 0;
+    return false;
+}
+
+bool file_map_open_sndfile(FileMap* map, SNDFILE* infile, int fd, size_t frame_bytes, const InputRange* range) {
+    (void)infile;
+    (void)fd;
+    (void)frame_bytes;
+    (void)range;
+    memset(map, 0, sizeof(*map));
+    log_warn("Memory-mapped input is not supported on Windows. Falling back to libsndfile reads.");
+    return false;
+}
+
+void file_map_close(FileMap* map) {
+    memset(map, 0, sizeof(*map));
+}
+
+#else
+
+SNDFILE* file_map_sf_open(const char* path, SF_INFO* sfinfo, int* out_fd) {
+    *out_fd = -1;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_error("Could not open '%s': %s", path, strerror(errno));
+        return NULL;
+    }
+
+    SNDFILE* infile = sf_open_fd(fd, SFM_READ, sfinfo, SF_TRUE);
+    if (!infile) {
+        close(fd);
+        return NULL;
+    }
+    *out_fd = fd;
+    return infile;
+}
+
+bool file_map_locate_data(SNDFILE* infile, int fd, size_t frame_bytes, const InputRange* range,
+                          unsigned long long* out_offset, unsigned long long* out_bytes) {
+    if (fd < 0 || frame_bytes == 0) {
+        return false;
+    }
+
+    // Seeking to frame 0 leaves the descriptor on the first sample byte.
+    if (sf_seek(infile, 0, SEEK_SET) != 0) {
+        log_warn("Cannot read the input directly: the file is not seekable. Falling back to libsndfile reads.");
+        return false;
+    }
+    off_t data_offset = lseek(fd, 0, SEEK_CUR);
+
+    SF_INFO sfinfo;
+    memset(&sfinfo, 0, sizeof(sfinfo));
+    sf_command(infile, SFC_GET_CURRENT_SF_INFO, &sfinfo, sizeof(sfinfo));
+
+    struct stat st;
+    if (data_offset < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        log_warn("Cannot read the input directly: it is not a regular file. Falling back to libsndfile reads.");
+        return false;
+    }
+    if (sfinfo.frames <= 0) {
+        return false;
+    }
+
+    unsigned long long data_bytes = (unsigned long long)sfinfo.frames * frame_bytes;
+    unsigned long long file_bytes = (unsigned long long)st.st_size;
+    if ((unsigned long long)data_offset > file_bytes || data_bytes > file_bytes - (unsigned long long)data_offset) {
+        // A header that claims more data than the file holds (e.g. an unfinished
+        // capture). Clamp to the data actually present.
+        data_bytes = ((unsigned long long)data_offset > file_bytes) ? 0
+                   : (file_bytes - (unsigned long long)data_offset) / frame_bytes * frame_bytes;
+        if (data_bytes == 0) {
+            return false;
+        }
+    }
+
+    // Confirm the offset by reading the same bytes through libsndfile and the descriptor.
+    unsigned char decoded[FILE_MAP_VERIFY_BYTES];
+    unsigned char direct[FILE_MAP_VERIFY_BYTES];
+    size_t probe_bytes = sizeof(decoded) / frame_bytes * frame_bytes;
+    if (probe_bytes > data_bytes) {
+        probe_bytes = (size_t)data_bytes;
+    }
+    sf_count_t decoded_read = sf_read_raw(infile, decoded, (sf_count_t)probe_bytes);
+    ssize_t direct_read = pread(fd, direct, probe_bytes, data_offset);
+    sf_seek(infile, 0, SEEK_SET);
+    if (decoded_read != (sf_count_t)probe_bytes || direct_read != (ssize_t)probe_bytes ||
+        memcmp(decoded, direct, probe_bytes) != 0) {
+        log_warn("Cannot read the input directly: the raw file data does not match the decoded data. Falling back to libsndfile reads.");
+        return false;
+    }
+
+    // Narrow the data to the frames selected by --start and --duration.
+    unsigned long long skip_bytes = range->first_frame * frame_bytes;
+    if (skip_bytes >= data_bytes) {
+        log_warn("Cannot read the input directly: the file ends before the selected start. Falling back to libsndfile reads.");
+        return false;
+    }
+    data_offset += (off_t)skip_bytes;
+    data_bytes -= skip_bytes;
+    if (range->num_frames < data_bytes / frame_bytes) {
+        data_bytes = range->num_frames * frame_bytes;
+    }
+
+    *out_offset = (unsigned long long)data_offset;
+    *out_bytes = data_bytes;
+    return true;
+}
+
+bool file_map_open_sndfile(FileMap* map, SNDFILE* infile, int fd, size_t frame_bytes, const InputRange* range) {
+    memset(map, 0, sizeof(*map));
+
+    unsigned long long data_offset;
+    unsigned long long data_bytes;
+    if (!file_map_locate_data(infile, fd, frame_bytes, range, &data_offset, &data_bytes)) {
+        return false;
+    }
+
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size <= 0) {
+        page_size = 4096;
+    }
+    unsigned long long map_offset = data_offset / (unsigned long long)page_size * (unsigned long long)page_size;
+    unsigned long long lead = data_offset - map_offset;
+    unsigned long long map_length = lead + data_bytes;
+    if (map_length > SIZE_MAX) {
+        log_warn("Cannot memory-map the input: %llu bytes exceed the address space. Falling back to libsndfile reads.", map_length);
+        return false;
+    }
+
+    void* base = mmap(NULL, (size_t)map_length, PROT_READ, MAP_SHARED, fd, (off_t)map_offset);
+    if (base == MAP_FAILED) {
+        log_warn("Cannot memory-map the input (%s). Falling back to libsndfile reads.", strerror(errno));
+        return false;
+    }
+#ifdef MADV_SEQUENTIAL
+    if (madvise(base, (size_t)map_length, MADV_SEQUENTIAL) != 0) {
+        log_debug("madvise(MADV_SEQUENTIAL) failed: %s", strerror(errno));
+    }
+#endif
+
+    map->map_base = base;
+    map->map_length = (size_t)map_length;
+    map->data = (const unsigned char*)base + lead;
+    map->data_bytes = data_bytes;
+    map->position = 0;
+    map->frame_bytes = frame_bytes;
+
+    log_debug("Mapped %llu bytes of sample data at file offset %llu.", data_bytes, data_offset);
+    return true;
+}
+
+void file_map_close(FileMap* map) {
+    if (map->map_base) {
+        munmap(map->map_base, map->map_length);
+    }
+    memset(map, 0, sizeof(*map));
+}
+
+#endif
+
+size_t file_map_next(FileMap* map, size_t max_bytes, const unsigned char** out_data) {
+    *out_data = NULL;
+    if (!map->data || map->frame_bytes == 0 || map->position >= map->data_bytes) {
+        return 0;
+    }
+
+    unsigned long long remaining = map->data_bytes - map->position;
+    size_t block = max_bytes / map->frame_bytes * map->frame_bytes;
+    if ((unsigned long long)block > remaining) {
+        block = (size_t)remaining;
+    }
+
+    *out_data = map->data + map->position;
+    map->position += block;
+    return block;
+}
@@ -0,0 +1,376 @@
+/**
+ * @file file_readahead.c
+ * @brief Implements the read-ahead engine for file inputs on top of async_io.
+ */
+
+#include "file_readahead.h"
+#include "async_io.h"
+#include "constants.h"
+#include "log.h"
+#include "app_context.h"
+#include "pipeline_types.h"
+#include "queue.h"
+#include "ring_buffer.h"
+#include "signal_handler.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// --- Windows: not supported, callers fall back to sf_read_raw() ---
+
+FileReadahead* file_readahead_create(const char* path, unsigned long long data_offset, unsigned long long data_bytes,
+                                     size_t frame_bytes, size_t max_read_bytes, unsigned int depth, bool direct_io) {
+    (void)path;
+    (void)data_offset;
+    (void)data_bytes;
+    (void)frame_bytes;
+    (void)max_read_bytes;
+    (void)depth;
+    (void)direct_io;
+    log_warn("Read-ahead input is not supported on Windows. Falling back to libsndfile reads.");
+    return NULL;
+}
+
+void file_readahead_run_reader(ModuleContext* ctx, FileReadahead* ra, bool passthrough) {
+    (void)ctx;
+    (void)ra;
+    (void)passthrough;
+}
+
+const char* file_readahead_describe(const FileReadahead* ra) {
+    (void)ra;
+    return "unavailable";
+}
+
+void file_readahead_destroy(FileReadahead* ra) {
+    (void)ra;
+}
+
+#else
+
+// --- Private Definitions ---
+
+/**
+ * @struct ReadSlot
+ * @brief One read in flight. Slots form a ring; the oldest read is at `head`.
+ */
+typedef struct {
+    AsyncIoRequest request;
+    SampleChunk*   chunk;
+    unsigned char* dest;    ///< Where the caller wants the sample data.
+    size_t         lead;    ///< Bytes read before the requested data (O_DIRECT alignment).
+    size_t         length;  ///< Requested sample data bytes.
+    unsigned char* bounce;  ///< Aligned bounce buffer (O_DIRECT only).
+} ReadSlot;
+
+struct FileReadahead {
+    int                fd;
+    bool               direct_io;
+    AsyncIo*           aio;
+    unsigned long long data_offset;
+    unsigned long long data_bytes;
+    unsigned long long next_position;  ///< Sample data bytes already submitted.
+    size_t             frame_bytes;
+    size_t             max_read_bytes;
+    unsigned int       depth;
+    ReadSlot*          slots;
+    unsigned int       head;
+    unsigned int       in_flight;
+    char               description[64];
+};
+
+// --- Private Helper Functions ---
+
+static unsigned long long _align_down(unsigned long long value) {
+    return value & ~((unsigned long long)ASYNC_IO_DIRECT_ALIGNMENT - 1);
+}
+
+static size_t _align_up(size_t value) {
+    return (value + ASYNC_IO_DIRECT_ALIGNMENT - 1) & ~((size_t)ASYNC_IO_DIRECT_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Starts the next read of the sample data into a chunk.
+ * @return false if there is no data left to read.
+ */
+static bool _submit_read(FileReadahead* ra, SampleChunk* chunk, unsigned char* dest, size_t capacity) {
+    unsigned long long remaining = ra->data_bytes - ra->next_position;
+    size_t length = (capacity < ra->max_read_bytes) ? capacity : ra->max_read_bytes;
+    length = length / ra->frame_bytes * ra->frame_bytes;
+    if ((unsigned long long)length > remaining) {
+        length = (size_t)remaining;
+    }
+    if (length == 0) {
+        return false;
+    }
+
+    ReadSlot* slot = &ra->slots[(ra->head + ra->in_flight) % ra->depth];
+    unsigned long long file_offset = ra->data_offset + ra->next_position;
+
+    slot->chunk = chunk;
+    slot->dest = dest;
+    slot->length = length;
+    slot->request.op = ASYNC_IO_READ;
+    if (ra->direct_io) {
+        unsigned long long aligned_offset = _align_down(file_offset);
+        slot->lead = (size_t)(file_offset - aligned_offset);
+        slot->request.offset = aligned_offset;
+        slot->request.length = _align_up(slot->lead + length);
+        slot->request.buffer = slot->bounce;
+    } else {
+        slot->lead = 0;
+        slot->request.offset = file_offset;
+        slot->request.length = length;
+        slot->request.buffer = dest;
+    }
+    ra->next_position += length;
+    ra->in_flight++;
+    async_io_submit(ra->aio, &slot->request);
+    return true;
+}
+
+/**
+ * @brief Waits for the oldest read and removes it from the ring.
+ * @param[out] out_chunk The chunk the read targeted.
+ * @return The number of sample bytes now in the chunk, or -1 on a read error.
+ */
+static long long _complete_oldest(FileReadahead* ra, SampleChunk** out_chunk) {
+    ReadSlot* slot = &ra->slots[ra->head];
+    async_io_wait(ra->aio, &slot->request);
+
+    *out_chunk = slot->chunk;
+    slot->chunk = NULL;
+    ra->head = (ra->head + 1) % ra->depth;
+    ra->in_flight--;
+
+    if (slot->request.error != 0) {
+        errno = slot->request.error;
+        return -1;
+    }
+
+    size_t valid = (slot->request.done > slot->lead) ? slot->request.done - slot->lead : 0;
+    if (valid > slot->length) {
+        valid = slot->length;
+    }
+    valid = valid / ra->frame_bytes * ra->frame_bytes;
+    if (slot->bounce && valid > 0) {
+        memcpy(slot->dest, slot->bounce + slot->lead, valid);
+    }
+    return (long long)valid;
+}
+
+static void _send_end_of_stream(AppResources* resources) {
+    SampleChunk* last = (SampleChunk*)queue_dequeue(resources->free_sample_chunk_queue);
+    if (!last) {
+        return;
+    }
+    last->is_last_chunk = true;
+    last->frames_read = 0;
+    last->packet_sample_format = resources->input_format;
+    last->stream_discontinuity_event = false;
+    last->mapped_input_data = NULL;
+    if (!queue_enqueue(resources->reader_output_queue, last)) {
+        queue_enqueue(resources->free_sample_chunk_queue, last);
+    }
+}
+
+// --- Public Function Implementations ---
+
+FileReadahead* file_readahead_create(const char* path, unsigned long long data_offset, unsigned long long data_bytes,
+                                     size_t frame_bytes, size_t max_read_bytes, unsigned int depth, bool direct_io) {
+    if (depth == 0 || frame_bytes == 0 || max_read_bytes < frame_bytes) {
+        return NULL;
+    }
+
+    FileReadahead* ra = (FileReadahead*)calloc(1, sizeof(FileReadahead));
+    if (!ra) {
+        return NULL;
+    }
+    ra->fd = -1;
+    ra->data_offset = data_offset;
+    ra->data_bytes = data_bytes;
+    ra->frame_bytes = frame_bytes;
+    ra->max_read_bytes = max_read_bytes;
+    ra->depth = depth;
+
+    int flags = O_RDONLY;
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+#ifdef O_DIRECT
+    if (direct_io) {
+        ra->fd = open(path, flags | O_DIRECT);
+        if (ra->fd >= 0) {
+            ra->direct_io = true;
+        } else {
+            log_warn("The input file system refused O_DIRECT (%s). Read-ahead will use the page cache.", strerror(errno));
+        }
+    }
+#else
+    if (direct_io) {
+        log_warn("O_DIRECT is not available on this platform. Read-ahead will use the page cache.");
+    }
+#endif
+    if (ra->fd < 0) {
+        ra->fd = open(path, flags);
+    }
+    if (ra->fd < 0) {
+        log_warn("Could not open '%s' for read-ahead (%s). Falling back to libsndfile reads.", path, strerror(errno));
+        free(ra);
+        return NULL;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (!ra->direct_io) {
+        posix_fadvise(ra->fd, (off_t)data_offset, (off_t)data_bytes, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    ra->slots = (ReadSlot*)calloc(depth, sizeof(ReadSlot));
+    if (!ra->slots) {
+        file_readahead_destroy(ra);
+        return NULL;
+    }
+    if (ra->direct_io) {
+        // An unaligned read can straddle one extra alignment unit at each end.
+        size_t bounce_bytes = _align_up(max_read_bytes) + 2 * ASYNC_IO_DIRECT_ALIGNMENT;
+        for (unsigned int i = 0; i < depth; i++) {
+            void* bounce = NULL;
+            if (posix_memalign(&bounce, ASYNC_IO_DIRECT_ALIGNMENT, bounce_bytes) != 0) {
+                log_warn("Could not allocate O_DIRECT read buffers. Falling back to libsndfile reads.");
+                file_readahead_destroy(ra);
+                return NULL;
+            }
+            ra->slots[i].bounce = (unsigned char*)bounce;
+        }
+    }
+
+    ra->aio = async_io_create(ra->fd, depth, ra->direct_io);
+    if (!ra->aio) {
+        log_warn("Could not start the read-ahead I/O backend. Falling back to libsndfile reads.");
+        file_readahead_destroy(ra);
+        return NULL;
+    }
+
+    snprintf(ra->description, sizeof(ra->description), "%s, depth %u%s",
+             async_io_backend_name(ra->aio), depth, ra->direct_io ? ", O_DIRECT" : "");
+    log_debug("Read-ahead engine: %s, %llu bytes at offset %llu.", ra->description, data_bytes, data_offset);
+    return ra;
+}
+
+void file_readahead_run_reader(ModuleContext* ctx, FileReadahead* ra, bool passthrough) {
+    AppResources* resources = ctx->resources;
+    bool pacing_required = resources->pacing_is_required;
+    const size_t writer_buffer_threshold = resources->writer_backpressure_threshold_bytes;
+    bool data_remaining = true;
+
+    while (!is_shutdown_requested() && !resources->error_occurred) {
+        if (pacing_required && (ring_buffer_get_size(resources->writer_input_buffer) > writer_buffer_threshold)) {
+            // The writer is falling behind. Reads in flight keep completing meanwhile.
+            unsigned long long pause_start = trace_is_enabled() ? get_monotonic_time_ns() : 0;
+            usleep(10000); // 10 ms
+            if (pause_start) {
+                trace_span("wait", "pacing sleep", pause_start, get_monotonic_time_ns(), 0);
+            }
+            continue;
+        }
+
+        // Keep the queue full. Only block for a free chunk when nothing is in
+        // flight; otherwise the chunks held here could be the ones downstream waits for.
+        if (data_remaining && ra->in_flight < ra->depth) {
+            SampleChunk* chunk = (SampleChunk*)((ra->in_flight == 0)
+                                 ? queue_dequeue(resources->free_sample_chunk_queue)
+                                 : queue_try_dequeue(resources->free_sample_chunk_queue));
+            if (chunk) {
+                chunk->stream_discontinuity_event = false;
+                chunk->mapped_input_data = NULL;
+                chunk->capture_time_ns = get_monotonic_time_ns();
+                unsigned char* dest = passthrough ? chunk->final_output_data : (unsigned char*)chunk->raw_input_data;
+                size_t capacity = passthrough ? chunk->final_output_capacity_bytes : chunk->raw_input_capacity_bytes;
+                if (!_submit_read(ra, chunk, dest, capacity)) {
+                    queue_enqueue(resources->free_sample_chunk_queue, chunk);
+                    data_remaining = false;
+                }
+                continue;
+            }
+            if (ra->in_flight == 0) {
+                break; // Shutdown or error signaled.
+            }
+        }
+
+        if (ra->in_flight == 0) {
+            _send_end_of_stream(resources);
+            break;
+        }
+
+        // Hand the oldest read downstream once it completes.
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_READER);
+        SampleChunk* chunk = NULL;
+        long long bytes_read = _complete_oldest(ra, &chunk);
+        if (bytes_read < 0) {
+            log_fatal("Read-ahead read error: %s", strerror(errno));
+            atomic_store(&resources->error_occurred, true);
+            request_shutdown();
+            queue_enqueue(resources->free_sample_chunk_queue, chunk);
+            break;
+        }
+        if (bytes_read == 0) {
+            // The file ended before the header said it would.
+            telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_READER, 0);
+            queue_enqueue(resources->free_sample_chunk_queue, chunk);
+            data_remaining = false;
+            continue;
+        }
+
+        chunk->frames_read = bytes_read / (long long)resources->input_bytes_per_sample_pair;
+        chunk->packet_sample_format = resources->input_format;
+        chunk->is_last_chunk = false;
+        atomic_fetch_add_explicit(&resources->total_frames_read, chunk->frames_read, memory_order_relaxed);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_READER, chunk->frames_read);
+
+        if (!queue_enqueue(resources->reader_output_queue, chunk)) {
+            queue_enqueue(resources->free_sample_chunk_queue, chunk);
+            break;
+        }
+    }
+
+    // Never return a chunk the kernel or a worker may still be writing into.
+    while (ra->in_flight > 0) {
+        SampleChunk* chunk = NULL;
+        _complete_oldest(ra, &chunk);
+        queue_enqueue(resources->free_sample_chunk_queue, chunk);
+    }
+}
+
+const char* file_readahead_describe(const FileReadahead* ra) {
+    return ra->description;
+}
+
+void file_readahead_destroy(FileReadahead* ra) {
+    if (!ra) {
+        return;
+    }
+    async_io_destroy(ra->aio);
+    if (ra->slots) {
+        for (unsigned int i = 0; i < ra->depth; i++) {
+            free(ra->slots[i].bounce);
+        }
+        free(ra->slots);
+    }
+    if (ra->fd >= 0) {
+        close(ra->fd);
+    }
+    free(ra);
+}
+
+#endif // _WIN32
@@ -0,0 +1,232 @@
+/**
+ * @file file_splice.c
+ * @brief Implements the in-kernel copy used by --raw-passthrough from file inputs.
+ */
+
+#include "file_splice.h"
+#include "file_map.h"
+#include "constants.h"
+#include "log.h"
+#include "app_context.h"
+#include "pipeline_types.h"
+#include "queue.h"
+#include "signal_handler.h"
+#include "telemetry.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef __linux__
+
+// --- Other platforms: no in-kernel copy, the input reads in chunks ---
+
+long long file_splice_to_output(ModuleContext* ctx, int in_fd, unsigned long long offset, unsigned long long length,
+                                int out_fd, long long* total_bytes_written, const char* writer_name) {
+    (void)ctx;
+    (void)in_fd;
+    (void)offset;
+    (void)length;
+    (void)out_fd;
+    (void)total_bytes_written;
+    (void)writer_name;
+    return -1;
+}
+
+#else
+
+// --- Private Definitions ---
+
+/**
+ * @enum SpliceMethod
+ * @brief The system calls tried, in order of preference for the output type.
+ */
+typedef enum {
+    SPLICE_METHOD_SPLICE,           ///< File to pipe. The pages are moved into the pipe, not copied.
+    SPLICE_METHOD_COPY_FILE_RANGE,  ///< File to file. May share extents instead of copying.
+    SPLICE_METHOD_SENDFILE,         ///< File to anything else, or where copy_file_range() is refused.
+} SpliceMethod;
+
+static const char* const s_method_names[] = { "splice", "copy_file_range", "sendfile" };
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Moves up to `bytes` from in_fd at *offset to out_fd, advancing *offset.
+ * @return The number of bytes moved (0 at the end of the input), or -1 with errno set.
+ */
+static ssize_t _move(SpliceMethod method, int in_fd, unsigned long long* offset, int out_fd, size_t bytes) {
+    switch (method) {
+        case SPLICE_METHOD_SPLICE: {
+            loff_t in_off = (loff_t)*offset;
+            ssize_t moved = splice(in_fd, &in_off, out_fd, NULL, bytes, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (moved > 0) *offset += (unsigned long long)moved;
+            return moved;
+        }
+        case SPLICE_METHOD_COPY_FILE_RANGE: {
+#ifdef HAVE_COPY_FILE_RANGE
+            loff_t in_off = (loff_t)*offset;
+            ssize_t moved = copy_file_range(in_fd, &in_off, out_fd, NULL, bytes, 0);
+            if (moved > 0) *offset += (unsigned long long)moved;
+            return moved;
+#else
+            errno = ENOSYS;
+            return -1;
+#endif
+        }
+        case SPLICE_METHOD_SENDFILE: {
+            off_t in_off = (off_t)*offset;
+            ssize_t moved = sendfile(out_fd, in_fd, &in_off, bytes);
+            if (moved > 0) *offset += (unsigned long long)moved;
+            return moved;
+        }
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+/**
+ * @brief Reports whether a failure means the method does not apply to these descriptors.
+ *
+ * Only meaningful before the first byte has moved; later, any error is real.
+ */
+static bool _is_unsupported_error(int err) {
+    return err == ENOSYS || err == EOPNOTSUPP || err == EXDEV || err == EINVAL || err == EBADF;
+}
+
+/**
+ * @brief Waits until a non-blocking output can take more data.
+ */
+static void _wait_writable(int fd) {
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT, .revents = 0 };
+    (void)poll(&pfd, 1, 100);
+}
+
+static void _report_progress(AppResources* resources, const long long* total_bytes_written) {
+    if (resources->progress_callback) {
+        unsigned long long current_frames = (unsigned long long)*total_bytes_written / resources->output_bytes_per_sample_pair;
+        atomic_store_explicit(&resources->total_output_frames, current_frames, memory_order_relaxed);
+        resources->progress_callback(current_frames, resources->expected_total_output_frames, (unsigned long long)*total_bytes_written,
+                                     resources->progress_callback_udata);
+    }
+}
+
+// --- Public Function Implementations ---
+
+long long file_splice_to_output(ModuleContext* ctx, int in_fd, unsigned long long offset, unsigned long long length,
+                                int out_fd, long long* total_bytes_written, const char* writer_name) {
+    AppResources* resources = ctx->resources;
+
+    struct stat out_stat;
+    if (in_fd < 0 || out_fd < 0 || fstat(out_fd, &out_stat) != 0) {
+        return -1;
+    }
+
+    SpliceMethod methods[2];
+    int num_methods = 0;
+    if (S_ISFIFO(out_stat.st_mode)) {
+        methods[num_methods++] = SPLICE_METHOD_SPLICE;
+    } else {
+        methods[num_methods++] = SPLICE_METHOD_COPY_FILE_RANGE;
+        methods[num_methods++] = SPLICE_METHOD_SENDFILE;
+    }
+
+    unsigned long long copied = 0;
+    int m = 0;
+    while (copied < length && !is_shutdown_requested() && !resources->error_occurred) {
+        unsigned long long remaining = length - copied;
+        size_t step = (remaining < FILE_SPLICE_STEP_BYTES) ? (size_t)remaining : FILE_SPLICE_STEP_BYTES;
+        unsigned long long position = offset + copied;
+
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
+        ssize_t moved = _move(methods[m], in_fd, &position, out_fd, step);
+        int err = errno;
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER,
+                                 (moved > 0) ? (unsigned long long)moved / resources->output_bytes_per_sample_pair : 0);
+
+        if (moved > 0) {
+            copied += (unsigned long long)moved;
+            *total_bytes_written += (long long)moved;
+            _report_progress(resources, total_bytes_written);
+            continue;
+        }
+        if (moved == 0) {
+            break; // The input is shorter than its header claimed.
+        }
+        if (err == EINTR) {
+            continue;
+        }
+        if (err == EAGAIN) {
+            _wait_writable(out_fd);
+            continue;
+        }
+        if (copied == 0 && _is_unsupported_error(err)) {
+            if (++m < num_methods) {
+                continue;
+            }
+            log_debug("%s: The kernel cannot copy to this output (%s). Using the chunk path.", writer_name, strerror(err));
+            return -1;
+        }
+        if (err == EPIPE) {
+            if (!is_shutdown_requested()) {
+                log_debug("%s: write error, consumer likely closed pipe: %s", writer_name, strerror(err));
+                request_shutdown();
+            }
+        } else {
+            char error_buf[256];
+            snprintf(error_buf, sizeof(error_buf), "%s: File write error: %s", writer_name, strerror(err));
+            handle_fatal_thread_error(error_buf, resources);
+        }
+        break;
+    }
+
+    char size_buf[40];
+    log_info("Raw passthrough: %s moved in the kernel with %s().",
+             format_file_size((long long)copied, size_buf, sizeof(size_buf)), s_method_names[methods[m]]);
+    return (long long)copied;
+}
+
+#endif // __linux__
+
+bool file_splice_run_passthrough(ModuleContext* ctx, SNDFILE* infile, int in_fd, const InputRange* range) {
+    AppResources* resources = ctx->resources;
+    const OutputModuleInterface* output_api = resources->selected_output_module_api;
+    if (in_fd < 0 || !output_api || !output_api->copy_from_file) {
+        return false;
+    }
+
+    unsigned long long data_offset;
+    unsigned long long data_bytes;
+    if (!file_map_locate_data(infile, in_fd, resources->input_bytes_per_sample_pair, range, &data_offset, &data_bytes)) {
+        return false;
+    }
+
+    long long copied = output_api->copy_from_file(ctx, in_fd, data_offset, data_bytes);
+    if (copied < 0) {
+        return false;
+    }
+    atomic_fetch_add_explicit(&resources->total_frames_read,
+                              (unsigned long long)copied / resources->input_bytes_per_sample_pair, memory_order_relaxed);
+
+    // Nothing went through the chunk queues, so the writer is still waiting for the end of stream.
+    if (!is_shutdown_requested() && !resources->error_occurred) {
+        SampleChunk* last_item = (SampleChunk*)queue_dequeue(resources->free_sample_chunk_queue);
+        if (last_item) {
+            last_item->is_last_chunk = true;
+            last_item->frames_read = 0;
+            last_item->packet_sample_format = resources->input_format;
+            if (!queue_enqueue(resources->reader_output_queue, last_item)) {
+                queue_enqueue(resources->free_sample_chunk_queue, last_item);
+            }
+        }
+    }
+    return true;
+}
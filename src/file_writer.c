@@ -0,0 +1,401 @@
+/**
+ * @file file_writer.c
+ * @brief Implements the write-behind engine for file outputs on top of async_io.
+ */
+
+#include "file_writer.h"
+#include "async_io.h"
+#include "constants.h"
+#include "log.h"
+#include "app_context.h"
+#include "ring_buffer.h"
+#include "signal_handler.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// --- Windows: not supported, callers fall back to stdio writes ---
+
+FileWriter* file_writer_create(int fd, unsigned int depth, size_t block_bytes, bool direct_io,
+                               unsigned long long expected_bytes) {
+    (void)fd;
+    (void)depth;
+    (void)block_bytes;
+    (void)direct_io;
+    (void)expected_bytes;
+    log_warn("Write-behind output is not supported on Windows. Falling back to buffered writes.");
+    return NULL;
+}
+
+unsigned char* file_writer_get_buffer(FileWriter* fw, size_t* out_space) {
+    (void)fw;
+    *out_space = 0;
+    errno = ENOSYS;
+    return NULL;
+}
+
+bool file_writer_commit(FileWriter* fw, size_t bytes) {
+    (void)fw;
+    (void)bytes;
+    errno = ENOSYS;
+    return false;
+}
+
+bool file_writer_write(FileWriter* fw, const void* data, size_t bytes) {
+    (void)fw;
+    (void)data;
+    (void)bytes;
+    errno = ENOSYS;
+    return false;
+}
+
+bool file_writer_finish(FileWriter* fw) {
+    (void)fw;
+    errno = ENOSYS;
+    return false;
+}
+
+void file_writer_run_writer(ModuleContext* ctx, FileWriter* fw, long long* total_bytes_written, const char* writer_name) {
+    (void)ctx;
+    (void)fw;
+    (void)total_bytes_written;
+    (void)writer_name;
+}
+
+const char* file_writer_describe(const FileWriter* fw) {
+    (void)fw;
+    return "unavailable";
+}
+
+void file_writer_destroy(FileWriter* fw) {
+    (void)fw;
+}
+
+#else
+
+// --- Private Definitions ---
+
+/**
+ * @struct WriteSlot
+ * @brief One block buffer. Slots are filled and written round-robin.
+ */
+typedef struct {
+    AsyncIoRequest request;
+    unsigned char* buffer;     ///< block_bytes, aligned for O_DIRECT.
+    bool           in_flight;
+} WriteSlot;
+
+struct FileWriter {
+    int                fd;
+    bool               direct_io;
+    AsyncIo*           aio;
+    unsigned int       depth;
+    size_t             block_bytes;
+    WriteSlot*         slots;
+    unsigned int       current;       ///< The slot being filled.
+    size_t             fill;          ///< Bytes already in the current slot.
+    unsigned long long next_offset;   ///< File offset of the current slot's first byte.
+    bool               preallocated;
+    int                error;         ///< errno of the first failed write, 0 otherwise.
+    char               description[64];
+};
+
+// --- Private Helper Functions ---
+
+static size_t _align_up(size_t value) {
+    return (value + ASYNC_IO_DIRECT_ALIGNMENT - 1) & ~((size_t)ASYNC_IO_DIRECT_ALIGNMENT - 1);
+}
+
+static bool _set_direct(int fd, bool enable) {
+#ifdef O_DIRECT
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0) {
+        return false;
+    }
+    flags = enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+    return fcntl(fd, F_SETFL, flags) == 0;
+#else
+    (void)fd;
+    (void)enable;
+    return false;
+#endif
+}
+
+/**
+ * @brief Waits for a slot's write if one is in flight and records any failure.
+ */
+static void _reclaim(FileWriter* fw, WriteSlot* slot) {
+    if (!slot->in_flight) {
+        return;
+    }
+    async_io_wait(fw->aio, &slot->request);
+    slot->in_flight = false;
+    if (fw->error == 0) {
+        if (slot->request.error != 0) {
+            fw->error = slot->request.error;
+        } else if (slot->request.done != slot->request.length) {
+            fw->error = EIO;
+        }
+    }
+}
+
+static bool _fail(const FileWriter* fw) {
+    errno = fw->error;
+    return false;
+}
+
+static bool _pwrite_all(int fd, const unsigned char* data, size_t length, unsigned long long offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, data, length, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (written == 0) {
+            errno = EIO;
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+        offset += (unsigned long long)written;
+    }
+    return true;
+}
+
+// --- Public Function Implementations ---
+
+FileWriter* file_writer_create(int fd, unsigned int depth, size_t block_bytes, bool direct_io,
+                               unsigned long long expected_bytes) {
+    if (fd < 0 || depth == 0 || block_bytes == 0) {
+        return NULL;
+    }
+
+    FileWriter* fw = (FileWriter*)calloc(1, sizeof(FileWriter));
+    if (!fw) {
+        return NULL;
+    }
+    fw->fd = fd;
+    fw->depth = depth;
+    fw->block_bytes = _align_up(block_bytes);
+
+    fw->slots = (WriteSlot*)calloc(depth, sizeof(WriteSlot));
+    if (!fw->slots) {
+        file_writer_destroy(fw);
+        return NULL;
+    }
+    for (unsigned int i = 0; i < depth; i++) {
+        void* buffer = NULL;
+        if (posix_memalign(&buffer, ASYNC_IO_DIRECT_ALIGNMENT, fw->block_bytes) != 0) {
+            log_warn("Could not allocate write-behind buffers. Falling back to buffered writes.");
+            file_writer_destroy(fw);
+            return NULL;
+        }
+        fw->slots[i].buffer = (unsigned char*)buffer;
+    }
+
+    if (direct_io) {
+        if (_set_direct(fd, true)) {
+            fw->direct_io = true;
+        } else {
+            log_warn("The output file system refused O_DIRECT (%s). Write-behind will use the page cache.", strerror(errno));
+        }
+    }
+
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    // Reserve the blocks without changing the file size, so an interrupted run
+    // leaves a file that ends at the last sample written. finish() trims any
+    // reservation past the end.
+    if (expected_bytes > 0) {
+        if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)expected_bytes) == 0) {
+            fw->preallocated = true;
+        } else {
+            log_debug("fallocate() of %llu bytes failed: %s", expected_bytes, strerror(errno));
+        }
+    }
+#else
+    (void)expected_bytes;
+#endif
+
+    fw->aio = async_io_create(fd, depth, fw->direct_io);
+    if (!fw->aio) {
+        log_warn("Could not start the write-behind I/O backend. Falling back to buffered writes.");
+        if (fw->direct_io) {
+            _set_direct(fd, false);
+        }
+        file_writer_destroy(fw);
+        return NULL;
+    }
+
+    snprintf(fw->description, sizeof(fw->description), "%s, depth %u%s",
+             async_io_backend_name(fw->aio), depth, fw->direct_io ? ", O_DIRECT" : "");
+    log_debug("Write-behind engine: %s, %zu-byte blocks%s.", fw->description, fw->block_bytes,
+              fw->preallocated ? ", preallocated" : "");
+    return fw;
+}
+
+unsigned char* file_writer_get_buffer(FileWriter* fw, size_t* out_space) {
+    WriteSlot* slot = &fw->slots[fw->current];
+    _reclaim(fw, slot);
+    if (fw->error != 0) {
+        *out_space = 0;
+        _fail(fw);
+        return NULL;
+    }
+    *out_space = fw->block_bytes - fw->fill;
+    return slot->buffer + fw->fill;
+}
+
+bool file_writer_commit(FileWriter* fw, size_t bytes) {
+    if (fw->error != 0) {
+        return _fail(fw);
+    }
+    fw->fill += bytes;
+    if (fw->fill < fw->block_bytes) {
+        return true;
+    }
+
+    WriteSlot* slot = &fw->slots[fw->current];
+    slot->request.op = ASYNC_IO_WRITE;
+    slot->request.buffer = slot->buffer;
+    slot->request.length = fw->block_bytes;
+    slot->request.offset = fw->next_offset;
+    slot->in_flight = true;
+    async_io_submit(fw->aio, &slot->request);
+
+    fw->next_offset += fw->block_bytes;
+    fw->current = (fw->current + 1) % fw->depth;
+    fw->fill = 0;
+    return true;
+}
+
+bool file_writer_write(FileWriter* fw, const void* data, size_t bytes) {
+    const unsigned char* source = (const unsigned char*)data;
+    while (bytes > 0) {
+        size_t space;
+        unsigned char* dest = file_writer_get_buffer(fw, &space);
+        if (!dest) {
+            return false;
+        }
+        size_t n = (bytes < space) ? bytes : space;
+        memcpy(dest, source, n);
+        if (!file_writer_commit(fw, n)) {
+            return false;
+        }
+        source += n;
+        bytes -= n;
+    }
+    return true;
+}
+
+bool file_writer_finish(FileWriter* fw) {
+    for (unsigned int i = 0; i < fw->depth; i++) {
+        _reclaim(fw, &fw->slots[i]);
+    }
+    if (fw->direct_io) {
+        // The tail is rarely a whole number of blocks; write it through the
+        // page cache rather than padding it and truncating afterwards.
+        _set_direct(fw->fd, false);
+        fw->direct_io = false;
+    }
+    if (fw->error != 0) {
+        return _fail(fw);
+    }
+
+    if (fw->fill > 0) {
+        if (!_pwrite_all(fw->fd, fw->slots[fw->current].buffer, fw->fill, fw->next_offset)) {
+            fw->error = errno;
+            return false;
+        }
+        fw->next_offset += fw->fill;
+        fw->fill = 0;
+    }
+
+    if (fw->preallocated && ftruncate(fw->fd, (off_t)fw->next_offset) != 0) {
+        log_debug("Could not release the unused preallocation: %s", strerror(errno));
+    }
+    return true;
+}
+
+void file_writer_run_writer(ModuleContext* ctx, FileWriter* fw, long long* total_bytes_written, const char* writer_name) {
+    AppResources* resources = ctx->resources;
+    unsigned long long stream_bytes_consumed = 0;
+    while (true) {
+        size_t space;
+        unsigned char* block = file_writer_get_buffer(fw, &space);
+        if (!block) {
+            char error_buf[256];
+            snprintf(error_buf, sizeof(error_buf), "%s: File write error: %s", writer_name, strerror(errno));
+            handle_fatal_thread_error(error_buf, resources);
+            break;
+        }
+
+        size_t bytes_read = ring_buffer_read(resources->writer_input_buffer, block, space);
+        if (bytes_read == 0) {
+            break; // End of stream
+        }
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
+
+        bool committed = file_writer_commit(fw, bytes_read);
+        if (committed) {
+            *total_bytes_written += (long long)bytes_read;
+        }
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER, committed ? bytes_read / resources->output_bytes_per_sample_pair : 0);
+        stream_bytes_consumed += bytes_read;
+        telemetry_latency_index_advance(resources->telemetry, stream_bytes_consumed);
+
+        if (!committed) {
+            char error_buf[256];
+            snprintf(error_buf, sizeof(error_buf), "%s: File write error: %s", writer_name, strerror(errno));
+            handle_fatal_thread_error(error_buf, resources);
+            break;
+        }
+
+        if (resources->progress_callback) {
+            unsigned long long current_frames = *total_bytes_written / resources->output_bytes_per_sample_pair;
+            atomic_store_explicit(&resources->total_output_frames, current_frames, memory_order_relaxed);
+            resources->progress_callback(current_frames, resources->expected_total_output_frames, *total_bytes_written, resources->progress_callback_udata);
+        }
+    }
+
+    // Drain the writes still in flight here, so a late failure fails the run.
+    if (!resources->error_occurred && !file_writer_finish(fw)) {
+        char error_buf[256];
+        snprintf(error_buf, sizeof(error_buf), "%s: File write error: %s", writer_name, strerror(errno));
+        handle_fatal_thread_error(error_buf, resources);
+    }
+}
+
+
+const char* file_writer_describe(const FileWriter* fw) {
+    return fw->description;
+}
+
+void file_writer_destroy(FileWriter* fw) {
+    if (!fw) {
+        return;
+    }
+    if (fw->slots) {
+        for (unsigned int i = 0; i < fw->depth; i++) {
+            if (fw->aio) {
+                _reclaim(fw, &fw->slots[i]);
+            }
+            free(fw->slots[i].buffer);
+        }
+        free(fw->slots);
+    }
+    async_io_destroy(fw->aio);
+    free(fw);
+}
+
+#endif // _WIN32
@@ -20,7 +20,7 @@
 // --- MACRO to create a real-coefficient (_crcf) filter from the complex master taps ---
 #define PREPARE_AND_CREATE_CRCF_FILTER(prefix, ...) \
     do { \
-        float* final_real_taps = (float*)mem_arena_alloc(arena, master_taps_len * sizeof(float), false); \
+        float* final_real_taps = (float*)mem_scratch_alloc(scratch, master_taps_len * sizeof(float), false); \
         if (!final_real_taps) goto cleanup; \
         for (int i = 0; i < master_taps_len; i++) { \
             final_real_taps[i] = crealf(master_taps[i]); \
@@ -114,10 +114,10 @@ _execute_fft_filter_pass(
 static liquid_float_complex* convolve_complex_taps(
     const liquid_float_complex* h1, int len1,
     const liquid_float_complex* h2, int len2,
-    int* out_len, MemoryArena* arena)
+    int* out_len, ScratchArena* scratch)
 {
     *out_len = len1 + len2 - 1;
-    liquid_float_complex* result = (liquid_float_complex*)mem_arena_alloc(arena, *out_len * sizeof(liquid_float_complex), false);
+    liquid_float_complex* result = (liquid_float_complex*)mem_scratch_alloc(scratch, *out_len * sizeof(liquid_float_complex), false);
     if (!result) {
         return NULL;
     }
@@ -142,18 +142,28 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
     resources->user_filter_object = NULL;
     resources->user_filter_type_actual = FILTER_IMPL_NONE;
     resources->user_filter_block_size = 0;
+    resources->user_filter_taps = 0;
 
     if (config->num_filter_requests == 0) {
         return true;
     }
 
+    // All design intermediates live in the scratch arena and are released on exit.
+    // liquid-dsp copies the final taps into the filter object, so only the
+    // remainder buffers below need to come from the setup arena.
+    ScratchArena* scratch = mem_scratch_get();
+    if (!scratch) {
+        return false;
+    }
+    ScratchMark scratch_mark = mem_scratch_mark(scratch);
+
     // First, determine the optimal stage for the filter (pre/post resample).
     if (!_configure_filter_stage(config, resources)) {
         goto cleanup;
     }
 
     int master_taps_len = 1;
-    master_taps = (liquid_float_complex*)mem_arena_alloc(arena, sizeof(liquid_float_complex), false);
+    master_taps = (liquid_float_complex*)mem_scratch_alloc(scratch, sizeof(liquid_float_complex), false);
     if (!master_taps) goto cleanup;
     master_taps[0] = 1.0f + 0.0f * I;
 
@@ -194,7 +204,7 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
             if (current_taps_len < FILTER_MINIMUM_TAPS) current_taps_len = FILTER_MINIMUM_TAPS;
         }
 
-        liquid_float_complex* current_taps = (liquid_float_complex*)mem_arena_alloc(arena, current_taps_len * sizeof(liquid_float_complex), false);
+        liquid_float_complex* current_taps = (liquid_float_complex*)mem_scratch_alloc(scratch, current_taps_len * sizeof(liquid_float_complex), false);
         if (!current_taps) goto cleanup;
 
         bool is_current_stage_complex = (req->type == FILTER_TYPE_PASSBAND && fabsf(req->freq1_hz) > 1e-9f);
@@ -203,12 +213,12 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
         }
 
         if (is_current_stage_complex) {
-            float* real_taps = (float*)mem_arena_alloc(arena, current_taps_len * sizeof(float), false);
+            float* real_taps = (float*)mem_scratch_alloc(scratch, current_taps_len * sizeof(float), false);
             if (!real_taps) goto cleanup;
             float half_bw_norm = (req->freq2_hz / 2.0f) / (float)sample_rate_for_design;
             liquid_firdes_kaiser(current_taps_len, half_bw_norm, attenuation_db, 0.0f, real_taps);
             float fc_norm = req->freq1_hz / (float)sample_rate_for_design;
-            nco_crcf shifter = nco_crcf_create(LIQUID_NCO);
+            nco_crcf shifter = nco_crcf_create(DSP_OSCILLATOR_TYPE);
             nco_crcf_set_frequency(shifter, 2.0f * M_PI * fc_norm);
             for (unsigned int k = 0; k < current_taps_len; k++) {
                 nco_crcf_cexpf(shifter, &current_taps[k]);
@@ -217,7 +227,7 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
             }
             nco_crcf_destroy(shifter);
         } else {
-            float* real_taps = (float*)mem_arena_alloc(arena, current_taps_len * sizeof(float), false);
+            float* real_taps = (float*)mem_scratch_alloc(scratch, current_taps_len * sizeof(float), false);
             if (!real_taps) goto cleanup;
             float fc, bw;
             switch (req->type) {
@@ -247,7 +257,7 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
         }
 
         int new_master_len;
-        liquid_float_complex* new_master_taps = convolve_complex_taps(master_taps, master_taps_len, current_taps, current_taps_len, &new_master_len, arena);
+        liquid_float_complex* new_master_taps = convolve_complex_taps(master_taps, master_taps_len, current_taps, current_taps_len, &new_master_len, scratch);
 
         if (!new_master_taps) goto cleanup;
 
@@ -311,6 +321,11 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
         }
     }
 
+    if (DSP_REFERENCE_KERNELS && final_choice == FILTER_TYPE_FFT) {
+        log_info("Reference kernels: using the time-domain FIR filter instead of FFT.");
+        final_choice = FILTER_TYPE_FIR;
+    }
+
     if (final_choice == FILTER_TYPE_FFT) {
         log_info("Preparing FFT-based filter object (this may take a moment)...");
 
@@ -357,6 +372,7 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
         log_fatal("Failed to create final combined filter object.");
         goto cleanup;
     }
+    resources->user_filter_taps = (unsigned int)master_taps_len;
 
     // Now that the filter object is created, allocate its dependent resources (e.g., remainder buffer)
     if (resources->user_filter_object &&
@@ -389,6 +405,7 @@ bool filter_create(AppConfig* config, AppResources* resources, MemoryArena* aren
     success = true;
 
 cleanup:
+    mem_scratch_reset(scratch, scratch_mark);
     return success;
 }
 
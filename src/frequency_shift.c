@@ -5,6 +5,7 @@
 #include "log.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 #include <ctype.h>
 
@@ -18,6 +19,38 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+/**
+ * @brief The phase increment an oscillator holds for a frequency, in
+ *        liquid-dsp's fixed-point units of 2^-32 of a turn.
+ *
+ * Mirrors the conversion nco_crcf_set_frequency() applies, so the result is
+ * the exact increment the oscillator steps by.
+ */
+static uint32_t _nco_fixed_point_increment(float freq_rad_per_sample) {
+    float p = freq_rad_per_sample * 0.159154943091895;  // 1/(2 pi), as in liquid-dsp
+    float fpart = p - ((long)p);
+    float f = (fpart < 0.0f) ? 1.0f + fpart : fpart;
+    return (uint32_t)(f * 0xffffffff);
+}
+
+/**
+ * @brief Starts a --segments job's oscillator at the phase a single run's
+ *        oscillator has after `origin` samples.
+ *
+ * The phase accumulator is a 32-bit integer that wraps once per turn, so that
+ * phase is exactly the increment times the origin, modulo 2^32. Working from
+ * the requested (float) frequency instead would drift by the increment's
+ * rounding error on every sample before the origin.
+ */
+static void _start_at_segment_origin(const AppConfig* config, void* nco, float freq_rad_per_sample, unsigned long long origin) {
+    if (!config->segment_job.active || origin == 0) {
+        return;
+    }
+    uint32_t increment = _nco_fixed_point_increment(freq_rad_per_sample);
+    uint32_t phase = (uint32_t)((uint64_t)increment * (origin & 0xFFFFFFFFULL));
+    nco_crcf_set_phase((nco_crcf)nco, (float)(2.0 * M_PI * ((double)phase / 4294967296.0)));
+}
+
 /**
  * @brief Creates and configures the NCOs (frequency shifters) based on user arguments.
  */
@@ -51,13 +84,14 @@ bool freq_shift_create(AppConfig *config, AppResources *resources) {
             log_error("Requested frequency shift %.2f Hz exceeds sanity limit for the pre-resample rate of %.1f Hz.", resources->nco_shift_hz, rate_for_nco);
             return false;
         }
-        resources->pre_resample_nco = nco_crcf_create(LIQUID_NCO);
+        resources->pre_resample_nco = nco_crcf_create(DSP_OSCILLATOR_TYPE);
         if (!resources->pre_resample_nco) {
             log_error("Failed to create pre-resample NCO (frequency shifter).");
             return false;
         }
         float nco_freq_rad_per_sample = (float)(2.0 * M_PI * fabs(resources->nco_shift_hz) / rate_for_nco);
         nco_crcf_set_frequency((nco_crcf)resources->pre_resample_nco, nco_freq_rad_per_sample);
+        _start_at_segment_origin(config, resources->pre_resample_nco, nco_freq_rad_per_sample, config->segment_job.input_origin);
     }
 
     // --- Create Post-Resample NCO ---
@@ -67,7 +101,7 @@ bool freq_shift_create(AppConfig *config, AppResources *resources) {
             log_error("Requested frequency shift %.2f Hz exceeds sanity limit for the post-resample rate of %.1f Hz.", resources->nco_shift_hz, rate_for_nco);
             return false;
         }
-        resources->post_resample_nco = nco_crcf_create(LIQUID_NCO);
+        resources->post_resample_nco = nco_crcf_create(DSP_OSCILLATOR_TYPE);
         if (!resources->post_resample_nco) {
             log_error("Failed to create post-resample NCO (frequency shifter).");
             freq_shift_destroy_ncos(resources); // Clean up pre-resample NCO if it was created
@@ -75,6 +109,7 @@ bool freq_shift_create(AppConfig *config, AppResources *resources) {
         }
         float nco_freq_rad_per_sample = (float)(2.0 * M_PI * fabs(resources->nco_shift_hz) / rate_for_nco);
         nco_crcf_set_frequency((nco_crcf)resources->post_resample_nco, nco_freq_rad_per_sample);
+        _start_at_segment_origin(config, resources->post_resample_nco, nco_freq_rad_per_sample, config->segment_job.output_origin);
     }
 
     return true;
@@ -431,7 +431,7 @@ static bool bladerf_initialize(ModuleContext* ctx) {
     resources->input_format = (s_bladerf_config.active_bit_depth == 8) ? CS8 : SC16Q11;
     resources->input_bytes_per_sample_pair = get_bytes_per_sample(resources->input_format);
 
-    size_t buffer_size_bytes = PIPELINE_CHUNK_BASE_SAMPLES * resources->input_bytes_per_sample_pair;
+    size_t buffer_size_bytes = resources->pipeline_chunk_base_samples * resources->input_bytes_per_sample_pair;
     private_data->stream_temp_buffer = mem_arena_alloc(&resources->setup_arena, buffer_size_bytes, false);
     if (!private_data->stream_temp_buffer) goto cleanup;
 
@@ -589,7 +589,7 @@ static void* bladerf_start_stream(ModuleContext* ctx) {
     }
 
     unsigned int samples_per_transfer = (unsigned int)(resources->source_info.samplerate * BLADERF_TRANSFER_SIZE_SECONDS);
-    if (samples_per_transfer > PIPELINE_CHUNK_BASE_SAMPLES) samples_per_transfer = PIPELINE_CHUNK_BASE_SAMPLES;
+    if (samples_per_transfer > resources->pipeline_chunk_base_samples) samples_per_transfer = (unsigned int)resources->pipeline_chunk_base_samples;
     if (samples_per_transfer < 4096) samples_per_transfer = 4096;
     samples_per_transfer = (samples_per_transfer / 1024) * 1024;
     log_debug("BladeRF: Using dynamic transfer size of %u samples.", samples_per_transfer);
@@ -704,13 +704,12 @@ static void* bladerf_start_stream(ModuleContext* ctx) {
                         log_warn("BladeRF reported a stream overrun (discontinuity).");
                     }
                     item->frames_read = meta.actual_count;
+                    item->capture_time_ns = get_monotonic_time_ns();
                     item->is_last_chunk = false;
                     item->packet_sample_format = resources->input_format;
 
                     if (item->frames_read > 0) {
-                        pthread_mutex_lock(&resources->progress_mutex);
-                        resources->total_frames_read += item->frames_read;
-                        pthread_mutex_unlock(&resources->progress_mutex);
+                        atomic_fetch_add_explicit(&resources->total_frames_read, item->frames_read, memory_order_relaxed);
                         if (!queue_enqueue(resources->reader_output_queue, item)) {
                             queue_enqueue(resources->free_sample_chunk_queue, item);
                             break;
@@ -0,0 +1,598 @@
+#include "input_generator.h"
+#include "constants.h"
+#include "log.h"
+#include "signal_handler.h"
+#include "utils.h"
+#include "app_context.h"
+#include "platform.h"
+#include "sample_convert.h"
+#include "memory_arena.h"
+#include "queue.h"
+#include "ring_buffer.h"
+#include "argparse.h"
+#include "telemetry.h"
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <complex.h>
+
+#ifndef _WIN32
+#include <strings.h>
+#include <unistd.h> // For usleep
+#else
+#include <windows.h> // For Sleep
+#endif
+
+#ifdef _WIN32
+#define strcasecmp _stricmp
+#endif
+
+typedef enum {
+    GENERATOR_SIGNAL_TONE,
+    GENERATOR_SIGNAL_CHIRP,
+    GENERATOR_SIGNAL_NOISE,
+    GENERATOR_SIGNAL_OFDM
+} GeneratorSignal;
+
+static const struct {
+    const char* name;
+    GeneratorSignal signal;
+} s_signal_names[] = {
+    { "tone",  GENERATOR_SIGNAL_TONE },
+    { "chirp", GENERATOR_SIGNAL_CHIRP },
+    { "noise", GENERATOR_SIGNAL_NOISE },
+    { "ofdm",  GENERATOR_SIGNAL_OFDM },
+};
+
+static struct {
+    const char* signal_str;
+    const char* format_str;
+    float sample_rate_hz_arg;
+    float freq_hz_arg;
+    float amplitude_arg;
+    float snr_db_arg;
+    int   num_carriers_arg;
+    float duration_sec_arg;
+    int   realtime;
+    float dc_offset_arg;
+    float iq_gain_imbalance_db_arg;
+    float iq_phase_imbalance_deg_arg;
+    GeneratorSignal signal;
+} s_generator_config = {
+    .signal_str = "tone",
+    .format_str = "cs16",
+    .sample_rate_hz_arg = (float)GENERATOR_DEFAULT_SAMPLE_RATE_HZ,
+    .freq_hz_arg = (float)GENERATOR_DEFAULT_FREQ_HZ,
+    .amplitude_arg = (float)GENERATOR_DEFAULT_AMPLITUDE,
+    .snr_db_arg = NAN, // No added noise unless requested.
+    .num_carriers_arg = GENERATOR_DEFAULT_OFDM_CARRIERS,
+};
+
+// The synthesized signal, shared with every input that generates one.
+struct GeneratorSource {
+    double sample_rate_hz;
+
+    // Tone state: the phase (in cycles) of the next sample.
+    double tone_phase_cycles;
+
+    // Chirp state: the position of the next sample within the current sweep.
+    unsigned long long chirp_period_samples;
+    unsigned long long chirp_index;
+
+    // OFDM state: a pre-computed loop of symbols, played back cyclically.
+    complex_float_t* ofdm_table;
+    size_t ofdm_table_len;
+    size_t ofdm_pos;
+
+    // Noise and impairments.
+    uint64_t rng_state;
+    float noise_rms;         // 0 when no noise is added.
+    bool apply_impairments;
+    float iq_gain;
+    float iq_phase_sin;
+    float iq_phase_cos;
+    complex_float_t dc_offset;
+};
+
+// This is the private data structure for the Signal Generator input module.
+typedef struct {
+    GeneratorSource* source;
+    double sample_rate_hz;
+    unsigned long long total_frames;      // 0 when the generator runs until stopped.
+    unsigned long long frames_generated;
+} GeneratorPrivateData;
+
+static const struct argparse_option generator_cli_options[] = {
+    OPT_GROUP("Signal Generator Input Options"),
+    OPT_FLOAT(0, "gen-rate", &s_generator_config.sample_rate_hz_arg, "Sample rate of the generated signal in Hz. (Default: 2048000)", NULL, 0, 0),
+    OPT_STRING(0, "gen-sample-format", &s_generator_config.format_str, "Sample format of the generated signal. (Default: cs16)", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-duration", &s_generator_config.duration_sec_arg, "Stop after this many seconds of signal. (Default: run until stopped)", NULL, 0, 0),
+    OPT_BOOLEAN(0, "gen-realtime", &s_generator_config.realtime, "Pace generation to the sample rate instead of running as fast as possible.", NULL, 0, 0),
+};
+
+static const struct argparse_option generator_signal_cli_options[] = {
+    OPT_GROUP("Generated Signal Options (generator, and sim-sdr without --sim-file)"),
+    OPT_STRING(0, "gen-signal", &s_generator_config.signal_str, "Signal to generate {tone|chirp|noise|ofdm}. (Default: tone)", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-freq", &s_generator_config.freq_hz_arg, "Tone offset, or chirp sweep range (+/-), in Hz. (Default: 100000)", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-amplitude", &s_generator_config.amplitude_arg, "Signal amplitude (peak for tone/chirp, RMS for noise/ofdm). (Default: 0.5)", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-snr", &s_generator_config.snr_db_arg, "(Optional) Add white Gaussian noise at this SNR in dB.", NULL, 0, 0),
+    OPT_INTEGER(0, "gen-carriers", &s_generator_config.num_carriers_arg, "Number of OFDM subcarriers. (Default: 64)", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-dc-offset", &s_generator_config.dc_offset_arg, "(Optional) Add a DC offset to both I and Q (full scale = 1.0).", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-iq-gain-imbalance", &s_generator_config.iq_gain_imbalance_db_arg, "(Optional) I/Q gain imbalance in dB.", NULL, 0, 0),
+    OPT_FLOAT(0, "gen-iq-phase-imbalance", &s_generator_config.iq_phase_imbalance_deg_arg, "(Optional) I/Q phase imbalance in degrees.", NULL, 0, 0),
+};
+
+const struct argparse_option* generator_get_cli_options(int* count) {
+    *count = sizeof(generator_cli_options) / sizeof(generator_cli_options[0]);
+    return generator_cli_options;
+}
+
+const struct argparse_option* generator_get_signal_cli_options(int* count) {
+    *count = sizeof(generator_signal_cli_options) / sizeof(generator_signal_cli_options[0]);
+    return generator_signal_cli_options;
+}
+
+static bool generator_initialize(ModuleContext* ctx);
+static void* generator_start_stream(ModuleContext* ctx);
+static void generator_stop_stream(ModuleContext* ctx);
+static void generator_cleanup(ModuleContext* ctx);
+static void generator_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info);
+static bool generator_validate_options(AppConfig* config);
+static bool generator_has_known_length(void);
+
+static InputModuleInterface generator_module_api = {
+    .initialize = generator_initialize,
+    .start_stream = generator_start_stream,
+    .stop_stream = generator_stop_stream,
+    .cleanup = generator_cleanup,
+    .get_summary_info = generator_get_summary_info,
+    .validate_options = generator_validate_options,
+    .has_known_length = generator_has_known_length,
+    .validate_generic_options = NULL,
+    .pre_stream_iq_correction = NULL,
+};
+
+InputModuleInterface* get_generator_input_module_api(void) {
+    return &generator_module_api;
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Returns a uniform random number in (0, 1].
+ */
+static inline double _rng_uniform(uint64_t* state) {
+    return (double)((utils_rng_next(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Returns a complex Gaussian sample with the given total RMS (Box-Muller).
+ */
+static inline complex_float_t _rng_complex_gaussian(uint64_t* state, float rms) {
+    double radius = sqrt(-2.0 * log(_rng_uniform(state))) * (rms / M_SQRT2);
+    double angle = 2.0 * M_PI * _rng_uniform(state);
+    return (float)(radius * cos(angle)) + (float)(radius * sin(angle)) * I;
+}
+
+static bool _build_ofdm_table(GeneratorSource* data, MemoryArena* arena, int num_carriers, float rms) {
+    // Carriers occupy ~80% of the band around DC (DC itself is left empty),
+    // each symbol is preceded by a 1/8 cyclic prefix.
+    const size_t fft_len = ((size_t)num_carriers * 5 + 3) / 4 + 1;
+    const size_t cp_len = fft_len / 8;
+    const size_t symbol_len = fft_len + cp_len;
+
+    data->ofdm_table_len = symbol_len * GENERATOR_OFDM_SYMBOLS;
+    data->ofdm_table = (complex_float_t*)mem_arena_alloc(arena, data->ofdm_table_len * sizeof(complex_float_t), false);
+    if (!data->ofdm_table) {
+        return false;
+    }
+
+    double power_sum = 0.0;
+    for (size_t s = 0; s < GENERATOR_OFDM_SYMBOLS; s++) {
+        complex_float_t* symbol = &data->ofdm_table[s * symbol_len];
+        for (size_t n = 0; n < symbol_len; n++) {
+            symbol[n] = 0.0f;
+        }
+
+        for (int k = 0; k < num_carriers; k++) {
+            int bin = k - num_carriers / 2;
+            if (bin >= 0) bin++; // Skip DC.
+
+            // Random QPSK point on this carrier for this symbol.
+            uint64_t bits = utils_rng_next(&data->rng_state);
+            double complex value = ((bits & 1) ? 1.0 : -1.0) + ((bits & 2) ? 1.0 : -1.0) * I;
+
+            // Start at n = -cp_len so the prefix is a copy of the symbol's tail.
+            double step = 2.0 * M_PI * (double)bin / (double)fft_len;
+            double complex rot = cexp(step * I);
+            double complex z = value * cexp(-step * (double)cp_len * I);
+            for (size_t n = 0; n < symbol_len; n++) {
+                symbol[n] += (complex_float_t)z;
+                z *= rot;
+            }
+        }
+
+        for (size_t n = 0; n < symbol_len; n++) {
+            power_sum += (double)(crealf(symbol[n]) * crealf(symbol[n]) + cimagf(symbol[n]) * cimagf(symbol[n]));
+        }
+    }
+
+    float scale = (power_sum > 0.0) ? (float)(rms / sqrt(power_sum / (double)data->ofdm_table_len)) : 0.0f;
+    for (size_t n = 0; n < data->ofdm_table_len; n++) {
+        data->ofdm_table[n] *= scale;
+    }
+    return true;
+}
+
+static void _sleep_ns(unsigned long long ns) {
+#ifdef _WIN32
+    Sleep((DWORD)(ns / 1000000ULL));
+#else
+    usleep((useconds_t)(ns / 1000ULL));
+#endif
+}
+
+// --- Signal Source ---
+
+bool generator_validate_signal_options(double sample_rate_hz) {
+    bool signal_found = false;
+    for (size_t i = 0; i < sizeof(s_signal_names) / sizeof(s_signal_names[0]); i++) {
+        if (strcasecmp(s_generator_config.signal_str, s_signal_names[i].name) == 0) {
+            s_generator_config.signal = s_signal_names[i].signal;
+            signal_found = true;
+            break;
+        }
+    }
+    if (!signal_found) {
+        log_fatal("Invalid value for --gen-signal: '%s'. Must be one of {tone|chirp|noise|ofdm}.", s_generator_config.signal_str);
+        return false;
+    }
+
+    if (fabs((double)s_generator_config.freq_hz_arg) > sample_rate_hz / 2.0) {
+        log_fatal("--gen-freq of %.0f Hz exceeds the Nyquist frequency of %.0f Hz.",
+                  s_generator_config.freq_hz_arg, sample_rate_hz / 2.0);
+        return false;
+    }
+    if (s_generator_config.amplitude_arg <= 0.0f) {
+        log_fatal("--gen-amplitude must be greater than 0.");
+        return false;
+    }
+    if (s_generator_config.num_carriers_arg < 1 || s_generator_config.num_carriers_arg > GENERATOR_MAX_OFDM_CARRIERS) {
+        log_fatal("--gen-carriers must be between 1 and %d.", GENERATOR_MAX_OFDM_CARRIERS);
+        return false;
+    }
+    if (fabsf(s_generator_config.iq_phase_imbalance_deg_arg) >= 45.0f) {
+        log_fatal("--gen-iq-phase-imbalance must be between -45 and 45 degrees.");
+        return false;
+    }
+
+    return true;
+}
+
+GeneratorSource* generator_source_create(MemoryArena* arena, double sample_rate_hz) {
+    GeneratorSource* source = (GeneratorSource*)mem_arena_alloc(arena, sizeof(GeneratorSource), true);
+    if (!source) {
+        return NULL;
+    }
+
+    source->sample_rate_hz = sample_rate_hz;
+    source->rng_state = 0x9E3779B97F4A7C15ULL; // Fixed seed: runs are reproducible.
+
+    source->chirp_period_samples = (unsigned long long)(GENERATOR_CHIRP_PERIOD_SECONDS * sample_rate_hz);
+    if (source->chirp_period_samples < 2) {
+        source->chirp_period_samples = 2;
+    }
+
+    if (s_generator_config.signal == GENERATOR_SIGNAL_OFDM) {
+        if (!_build_ofdm_table(source, arena, s_generator_config.num_carriers_arg, s_generator_config.amplitude_arg)) {
+            return NULL;
+        }
+    }
+
+    if (isfinite(s_generator_config.snr_db_arg) && s_generator_config.signal != GENERATOR_SIGNAL_NOISE) {
+        source->noise_rms = s_generator_config.amplitude_arg / powf(10.0f, s_generator_config.snr_db_arg / 20.0f);
+    }
+
+    float phase_rad = s_generator_config.iq_phase_imbalance_deg_arg * (float)M_PI / 180.0f;
+    source->iq_gain = powf(10.0f, s_generator_config.iq_gain_imbalance_db_arg / 20.0f);
+    source->iq_phase_sin = sinf(phase_rad);
+    source->iq_phase_cos = cosf(phase_rad);
+    source->dc_offset = s_generator_config.dc_offset_arg + s_generator_config.dc_offset_arg * I;
+    source->apply_impairments = (s_generator_config.dc_offset_arg != 0.0f ||
+                                 s_generator_config.iq_gain_imbalance_db_arg != 0.0f ||
+                                 s_generator_config.iq_phase_imbalance_deg_arg != 0.0f);
+    return source;
+}
+
+/**
+ * @brief Generates the next block of the selected signal as cf32.
+ */
+void generator_source_generate(GeneratorSource* data, complex_float_t* out, size_t num_frames) {
+    const float amplitude = s_generator_config.amplitude_arg;
+
+    switch (s_generator_config.signal) {
+        case GENERATOR_SIGNAL_TONE: {
+            // Recursive oscillator in double precision, re-seeded from the exact phase every block.
+            double step_cycles = (double)s_generator_config.freq_hz_arg / data->sample_rate_hz;
+            double complex z = amplitude * cexp(2.0 * M_PI * data->tone_phase_cycles * I);
+            double complex rot = cexp(2.0 * M_PI * step_cycles * I);
+            for (size_t i = 0; i < num_frames; i++) {
+                out[i] = (complex_float_t)z;
+                z *= rot;
+            }
+            data->tone_phase_cycles = fmod(data->tone_phase_cycles + step_cycles * (double)num_frames, 1.0);
+            break;
+        }
+        case GENERATOR_SIGNAL_CHIRP: {
+            // Linear sweep from -freq to +freq. The per-sample phase step grows by a
+            // fixed amount, so both the phase and the step are plain rotators.
+            const double span = (double)s_generator_config.freq_hz_arg;
+            const double period = (double)data->chirp_period_samples;
+            const double theta0 = -2.0 * M_PI * span / data->sample_rate_hz;
+            const double delta = 2.0 * M_PI * (2.0 * span / data->sample_rate_hz) / period;
+            const double complex drot = cexp(delta * I);
+
+            double k = (double)data->chirp_index;
+            double complex z = amplitude * cexp((k * theta0 + delta * k * (k - 1.0) / 2.0) * I);
+            double complex rot = cexp((theta0 + k * delta) * I);
+            for (size_t i = 0; i < num_frames; i++) {
+                out[i] = (complex_float_t)z;
+                z *= rot;
+                rot *= drot;
+                if (++data->chirp_index >= data->chirp_period_samples) {
+                    data->chirp_index = 0;
+                    z = amplitude;
+                    rot = cexp(theta0 * I);
+                }
+            }
+            break;
+        }
+        case GENERATOR_SIGNAL_NOISE:
+            for (size_t i = 0; i < num_frames; i++) {
+                out[i] = _rng_complex_gaussian(&data->rng_state, amplitude);
+            }
+            break;
+        case GENERATOR_SIGNAL_OFDM: {
+            size_t done = 0;
+            while (done < num_frames) {
+                size_t run = data->ofdm_table_len - data->ofdm_pos;
+                if (run > num_frames - done) run = num_frames - done;
+                memcpy(&out[done], &data->ofdm_table[data->ofdm_pos], run * sizeof(complex_float_t));
+                done += run;
+                data->ofdm_pos += run;
+                if (data->ofdm_pos == data->ofdm_table_len) data->ofdm_pos = 0;
+            }
+            break;
+        }
+    }
+
+    if (data->noise_rms > 0.0f) {
+        for (size_t i = 0; i < num_frames; i++) {
+            out[i] += _rng_complex_gaussian(&data->rng_state, data->noise_rms);
+        }
+    }
+
+    if (data->apply_impairments) {
+        // Front-end model: gain error on I, Q skewed by the phase error, then DC.
+        for (size_t i = 0; i < num_frames; i++) {
+            float re = crealf(out[i]);
+            float im = cimagf(out[i]);
+            float out_re = re * data->iq_gain;
+            float out_im = im * data->iq_phase_cos - re * data->iq_phase_sin;
+            out[i] = out_re + out_im * I + data->dc_offset;
+        }
+    }
+}
+
+void generator_add_signal_summary(InputSummaryInfo* info) {
+    switch (s_generator_config.signal) {
+        case GENERATOR_SIGNAL_TONE:
+            add_summary_item(info, "Signal", "tone at %.0f Hz", s_generator_config.freq_hz_arg);
+            break;
+        case GENERATOR_SIGNAL_CHIRP:
+            add_summary_item(info, "Signal", "chirp +/-%.0f Hz", fabsf(s_generator_config.freq_hz_arg));
+            break;
+        case GENERATOR_SIGNAL_NOISE:
+            add_summary_item(info, "Signal", "noise");
+            break;
+        case GENERATOR_SIGNAL_OFDM:
+            add_summary_item(info, "Signal", "ofdm, %d carriers", s_generator_config.num_carriers_arg);
+            break;
+    }
+    if (isfinite(s_generator_config.snr_db_arg) && s_generator_config.signal != GENERATOR_SIGNAL_NOISE) {
+        add_summary_item(info, "Signal SNR", "%.1f dB", s_generator_config.snr_db_arg);
+    }
+}
+
+// --- Module Implementation ---
+
+static bool generator_validate_options(AppConfig* config) {
+    (void)config;
+
+    if (utils_get_format_from_string(s_generator_config.format_str) == FORMAT_UNKNOWN) {
+        log_fatal("Invalid generator format '%s'. See --help for valid formats.", s_generator_config.format_str);
+        return false;
+    }
+
+    if (s_generator_config.sample_rate_hz_arg <= 0.0f) {
+        log_fatal("--gen-rate must be a positive sample rate in Hz.");
+        return false;
+    }
+    if (s_generator_config.duration_sec_arg < 0.0f) {
+        log_fatal("--gen-duration cannot be negative.");
+        return false;
+    }
+
+    return generator_validate_signal_options((double)s_generator_config.sample_rate_hz_arg);
+}
+
+static bool generator_has_known_length(void) {
+    return s_generator_config.duration_sec_arg > 0.0f;
+}
+
+static bool generator_initialize(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+
+    GeneratorPrivateData* private_data = (GeneratorPrivateData*)mem_arena_alloc(&resources->setup_arena, sizeof(GeneratorPrivateData), true);
+    if (!private_data) {
+        return false;
+    }
+    resources->input_module_private_data = private_data;
+
+    resources->input_format = utils_get_format_from_string(s_generator_config.format_str);
+    resources->input_bytes_per_sample_pair = get_bytes_per_sample(resources->input_format);
+    if (resources->input_bytes_per_sample_pair == 0) {
+        log_fatal("Internal error: could not determine sample size for format '%s'.", s_generator_config.format_str);
+        return false;
+    }
+
+    private_data->sample_rate_hz = (double)s_generator_config.sample_rate_hz_arg;
+    if (s_generator_config.duration_sec_arg > 0.0f) {
+        private_data->total_frames = (unsigned long long)((double)s_generator_config.duration_sec_arg * private_data->sample_rate_hz);
+    }
+
+    private_data->source = generator_source_create(&resources->setup_arena, private_data->sample_rate_hz);
+    if (!private_data->source) {
+        return false;
+    }
+
+    resources->source_info.samplerate = (int)private_data->sample_rate_hz;
+    resources->source_info.frames = (private_data->total_frames > 0) ? (long long)private_data->total_frames : -1;
+
+    log_info("Signal generator: %s at %.0f Hz (%s)%s.", s_generator_config.signal_str, private_data->sample_rate_hz,
+             s_generator_config.format_str, s_generator_config.realtime ? ", paced to real time" : "");
+    return true;
+}
+
+static void* generator_start_stream(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    const AppConfig *config = ctx->config;
+    GeneratorPrivateData* private_data = (GeneratorPrivateData*)resources->input_module_private_data;
+
+    if (config->raw_passthrough && resources->input_format != config->output_format) {
+        char error_buf[256];
+        snprintf(error_buf, sizeof(error_buf),
+                 "Option --raw-passthrough requires input and output formats to be identical. Input format is '%s', output format is '%s'.",
+                 s_generator_config.format_str, config->output_sample_format_name);
+        handle_fatal_thread_error(error_buf, resources);
+        return NULL;
+    }
+
+    bool pacing_required = resources->pacing_is_required;
+    const size_t writer_buffer_threshold = resources->writer_backpressure_threshold_bytes;
+    const unsigned long long stream_start_ns = get_monotonic_time_ns();
+
+    while (!is_shutdown_requested() && !resources->error_occurred) {
+        if (pacing_required && (ring_buffer_get_size(resources->writer_input_buffer) > writer_buffer_threshold)) {
+            // The writer is falling behind. Pause briefly to let it catch up.
+            unsigned long long pause_start = trace_is_enabled() ? get_monotonic_time_ns() : 0;
+            #ifdef _WIN32
+                Sleep(10); // 10 ms
+            #else
+                usleep(10000); // 10 ms
+            #endif
+            if (pause_start) {
+                trace_span("wait", "pacing sleep", pause_start, get_monotonic_time_ns(), 0);
+            }
+            continue; // Re-evaluate the buffer state in the next loop iteration.
+        }
+
+        SampleChunk *current_item = (SampleChunk*)queue_dequeue(resources->free_sample_chunk_queue);
+        if (!current_item) {
+            break; // Shutdown or error signaled
+        }
+
+        current_item->stream_discontinuity_event = false;
+        current_item->packet_sample_format = resources->input_format;
+
+        if (private_data->total_frames > 0 && private_data->frames_generated >= private_data->total_frames) {
+            // Requested duration reached. ALWAYS send a final "last chunk" marker down the pipeline.
+            current_item->is_last_chunk = true;
+            current_item->frames_read = 0;
+            queue_enqueue(resources->reader_output_queue, current_item);
+            break;
+        }
+
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_READER);
+        current_item->capture_time_ns = get_monotonic_time_ns();
+
+        unsigned char* target_buffer;
+        size_t capacity_bytes;
+        if (config->raw_passthrough) {
+            target_buffer = current_item->final_output_data;
+            capacity_bytes = current_item->final_output_capacity_bytes;
+        } else {
+            target_buffer = current_item->raw_input_data;
+            capacity_bytes = current_item->raw_input_capacity_bytes;
+        }
+
+        size_t frames_to_generate = capacity_bytes / resources->input_bytes_per_sample_pair;
+        if (private_data->total_frames > 0 && private_data->total_frames - private_data->frames_generated < frames_to_generate) {
+            frames_to_generate = (size_t)(private_data->total_frames - private_data->frames_generated);
+        }
+
+        // The pre-processor has not seen this chunk yet, so its complex buffer is free
+        // to use as scratch space for the cf32 signal before conversion.
+        size_t done = 0;
+        while (done < frames_to_generate) {
+            size_t block = frames_to_generate - done;
+            if (block > current_item->complex_buffer_capacity_samples) {
+                block = current_item->complex_buffer_capacity_samples;
+            }
+            generator_source_generate(private_data->source, current_item->complex_sample_buffer_a, block);
+            convert_cf32_to_block(current_item->complex_sample_buffer_a,
+                                  target_buffer + done * resources->input_bytes_per_sample_pair,
+                                  block, resources->input_format);
+            done += block;
+        }
+
+        private_data->frames_generated += frames_to_generate;
+        current_item->frames_read = frames_to_generate;
+        current_item->is_last_chunk = false;
+
+        atomic_fetch_add_explicit(&resources->total_frames_read, current_item->frames_read, memory_order_relaxed);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_READER, current_item->frames_read);
+
+        if (s_generator_config.realtime) {
+            // Hold the chunk until the moment its last sample would have been captured.
+            unsigned long long due_ns = stream_start_ns +
+                (unsigned long long)((double)private_data->frames_generated * 1e9 / private_data->sample_rate_hz);
+            unsigned long long now_ns = get_monotonic_time_ns();
+            if (due_ns > now_ns) {
+                _sleep_ns(due_ns - now_ns);
+                if (trace_is_enabled()) {
+                    trace_span("wait", "realtime pacing", now_ns, get_monotonic_time_ns(), 0);
+                }
+            }
+            current_item->capture_time_ns = get_monotonic_time_ns();
+        }
+
+        if (!queue_enqueue(resources->reader_output_queue, current_item)) {
+            queue_enqueue(resources->free_sample_chunk_queue, current_item);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void generator_stop_stream(ModuleContext* ctx) {
+    (void)ctx;
+}
+
+static void generator_cleanup(ModuleContext* ctx) {
+    // All generator memory lives in the setup arena.
+    ctx->resources->input_module_private_data = NULL;
+}
+
+static void generator_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info) {
+    (void)ctx;
+    add_summary_item(info, "Input Type", "SIGNAL GENERATOR");
+    generator_add_signal_summary(info);
+
+    add_summary_item(info, "Input Format", "%s", s_generator_config.format_str);
+    add_summary_item(info, "Input Rate", "%.0f Hz", (double)s_generator_config.sample_rate_hz_arg);
+    add_summary_item(info, "Input Pacing", "%s", s_generator_config.realtime ? "Real Time" : "Unpaced");
+}
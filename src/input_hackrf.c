@@ -194,20 +194,19 @@ static int hackrf_realtime_stream_callback(hackrf_transfer* transfer) {
         item->stream_discontinuity_event = false;
 
         size_t chunk_size = transfer->valid_length - bytes_processed;
-        const size_t pipeline_buffer_size = PIPELINE_CHUNK_BASE_SAMPLES * resources->input_bytes_per_sample_pair;
+        const size_t pipeline_buffer_size = resources->pipeline_chunk_base_samples * resources->input_bytes_per_sample_pair;
         if (chunk_size > pipeline_buffer_size) {
             chunk_size = pipeline_buffer_size;
         }
 
         memcpy(item->raw_input_data, transfer->buffer + bytes_processed, chunk_size);
         item->frames_read = chunk_size / resources->input_bytes_per_sample_pair;
+        item->capture_time_ns = get_monotonic_time_ns();
         item->is_last_chunk = false;
 	    item->packet_sample_format = resources->input_format;
 
         if (item->frames_read > 0) {
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->total_frames_read += item->frames_read;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_fetch_add_explicit(&resources->total_frames_read, item->frames_read, memory_order_relaxed);
         }
 
         if (!queue_enqueue(resources->reader_output_queue, item)) {
@@ -0,0 +1,112 @@
+/**
+ * @file input_range.c
+ * @brief Implements the resolution of --start and --duration for file inputs.
+ */
+
+#include "input_range.h"
+#include "app_context.h"
+#include "log.h"
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+
+// --- Forward Declarations for Static Helper Functions ---
+static unsigned long long _seconds_to_frames(double seconds, double sample_rate_hz);
+
+// --- Public Function Implementations ---
+
+bool input_range_resolve(const AppConfig* config, double sample_rate_hz, long long total_frames,
+                         bool start_time_known, time_t start_time_unix, InputRange* out_range) {
+    memset(out_range, 0, sizeof(*out_range));
+    unsigned long long available = (total_frames > 0) ? (unsigned long long)total_frames : 0;
+    out_range->num_frames = available;
+    out_range->total_frames = available;
+
+    const RangeValue* start = &config->range_start;
+    const RangeValue* duration = &config->range_duration;
+    if (start->unit == RANGE_VALUE_UNSET && duration->unit == RANGE_VALUE_UNSET) {
+        return true;
+    }
+    out_range->limited = true;
+
+    switch (start->unit) {
+        case RANGE_VALUE_SAMPLES:
+            out_range->first_frame = start->samples;
+            break;
+        case RANGE_VALUE_SECONDS:
+            out_range->first_frame = _seconds_to_frames(start->seconds, sample_rate_hz);
+            break;
+        case RANGE_VALUE_UTC: {
+            if (!start_time_known) {
+                log_fatal("--start was given as a UTC time, but the input has no recording start time "
+                          "(from WAV 'auxi' metadata or an SDR#-style filename).");
+                return false;
+            }
+            double offset = start->seconds - (double)start_time_unix;
+            if (offset < 0.0) {
+                log_fatal("--start %s is %.3f s before the recording starts.", config->start_str_arg, -offset);
+                return false;
+            }
+            out_range->first_frame = _seconds_to_frames(offset, sample_rate_hz);
+            break;
+        }
+        case RANGE_VALUE_UNSET:
+            break;
+    }
+
+    if (available == 0) {
+        log_fatal("--start and --duration cannot be applied: the input is empty.");
+        return false;
+    }
+    if (out_range->first_frame >= available) {
+        log_fatal("--start %s is at or past the end of the input (%llu frames, %.3f s).",
+                  config->start_str_arg, available, (double)available / sample_rate_hz);
+        return false;
+    }
+    unsigned long long remaining = available - out_range->first_frame;
+
+    unsigned long long wanted = remaining;
+    if (duration->unit == RANGE_VALUE_SAMPLES) {
+        wanted = duration->samples;
+    } else if (duration->unit == RANGE_VALUE_SECONDS) {
+        wanted = _seconds_to_frames(duration->seconds, sample_rate_hz);
+    }
+    if (wanted == 0) {
+        log_fatal("--duration %s is shorter than one sample at %.0f Hz.", config->duration_str_arg, sample_rate_hz);
+        return false;
+    }
+    if (wanted > remaining) {
+        log_warn("--duration runs past the end of the input. Stopping at the end, after %llu frames.", remaining);
+        wanted = remaining;
+    }
+    out_range->num_frames = wanted;
+
+    log_info("Processing frames %llu to %llu (%.3f s to %.3f s) of %llu.",
+             out_range->first_frame, out_range->first_frame + out_range->num_frames,
+             (double)out_range->first_frame / sample_rate_hz,
+             (double)(out_range->first_frame + out_range->num_frames) / sample_rate_hz, available);
+    return true;
+}
+
+void input_range_add_summary_item(InputSummaryInfo* info, const InputRange* range, double sample_rate_hz) {
+    unsigned long long end_frame = range->first_frame + range->num_frames;
+    add_summary_item(info, "Input Range", "%.3f s to %.3f s (frames %llu to %llu of %llu)",
+                     (double)range->first_frame / sample_rate_hz, (double)end_frame / sample_rate_hz,
+                     range->first_frame, end_frame, range->total_frames);
+}
+
+// --- Static Helper Function Implementations ---
+
+/**
+ * @brief Converts a time offset to the nearest whole frame.
+ */
+static unsigned long long _seconds_to_frames(double seconds, double sample_rate_hz) {
+    double frames = round(seconds * sample_rate_hz);
+    if (frames <= 0.0) {
+        return 0;
+    }
+    if (frames >= 18446744073709551615.0) {
+        return ~0ULL;
+    }
+    return (unsigned long long)frames;
+}
@@ -12,6 +12,12 @@
 #include "ring_buffer.h"
 #include "argparse.h"
 #include "iq_correct.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "file_map.h"
+#include "file_readahead.h"
+#include "file_splice.h"
+#include "input_range.h"
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
@@ -44,6 +50,10 @@ static struct {
 // This is the private data structure for the Raw File input module.
 typedef struct {
     SNDFILE *infile;
+    int infile_fd; // -1 unless opened for --mmap-input, --read-ahead or --raw-passthrough
+    FileMap map;
+    FileReadahead* readahead;
+    InputRange range;
 } RawfilePrivateData;
 
 static const struct argparse_option rawfile_cli_options[] = {
@@ -112,6 +122,7 @@ static bool rawfile_initialize(ModuleContext* ctx) {
         return false;
     }
     resources->input_module_private_data = private_data;
+    private_data->infile_fd = -1;
 
     resources->input_format = utils_get_format_from_string(s_rawfile_config.format_str);
     if (resources->input_format == FORMAT_UNKNOWN) {
@@ -150,7 +161,11 @@ static bool rawfile_initialize(ModuleContext* ctx) {
     private_data->infile = sf_wchar_open(config->effective_input_filename_w, SFM_READ, &sfinfo);
 #else
     log_info("Opening RAW input file: %s", config->effective_input_filename);
-    private_data->infile = sf_open(config->effective_input_filename, SFM_READ, &sfinfo);
+    if (config->mmap_input || config->read_ahead_depth > 0 || config->raw_passthrough) {
+        private_data->infile = file_map_sf_open(config->effective_input_filename, &sfinfo, &private_data->infile_fd);
+    } else {
+        private_data->infile = sf_open(config->effective_input_filename, SFM_READ, &sfinfo);
+    }
 #endif
 
     if (!private_data->infile) {
@@ -162,6 +177,39 @@ static bool rawfile_initialize(ModuleContext* ctx) {
     resources->source_info.samplerate = sfinfo.samplerate;
     resources->source_info.frames = sfinfo.frames;
 
+    // A raw file carries no timestamp, so --start cannot be a UTC time.
+    if (!input_range_resolve(config, s_rawfile_config.sample_rate_hz, (long long)sfinfo.frames, false, 0, &private_data->range)) {
+        sf_close(private_data->infile);
+        private_data->infile = NULL;
+        return false;
+    }
+    if (private_data->range.limited) {
+        resources->source_info.frames = (long long)private_data->range.num_frames;
+        resources->input_start_frame = private_data->range.first_frame;
+    }
+
+    if (config->mmap_input) {
+        resources->input_is_mapped = file_map_open_sndfile(&private_data->map, private_data->infile, private_data->infile_fd,
+                                                           resources->input_bytes_per_sample_pair, &private_data->range);
+    } else if (config->read_ahead_depth > 0) {
+        unsigned long long data_offset;
+        unsigned long long data_bytes;
+        size_t bytes_per_pair = resources->input_bytes_per_sample_pair;
+        if (file_map_locate_data(private_data->infile, private_data->infile_fd, bytes_per_pair, &private_data->range,
+                                 &data_offset, &data_bytes)) {
+            private_data->readahead = file_readahead_create(config->effective_input_filename, data_offset, data_bytes, bytes_per_pair,
+                                                            resources->pipeline_chunk_base_samples * bytes_per_pair,
+                                                            (unsigned int)config->read_ahead_depth, config->direct_io);
+        }
+    }
+
+    // Leave the handle at the first frame, where I/Q calibration and the reader begin.
+    if (private_data->range.first_frame > 0 &&
+        sf_seek(private_data->infile, (sf_count_t)private_data->range.first_frame, SEEK_SET) < 0) {
+        log_fatal("Cannot seek to --start in the input file: %s", sf_strerror(private_data->infile));
+        return false;
+    }
+
     return true;
 }
 
@@ -179,20 +227,41 @@ static void* rawfile_start_stream(ModuleContext* ctx) {
         return NULL;
     }
 
+    if (config->raw_passthrough && file_splice_run_passthrough(ctx, private_data->infile, private_data->infile_fd, &private_data->range)) {
+        return NULL;
+    }
+
+    if (private_data->readahead) {
+        file_readahead_run_reader(ctx, private_data->readahead, config->raw_passthrough);
+        return NULL;
+    }
+
+    // Locating the data for the kernel copy rewinds the handle, so seek again.
+    if (!resources->input_is_mapped && private_data->range.first_frame > 0 &&
+        sf_seek(private_data->infile, (sf_count_t)private_data->range.first_frame, SEEK_SET) < 0) {
+        handle_fatal_thread_error("Cannot seek to --start in the input file.", resources);
+        return NULL;
+    }
+    unsigned long long frames_left = private_data->range.num_frames;
+
     bool pacing_required = resources->pacing_is_required;
 
-    // Pre-calculate the back-pressure threshold in bytes for efficiency.
-    const size_t writer_buffer_capacity = pacing_required ? ring_buffer_get_capacity(resources->writer_input_buffer) : 0;
-    const size_t writer_buffer_threshold = (size_t)(writer_buffer_capacity * IO_WRITER_BUFFER_HIGH_WATER_MARK);
+    // The back-pressure threshold is sized by the pipeline's memory plan so that
+    // every chunk still in flight fits in the ring after the reader pauses.
+    const size_t writer_buffer_threshold = resources->writer_backpressure_threshold_bytes;
 
     while (!is_shutdown_requested() && !resources->error_occurred) {
         if (pacing_required && (ring_buffer_get_size(resources->writer_input_buffer) > writer_buffer_threshold)) {
             // The writer is falling behind. Pause briefly to let it catch up.
+            unsigned long long pause_start = trace_is_enabled() ? get_monotonic_time_ns() : 0;
             #ifdef _WIN32
                 Sleep(10); // 10 ms
             #else
                 usleep(10000); // 10 ms
             #endif
+            if (pause_start) {
+                trace_span("wait", "pacing sleep", pause_start, get_monotonic_time_ns(), 0);
+            }
             continue; // Re-evaluate the buffer state in the next loop iteration.
         }
 
@@ -200,26 +269,46 @@ static void* rawfile_start_stream(ModuleContext* ctx) {
         if (!current_item) {
             break; // Shutdown or error signaled
         }
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_READER);
 
         current_item->stream_discontinuity_event = false;
+        current_item->capture_time_ns = get_monotonic_time_ns();
 
         void* target_buffer;
         size_t bytes_to_read;
         if (config->raw_passthrough) {
             target_buffer = current_item->final_output_data;
             bytes_to_read = current_item->final_output_capacity_bytes;
+        } else if (resources->input_is_mapped) {
+            target_buffer = NULL; // The chunk points straight into the mapping.
+            bytes_to_read = resources->pipeline_chunk_base_samples * resources->input_bytes_per_sample_pair;
         } else {
             target_buffer = current_item->raw_input_data;
             bytes_to_read = current_item->raw_input_capacity_bytes;
         }
 
-        int64_t bytes_read = sf_read_raw(private_data->infile, target_buffer, bytes_to_read);
+        int64_t bytes_read;
+        if (resources->input_is_mapped) {
+            const unsigned char* mapped_data;
+            bytes_read = (int64_t)file_map_next(&private_data->map, bytes_to_read, &mapped_data);
+            if (target_buffer) {
+                if (bytes_read > 0) {
+                    memcpy(target_buffer, mapped_data, (size_t)bytes_read);
+                }
+            } else {
+                current_item->mapped_input_data = mapped_data;
+            }
+        } else {
+            // Stop exactly at the end of a --duration range.
+            if (private_data->range.limited && frames_left * resources->input_bytes_per_sample_pair < bytes_to_read) {
+                bytes_to_read = (size_t)frames_left * resources->input_bytes_per_sample_pair;
+            }
+            bytes_read = (bytes_to_read > 0) ? sf_read_raw(private_data->infile, target_buffer, bytes_to_read) : 0;
+        }
 
         if (bytes_read < 0) {
             log_fatal("libsndfile read error: %s", sf_strerror(private_data->infile));
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->error_occurred = true;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_store(&resources->error_occurred, true);
             request_shutdown();
             queue_enqueue(resources->free_sample_chunk_queue, current_item);
             break;
@@ -237,10 +326,11 @@ static void* rawfile_start_stream(ModuleContext* ctx) {
         current_item->frames_read = bytes_read / resources->input_bytes_per_sample_pair;
         current_item->packet_sample_format = resources->input_format;
         current_item->is_last_chunk = false;
+        unsigned long long frames_consumed = (unsigned long long)current_item->frames_read;
+        frames_left -= (frames_consumed < frames_left) ? frames_consumed : frames_left;
 
-        pthread_mutex_lock(&resources->progress_mutex);
-        resources->total_frames_read += current_item->frames_read;
-        pthread_mutex_unlock(&resources->progress_mutex);
+        atomic_fetch_add_explicit(&resources->total_frames_read, current_item->frames_read, memory_order_relaxed);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_READER, current_item->frames_read);
 
         if (!queue_enqueue(resources->reader_output_queue, current_item)) {
             queue_enqueue(resources->free_sample_chunk_queue, current_item);
@@ -259,6 +349,10 @@ static void rawfile_cleanup(ModuleContext* ctx) {
     AppResources *resources = ctx->resources;
     if (resources->input_module_private_data) {
         RawfilePrivateData* private_data = (RawfilePrivateData*)resources->input_module_private_data;
+        file_map_close(&private_data->map);
+        resources->input_is_mapped = false;
+        file_readahead_destroy(private_data->readahead);
+        private_data->readahead = NULL;
         if (private_data->infile) {
             log_info("Closing RAW input file.");
             sf_close(private_data->infile);
@@ -271,6 +365,7 @@ static void rawfile_cleanup(ModuleContext* ctx) {
 static void rawfile_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info) {
     const AppConfig *config = ctx->config;
     const AppResources *resources = ctx->resources;
+    const RawfilePrivateData* private_data = (const RawfilePrivateData*)resources->input_module_private_data;
     const char* display_path = config->input_filename_arg;
 #ifdef _WIN32
     if (config->effective_input_filename_utf8[0] != '\0') {
@@ -284,8 +379,16 @@ static void rawfile_get_summary_info(const ModuleContext* ctx, InputSummaryInfo*
     add_summary_item(info, "Input Rate", "%.0f Hz", s_rawfile_config.sample_rate_hz);
 
     char size_buf[40];
-    long long file_size_bytes = resources->source_info.frames * resources->input_bytes_per_sample_pair;
+    long long file_size_bytes = (long long)private_data->range.total_frames * (long long)resources->input_bytes_per_sample_pair;
     add_summary_item(info, "Input File Size", "%s", format_file_size(file_size_bytes, size_buf, sizeof(size_buf)));
+    if (resources->input_is_mapped) {
+        add_summary_item(info, "Input Reads", "%s", "Memory-mapped");
+    } else if (private_data->readahead) {
+        add_summary_item(info, "Input Reads", "Read-ahead (%s)", file_readahead_describe(private_data->readahead));
+    }
+    if (private_data->range.limited) {
+        input_range_add_summary_item(info, &private_data->range, s_rawfile_config.sample_rate_hz);
+    }
 }
 
 static bool rawfile_pre_stream_iq_correction(ModuleContext* ctx) {
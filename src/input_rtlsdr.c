@@ -328,7 +328,7 @@ static void* rtlsdr_start_stream(ModuleContext* ctx) {
                     if (!item) break;
 
                     int n_read = 0;
-                    size_t bytes_to_read = PIPELINE_CHUNK_BASE_SAMPLES * resources->input_bytes_per_sample_pair;
+                    size_t bytes_to_read = resources->pipeline_chunk_base_samples * resources->input_bytes_per_sample_pair;
                     result = rtlsdr_read_sync(private_data->dev, item->raw_input_data, bytes_to_read, &n_read);
 
                     if (result >= 0) {
@@ -347,14 +347,13 @@ static void* rtlsdr_start_stream(ModuleContext* ctx) {
                     }
 
                     item->frames_read = n_read / resources->input_bytes_per_sample_pair;
+                    item->capture_time_ns = get_monotonic_time_ns();
                     item->is_last_chunk = false;
                     item->stream_discontinuity_event = false;
 		            item->packet_sample_format = resources->input_format;
 
                     if (item->frames_read > 0) {
-                        pthread_mutex_lock(&resources->progress_mutex);
-                        resources->total_frames_read += item->frames_read;
-                        pthread_mutex_unlock(&resources->progress_mutex);
+                        atomic_fetch_add_explicit(&resources->total_frames_read, item->frames_read, memory_order_relaxed);
                         if (!queue_enqueue(resources->reader_output_queue, item)) {
                             queue_enqueue(resources->free_sample_chunk_queue, item);
                             break;
@@ -12,6 +12,7 @@
 #include "queue.h"
 #include "ring_buffer.h"
 #include "sdr_packet_serializer.h"
+#include "telemetry.h"
 #include "argparse.h"
 #include <stdio.h>
 #include <string.h>
@@ -426,9 +427,9 @@ static void sdrplay_realtime_stream_callback(short *xi, short *xq, sdrplay_api_S
         }
         item->stream_discontinuity_event = false;
         size_t samples_to_copy = numSamples;
-        if (samples_to_copy > PIPELINE_CHUNK_BASE_SAMPLES) {
+        if (samples_to_copy > resources->pipeline_chunk_base_samples) {
             log_warn("SDRplay callback provided more samples than buffer can hold. Truncating.");
-            samples_to_copy = PIPELINE_CHUNK_BASE_SAMPLES;
+            samples_to_copy = resources->pipeline_chunk_base_samples;
         }
         int16_t *raw_buffer = (int16_t*)item->raw_input_data;
         for (unsigned int i = 0; i < samples_to_copy; i++) {
@@ -436,13 +437,12 @@ static void sdrplay_realtime_stream_callback(short *xi, short *xq, sdrplay_api_S
             raw_buffer[i * 2 + 1] = xq[i];
         }
         item->frames_read = samples_to_copy;
+        item->capture_time_ns = get_monotonic_time_ns();
         item->is_last_chunk = false;
 	    item->packet_sample_format = resources->input_format;
 
         if (samples_to_copy > 0) {
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->total_frames_read += samples_to_copy;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_fetch_add_explicit(&resources->total_frames_read, samples_to_copy, memory_order_relaxed);
         }
         if (!queue_enqueue(resources->reader_output_queue, item)) {
             queue_enqueue(resources->free_sample_chunk_queue, item);
@@ -467,9 +467,11 @@ static void sdrplay_buffered_stream_callback(short *xi, short *xq, sdrplay_api_S
     }
 
     if (numSamples > 0) {
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE);
         if (!sdr_packet_serializer_write_deinterleaved_chunk(resources->sdr_input_buffer, numSamples, xi, xq, CS16)) {
             log_warn("SDR input buffer overrun! Dropped data.");
         }
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE, numSamples);
     }
 }
 
@@ -0,0 +1,638 @@
+#include "input_simsdr.h"
+#include "input_generator.h"
+#include "module.h"
+#include "constants.h"
+#include "log.h"
+#include "signal_handler.h"
+#include "app_context.h"
+#include "utils.h"
+#include "sample_convert.h"
+#include "input_common.h"
+#include "memory_arena.h"
+#include "queue.h"
+#include "sdr_packet_serializer.h"
+#include "argparse.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <strings.h>
+#include <unistd.h> // For usleep
+#else
+#include <windows.h> // For Sleep
+#endif
+
+#ifdef _WIN32
+#define strcasecmp _stricmp
+#endif
+
+typedef enum {
+    SIMSDR_PACKETS_INTERLEAVED,   // One [I, Q, I, Q, ...] buffer per callback, like RTL-SDR.
+    SIMSDR_PACKETS_DEINTERLEAVED  // Separate I and Q arrays per callback, like SDRplay.
+} SimSdrPacketLayout;
+
+// --- Private Module Configuration ---
+static struct {
+    const char* file_path;
+    const char* format_str;
+    const char* mode_str;
+    const char* packets_str;
+    float sample_rate_hz_arg;
+    int   burst_samples_arg;
+    int   jitter_us_arg;
+    int   stall_ms_arg;
+    float stall_every_sec_arg;
+    int   stall_reset;
+    float duration_sec_arg;
+    int   loop;
+    PipelineMode mode;
+    SimSdrPacketLayout packets;
+} s_simsdr_config = {
+    .format_str = "cs16",
+    .mode_str = "buffered",
+    .packets_str = "interleaved",
+    .sample_rate_hz_arg = (float)SIMSDR_DEFAULT_SAMPLE_RATE_HZ,
+    .burst_samples_arg = SIMSDR_DEFAULT_BURST_SAMPLES,
+};
+
+// --- Private Module State ---
+typedef struct {
+    FILE* file;                           // NULL when the signal is synthesized instead.
+    GeneratorSource* signal;              // The --gen-* signal, when there is no file.
+    double sample_rate_hz;
+    unsigned long long total_frames;      // 0 when the stream runs until stopped (or the file ends).
+    uint64_t rng_state;                   // Callback jitter.
+
+    // Per-callback buffers, as a driver would hand them to its callback.
+    unsigned char* burst_buffer;          // Interleaved samples in the input format.
+    short* i_buffer;                      // De-interleaved layout only.
+    short* q_buffer;
+    complex_float_t* signal_buffer;       // Synthesized signal only.
+
+    atomic_bool stop_requested;
+
+    // Statistics, reported when the stream ends.
+    unsigned long long callbacks;
+    unsigned long long frames_delivered;
+    unsigned long long frames_dropped;
+    unsigned long long stalls_injected;
+} SimSdrPrivateData;
+
+static const struct argparse_option simsdr_cli_options[] = {
+    OPT_GROUP("Simulated SDR Input Options"),
+    OPT_STRING(0, "sim-file", &s_simsdr_config.file_path, "(Optional) Raw interleaved I/Q file to replay. (Default: synthesize the --gen-* signal)", NULL, 0, 0),
+    OPT_STRING(0, "sim-sample-format", &s_simsdr_config.format_str, "Sample format of the simulated device. (Default: cs16)", NULL, 0, 0),
+    OPT_FLOAT(0, "sim-rate", &s_simsdr_config.sample_rate_hz_arg, "Sample rate of the simulated device in Hz. (Default: 2048000)", NULL, 0, 0),
+    OPT_STRING(0, "sim-mode", &s_simsdr_config.mode_str, "SDR pipeline mode to run {buffered|realtime}. (Default: buffered)", NULL, 0, 0),
+    OPT_STRING(0, "sim-packets", &s_simsdr_config.packets_str, "Callback data layout {interleaved|deinterleaved}. De-interleaved requires cs16. (Default: interleaved)", NULL, 0, 0),
+    OPT_INTEGER(0, "sim-burst", &s_simsdr_config.burst_samples_arg, "Samples delivered per driver callback. (Default: 16384)", NULL, 0, 0),
+    OPT_INTEGER(0, "sim-jitter-us", &s_simsdr_config.jitter_us_arg, "(Optional) Delay each callback by a random 0 to N microseconds.", NULL, 0, 0),
+    OPT_INTEGER(0, "sim-stall-ms", &s_simsdr_config.stall_ms_arg, "(Optional) Length of each injected stall in milliseconds.", NULL, 0, 0),
+    OPT_FLOAT(0, "sim-stall-every", &s_simsdr_config.stall_every_sec_arg, "(Optional) Inject a stall after every N seconds of signal.", NULL, 0, 0),
+    OPT_BOOLEAN(0, "sim-stall-reset", &s_simsdr_config.stall_reset, "Drop the samples missed during a stall and signal a stream reset, instead of delivering the backlog late.", NULL, 0, 0),
+    OPT_FLOAT(0, "sim-duration", &s_simsdr_config.duration_sec_arg, "Stop after this many seconds of signal. (Default: run until stopped)", NULL, 0, 0),
+    OPT_BOOLEAN(0, "sim-loop", &s_simsdr_config.loop, "Replay --sim-file from the start when it ends.", NULL, 0, 0),
+};
+
+const struct argparse_option* simsdr_get_cli_options(int* count) {
+    *count = sizeof(simsdr_cli_options) / sizeof(simsdr_cli_options[0]);
+    return simsdr_cli_options;
+}
+
+static bool simsdr_initialize(ModuleContext* ctx);
+static void* simsdr_start_stream(ModuleContext* ctx);
+static void simsdr_stop_stream(ModuleContext* ctx);
+static void simsdr_cleanup(ModuleContext* ctx);
+static void simsdr_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info);
+static bool simsdr_validate_options(AppConfig* config);
+static bool simsdr_has_known_length(void);
+static void simsdr_interleaved_stream_callback(unsigned char *buf, uint32_t len, bool reset, void *cb_ctx);
+static void simsdr_deinterleaved_stream_callback(short *xi, short *xq, unsigned int numSamples, bool reset, void *cb_ctx);
+
+static InputModuleInterface simsdr_module_api = {
+    .initialize = simsdr_initialize,
+    .start_stream = simsdr_start_stream,
+    .stop_stream = simsdr_stop_stream,
+    .cleanup = simsdr_cleanup,
+    .get_summary_info = simsdr_get_summary_info,
+    .validate_options = simsdr_validate_options,
+    .validate_generic_options = NULL,
+    .has_known_length = simsdr_has_known_length,
+    .pre_stream_iq_correction = NULL
+};
+
+InputModuleInterface* get_simsdr_input_module_api(void) {
+    return &simsdr_module_api;
+}
+
+// --- Private Helper Functions ---
+
+static bool _stream_should_stop(AppResources* resources, SimSdrPrivateData* data) {
+    return is_shutdown_requested() || resources->error_occurred ||
+           atomic_load_explicit(&data->stop_requested, memory_order_relaxed);
+}
+
+/**
+ * @brief Sleeps until the given monotonic time, waking regularly to check for a stop.
+ * @return false if the stream was stopped while waiting.
+ */
+static bool _sleep_until(AppResources* resources, SimSdrPrivateData* data, unsigned long long due_ns) {
+    const unsigned long long slice_ns = (unsigned long long)SIMSDR_SLEEP_SLICE_MS * 1000000ULL;
+    while (!_stream_should_stop(resources, data)) {
+        unsigned long long now_ns = get_monotonic_time_ns();
+        if (now_ns >= due_ns) {
+            return true;
+        }
+        unsigned long long wait_ns = due_ns - now_ns;
+        if (wait_ns > slice_ns) wait_ns = slice_ns;
+#ifdef _WIN32
+        Sleep((DWORD)(wait_ns / 1000000ULL));
+#else
+        usleep((useconds_t)(wait_ns / 1000ULL));
+#endif
+    }
+    return false;
+}
+
+/**
+ * @brief Fills the burst buffer with the next samples from the file or the generated signal.
+ * @return The number of frames produced. Less than requested only at the end of the file.
+ */
+static size_t _read_source(SimSdrPrivateData* data, size_t num_frames, size_t bytes_per_pair, format_t format) {
+    if (!data->file) {
+        generator_source_generate(data->signal, data->signal_buffer, num_frames);
+        convert_cf32_to_block(data->signal_buffer, data->burst_buffer, num_frames, format);
+        return num_frames;
+    }
+
+    size_t done = 0;
+    bool rewound = false;
+    while (done < num_frames) {
+        size_t got = fread(data->burst_buffer + done * bytes_per_pair, bytes_per_pair, num_frames - done, data->file);
+        done += got;
+        if (done == num_frames) break;
+
+        // Stop on a read error, at the end of the file, or if the file holds no whole sample pair.
+        if (ferror(data->file) || !s_simsdr_config.loop || (rewound && got == 0)) {
+            break;
+        }
+        rewind(data->file);
+        rewound = true;
+    }
+    return done;
+}
+
+/**
+ * @brief Realtime mode: copies interleaved samples into free chunks and queues them.
+ *
+ * A real device cannot wait for the pipeline, so samples are dropped when no
+ * chunk is free, as the SDRplay real-time callback does.
+ */
+static void _realtime_enqueue_interleaved(AppResources* resources, const unsigned char* data, size_t num_frames) {
+    const size_t bytes_per_pair = resources->input_bytes_per_sample_pair;
+    size_t frames_done = 0;
+
+    while (frames_done < num_frames) {
+        SampleChunk *item = (SampleChunk*)queue_try_dequeue(resources->free_sample_chunk_queue);
+        if (!item) {
+            log_warn("Real-time pipeline stalled. Dropping %zu samples.", num_frames - frames_done);
+            return;
+        }
+
+        size_t frames_this_chunk = num_frames - frames_done;
+        if (frames_this_chunk > resources->pipeline_chunk_base_samples) {
+            frames_this_chunk = resources->pipeline_chunk_base_samples;
+        }
+        memcpy(item->raw_input_data, data + frames_done * bytes_per_pair, frames_this_chunk * bytes_per_pair);
+
+        item->frames_read = frames_this_chunk;
+        item->capture_time_ns = get_monotonic_time_ns();
+        item->is_last_chunk = false;
+        item->stream_discontinuity_event = false;
+        item->packet_sample_format = resources->input_format;
+
+        atomic_fetch_add_explicit(&resources->total_frames_read, item->frames_read, memory_order_relaxed);
+        if (!queue_enqueue(resources->reader_output_queue, item)) {
+            queue_enqueue(resources->free_sample_chunk_queue, item);
+            return;
+        }
+        frames_done += frames_this_chunk;
+    }
+}
+
+/**
+ * @brief Realtime mode: sends a stream discontinuity down the pipeline.
+ */
+static void _realtime_send_reset(AppResources* resources) {
+    SampleChunk* reset_item = (SampleChunk*)queue_dequeue(resources->free_sample_chunk_queue);
+    if (reset_item) {
+        reset_item->stream_discontinuity_event = true;
+        reset_item->is_last_chunk = false;
+        reset_item->frames_read = 0;
+        if (!queue_enqueue(resources->reader_output_queue, reset_item)) {
+            queue_enqueue(resources->free_sample_chunk_queue, reset_item);
+        }
+    }
+}
+
+/**
+ * @brief Realtime mode with --raw-passthrough: hands the samples straight to the output module.
+ */
+static void _realtime_passthrough(AppResources* resources, const void* data, size_t bytes) {
+    ModuleContext ctx = { .config = resources->config, .resources = resources };
+    size_t written = resources->selected_output_module_api->write_chunk(&ctx, data, bytes);
+    if (written < bytes) {
+        log_debug("Real-time passthrough: stdout write error, consumer likely closed pipe.");
+        request_shutdown();
+    }
+}
+
+// --- Simulated Driver Callbacks ---
+// These follow rtlsdr_stream_callback and the SDRplay stream callbacks. The
+// only addition is the reset flag on the interleaved callback, which the
+// RTL-SDR driver does not have, so that --sim-stall-reset works for both layouts.
+
+static void simsdr_interleaved_stream_callback(unsigned char *buf, uint32_t len, bool reset, void *cb_ctx) {
+    AppResources *resources = (AppResources*)cb_ctx;
+
+    // --- HEARTBEAT ---
+    sdr_input_update_heartbeat(resources);
+
+    if (is_shutdown_requested() || resources->error_occurred) {
+        return;
+    }
+
+    if (resources->pipeline_mode == PIPELINE_MODE_BUFFERED_SDR) {
+        if (reset) {
+            log_info("Simulated SDR stream reset (buffered mode), sending event.");
+            sdr_packet_serializer_write_reset_event(resources->sdr_input_buffer);
+        }
+        // Simply hand off the entire buffer to the reusable chunker.
+        sdr_write_interleaved_chunks(resources, buf, len, resources->input_bytes_per_sample_pair, resources->input_format);
+        return;
+    }
+
+    if (reset && !resources->config->raw_passthrough) {
+        log_info("Simulated SDR stream reset. Sending reset command to pipeline.");
+        _realtime_send_reset(resources);
+    }
+    if (resources->config->raw_passthrough) {
+        _realtime_passthrough(resources, buf, len);
+    } else {
+        _realtime_enqueue_interleaved(resources, buf, len / resources->input_bytes_per_sample_pair);
+    }
+}
+
+static void simsdr_deinterleaved_stream_callback(short *xi, short *xq, unsigned int numSamples, bool reset, void *cb_ctx) {
+    AppResources *resources = (AppResources*)cb_ctx;
+
+    // --- HEARTBEAT ---
+    sdr_input_update_heartbeat(resources);
+
+    if (is_shutdown_requested() || resources->error_occurred) {
+        return;
+    }
+
+    if (resources->pipeline_mode == PIPELINE_MODE_BUFFERED_SDR) {
+        if (reset) {
+            log_info("Simulated SDR stream reset (buffered mode), sending event.");
+            sdr_packet_serializer_write_reset_event(resources->sdr_input_buffer);
+        }
+        if (numSamples > 0) {
+            telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE);
+            if (!sdr_packet_serializer_write_deinterleaved_chunk(resources->sdr_input_buffer, numSamples, xi, xq, CS16)) {
+                log_warn("SDR input buffer overrun! Dropped data.");
+            }
+            telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE, numSamples);
+        }
+        return;
+    }
+
+    if (reset && !resources->config->raw_passthrough) {
+        log_info("Simulated SDR stream reset. Sending reset command to pipeline.");
+        _realtime_send_reset(resources);
+    }
+
+    // Interleave in pieces, as the real-time callbacks do before queueing or writing.
+    int16_t temp_buffer[8192];
+    const unsigned int pairs_per_piece = (unsigned int)(sizeof(temp_buffer) / sizeof(int16_t) / 2);
+    unsigned int samples_processed = 0;
+    while (samples_processed < numSamples && !is_shutdown_requested()) {
+        unsigned int samples_this_piece = numSamples - samples_processed;
+        if (samples_this_piece > pairs_per_piece) {
+            samples_this_piece = pairs_per_piece;
+        }
+        for (unsigned int i = 0; i < samples_this_piece; i++) {
+            temp_buffer[i * 2]     = xi[samples_processed + i];
+            temp_buffer[i * 2 + 1] = xq[samples_processed + i];
+        }
+        if (resources->config->raw_passthrough) {
+            _realtime_passthrough(resources, temp_buffer, samples_this_piece * resources->input_bytes_per_sample_pair);
+        } else {
+            _realtime_enqueue_interleaved(resources, (const unsigned char*)temp_buffer, samples_this_piece);
+        }
+        samples_processed += samples_this_piece;
+    }
+}
+
+/**
+ * @brief Hands one burst to the simulated driver callback for the selected layout.
+ */
+static void _deliver_burst(AppResources* resources, SimSdrPrivateData* data, size_t num_frames, bool reset) {
+    if (s_simsdr_config.packets == SIMSDR_PACKETS_DEINTERLEAVED) {
+        const int16_t* interleaved = (const int16_t*)data->burst_buffer;
+        for (size_t i = 0; i < num_frames; i++) {
+            data->i_buffer[i] = interleaved[i * 2];
+            data->q_buffer[i] = interleaved[i * 2 + 1];
+        }
+        simsdr_deinterleaved_stream_callback(data->i_buffer, data->q_buffer, (unsigned int)num_frames, reset, resources);
+    } else {
+        simsdr_interleaved_stream_callback(data->burst_buffer, (uint32_t)(num_frames * resources->input_bytes_per_sample_pair), reset, resources);
+    }
+    data->callbacks++;
+}
+
+// --- Module Implementation ---
+
+static bool simsdr_validate_options(AppConfig* config) {
+    (void)config;
+
+    if (strcasecmp(s_simsdr_config.mode_str, "buffered") == 0) {
+        s_simsdr_config.mode = PIPELINE_MODE_BUFFERED_SDR;
+    } else if (strcasecmp(s_simsdr_config.mode_str, "realtime") == 0) {
+        s_simsdr_config.mode = PIPELINE_MODE_REALTIME_SDR;
+    } else {
+        log_fatal("Invalid value for --sim-mode: '%s'. Must be one of {buffered|realtime}.", s_simsdr_config.mode_str);
+        return false;
+    }
+
+    if (strcasecmp(s_simsdr_config.packets_str, "interleaved") == 0) {
+        s_simsdr_config.packets = SIMSDR_PACKETS_INTERLEAVED;
+    } else if (strcasecmp(s_simsdr_config.packets_str, "deinterleaved") == 0) {
+        s_simsdr_config.packets = SIMSDR_PACKETS_DEINTERLEAVED;
+    } else {
+        log_fatal("Invalid value for --sim-packets: '%s'. Must be one of {interleaved|deinterleaved}.", s_simsdr_config.packets_str);
+        return false;
+    }
+
+    format_t format = utils_get_format_from_string(s_simsdr_config.format_str);
+    if (format == FORMAT_UNKNOWN) {
+        log_fatal("Invalid simulated SDR format '%s'. See --help for valid formats.", s_simsdr_config.format_str);
+        return false;
+    }
+    if (s_simsdr_config.packets == SIMSDR_PACKETS_DEINTERLEAVED && format != CS16) {
+        log_fatal("--sim-packets deinterleaved requires --sim-sample-format cs16.");
+        return false;
+    }
+
+    if (s_simsdr_config.sample_rate_hz_arg <= 0.0f) {
+        log_fatal("--sim-rate must be a positive sample rate in Hz.");
+        return false;
+    }
+    if (!s_simsdr_config.file_path && !generator_validate_signal_options((double)s_simsdr_config.sample_rate_hz_arg)) {
+        return false;
+    }
+    if (s_simsdr_config.burst_samples_arg < 1 || s_simsdr_config.burst_samples_arg > SIMSDR_MAX_BURST_SAMPLES) {
+        log_fatal("--sim-burst must be between 1 and %d samples.", SIMSDR_MAX_BURST_SAMPLES);
+        return false;
+    }
+    if (s_simsdr_config.jitter_us_arg < 0) {
+        log_fatal("--sim-jitter-us cannot be negative.");
+        return false;
+    }
+    if (s_simsdr_config.stall_ms_arg < 0 || s_simsdr_config.stall_every_sec_arg < 0.0f) {
+        log_fatal("--sim-stall-ms and --sim-stall-every cannot be negative.");
+        return false;
+    }
+    if ((s_simsdr_config.stall_ms_arg > 0) != (s_simsdr_config.stall_every_sec_arg > 0.0f)) {
+        log_fatal("--sim-stall-ms and --sim-stall-every must be used together.");
+        return false;
+    }
+    if (s_simsdr_config.duration_sec_arg < 0.0f) {
+        log_fatal("--sim-duration cannot be negative.");
+        return false;
+    }
+    if (s_simsdr_config.loop && !s_simsdr_config.file_path) {
+        log_fatal("--sim-loop requires --sim-file.");
+        return false;
+    }
+
+    return true;
+}
+
+static bool simsdr_has_known_length(void) {
+    return s_simsdr_config.duration_sec_arg > 0.0f;
+}
+
+static bool simsdr_initialize(ModuleContext* ctx) {
+    const AppConfig *config = ctx->config;
+    AppResources *resources = ctx->resources;
+
+    SimSdrPrivateData* private_data = (SimSdrPrivateData*)mem_arena_alloc(&resources->setup_arena, sizeof(SimSdrPrivateData), true);
+    if (!private_data) {
+        return false;
+    }
+    atomic_init(&private_data->stop_requested, false);
+    resources->input_module_private_data = private_data;
+
+    resources->input_format = utils_get_format_from_string(s_simsdr_config.format_str);
+    resources->input_bytes_per_sample_pair = get_bytes_per_sample(resources->input_format);
+    if (resources->input_bytes_per_sample_pair == 0) {
+        log_fatal("Internal error: could not determine sample size for format '%s'.", s_simsdr_config.format_str);
+        return false;
+    }
+
+    if (config->raw_passthrough && resources->input_format != config->output_format) {
+        log_fatal("Option --raw-passthrough requires input and output formats to be identical. Simulated SDR input is '%s', but output was set to '%s'.",
+                  s_simsdr_config.format_str, config->output_sample_format_name);
+        return false;
+    }
+
+    // The pipeline sizes its buffers and picks its threads from this, so it must be set before pipeline_run().
+    resources->pipeline_mode = s_simsdr_config.mode;
+
+    if (s_simsdr_config.file_path) {
+        private_data->file = fopen(s_simsdr_config.file_path, "rb");
+        if (!private_data->file) {
+            log_fatal("Failed to open simulated SDR file '%s': %s", s_simsdr_config.file_path, strerror(errno));
+            return false;
+        }
+    }
+
+    const size_t burst = (size_t)s_simsdr_config.burst_samples_arg;
+    private_data->burst_buffer = (unsigned char*)mem_arena_alloc(&resources->setup_arena, burst * resources->input_bytes_per_sample_pair, false);
+    if (!private_data->burst_buffer) {
+        return false;
+    }
+    if (s_simsdr_config.packets == SIMSDR_PACKETS_DEINTERLEAVED) {
+        private_data->i_buffer = (short*)mem_arena_alloc(&resources->setup_arena, burst * sizeof(short), false);
+        private_data->q_buffer = (short*)mem_arena_alloc(&resources->setup_arena, burst * sizeof(short), false);
+        if (!private_data->i_buffer || !private_data->q_buffer) {
+            return false;
+        }
+    }
+    private_data->sample_rate_hz = (double)s_simsdr_config.sample_rate_hz_arg;
+    if (!private_data->file) {
+        private_data->signal = generator_source_create(&resources->setup_arena, private_data->sample_rate_hz);
+        private_data->signal_buffer = (complex_float_t*)mem_arena_alloc(&resources->setup_arena, burst * sizeof(complex_float_t), false);
+        if (!private_data->signal || !private_data->signal_buffer) {
+            return false;
+        }
+    }
+
+    private_data->rng_state = 0x9E3779B97F4A7C15ULL; // Fixed seed: the jitter pattern is reproducible.
+    if (s_simsdr_config.duration_sec_arg > 0.0f) {
+        private_data->total_frames = (unsigned long long)((double)s_simsdr_config.duration_sec_arg * private_data->sample_rate_hz);
+    }
+
+    resources->source_info.samplerate = (int)private_data->sample_rate_hz;
+    resources->source_info.frames = (private_data->total_frames > 0) ? (long long)private_data->total_frames : -1;
+
+    log_info("Simulated SDR: replaying %s at %.0f Hz (%s), %s packets, %s mode.",
+             s_simsdr_config.file_path ? s_simsdr_config.file_path : "a generated signal", private_data->sample_rate_hz,
+             s_simsdr_config.format_str, s_simsdr_config.packets_str, s_simsdr_config.mode_str);
+    return true;
+}
+
+static void* simsdr_start_stream(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    SimSdrPrivateData* private_data = (SimSdrPrivateData*)resources->input_module_private_data;
+
+    const size_t bytes_per_pair = resources->input_bytes_per_sample_pair;
+    const double ns_per_frame = 1e9 / private_data->sample_rate_hz;
+    const unsigned long long stall_every_frames =
+        (unsigned long long)((double)s_simsdr_config.stall_every_sec_arg * private_data->sample_rate_hz);
+    const unsigned long long stall_ns = (unsigned long long)s_simsdr_config.stall_ms_arg * 1000000ULL;
+    const unsigned long long stall_frames = (unsigned long long)((double)stall_ns / ns_per_frame);
+
+    log_info("Starting simulated SDR stream (%s Mode)...",
+             resources->pipeline_mode == PIPELINE_MODE_BUFFERED_SDR ? "Buffered" : "Real-Time");
+
+    // stream_frames is the device's position in time: it includes samples lost to stalls.
+    unsigned long long stream_frames = 0;
+    unsigned long long next_stall_frames = stall_every_frames;
+    bool pending_reset = false;
+    const unsigned long long stream_start_ns = get_monotonic_time_ns();
+
+    while (!_stream_should_stop(resources, private_data)) {
+        size_t burst = (size_t)s_simsdr_config.burst_samples_arg;
+        if (private_data->total_frames > 0) {
+            if (stream_frames >= private_data->total_frames) break;
+            if (private_data->total_frames - stream_frames < burst) {
+                burst = (size_t)(private_data->total_frames - stream_frames);
+            }
+        }
+
+        if (stall_every_frames > 0 && stream_frames >= next_stall_frames) {
+            // The device goes quiet: no callbacks, and so no heartbeats either.
+            next_stall_frames += stall_every_frames;
+            private_data->stalls_injected++;
+            log_debug("Simulated SDR: injecting a %d ms stall.", s_simsdr_config.stall_ms_arg);
+            if (!_sleep_until(resources, private_data, get_monotonic_time_ns() + stall_ns)) break;
+
+            if (s_simsdr_config.stall_reset) {
+                // The samples the device could not deliver are gone; it restarts the stream.
+                unsigned long long skipped = 0;
+                while (skipped < stall_frames) {
+                    size_t skip = (stall_frames - skipped > burst) ? burst : (size_t)(stall_frames - skipped);
+                    size_t got = _read_source(private_data, skip, bytes_per_pair, resources->input_format);
+                    skipped += got;
+                    if (got < skip) break;
+                }
+                stream_frames += stall_frames;
+                private_data->frames_dropped += stall_frames;
+                pending_reset = true;
+                continue;
+            }
+            // Otherwise the schedule is unchanged, so the backlog arrives late in back-to-back bursts.
+        }
+
+        // A burst can only be delivered once its last sample has been "captured".
+        unsigned long long due_ns = stream_start_ns + (unsigned long long)((double)(stream_frames + burst) * ns_per_frame);
+        if (s_simsdr_config.jitter_us_arg > 0) {
+            due_ns += (utils_rng_next(&private_data->rng_state) % ((uint64_t)s_simsdr_config.jitter_us_arg + 1)) * 1000ULL;
+        }
+        if (!_sleep_until(resources, private_data, due_ns)) break;
+
+        size_t frames = _read_source(private_data, burst, bytes_per_pair, resources->input_format);
+        if (frames == 0) {
+            break; // End of the file.
+        }
+
+        _deliver_burst(resources, private_data, frames, pending_reset);
+        pending_reset = false;
+        stream_frames += frames;
+        private_data->frames_delivered += frames;
+
+        if (frames < burst) {
+            break; // The file ended mid-burst.
+        }
+    }
+
+    if (private_data->file && ferror(private_data->file)) {
+        char error_buf[256];
+        snprintf(error_buf, sizeof(error_buf), "Simulated SDR: read error on '%s'.", s_simsdr_config.file_path);
+        handle_fatal_thread_error(error_buf, resources);
+    }
+
+    log_info("Simulated SDR: delivered %llu samples in %llu callbacks, %llu stall(s) injected, %llu samples dropped.",
+             private_data->frames_delivered, private_data->callbacks, private_data->stalls_injected, private_data->frames_dropped);
+
+    if (resources->pipeline_mode == PIPELINE_MODE_REALTIME_SDR) {
+        SampleChunk *last_item = (SampleChunk*)queue_dequeue(resources->free_sample_chunk_queue);
+        if (last_item) {
+            last_item->is_last_chunk = true;
+            last_item->frames_read = 0;
+            queue_enqueue(resources->reader_output_queue, last_item);
+        }
+    }
+    // In buffered mode, the SDR capture thread signals the end of the stream once this returns.
+    return NULL;
+}
+
+static void simsdr_stop_stream(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    SimSdrPrivateData* private_data = (SimSdrPrivateData*)resources->input_module_private_data;
+    if (private_data) {
+        log_info("Stopping simulated SDR stream...");
+        atomic_store_explicit(&private_data->stop_requested, true, memory_order_relaxed);
+    }
+}
+
+static void simsdr_cleanup(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    if (resources->input_module_private_data) {
+        SimSdrPrivateData* private_data = (SimSdrPrivateData*)resources->input_module_private_data;
+        if (private_data->file) {
+            fclose(private_data->file);
+            private_data->file = NULL;
+        }
+        // Everything else lives in the setup arena.
+        resources->input_module_private_data = NULL;
+    }
+}
+
+static void simsdr_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info) {
+    (void)ctx;
+    add_summary_item(info, "Input Type", "SIMULATED SDR");
+    if (s_simsdr_config.file_path) {
+        add_summary_item(info, "Input Source", "%s%s", s_simsdr_config.file_path, s_simsdr_config.loop ? " (looped)" : "");
+    } else {
+        add_summary_item(info, "Input Source", "generated signal");
+        generator_add_signal_summary(info);
+    }
+    add_summary_item(info, "Input Format", "%s", s_simsdr_config.format_str);
+    add_summary_item(info, "Input Rate", "%.0f Hz", (double)s_simsdr_config.sample_rate_hz_arg);
+    add_summary_item(info, "SDR Pipeline Mode", "%s", s_simsdr_config.mode == PIPELINE_MODE_BUFFERED_SDR ? "Buffered" : "Real-Time");
+    add_summary_item(info, "Callback Packets", "%s, %d samples", s_simsdr_config.packets_str, s_simsdr_config.burst_samples_arg);
+    if (s_simsdr_config.jitter_us_arg > 0) {
+        add_summary_item(info, "Callback Jitter", "0-%d us", s_simsdr_config.jitter_us_arg);
+    }
+    if (s_simsdr_config.stall_ms_arg > 0) {
+        add_summary_item(info, "Injected Stalls", "%d ms every %.1f s (%s)", s_simsdr_config.stall_ms_arg,
+                         s_simsdr_config.stall_every_sec_arg, s_simsdr_config.stall_reset ? "dropped + reset" : "delivered late");
+    }
+}
@@ -647,14 +647,13 @@ static void* spyserver_client_start_stream(ModuleContext* ctx) {
             item->packet_sample_format = p->active_format;
             item->input_bytes_per_sample_pair = get_bytes_per_sample(p->active_format);
             item->frames_read = bytes_this_chunk / item->input_bytes_per_sample_pair;
+            item->capture_time_ns = get_monotonic_time_ns();
 
             item->is_last_chunk = false;
             item->stream_discontinuity_event = false;
 
             if (item->frames_read > 0) {
-                pthread_mutex_lock(&resources->progress_mutex);
-                resources->total_frames_read += item->frames_read;
-                pthread_mutex_unlock(&resources->progress_mutex);
+                atomic_fetch_add_explicit(&resources->total_frames_read, item->frames_read, memory_order_relaxed);
             }
 
             if (!queue_enqueue(resources->reader_output_queue, item)) {
@@ -0,0 +1,334 @@
+#include "input_stdin.h"
+#include "module.h"
+#include "constants.h"
+#include "log.h"
+#include "signal_handler.h"
+#include "app_context.h"
+#include "utils.h"
+#include "sample_convert.h"
+#include "input_common.h"
+#include "memory_arena.h"
+#include "buffer_alloc.h"
+#include "ring_buffer.h"
+#include "sdr_packet_serializer.h"
+#include "argparse.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#define STDIN_NULL_DEVICE "/dev/null"
+#else
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#define STDIN_NULL_DEVICE "NUL"
+#define dup _dup
+#define close _close
+#define isatty _isatty
+#endif
+
+// --- Private Module Configuration ---
+static struct {
+    float sample_rate_hz_arg;
+    const char* format_str;
+} s_stdin_config;
+
+// --- Private Module State ---
+typedef struct {
+    int fd;                               // Private duplicate of the original stdin; fd 0 now reads the null device.
+    size_t pipe_size;                     // 0 if stdin is not a pipe we can size.
+    unsigned char* read_buffer;
+    size_t read_buffer_bytes;
+    atomic_bool stop_requested;
+
+    // Statistics, reported when the stream ends.
+    unsigned long long bytes_read;
+    unsigned long long ring_full_waits;
+} StdinPrivateData;
+
+static const struct argparse_option stdin_cli_options[] = {
+    OPT_GROUP("Stdin Input Options"),
+    OPT_FLOAT(0, "stdin-input-rate", &s_stdin_config.sample_rate_hz_arg, "(Required) The sample rate of the I/Q stream on stdin.", NULL, 0, 0),
+    OPT_STRING(0, "stdin-input-sample-format", &s_stdin_config.format_str, "(Required) The sample format of the I/Q stream on stdin.", NULL, 0, 0),
+};
+
+const struct argparse_option* stdin_get_cli_options(int* count) {
+    *count = sizeof(stdin_cli_options) / sizeof(stdin_cli_options[0]);
+    return stdin_cli_options;
+}
+
+static bool stdin_initialize(ModuleContext* ctx);
+static void* stdin_start_stream(ModuleContext* ctx);
+static void stdin_stop_stream(ModuleContext* ctx);
+static void stdin_cleanup(ModuleContext* ctx);
+static void stdin_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info);
+static bool stdin_validate_options(AppConfig* config);
+
+static InputModuleInterface stdin_module_api = {
+    .initialize = stdin_initialize,
+    .start_stream = stdin_start_stream,
+    .stop_stream = stdin_stop_stream,
+    .cleanup = stdin_cleanup,
+    .get_summary_info = stdin_get_summary_info,
+    .validate_options = stdin_validate_options,
+    .validate_generic_options = NULL,
+    .has_known_length = _input_source_has_known_length_false,
+    .pre_stream_iq_correction = NULL
+};
+
+InputModuleInterface* get_stdin_input_module_api(void) {
+    return &stdin_module_api;
+}
+
+// --- Private Helper Functions ---
+
+static bool _stream_should_stop(AppResources* resources, StdinPrivateData* data) {
+    return is_shutdown_requested() || resources->error_occurred ||
+           atomic_load_explicit(&data->stop_requested, memory_order_relaxed);
+}
+
+/**
+ * @brief Waits until stdin has data (or has closed), waking regularly to check for a stop.
+ * @return false if the stream was stopped while waiting.
+ */
+static bool _wait_readable(AppResources* resources, StdinPrivateData* data) {
+#ifndef _WIN32
+    struct pollfd pfd = { .fd = data->fd, .events = POLLIN, .revents = 0 };
+    while (!_stream_should_stop(resources, data)) {
+        int ready = poll(&pfd, 1, STDIN_POLL_SLICE_MS);
+        if (ready > 0 || (ready < 0 && errno != EINTR)) {
+            return true; // Data, end of stream, or an error the read will report.
+        }
+    }
+    return false;
+#else
+    // Anonymous pipes cannot be polled, so a stop is only seen once the next read returns.
+    return !_stream_should_stop(resources, data);
+#endif
+}
+
+/**
+ * @brief Splits whole samples into packets for the SDR input buffer.
+ *
+ * Unlike a device callback, stdin can wait: when the buffer is full the
+ * capture thread stops reading, and the producer blocks on the full pipe
+ * instead of losing samples.
+ *
+ * @return false if the stream was stopped or the buffer rejected a packet.
+ */
+static bool _deliver_samples(AppResources* resources, StdinPrivateData* data, const unsigned char* samples, size_t num_frames) {
+    RingBuffer* ring = resources->sdr_input_buffer;
+    const size_t bytes_per_pair = resources->input_bytes_per_sample_pair;
+    size_t frames_done = 0;
+
+    while (frames_done < num_frames) {
+        size_t frames_this_packet = num_frames - frames_done;
+        if (frames_this_packet > resources->pipeline_chunk_base_samples) {
+            frames_this_packet = resources->pipeline_chunk_base_samples;
+        }
+
+        size_t packet_bytes = sdr_packet_serializer_packet_bytes((uint32_t)frames_this_packet, bytes_per_pair);
+        bool waited = false;
+        // The ring keeps one byte free to tell full from empty.
+        while (ring_buffer_get_capacity(ring) - ring_buffer_get_size(ring) - 1 < packet_bytes) {
+            if (_stream_should_stop(resources, data)) {
+                return false;
+            }
+            waited = true;
+#ifdef _WIN32
+            Sleep(1);
+#else
+            usleep(STDIN_RING_WAIT_US);
+#endif
+        }
+        if (waited) {
+            data->ring_full_waits++;
+        }
+
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE);
+        bool ok = sdr_packet_serializer_write_interleaved_chunk(ring, (uint32_t)frames_this_packet,
+                                                                samples + frames_done * bytes_per_pair,
+                                                                bytes_per_pair, resources->input_format);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE, frames_this_packet);
+        if (!ok) {
+            handle_fatal_thread_error("Stdin: SDR input buffer rejected a packet. Stream corrupted.", resources);
+            return false;
+        }
+        frames_done += frames_this_packet;
+    }
+    return true;
+}
+
+// --- Module Implementation ---
+
+static bool stdin_validate_options(AppConfig* config) {
+    (void)config;
+    if (s_stdin_config.sample_rate_hz_arg <= 0.0f) {
+        log_fatal("Missing required option --stdin-input-rate <hz> for stdin input.");
+        return false;
+    }
+    if (!s_stdin_config.format_str) {
+        log_fatal("Missing required option --stdin-input-sample-format <format> for stdin input.");
+        return false;
+    }
+    return true;
+}
+
+static bool stdin_initialize(ModuleContext* ctx) {
+    const AppConfig *config = ctx->config;
+    AppResources *resources = ctx->resources;
+
+    StdinPrivateData* private_data = (StdinPrivateData*)mem_arena_alloc(&resources->setup_arena, sizeof(StdinPrivateData), true);
+    if (!private_data) {
+        return false;
+    }
+    private_data->fd = -1;
+    atomic_init(&private_data->stop_requested, false);
+    resources->input_module_private_data = private_data;
+
+    resources->input_format = utils_get_format_from_string(s_stdin_config.format_str);
+    if (resources->input_format == FORMAT_UNKNOWN) {
+        log_fatal("Invalid stdin input format '%s'. See --help for valid formats.", s_stdin_config.format_str);
+        return false;
+    }
+    resources->input_bytes_per_sample_pair = get_bytes_per_sample(resources->input_format);
+    if (resources->input_bytes_per_sample_pair == 0) {
+        log_fatal("Internal error: could not determine sample size for format '%s'.", s_stdin_config.format_str);
+        return false;
+    }
+
+    if (config->raw_passthrough && resources->input_format != config->output_format) {
+        log_fatal("Option --raw-passthrough requires input and output formats to be identical. Stdin input is '%s', but output was set to '%s'.",
+                  s_stdin_config.format_str, config->output_sample_format_name);
+        return false;
+    }
+
+    if (isatty(fileno(stdin))) {
+        log_fatal("Stdin is a terminal. Pipe I/Q samples into iq_tool (e.g., 'rtl_sdr - | iq_tool -i stdin ...').");
+        return false;
+    }
+
+    // The pipeline sizes its buffers and picks its threads from this, so it must be set before pipeline_run().
+    resources->pipeline_mode = PIPELINE_MODE_BUFFERED_SDR;
+
+#ifdef _WIN32
+    if (_setmode(_fileno(stdin), _O_BINARY) == -1) {
+        log_fatal("Failed to set stdin to binary mode: %s", strerror(errno));
+        return false;
+    }
+#endif
+    // Keep the samples on a private descriptor. Anything that later reads stdin
+    // (e.g., the overwrite prompt) then sees end-of-file instead of eating samples.
+    private_data->fd = dup(fileno(stdin));
+    if (private_data->fd < 0) {
+        log_fatal("Failed to duplicate stdin: %s", strerror(errno));
+        return false;
+    }
+    if (!freopen(STDIN_NULL_DEVICE, "r", stdin)) {
+        log_warn("Could not detach stdin from the sample stream: %s", strerror(errno));
+    }
+
+    // A pipe as large as one read lets each read() drain a burst in one call.
+    private_data->pipe_size = utils_grow_pipe(private_data->fd, STDIN_READ_BYTES, "stdin");
+
+    private_data->read_buffer_bytes = STDIN_READ_BYTES;
+    private_data->read_buffer = (unsigned char*)buffer_alloc(private_data->read_buffer_bytes);
+    if (!private_data->read_buffer) {
+        log_fatal("Failed to allocate the stdin read buffer.");
+        return false;
+    }
+
+    resources->source_info.samplerate = (int)s_stdin_config.sample_rate_hz_arg;
+    resources->source_info.frames = -1;
+
+    log_info("Reading %s I/Q samples at %.0f Hz from stdin.", s_stdin_config.format_str, (double)s_stdin_config.sample_rate_hz_arg);
+    return true;
+}
+
+static void* stdin_start_stream(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    StdinPrivateData* private_data = (StdinPrivateData*)resources->input_module_private_data;
+
+    const size_t bytes_per_pair = resources->input_bytes_per_sample_pair;
+    unsigned char* buffer = private_data->read_buffer;
+    size_t carry = 0; // Bytes of an incomplete sample pair left over from the last read.
+
+    while (_wait_readable(resources, private_data)) {
+#ifdef _WIN32
+        int bytes = _read(private_data->fd, buffer + carry, (unsigned int)(private_data->read_buffer_bytes - carry));
+#else
+        ssize_t bytes = read(private_data->fd, buffer + carry, private_data->read_buffer_bytes - carry);
+#endif
+        if (bytes < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            char error_buf[256];
+            snprintf(error_buf, sizeof(error_buf), "Stdin: read error: %s", strerror(errno));
+            handle_fatal_thread_error(error_buf, resources);
+            break;
+        }
+        if (bytes == 0) {
+            break; // The producer closed the pipe.
+        }
+        private_data->bytes_read += (unsigned long long)bytes;
+
+        size_t available = carry + (size_t)bytes;
+        size_t frames = available / bytes_per_pair;
+        if (!_deliver_samples(resources, private_data, buffer, frames)) {
+            break;
+        }
+        carry = available - frames * bytes_per_pair;
+        if (carry > 0) {
+            memmove(buffer, buffer + frames * bytes_per_pair, carry);
+        }
+    }
+
+    if (carry > 0 && !_stream_should_stop(resources, private_data)) {
+        log_warn("Stdin: discarded %zu trailing bytes that do not form a whole sample.", carry);
+    }
+    char size_buf[40];
+    log_info("Stdin: read %s; the input buffer was full %llu time(s).",
+             format_file_size((long long)private_data->bytes_read, size_buf, sizeof(size_buf)), private_data->ring_full_waits);
+
+    // The SDR capture thread signals the end of the stream once this returns.
+    return NULL;
+}
+
+static void stdin_stop_stream(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    StdinPrivateData* private_data = (StdinPrivateData*)resources->input_module_private_data;
+    if (private_data) {
+        atomic_store_explicit(&private_data->stop_requested, true, memory_order_relaxed);
+    }
+}
+
+static void stdin_cleanup(ModuleContext* ctx) {
+    AppResources *resources = ctx->resources;
+    if (resources->input_module_private_data) {
+        StdinPrivateData* private_data = (StdinPrivateData*)resources->input_module_private_data;
+        if (private_data->fd >= 0) {
+            close(private_data->fd);
+            private_data->fd = -1;
+        }
+        buffer_free(private_data->read_buffer);
+        private_data->read_buffer = NULL;
+        resources->input_module_private_data = NULL;
+    }
+}
+
+static void stdin_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* info) {
+    const StdinPrivateData* private_data = (const StdinPrivateData*)ctx->resources->input_module_private_data;
+
+    add_summary_item(info, "Input Type", "STDIN");
+    add_summary_item(info, "Input Format", "%s", s_stdin_config.format_str);
+    add_summary_item(info, "Input Rate", "%.0f Hz", (double)s_stdin_config.sample_rate_hz_arg);
+    if (private_data && private_data->pipe_size > 0) {
+        char size_buf[40];
+        add_summary_item(info, "Input Pipe", "%s", format_file_size((long long)private_data->pipe_size, size_buf, sizeof(size_buf)));
+    }
+}
@@ -12,6 +12,12 @@
 #include "ring_buffer.h"
 #include "argparse.h"
 #include "iq_correct.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "file_map.h"
+#include "file_readahead.h"
+#include "file_splice.h"
+#include "input_range.h"
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
@@ -97,6 +103,10 @@ typedef struct {
 // This is the private data structure for the WAV input module.
 typedef struct {
     SNDFILE *infile;
+    int infile_fd; // -1 unless opened for --mmap-input, --read-ahead or --raw-passthrough
+    FileMap map;
+    FileReadahead* readahead;
+    InputRange range;
     SdrMetadata sdr_info;
     bool sdr_info_present;
 } WavPrivateData;
@@ -104,9 +114,8 @@ typedef struct {
 static void XMLCALL expat_start_element_handler(void *userData, const XML_Char *name, const XML_Char **atts);
 static bool _parse_auxi_xml_expat(const unsigned char *chunk_data, sf_count_t chunk_size, SdrMetadata *metadata);
 static bool _parse_binary_auxi_data(const unsigned char *chunk_data, sf_count_t chunk_size, SdrMetadata *metadata);
-static time_t timegm_portable(struct tm *tm);
 static void init_sdr_metadata(SdrMetadata *metadata);
-static bool parse_sdr_metadata_chunks(SNDFILE *infile, const SF_INFO *sfinfo, SdrMetadata *metadata, MemoryArena* arena);
+static bool parse_sdr_metadata_chunks(SNDFILE *infile, const SF_INFO *sfinfo, SdrMetadata *metadata, AppResources* resources);
 static bool parse_sdr_metadata_from_filename(const char* base_filename, SdrMetadata *metadata);
 
 static const char* sdr_software_type_to_string(SdrSoftwareType type) {
@@ -143,7 +152,7 @@ static void init_sdr_metadata(SdrMetadata *metadata) {
     metadata->source_software = SDR_SOFTWARE_UNKNOWN;
 }
 
-static bool process_specific_chunk(SNDFILE *infile, SdrMetadata *metadata, const char* chunk_id_str, MemoryArena* arena) {
+static bool process_specific_chunk(SNDFILE *infile, SdrMetadata *metadata, const char* chunk_id_str, AppResources* resources) {
     SF_CHUNK_ITERATOR *iterator = NULL;
     SF_CHUNK_INFO chunk_info_filter, chunk_info_query;
     unsigned char* chunk_data_buffer = NULL;
@@ -160,7 +169,7 @@ static bool process_specific_chunk(SNDFILE *infile, SdrMetadata *metadata, const
     if (sf_get_chunk_size(iterator, &chunk_info_query) != SF_ERR_NO_ERROR) return false;
     if (chunk_info_query.datalen == 0 || chunk_info_query.datalen > MAX_METADATA_CHUNK_SIZE) return false;
 
-    chunk_data_buffer = (unsigned char*)mem_arena_alloc(arena, chunk_info_query.datalen, false);
+    chunk_data_buffer = (unsigned char*)mem_arena_alloc(&resources->setup_arena, chunk_info_query.datalen, false);
     if (!chunk_data_buffer) {
         return false;
     }
@@ -171,6 +180,9 @@ static bool process_specific_chunk(SNDFILE *infile, SdrMetadata *metadata, const
     }
 
     if (strcmp(chunk_id_str, SDRC_AUXI_CHUNK_ID_STR) == 0) {
+        // Keep the chunk as-is for WAV outputs, whether or not it parses.
+        resources->input_auxi_chunk = chunk_data_buffer;
+        resources->input_auxi_chunk_bytes = (size_t)chunk_info_query.datalen;
         if (!_parse_auxi_xml_expat(chunk_data_buffer, chunk_info_query.datalen, metadata)) {
             parsed_successfully = _parse_binary_auxi_data(chunk_data_buffer, chunk_info_query.datalen, metadata);
         } else {
@@ -181,10 +193,10 @@ static bool process_specific_chunk(SNDFILE *infile, SdrMetadata *metadata, const
     return parsed_successfully;
 }
 
-static bool parse_sdr_metadata_chunks(SNDFILE *infile, const SF_INFO *sfinfo, SdrMetadata *metadata, MemoryArena* arena) {
+static bool parse_sdr_metadata_chunks(SNDFILE *infile, const SF_INFO *sfinfo, SdrMetadata *metadata, AppResources* resources) {
     if (!infile || !sfinfo || !metadata) return false;
     (void)sfinfo;
-    return process_specific_chunk(infile, metadata, SDRC_AUXI_CHUNK_ID_STR, arena);
+    return process_specific_chunk(infile, metadata, SDRC_AUXI_CHUNK_ID_STR, resources);
 }
 
 static bool parse_sdr_metadata_from_filename(const char* base_filename, SdrMetadata *metadata) {
@@ -234,7 +246,7 @@ static bool parse_sdr_metadata_from_filename(const char* base_filename, SdrMetad
                 t.tm_hour = hour;
                 t.tm_min = min;
                 t.tm_sec = sec;
-                time_t timestamp = timegm_portable(&t);
+                time_t timestamp = utils_timegm(&t);
                 if (timestamp != (time_t)-1) {
                     metadata->timestamp_unix = timestamp;
                     metadata->timestamp_unix_present = true;
@@ -270,27 +282,6 @@ static bool parse_sdr_metadata_from_filename(const char* base_filename, SdrMetad
     return parsed_something_new;
 }
 
-static time_t timegm_portable(struct tm *tm) {
-    if (!tm) return -1;
-    tm->tm_isdst = 0;
-#ifdef _WIN32
-    return _mkgmtime(tm);
-#else
-    time_t result;
-    char *tz_orig = getenv("TZ");
-    setenv("TZ", "", 1);
-    tzset();
-    result = mktime(tm);
-    if (tz_orig) {
-        setenv("TZ", tz_orig, 1);
-    } else {
-        unsetenv("TZ");
-    }
-    tzset();
-    return result;
-#endif
-}
-
 static bool _parse_binary_auxi_data(const unsigned char *chunk_data, sf_count_t chunk_size, SdrMetadata *metadata) {
     const size_t min_req_size = sizeof(SdrUnoSystemTime) + 16 + 4;
     if (!chunk_data || !metadata || chunk_size < (sf_count_t)min_req_size) {
@@ -308,7 +299,7 @@ static bool _parse_binary_auxi_data(const unsigned char *chunk_data, sf_count_t
     t.tm_hour = st.wHour;
     t.tm_min = st.wMinute;
     t.tm_sec = st.wSecond;
-    time_t timestamp = timegm_portable(&t);
+    time_t timestamp = utils_timegm(&t);
     if (timestamp != (time_t)-1 && !metadata->timestamp_unix_present) {
         metadata->timestamp_unix = timestamp;
         metadata->timestamp_unix_present = true;
@@ -393,7 +384,7 @@ static void XMLCALL expat_start_element_handler(void *userData, const XML_Char *
                             t.tm_hour = hour;
                             t.tm_min = min;
                             t.tm_sec = sec;
-                            time_t timestamp = timegm_portable(&t);
+                            time_t timestamp = utils_timegm(&t);
                             if (timestamp != (time_t)-1) {
                                 metadata->timestamp_unix = timestamp;
                                 metadata->timestamp_unix_present = true;
@@ -504,6 +495,14 @@ static void wav_get_summary_info(const ModuleContext* ctx, InputSummaryInfo* inf
 #endif
     char size_buf[40];
     add_summary_item(info, "Input File Size", "%s", format_file_size(input_file_size, size_buf, sizeof(size_buf)));
+    if (resources->input_is_mapped) {
+        add_summary_item(info, "Input Reads", "%s", "Memory-mapped");
+    } else if (private_data->readahead) {
+        add_summary_item(info, "Input Reads", "Read-ahead (%s)", file_readahead_describe(private_data->readahead));
+    }
+    if (private_data->range.limited) {
+        input_range_add_summary_item(info, &private_data->range, (double)resources->source_info.samplerate);
+    }
 
     if (private_data->sdr_info_present) {
         if (private_data->sdr_info.timestamp_unix_present) {
@@ -548,6 +547,7 @@ static bool wav_initialize(ModuleContext* ctx) {
         return false;
     }
     resources->input_module_private_data = private_data;
+    private_data->infile_fd = -1;
 
 #ifdef _WIN32
     log_info("Opening WAV input file: %s", config->effective_input_filename_utf8);
@@ -558,7 +558,11 @@ static bool wav_initialize(ModuleContext* ctx) {
     log_info("Opening WAV input file: %s", config->effective_input_filename);
     SF_INFO sfinfo;
     memset(&sfinfo, 0, sizeof(SF_INFO));
-    private_data->infile = sf_open(config->effective_input_filename, SFM_READ, &sfinfo);
+    if (config->mmap_input || config->read_ahead_depth > 0 || config->raw_passthrough) {
+        private_data->infile = file_map_sf_open(config->effective_input_filename, &sfinfo, &private_data->infile_fd);
+    } else {
+        private_data->infile = sf_open(config->effective_input_filename, SFM_READ, &sfinfo);
+    }
 #endif
 
     if (!private_data->infile) {
@@ -602,7 +606,7 @@ static bool wav_initialize(ModuleContext* ctx) {
     resources->source_info.frames = sfinfo.frames;
 
     init_sdr_metadata(&private_data->sdr_info);
-    private_data->sdr_info_present = parse_sdr_metadata_chunks(private_data->infile, &sfinfo, &private_data->sdr_info, &resources->setup_arena);
+    private_data->sdr_info_present = parse_sdr_metadata_chunks(private_data->infile, &sfinfo, &private_data->sdr_info, resources);
 
     char basename_buffer[MAX_PATH_BUFFER];
     const char* base_filename = get_basename_for_parsing(config, basename_buffer, sizeof(basename_buffer), &resources->setup_arena);
@@ -611,6 +615,18 @@ static bool wav_initialize(ModuleContext* ctx) {
         private_data->sdr_info_present = private_data->sdr_info_present || filename_parsed;
     }
 
+    if (!input_range_resolve(config, (double)sfinfo.samplerate, (long long)sfinfo.frames,
+                             private_data->sdr_info.timestamp_unix_present, private_data->sdr_info.timestamp_unix,
+                             &private_data->range)) {
+        sf_close(private_data->infile);
+        private_data->infile = NULL;
+        return false;
+    }
+    if (private_data->range.limited) {
+        resources->source_info.frames = (long long)private_data->range.num_frames;
+        resources->input_start_frame = private_data->range.first_frame;
+    }
+
     if (s_wav_config.center_target_hz_arg != 0.0f) {
         if (config->freq_shift_hz_arg != 0.0f) {
             log_fatal("Conflicting frequency shift options provided. Cannot use --freq-shift and --wav-center-target-freq at the same time.");
@@ -628,30 +644,83 @@ static bool wav_initialize(ModuleContext* ctx) {
         resources->nco_shift_hz = private_data->sdr_info.center_freq_hz - target_freq;
     }
 
+    if (config->mmap_input) {
+        resources->input_is_mapped = file_map_open_sndfile(&private_data->map, private_data->infile, private_data->infile_fd,
+                                                           resources->input_bytes_per_sample_pair, &private_data->range);
+    } else if (config->read_ahead_depth > 0) {
+        unsigned long long data_offset;
+        unsigned long long data_bytes;
+        size_t bytes_per_pair = resources->input_bytes_per_sample_pair;
+        if (file_map_locate_data(private_data->infile, private_data->infile_fd, bytes_per_pair, &private_data->range,
+                                 &data_offset, &data_bytes)) {
+            private_data->readahead = file_readahead_create(config->effective_input_filename, data_offset, data_bytes, bytes_per_pair,
+                                                            resources->pipeline_chunk_base_samples * bytes_per_pair,
+                                                            (unsigned int)config->read_ahead_depth, config->direct_io);
+        }
+    }
+
+    // Leave the handle at the first frame, where I/Q calibration and the reader begin.
+    if (private_data->range.first_frame > 0 &&
+        sf_seek(private_data->infile, (sf_count_t)private_data->range.first_frame, SEEK_SET) < 0) {
+        log_fatal("Cannot seek to --start in the input file: %s", sf_strerror(private_data->infile));
+        return false;
+    }
+
     return true;
 }
 
 static void* wav_start_stream(ModuleContext* ctx) {
     AppResources *resources = ctx->resources;
+    const AppConfig *config = ctx->config;
     WavPrivateData* private_data = (WavPrivateData*)resources->input_module_private_data;
 
+    if (config->raw_passthrough && resources->input_format != config->output_format) {
+        char error_buf[256];
+        snprintf(error_buf, sizeof(error_buf),
+                 "Option --raw-passthrough requires input and output formats to be identical. Input format is '%s', output format is '%s'.",
+                 (resources->input_format == CS16) ? "cs16" : "cu8", config->output_sample_format_name);
+        handle_fatal_thread_error(error_buf, resources);
+        return NULL;
+    }
+
+    if (config->raw_passthrough && file_splice_run_passthrough(ctx, private_data->infile, private_data->infile_fd, &private_data->range)) {
+        return NULL;
+    }
+
+    if (private_data->readahead) {
+        file_readahead_run_reader(ctx, private_data->readahead, config->raw_passthrough);
+        return NULL;
+    }
+
+    // Locating the data for the kernel copy rewinds the handle, so seek again.
+    if (!resources->input_is_mapped && private_data->range.first_frame > 0 &&
+        sf_seek(private_data->infile, (sf_count_t)private_data->range.first_frame, SEEK_SET) < 0) {
+        handle_fatal_thread_error("Cannot seek to --start in the input file.", resources);
+        return NULL;
+    }
+    unsigned long long frames_left = private_data->range.num_frames;
+
     // This is now a clean, high-level check.
     // The input module no longer knows or cares about "stdout".
     bool pacing_required = resources->pacing_is_required;
 
-    // Pre-calculate the back-pressure threshold in bytes for efficiency.
-    const size_t writer_buffer_capacity = pacing_required ? ring_buffer_get_capacity(resources->writer_input_buffer) : 0;
-    const size_t writer_buffer_threshold = (size_t)(writer_buffer_capacity * IO_WRITER_BUFFER_HIGH_WATER_MARK);
+    // The back-pressure threshold is sized by the pipeline's memory plan so that
+    // every chunk still in flight fits in the ring after the reader pauses.
+    const size_t writer_buffer_threshold = resources->writer_backpressure_threshold_bytes;
 
     while (!is_shutdown_requested() && !resources->error_occurred) {
         // --- START: Back-pressure Pacing Logic ---
         if (pacing_required && (ring_buffer_get_size(resources->writer_input_buffer) > writer_buffer_threshold)) {
             // The writer is falling behind. Pause briefly to let it catch up.
+            unsigned long long pause_start = trace_is_enabled() ? get_monotonic_time_ns() : 0;
             #ifdef _WIN32
                 Sleep(10); // 10 ms
             #else
                 usleep(10000); // 10 ms
             #endif
+            if (pause_start) {
+                trace_span("wait", "pacing sleep", pause_start, get_monotonic_time_ns(), 0);
+            }
             continue; // Re-evaluate the buffer state in the next loop iteration.
         }
         // --- END: Back-pressure Pacing Logic ---
@@ -660,16 +729,39 @@ static void* wav_start_stream(ModuleContext* ctx) {
         if (!current_item) {
             break; // Shutdown or error signaled
         }
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_READER);
 
         current_item->stream_discontinuity_event = false;
-
-        int64_t bytes_read = sf_read_raw(private_data->infile, current_item->raw_input_data, current_item->raw_input_capacity_bytes);
+        current_item->capture_time_ns = get_monotonic_time_ns();
+
+        // With --raw-passthrough the samples go straight to the output buffer.
+        void* target_buffer = config->raw_passthrough ? current_item->final_output_data : current_item->raw_input_data;
+        size_t target_capacity = config->raw_passthrough ? current_item->final_output_capacity_bytes : current_item->raw_input_capacity_bytes;
+
+        int64_t bytes_read;
+        if (resources->input_is_mapped) {
+            const unsigned char* mapped_data;
+            size_t max_bytes = resources->pipeline_chunk_base_samples * resources->input_bytes_per_sample_pair;
+            bytes_read = (int64_t)file_map_next(&private_data->map, max_bytes, &mapped_data);
+            if (config->raw_passthrough) {
+                if (bytes_read > 0) {
+                    memcpy(target_buffer, mapped_data, (size_t)bytes_read);
+                }
+            } else {
+                // The chunk points straight into the mapping; nothing is copied.
+                current_item->mapped_input_data = mapped_data;
+            }
+        } else {
+            // Stop exactly at the end of a --duration range.
+            if (private_data->range.limited && frames_left * resources->input_bytes_per_sample_pair < target_capacity) {
+                target_capacity = (size_t)frames_left * resources->input_bytes_per_sample_pair;
+            }
+            bytes_read = (target_capacity > 0) ? sf_read_raw(private_data->infile, target_buffer, target_capacity) : 0;
+        }
 
         if (bytes_read < 0) {
             log_fatal("libsndfile read error: %s", sf_strerror(private_data->infile));
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->error_occurred = true;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_store(&resources->error_occurred, true);
             request_shutdown();
             queue_enqueue(resources->free_sample_chunk_queue, current_item);
             break;
@@ -677,14 +769,15 @@ static void* wav_start_stream(ModuleContext* ctx) {
 
         current_item->frames_read = bytes_read / resources->input_bytes_per_sample_pair;
         current_item->packet_sample_format = resources->input_format;
+        unsigned long long frames_consumed = (unsigned long long)current_item->frames_read;
+        frames_left -= (frames_consumed < frames_left) ? frames_consumed : frames_left;
         
         current_item->is_last_chunk = (current_item->frames_read == 0);
 
         if (!current_item->is_last_chunk) {
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->total_frames_read += current_item->frames_read;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_fetch_add_explicit(&resources->total_frames_read, current_item->frames_read, memory_order_relaxed);
         }
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_READER, current_item->frames_read);
 
         if (!queue_enqueue(resources->reader_output_queue, current_item)) {
             queue_enqueue(resources->free_sample_chunk_queue, current_item);
@@ -706,6 +799,10 @@ static void wav_cleanup(ModuleContext* ctx) {
     AppResources *resources = ctx->resources;
     if (resources->input_module_private_data) {
         WavPrivateData* private_data = (WavPrivateData*)resources->input_module_private_data;
+        file_map_close(&private_data->map);
+        resources->input_is_mapped = false;
+        file_readahead_destroy(private_data->readahead);
+        private_data->readahead = NULL;
         if (private_data->infile) {
             log_info("Closing WAV input file.");
             sf_close(private_data->infile);
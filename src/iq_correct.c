@@ -62,6 +62,7 @@
 #include <math.h>
 #include <errno.h>
 #include <time.h>
+#include <stdint.h>
 
 #ifdef _WIN32
 #include <liquid.h>
@@ -79,6 +80,8 @@ static float _calculate_imbalance_metric(IqCorrectionResources* iq_res, const co
 static void _estimate_power(IqCorrectionResources* iq_res, const complex_float_t* signal_block);
 static float _get_random_direction(void);
 static void _calculate_power_spectrum(IqCorrectionResources* iq_res, const complex_float_t* signal_block, float gain_adj, float phase_adj);
+static void _publish_factors(IqCorrectionResources* iq_res, IqCorrectionFactors factors);
+static IqCorrectionFactors _load_factors(IqCorrectionResources* iq_res);
 
 
 // --- Public API Functions ---
@@ -91,11 +94,6 @@ bool iq_correct_init(AppConfig* config, AppResources* resources, MemoryArena* ar
 
     srand((unsigned int)time(NULL));
 
-    if (pthread_mutex_init(&resources->iq_correction.iq_factors_mutex, NULL) != 0) {
-        log_fatal("Failed to initialize I/Q correction mutex.");
-        return false;
-    }
-
     const unsigned int nfft = IQ_CORRECTION_FFT_SIZE;
     resources->iq_correction.fft_buffer = (complex_float_t*)mem_arena_alloc(arena, nfft * sizeof(complex_float_t), false);
     resources->iq_correction.fft_shift_buffer = (complex_float_t*)mem_arena_alloc(arena, nfft * sizeof(complex_float_t), false);
@@ -123,11 +121,8 @@ bool iq_correct_init(AppConfig* config, AppResources* resources, MemoryArena* ar
         resources->iq_correction.window_coeffs[i] = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * (float)i / (float)(nfft - 1));
     }
 
-    resources->iq_correction.factors_buffer[0].mag = 0.0f;
-    resources->iq_correction.factors_buffer[0].phase = 0.0f;
-    resources->iq_correction.factors_buffer[1].mag = 0.0f;
-    resources->iq_correction.factors_buffer[1].phase = 0.0f;
-    resources->iq_correction.active_buffer_idx = 0;
+    IqCorrectionFactors initial_factors = { 0.0f, 0.0f };
+    _publish_factors(&resources->iq_correction, initial_factors);
 
     resources->iq_correction.average_power = 0.0f;
     resources->iq_correction.power_range = 0.0f;
@@ -141,16 +136,15 @@ bool iq_correct_init(AppConfig* config, AppResources* resources, MemoryArena* ar
 void iq_correct_apply(AppResources* resources, complex_float_t* samples, int num_samples) {
     if (!resources->config->iq_correction.enable) return;
 
-    IqCorrectionFactors local_factors;
-
-    pthread_mutex_lock(&resources->iq_correction.iq_factors_mutex);
-    int active_idx = resources->iq_correction.active_buffer_idx;
-    local_factors = resources->iq_correction.factors_buffer[active_idx];
-    pthread_mutex_unlock(&resources->iq_correction.iq_factors_mutex);
-
+    IqCorrectionFactors local_factors = _load_factors(&resources->iq_correction);
     _apply_correction_to_buffer(samples, num_samples, local_factors.mag, local_factors.phase);
 }
 
+void iq_correct_set_factors(AppResources* resources, float mag, float phase) {
+    IqCorrectionFactors factors = { mag, phase };
+    _publish_factors(&resources->iq_correction, factors);
+}
+
 void iq_correct_run_optimization(AppResources* resources, const complex_float_t* optimization_data) {
     if (!resources->config->iq_correction.enable) return;
 
@@ -175,16 +169,12 @@ void iq_correct_run_optimization(AppResources* resources, const complex_float_t*
 
     log_debug("IQ_OPT_PROBE: Signal is strong enough, starting optimization...");
 
-    float current_gain;
-    float current_phase;
-    float best_metric;
-
-    pthread_mutex_lock(&resources->iq_correction.iq_factors_mutex);
-    int active_idx = resources->iq_correction.active_buffer_idx;
-    current_gain = resources->iq_correction.factors_buffer[active_idx].mag;
-    current_phase = resources->iq_correction.factors_buffer[active_idx].phase;
-    best_metric = _calculate_imbalance_metric(&resources->iq_correction, optimization_data, current_gain, current_phase);
-    pthread_mutex_unlock(&resources->iq_correction.iq_factors_mutex);
+    // This thread is the only writer of the factors, so the snapshot taken here
+    // is still current when the smoothed result is published below.
+    const IqCorrectionFactors published = _load_factors(&resources->iq_correction);
+    float current_gain = published.mag;
+    float current_phase = published.phase;
+    float best_metric = _calculate_imbalance_metric(&resources->iq_correction, optimization_data, current_gain, current_phase);
 
     log_debug("IQ_OPT_PROBE: Initial metric (utility score) is %.4e", best_metric);
 
@@ -203,25 +193,15 @@ void iq_correct_run_optimization(AppResources* resources, const complex_float_t*
     log_debug("IQ_OPT_PROBE: Optimization finished. Best metric found: %.4e", best_metric);
     log_debug("IQ_OPT_PROBE: Final raw params for this pass: mag=%.6f, phase=%.6f", current_gain, current_phase);
 
-    pthread_mutex_lock(&resources->iq_correction.iq_factors_mutex);
-    int current_active_idx = resources->iq_correction.active_buffer_idx;
-    int inactive_idx = 1 - current_active_idx;
+    IqCorrectionFactors smoothed;
+    smoothed.mag = ((1.0f - IQ_CORRECTION_SMOOTHING_FACTOR) * published.mag) + (IQ_CORRECTION_SMOOTHING_FACTOR * current_gain);
+    smoothed.phase = ((1.0f - IQ_CORRECTION_SMOOTHING_FACTOR) * published.phase) + (IQ_CORRECTION_SMOOTHING_FACTOR * current_phase);
+    _publish_factors(&resources->iq_correction, smoothed);
 
-    float smoothed_gain = ((1.0f - IQ_CORRECTION_SMOOTHING_FACTOR) * resources->iq_correction.factors_buffer[current_active_idx].mag) + (IQ_CORRECTION_SMOOTHING_FACTOR * current_gain);
-    float smoothed_phase = ((1.0f - IQ_CORRECTION_SMOOTHING_FACTOR) * resources->iq_correction.factors_buffer[current_active_idx].phase) + (IQ_CORRECTION_SMOOTHING_FACTOR * current_phase);
-    
-    resources->iq_correction.factors_buffer[inactive_idx].mag = smoothed_gain;
-    resources->iq_correction.factors_buffer[inactive_idx].phase = smoothed_phase;
-    resources->iq_correction.active_buffer_idx = inactive_idx;
-    pthread_mutex_unlock(&resources->iq_correction.iq_factors_mutex);
-
-    log_debug("IQ_OPT_PROBE: Smoothed global params updated to: mag=%.6f, phase=%.6f", smoothed_gain, smoothed_phase);
+    log_debug("IQ_OPT_PROBE: Smoothed global params updated to: mag=%.6f, phase=%.6f", smoothed.mag, smoothed.phase);
 }
 
 void iq_correct_destroy(AppResources* resources) {
-    if (resources->config->iq_correction.enable) {
-        pthread_mutex_destroy(&resources->iq_correction.iq_factors_mutex);
-    }
     if (resources->iq_correction.fft_plan) {
         fft_destroy_plan((fftplan)resources->iq_correction.fft_plan);
         resources->iq_correction.fft_plan = NULL;
@@ -249,21 +229,37 @@ bool iq_correct_run_initial_calibration(ModuleContext* ctx, SNDFILE* infile) {
         return true;
     }
 
-    // Allocate temporary buffers from the setup arena.
+    // Allocate temporary buffers from this thread's scratch arena. They are
+    // released on every exit path, so calibration leaves no trace in setup memory.
+    ScratchArena* scratch = mem_scratch_get();
+    if (!scratch) {
+        log_fatal("Failed to allocate temporary buffers for I/Q calibration.");
+        return false;
+    }
+    ScratchMark scratch_mark = mem_scratch_mark(scratch);
     size_t raw_buffer_size = IQ_CORRECTION_FFT_SIZE * resources->input_bytes_per_sample_pair;
-    void* raw_buffer = mem_arena_alloc(&resources->setup_arena, raw_buffer_size, false);
-    complex_float_t* cf32_buffer = (complex_float_t*)mem_arena_alloc(&resources->setup_arena, IQ_CORRECTION_FFT_SIZE * sizeof(complex_float_t), false);
+    void* raw_buffer = mem_scratch_alloc(scratch, raw_buffer_size, false);
+    complex_float_t* cf32_buffer = (complex_float_t*)mem_scratch_alloc(scratch, IQ_CORRECTION_FFT_SIZE * sizeof(complex_float_t), false);
 
     if (!raw_buffer || !cf32_buffer) {
         log_fatal("Failed to allocate temporary buffers for I/Q calibration.");
+        mem_scratch_reset(scratch, scratch_mark);
         return false;
     }
 
+    // Calibrate on the first block the reader will process (the start of any
+    // --start range), and return there afterwards.
+    sf_count_t start_frame = sf_seek(infile, 0, SEEK_CUR);
+    if (start_frame < 0) {
+        start_frame = 0;
+    }
+
     // Read the first block of samples.
     sf_count_t frames_read_bytes = sf_read_raw(infile, raw_buffer, raw_buffer_size);
     if (frames_read_bytes < (sf_count_t)raw_buffer_size) {
         log_warn("Failed to read enough samples for I/Q calibration. Skipping.");
-        sf_seek(infile, 0, SEEK_SET); // Rewind anyway to be safe.
+        mem_scratch_reset(scratch, scratch_mark);
+        sf_seek(infile, start_frame, SEEK_SET); // Rewind anyway to be safe.
         return true;
     }
 
@@ -287,12 +283,13 @@ bool iq_correct_run_initial_calibration(ModuleContext* ctx, SNDFILE* infile) {
     // Run the optimization algorithm once, synchronously, on the processed data.
     // The result from the pre-processor is in the buffer pointed to by current_output_buffer.
     iq_correct_run_optimization(resources, temp_chunk.current_output_buffer);
+    mem_scratch_reset(scratch, scratch_mark);
 
     // Update the last optimization time to prevent the thread from running immediately.
     resources->iq_correction.last_optimization_time = get_monotonic_time_sec();
 
-    // Rewind the file so the main reader thread can process the file from the start.
-    if (sf_seek(infile, 0, SEEK_SET) < 0) {
+    // Rewind the file so the main reader thread starts from the same frame.
+    if (sf_seek(infile, start_frame, SEEK_SET) < 0) {
         log_fatal("Failed to rewind input file after I/Q calibration.");
         return false;
     }
@@ -304,6 +301,31 @@ bool iq_correct_run_initial_calibration(ModuleContext* ctx, SNDFILE* infile) {
 
 // --- Internal Helper Functions ---
 
+/**
+ * @brief Publishes a new pair of correction factors as a single atomic 64-bit store.
+ * The release ordering pairs with the acquire in _load_factors().
+ */
+static void _publish_factors(IqCorrectionResources* iq_res, IqCorrectionFactors factors) {
+    uint32_t mag_bits, phase_bits;
+    memcpy(&mag_bits, &factors.mag, sizeof(mag_bits));
+    memcpy(&phase_bits, &factors.phase, sizeof(phase_bits));
+    unsigned long long packed = ((unsigned long long)phase_bits << 32) | mag_bits;
+    atomic_store_explicit(&iq_res->published_factors, packed, memory_order_release);
+}
+
+/**
+ * @brief Reads the current correction factors. Never blocks.
+ */
+static IqCorrectionFactors _load_factors(IqCorrectionResources* iq_res) {
+    unsigned long long packed = atomic_load_explicit(&iq_res->published_factors, memory_order_acquire);
+    uint32_t mag_bits = (uint32_t)(packed & 0xFFFFFFFFULL);
+    uint32_t phase_bits = (uint32_t)(packed >> 32);
+    IqCorrectionFactors factors;
+    memcpy(&factors.mag, &mag_bits, sizeof(factors.mag));
+    memcpy(&factors.phase, &phase_bits, sizeof(factors.phase));
+    return factors;
+}
+
 static void _apply_correction_to_buffer(complex_float_t* buffer, int length, float gain_adj, float phase_adj) {
     const float magp1 = 1.0f + gain_adj;
     for (int i = 0; i < length; i++) {
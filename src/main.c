@@ -47,6 +47,9 @@
 #include "platform.h"
 #include "memory_arena.h"
 #include "pipeline.h"
+#include "segment.h"
+#include "buffer_alloc.h"
+#include "perf_counters.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
@@ -74,9 +77,12 @@ pthread_mutex_t g_console_mutex;
 static void initialize_resource_struct(AppConfig *config, AppResources *resources);
 static bool validate_configuration(AppConfig *config, const AppResources *resources);
 static void print_final_summary(const AppConfig *config, const AppResources *resources, bool success);
+static void print_perf_counter_summary(const AppResources *resources, int label_width);
 static void console_lock_function(bool lock, void *udata);
 static void application_progress_callback(unsigned long long current_output_frames, long long total_output_frames, unsigned long long current_bytes_written, void* udata);
 static const char* find_input_type_arg(int argc, char *argv[]);
+static size_t find_arena_size_arg(int argc, char *argv[]);
+static bool find_segment_job_arg(int argc, char *argv[]);
 
 
 // --- Main Application Entry Point ---
@@ -113,7 +119,8 @@ int main(int argc, char *argv[]) {
     pthread_mutexattr_destroy(&attr);
 
     log_set_lock(console_lock_function, &g_console_mutex);
-    log_set_level(LOG_INFO);
+    // A --segments job reports to its parent; only warnings and errors reach the console.
+    log_set_level(find_segment_job_arg(argc, argv) ? LOG_WARN : LOG_INFO);
 
     memset(&config, 0, sizeof(AppConfig));
 
@@ -121,7 +128,9 @@ int main(int argc, char *argv[]) {
     reset_shutdown_flag();
     setup_signal_handlers(&resources);
 
-    if (!mem_arena_init(&resources.setup_arena, MEM_ARENA_SIZE_BYTES)) {
+    // The arena must exist before the main parser runs, so --arena-size is pre-scanned.
+    resources.arena_size_bytes = find_arena_size_arg(argc, argv);
+    if (!mem_arena_init(&resources.setup_arena, resources.arena_size_bytes)) {
         goto cleanup;
     }
     arena_initialized = true;
@@ -174,6 +183,13 @@ int main(int argc, char *argv[]) {
         goto cleanup;
     }
 
+    // The parser reorders argv in place; --segments starts its jobs with the original order.
+    char** original_argv = (char**)mem_arena_alloc(&resources.setup_arena, (size_t)argc * sizeof(char*), false);
+    if (!original_argv) {
+        goto cleanup;
+    }
+    memcpy(original_argv, argv, (size_t)argc * sizeof(char*));
+
     // Phase 2: Call the main parser.
     if (!parse_arguments(argc, argv, &config, &resources.setup_arena)) {
         goto cleanup;
@@ -194,18 +210,27 @@ int main(int argc, char *argv[]) {
     }
     resources_initialized = true;
 
-    resources.progress_callback = application_progress_callback;
-    resources.progress_callback_udata = &g_console_mutex;
+    if (!config.segment_job.active) {
+        resources.progress_callback = application_progress_callback;
+        resources.progress_callback_udata = &g_console_mutex;
+    }
 
     resources.start_time = time(NULL);
 
 
-    // The entire concurrent operation is now encapsulated in this single call.
-    PipelineContext pipeline_context = { .config = &config, .resources = &resources };
-    if (!pipeline_run(&pipeline_context)) {
-        // pipeline_run handles its own internal cleanup. If it fails, we
-        // just need to proceed to the main application cleanup.
-        log_error("Pipeline execution failed.");
+    if (config.segments > 1) {
+        // The input is split between parallel jobs writing into this output.
+        if (!segment_run(&config, &resources, argc, original_argv)) {
+            log_error("Segmented processing failed.");
+        }
+    } else {
+        // The entire concurrent operation is now encapsulated in this single call.
+        PipelineContext pipeline_context = { .config = &config, .resources = &resources };
+        if (!pipeline_run(&pipeline_context)) {
+            // pipeline_run handles its own internal cleanup. If it fails, we
+            // just need to proceed to the main application cleanup.
+            log_error("Pipeline execution failed.");
+        }
     }
 
 
@@ -219,7 +244,7 @@ cleanup:
 
     cleanup_application(&config, &resources);
 
-    if (resources_initialized) {
+    if (resources_initialized && !config.segment_job.active) {
         print_final_summary(&config, &resources, final_ok);
     }
 
@@ -228,6 +253,7 @@ cleanup:
     if (arena_initialized) {
         mem_arena_destroy(&resources.setup_arena);
     }
+    mem_scratch_release();
 
     pthread_mutex_destroy(&g_console_mutex);
 
@@ -252,6 +278,42 @@ static const char* find_input_type_arg(int argc, char *argv[]) {
     return NULL;
 }
 
+/**
+ * Pre-scans the command line for `--arena-size` so the setup arena can be sized
+ * before it is used by the preset loader and the main parser. An invalid value
+ * falls back to the default here and is reported later by validate_memory_options().
+ */
+static size_t find_arena_size_arg(int argc, char *argv[]) {
+    const char* prefix = "--arena-size=";
+    const char* value = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--arena-size") == 0 && i + 1 < argc) {
+            value = argv[i + 1];
+        } else if (strncmp(argv[i], prefix, strlen(prefix)) == 0) {
+            value = argv[i] + strlen(prefix);
+        }
+    }
+
+    unsigned long long size_bytes = 0;
+    if (value && utils_parse_size_string(value, &size_bytes) && size_bytes >= MEM_ARENA_MIN_SIZE_BYTES) {
+        return (size_t)size_bytes;
+    }
+    return MEM_ARENA_SIZE_BYTES;
+}
+
+/**
+ * Pre-scans the command line for the internal `--segment-job` option, so that a
+ * job started by --segments is quiet from its first log line.
+ */
+static bool find_segment_job_arg(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--segment-job", strlen("--segment-job")) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static void initialize_resource_struct(AppConfig *config, AppResources *resources) {
     memset(resources, 0, sizeof(AppResources));
     config->iq_correction.enable = false;
@@ -295,10 +357,15 @@ static void print_final_summary(const AppConfig *config, const AppResources *res
             log_error("Processing stopped after %llu input frames.", resources->total_frames_read);
         }
         fprintf(stderr, "%-*s %s (possibly incomplete)\n", label_width, "Output File Size:", size_buf);
-    } else if (resources->end_of_stream_reached) {
+    } else if (atomic_load(&resources->end_of_stream_reached)) {
         fprintf(stderr, "%-*s %s\n", label_width, "Status:", "Completed Successfully");
         fprintf(stderr, "%-*s %s\n", label_width, "Processing Duration:", duration_buf);
-        fprintf(stderr, "%-*s %llu / %lld (100.0%%)\n", label_width, "Input Frames Read:", resources->total_frames_read, (long long)resources->source_info.frames);
+        if (resources->source_info.frames >= 0) {
+            fprintf(stderr, "%-*s %llu / %lld (100.0%%)\n", label_width, "Input Frames Read:", resources->total_frames_read, (long long)resources->source_info.frames);
+        } else {
+            // A stream of unknown length (e.g., stdin) that ended by itself.
+            fprintf(stderr, "%-*s %llu\n", label_width, "Input Frames Read:", resources->total_frames_read);
+        }
         fprintf(stderr, "%-*s %llu\n", label_width, "Input Samples Read:", total_input_samples);
         fprintf(stderr, "%-*s %llu\n", label_width, "Output Frames Written:", resources->total_output_frames);
         fprintf(stderr, "%-*s %llu\n", label_width, "Output Samples Written:", total_output_samples);
@@ -329,6 +396,46 @@ static void print_final_summary(const AppConfig *config, const AppResources *res
         fprintf(stderr, "%-*s %s\n", label_width, "Final Output Size:", size_buf);
         fprintf(stderr, "%-*s %.2f MB/s\n", label_width, "Average Write Speed:", avg_write_speed_mbps);
     }
+
+    fprintf(stderr, "%-*s %s\n", label_width, "Buffer Memory:", buffer_alloc_describe());
+    if (resources->page_faults_available) {
+        fprintf(stderr, "%-*s %llu / %llu (up to %llu from first touch of the buffers)\n", label_width, "Page Faults (minor/major):",
+                resources->page_faults_minor, resources->page_faults_major, resources->page_faults_first_touch_max);
+    }
+    print_perf_counter_summary(resources, label_width);
+    if (resources->latency_available) {
+        fprintf(stderr, "%-*s %.2f / %.2f / %.2f ms\n", label_width, "Latency (p50/p99/p99.9):",
+                resources->latency_p50_ms, resources->latency_p99_ms, resources->latency_p999_ms);
+    }
+}
+
+static void print_perf_counter_summary(const AppResources *resources, int label_width) {
+    int num_perf_results = perf_counters_get_result_count();
+    for (int i = 0; i < num_perf_results; i++) {
+        const PerfCounterResult* r = perf_counters_get_result(i);
+        if (!r->valid[PERF_COUNTER_CYCLES]) continue;
+
+        char label[64];
+        char detail[192];
+        int len = 0;
+        snprintf(label, sizeof(label), "Perf [%s]:", r->name);
+        if (r->valid[PERF_COUNTER_INSTRUCTIONS] && r->values[PERF_COUNTER_CYCLES] > 0) {
+            len += snprintf(detail + len, sizeof(detail) - len, "IPC %.2f, ",
+                            (double)r->values[PERF_COUNTER_INSTRUCTIONS] / (double)r->values[PERF_COUNTER_CYCLES]);
+        }
+        if (resources->total_frames_read > 0) {
+            len += snprintf(detail + len, sizeof(detail) - len, "%.1f cycles/sample, ",
+                            (double)r->values[PERF_COUNTER_CYCLES] / (double)resources->total_frames_read);
+        }
+        len += snprintf(detail + len, sizeof(detail) - len, "%.1fM cycles", (double)r->values[PERF_COUNTER_CYCLES] / 1e6);
+        if (r->valid[PERF_COUNTER_CACHE_MISSES]) {
+            len += snprintf(detail + len, sizeof(detail) - len, ", %.2fM cache misses", (double)r->values[PERF_COUNTER_CACHE_MISSES] / 1e6);
+        }
+        if (r->valid[PERF_COUNTER_BRANCH_MISSES]) {
+            snprintf(detail + len, sizeof(detail) - len, ", %.2fM branch misses", (double)r->values[PERF_COUNTER_BRANCH_MISSES] / 1e6);
+        }
+        fprintf(stderr, "%-*s %s\n", label_width, label, detail);
+    }
 }
 
 static void console_lock_function(bool lock, void *udata) {
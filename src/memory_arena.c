@@ -4,42 +4,157 @@
 #include "log.h"
 #include "constants.h"
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
 
+// --- Private Definitions ---
+
+struct MemArenaBlock {
+    MemArenaBlock* next;
+    unsigned char* data;    ///< Start of the usable region, aligned to MEM_ARENA_ALIGNMENT.
+    size_t capacity;        ///< Usable bytes starting at data.
+    size_t offset;          ///< Bump pointer within this block.
+};
+
+// --- Private Data ---
+static pthread_key_t  s_scratch_key;
+static pthread_once_t s_scratch_key_once = PTHREAD_ONCE_INIT;
+static bool           s_scratch_key_valid = false;
+
+// --- Private Helper Functions ---
+
+static size_t _align_size(size_t size) {
+    return (size + MEM_ARENA_ALIGNMENT - 1) & ~((size_t)MEM_ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Allocates a new block with at least `capacity` usable, aligned bytes.
+ *
+ * The header and the data share a single allocation. The data region is
+ * aligned manually so that the block works with plain malloc on every platform.
+ */
+static MemArenaBlock* _block_create(size_t capacity) {
+    size_t total = sizeof(MemArenaBlock) + MEM_ARENA_ALIGNMENT - 1 + capacity;
+    if (total < capacity) {
+        return NULL; // Overflow
+    }
+    MemArenaBlock* block = (MemArenaBlock*)malloc(total);
+    if (!block) {
+        return NULL;
+    }
+    uintptr_t data_start = (uintptr_t)(block + 1);
+    data_start = (data_start + MEM_ARENA_ALIGNMENT - 1) & ~((uintptr_t)MEM_ARENA_ALIGNMENT - 1);
+    block->next = NULL;
+    block->data = (unsigned char*)data_start;
+    block->capacity = capacity;
+    block->offset = 0;
+    return block;
+}
+
+static void _block_chain_free(MemArenaBlock* block) {
+    while (block) {
+        MemArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+/**
+ * @brief Bump-allocates from a block chain, moving forward or growing as needed.
+ *
+ * Blocks after `*current` are reused if they are large enough (they are
+ * empty after a scratch reset). Otherwise a new block of up to `max_growth`
+ * bytes is appended to the tail.
+ *
+ * @return The allocation, or NULL if a new block could not be created.
+ */
+static void* _chain_alloc(MemArenaBlock** first, MemArenaBlock** current, size_t block_size,
+                          size_t max_growth, size_t aligned_size, MemArenaBlock** new_block_out) {
+    *new_block_out = NULL;
+
+    MemArenaBlock* block = *current;
+    while (block && aligned_size > block->capacity - block->offset) {
+        block = block->next;
+    }
+
+    if (!block) {
+        if (aligned_size > max_growth) {
+            return NULL;
+        }
+        size_t new_capacity = (aligned_size > block_size) ? aligned_size : block_size;
+        if (new_capacity > max_growth) {
+            new_capacity = max_growth;
+        }
+        block = _block_create(new_capacity);
+        if (!block) {
+            return NULL;
+        }
+        if (!*first) {
+            *first = block;
+        } else {
+            MemArenaBlock* tail = *current ? *current : *first;
+            while (tail->next) {
+                tail = tail->next;
+            }
+            tail->next = block;
+        }
+        *new_block_out = block;
+    }
+
+    void* ptr = block->data + block->offset;
+    block->offset += aligned_size;
+    *current = block;
+    return ptr;
+}
+
+static void _scratch_destructor(void* value) {
+    ScratchArena* scratch = (ScratchArena*)value;
+    if (scratch) {
+        _block_chain_free(scratch->first);
+        free(scratch);
+    }
+}
+
+static void _scratch_key_create(void) {
+    s_scratch_key_valid = (pthread_key_create(&s_scratch_key, _scratch_destructor) == 0);
+}
+
+// --- Public Function Implementations (Setup Arena) ---
+
 /**
- * @brief Initializes a memory arena with a specified capacity.
+ * @brief Initializes a memory arena with a specified initial capacity.
  * @param arena Pointer to the MemoryArena struct to initialize.
- * @param capacity The total size of the memory block to allocate.
+ * @param capacity The size of the first block.
  * @return true on success, false on memory allocation failure.
  */
 bool mem_arena_init(MemoryArena* arena, size_t capacity) {
     if (!arena) return false;
 
-    // FIX: Handle malloc(0) edge case gracefully.
+    memset(arena, 0, sizeof(MemoryArena));
+
+    // A zero capacity is allowed; the first allocation will create a block.
     if (capacity == 0) {
         log_warn("Initializing memory arena with zero capacity.");
-        arena->memory = NULL;
-        arena->capacity = 0;
-        arena->offset = 0;
+        arena->block_size = MEM_SCRATCH_BLOCK_SIZE_BYTES;
     } else {
-        arena->memory = malloc(capacity);
-        if (!arena->memory) {
+        arena->first = _block_create(capacity);
+        if (!arena->first) {
             log_fatal("Failed to allocate memory for setup arena (%zu bytes).", capacity);
             return false;
         }
+        arena->current = arena->first;
+        arena->block_size = capacity;
         arena->capacity = capacity;
-        arena->offset = 0;
+        arena->num_blocks = 1;
     }
 
-    // Initialize the mutex
     int ret = pthread_mutex_init(&arena->mutex, NULL);
     if (ret != 0) {
         log_fatal("Failed to initialize memory arena mutex: %s", strerror(ret));
-        if (arena->memory) {
-            free(arena->memory);
-            arena->memory = NULL;
-        }
+        _block_chain_free(arena->first);
+        arena->first = NULL;
+        arena->current = NULL;
         return false;
     }
 
@@ -49,36 +164,49 @@ bool mem_arena_init(MemoryArena* arena, size_t capacity) {
 
 /**
  * @brief Allocates a block of memory from the arena.
- * This is a simple, fast bump-pointer allocator.
+ * This is a simple, fast bump-pointer allocator that chains a new block when
+ * the current one is exhausted.
  * @param arena Pointer to the initialized MemoryArena.
  * @param size The number of bytes to allocate.
  * @param zero_memory If true, the allocated memory will be zero-initialized.
- * @return A void pointer to the allocated memory, or NULL if the arena is full.
+ * @return A void pointer to the allocated memory, or NULL on allocation failure.
  */
 void* mem_arena_alloc(MemoryArena* arena, size_t size, bool zero_memory) {
-    // Align the size to the next multiple of the alignment constant for performance
-    size_t aligned_size = (size + MEM_ARENA_ALIGNMENT - 1) & ~(MEM_ARENA_ALIGNMENT - 1);
-
     if (!arena) {
         return NULL;
     }
 
+    size_t aligned_size = _align_size(size);
+
     pthread_mutex_lock(&arena->mutex);
 
-    // FIX: Use an integer-overflow-safe check and log a non-fatal error.
-    if (!arena->memory || (aligned_size > arena->capacity - arena->offset)) {
-        log_error("Memory arena exhausted. Requested %zu bytes, but only %zu remaining.",
-                  size, arena->capacity - arena->offset);
+    size_t max_growth = SIZE_MAX;
+    if (arena->limit > 0) {
+        max_growth = (arena->limit > arena->capacity) ? arena->limit - arena->capacity : 0;
+    }
+
+    MemArenaBlock* new_block = NULL;
+    void* ptr = _chain_alloc(&arena->first, &arena->current, arena->block_size, max_growth, aligned_size, &new_block);
+    if (!ptr) {
+        if (arena->limit > 0) {
+            log_error("Memory arena could not grow. Requested %zu bytes with %zu bytes already in use (limit %zu bytes).",
+                      size, arena->used, arena->limit);
+        } else {
+            log_error("Memory arena could not grow. Requested %zu bytes with %zu bytes already in use.",
+                      size, arena->used);
+        }
         pthread_mutex_unlock(&arena->mutex);
         return NULL;
     }
+    if (new_block) {
+        arena->capacity += new_block->capacity;
+        arena->num_blocks++;
+        log_debug("Setup memory arena grew to %d blocks (%zu bytes).", arena->num_blocks, arena->capacity);
+    }
+    arena->used += aligned_size;
 
-    void* ptr = (char*)arena->memory + arena->offset;
-    arena->offset += aligned_size;
-    
     pthread_mutex_unlock(&arena->mutex);
 
-    // FIX: Make zero-initialization optional for performance.
     if (zero_memory) {
         memset(ptr, 0, size);
     }
@@ -86,17 +214,117 @@ void* mem_arena_alloc(MemoryArena* arena, size_t size, bool zero_memory) {
 }
 
 /**
- * @brief Destroys a memory arena, freeing its main memory block.
+ * @brief Caps how far the arena may grow.
+ * @param arena Pointer to the initialized MemoryArena.
+ * @param limit The largest total capacity, in bytes, or 0 to remove the limit.
+ */
+void mem_arena_set_limit(MemoryArena* arena, size_t limit) {
+    if (!arena) return;
+    pthread_mutex_lock(&arena->mutex);
+    arena->limit = limit;
+    pthread_mutex_unlock(&arena->mutex);
+}
+
+/**
+ * @brief Destroys a memory arena, freeing every block in its chain.
  * @param arena Pointer to the MemoryArena to destroy.
  */
 void mem_arena_destroy(MemoryArena* arena) {
     if (arena) {
-        pthread_mutex_destroy(&arena->mutex);
-        if (arena->memory) {
-            free(arena->memory);
-            arena->memory = NULL;
+        if (arena->first) {
+            log_debug("Setup memory arena used %zu of %zu bytes in %d block(s).",
+                      arena->used, arena->capacity, arena->num_blocks);
         }
+        pthread_mutex_destroy(&arena->mutex);
+        _block_chain_free(arena->first);
+        arena->first = NULL;
+        arena->current = NULL;
         arena->capacity = 0;
-        arena->offset = 0;
+        arena->limit = 0;
+        arena->used = 0;
+        arena->num_blocks = 0;
+    }
+}
+
+// --- Public Function Implementations (Scratch Arenas) ---
+
+ScratchArena* mem_scratch_get(void) {
+    pthread_once(&s_scratch_key_once, _scratch_key_create);
+    if (!s_scratch_key_valid) {
+        log_error("Failed to create the thread-local key for scratch arenas.");
+        return NULL;
+    }
+
+    ScratchArena* scratch = (ScratchArena*)pthread_getspecific(s_scratch_key);
+    if (scratch) {
+        return scratch;
+    }
+
+    scratch = (ScratchArena*)calloc(1, sizeof(ScratchArena));
+    if (!scratch) {
+        log_error("Failed to allocate a scratch arena for the current thread.");
+        return NULL;
+    }
+    scratch->block_size = MEM_SCRATCH_BLOCK_SIZE_BYTES;
+
+    int ret = pthread_setspecific(s_scratch_key, scratch);
+    if (ret != 0) {
+        log_error("Failed to register the scratch arena for the current thread: %s", strerror(ret));
+        free(scratch);
+        return NULL;
+    }
+    return scratch;
+}
+
+ScratchMark mem_scratch_mark(const ScratchArena* scratch) {
+    ScratchMark mark = { NULL, 0 };
+    if (scratch && scratch->current) {
+        mark.block = scratch->current;
+        mark.offset = scratch->current->offset;
+    }
+    return mark;
+}
+
+void* mem_scratch_alloc(ScratchArena* scratch, size_t size, bool zero_memory) {
+    if (!scratch) {
+        return NULL;
+    }
+
+    MemArenaBlock* new_block = NULL;
+    void* ptr = _chain_alloc(&scratch->first, &scratch->current, scratch->block_size, SIZE_MAX, _align_size(size), &new_block);
+    if (!ptr) {
+        log_error("Failed to allocate %zu bytes of scratch memory.", size);
+        return NULL;
+    }
+
+    if (zero_memory) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void mem_scratch_reset(ScratchArena* scratch, ScratchMark mark) {
+    if (!scratch || !scratch->first) {
+        return;
+    }
+
+    // A NULL mark was taken before the first block existed: rewind everything.
+    MemArenaBlock* keep = mark.block ? mark.block : scratch->first;
+    keep->offset = mark.block ? mark.offset : 0;
+    for (MemArenaBlock* block = keep->next; block; block = block->next) {
+        block->offset = 0;
+    }
+    scratch->current = keep;
+}
+
+void mem_scratch_release(void) {
+    pthread_once(&s_scratch_key_once, _scratch_key_create);
+    if (!s_scratch_key_valid) {
+        return;
+    }
+    ScratchArena* scratch = (ScratchArena*)pthread_getspecific(s_scratch_key);
+    if (scratch) {
+        pthread_setspecific(s_scratch_key, NULL);
+        _scratch_destructor(scratch);
     }
 }
@@ -9,6 +9,9 @@
 #include "input_wav.h"
 #include "input_rawfile.h"
 #include "input_spyserver_client.h"
+#include "input_generator.h"
+#include "input_simsdr.h"
+#include "input_stdin.h"
 #if defined(WITH_RTLSDR)
 #include "input_rtlsdr.h"
 #endif
@@ -27,6 +30,7 @@
 #include "output_wav.h"
 #include "output_wav_rf64.h"
 #include "output_stdout.h"
+#include "output_null.h"
 
 
 #ifdef _WIN32
@@ -120,6 +124,35 @@ static void initialize_modules_list(MemoryArena* arena) {
             .get_cli_options = spyserver_client_get_cli_options,
             .requires_output_path = false,
         },
+        {
+            .name = "generator",
+            .type = MODULE_TYPE_INPUT,
+            .api = get_generator_input_module_api(),
+            .is_sdr = false,
+            .set_default_config = NULL,
+            .get_cli_options = generator_get_cli_options,
+            .requires_output_path = false,
+            .uses_generated_signal = true,
+        },
+        {
+            .name = "sim-sdr", // Replays a file or the generator's signal through the SDR callback path
+            .type = MODULE_TYPE_INPUT,
+            .api = get_simsdr_input_module_api(),
+            .is_sdr = true,
+            .set_default_config = NULL,
+            .get_cli_options = simsdr_get_cli_options,
+            .requires_output_path = false,
+            .uses_generated_signal = true,
+        },
+        {
+            .name = "stdin", // Raw I/Q piped in from another tool; no watchdog, as pipes may idle
+            .type = MODULE_TYPE_INPUT,
+            .api = get_stdin_input_module_api(),
+            .is_sdr = false,
+            .set_default_config = NULL,
+            .get_cli_options = stdin_get_cli_options,
+            .requires_output_path = false,
+        },
         // --- OUTPUT MODULES ---
         {
             .name = "raw-file",
@@ -157,6 +190,15 @@ static void initialize_modules_list(MemoryArena* arena) {
             .get_cli_options = NULL,
             .requires_output_path = false,
         },
+        {
+            .name = "null", // Discards output; for measuring pipeline throughput
+            .type = MODULE_TYPE_OUTPUT,
+            .api = get_null_output_module_api(),
+            .is_sdr = false,
+            .set_default_config = NULL,
+            .get_cli_options = NULL,
+            .requires_output_path = false,
+        },
     };
 
     num_all_modules = sizeof(temp_modules) / sizeof(temp_modules[0]);
@@ -221,7 +263,32 @@ bool module_manager_is_sdr_module(const char* name, MemoryArena* arena) {
     return (mod != NULL && mod->is_sdr);
 }
 
-void module_manager_populate_cli_options(
+/**
+ * @brief Appends a module's options, unbinding them if they belong to an inactive input.
+ */
+static bool _append_cli_options(struct argparse_option* dest_buffer, int* total_opts_ptr, int max_opts,
+                                const struct argparse_option* opts, int count, bool bound) {
+    if (!opts || count <= 0) return true;
+    if (*total_opts_ptr + count > max_opts) {
+        log_fatal("Internal error: Exceeded maximum number of CLI options.");
+        return false;
+    }
+
+    memcpy(&dest_buffer[*total_opts_ptr], opts, count * sizeof(struct argparse_option));
+
+    if (!bound) {
+        for (int j = 0; j < count; j++) {
+            struct argparse_option* opt = &dest_buffer[*total_opts_ptr + j];
+            if (opt->type != ARGPARSE_OPT_GROUP) {
+                opt->value = NULL;
+            }
+        }
+    }
+    *total_opts_ptr += count;
+    return true;
+}
+
+bool module_manager_populate_cli_options(
     struct argparse_option* dest_buffer,
     int* total_opts_ptr,
     int max_opts,
@@ -229,30 +296,34 @@ void module_manager_populate_cli_options(
     struct MemoryArena* arena)
 {
     initialize_modules_list(arena);
-    if (!all_modules) return;
+    if (!all_modules) return true;
+
+    // The --gen-* signal options are shared, so they are bound if any input that reads them is active.
+    bool signal_bound = (active_input_type == NULL);
+    for (int i = 0; i < num_all_modules; ++i) {
+        if (active_input_type && all_modules[i].uses_generated_signal && strcasecmp(all_modules[i].name, active_input_type) == 0) {
+            signal_bound = true;
+        }
+    }
+    bool signal_added = false;
 
     for (int i = 0; i < num_all_modules; ++i) {
         if (all_modules[i].get_cli_options) {
             int count = 0;
             const struct argparse_option* opts = all_modules[i].get_cli_options(&count);
-            if (opts && count > 0) {
-                if (*total_opts_ptr + count > max_opts) {
-                    log_fatal("Internal error: Exceeded maximum number of CLI options.");
-                    return;
-                }
-
-                memcpy(&dest_buffer[*total_opts_ptr], opts, count * sizeof(struct argparse_option));
-
-                if (active_input_type && all_modules[i].type == MODULE_TYPE_INPUT && strcasecmp(all_modules[i].name, active_input_type) != 0) {
-                    for (int j = 0; j < count; j++) {
-                        struct argparse_option* opt = &dest_buffer[*total_opts_ptr + j];
-                        if (opt->type != ARGPARSE_OPT_GROUP) {
-                            opt->value = NULL;
-                        }
-                    }
-                }
-                *total_opts_ptr += count;
+            bool bound = !(active_input_type && all_modules[i].type == MODULE_TYPE_INPUT && strcasecmp(all_modules[i].name, active_input_type) != 0);
+            if (!_append_cli_options(dest_buffer, total_opts_ptr, max_opts, opts, count, bound)) {
+                return false;
+            }
+        }
+        if (all_modules[i].uses_generated_signal && !signal_added) {
+            int count = 0;
+            const struct argparse_option* opts = generator_get_signal_cli_options(&count);
+            if (!_append_cli_options(dest_buffer, total_opts_ptr, max_opts, opts, count, signal_bound)) {
+                return false;
             }
+            signal_added = true;
         }
     }
+    return true;
 }
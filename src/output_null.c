@@ -0,0 +1,95 @@
+#include "output_null.h"
+#include "module.h"
+#include "app_context.h"
+#include "log.h"
+#include "queue.h"
+#include "telemetry.h"
+#include "utils.h"
+
+// --- Private Data ---
+typedef struct {
+    long long total_bytes_discarded;
+} NullData;
+
+// --- Module Implementation ---
+
+static bool null_out_initialize(ModuleContext* ctx) {
+    AppResources* resources = ctx->resources;
+
+    NullData* data = (NullData*)mem_arena_alloc(&resources->setup_arena, sizeof(NullData), true);
+    if (!data) {
+        return false;
+    }
+    resources->output_module_private_data = data;
+    return true;
+}
+
+static void* null_out_run_writer(ModuleContext* ctx) {
+    AppResources* resources = ctx->resources;
+    NullData* data = (NullData*)resources->output_module_private_data;
+
+    while (true) {
+        SampleChunk* item = (SampleChunk*)queue_dequeue(resources->writer_input_queue);
+        if (!item) break; // Shutdown
+
+        if (item->stream_discontinuity_event) {
+            queue_enqueue(resources->free_sample_chunk_queue, item);
+            continue;
+        }
+
+        if (item->is_last_chunk) {
+            queue_enqueue(resources->free_sample_chunk_queue, item);
+            break; // End of stream
+        }
+
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
+        data->total_bytes_discarded += (long long)(item->frames_to_write * resources->output_bytes_per_sample_pair);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER, item->frames_to_write);
+        telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_WRITER, item->capture_time_ns);
+
+        if (!queue_enqueue(resources->free_sample_chunk_queue, item)) {
+            break; // Shutdown
+        }
+    }
+    log_debug("Null output writer thread is exiting.");
+    return NULL;
+}
+
+static size_t null_out_write_chunk(ModuleContext* ctx, const void* buffer, size_t bytes_to_write) {
+    (void)buffer;
+    AppResources* resources = ctx->resources;
+    NullData* data = (NullData*)resources->output_module_private_data;
+    if (!data) return 0;
+
+    data->total_bytes_discarded += (long long)bytes_to_write;
+    return bytes_to_write;
+}
+
+static void null_out_finalize_output(ModuleContext* ctx) {
+    AppResources* resources = ctx->resources;
+    if (!resources->output_module_private_data) return;
+    NullData* data = (NullData*)resources->output_module_private_data;
+
+    resources->final_output_size_bytes = data->total_bytes_discarded;
+}
+
+static void null_out_get_summary_info(const ModuleContext* ctx, OutputSummaryInfo* info) {
+    (void)ctx;
+    add_summary_item(info, "Output Type", "NULL (discarded)");
+}
+
+// --- The V-Table ---
+static OutputModuleInterface null_output_module_api = {
+    .validate_options = NULL,
+    .get_cli_options = NULL,
+    .initialize = null_out_initialize,
+    .run_writer = null_out_run_writer,
+    .write_chunk = null_out_write_chunk,
+    .finalize_output = null_out_finalize_output,
+    .get_summary_info = null_out_get_summary_info,
+};
+
+// --- Public Getter ---
+OutputModuleInterface* get_null_output_module_api(void) {
+    return &null_output_module_api;
+}
@@ -6,6 +6,11 @@
 #include "ring_buffer.h"
 #include "utils.h"
 #include "signal_handler.h"
+#include "telemetry.h"
+#include "file_writer.h"
+#include "sample_convert.h"
+#include "file_splice.h"
+#include "segment.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -25,6 +30,7 @@
 typedef struct {
     FILE* handle;
     long long total_bytes_written;
+    FileWriter* write_behind;  ///< Non-NULL with --write-behind; replaces stdio writes.
 } RawOutData;
 
 // --- Helper Functions (migrated from output_writer.c) ---
@@ -139,6 +145,24 @@ static bool raw_out_initialize(ModuleContext* ctx) {
         return false;
     }
 
+    #ifndef _WIN32
+    if (config->write_behind_depth > 0) {
+        int fd = fileno(data->handle);
+        struct stat stat_buf;
+        if (fstat(fd, &stat_buf) != 0 || !S_ISREG(stat_buf.st_mode)) {
+            log_warn("--write-behind needs a regular output file. Falling back to buffered writes.");
+        } else {
+            unsigned long long expected_bytes = 0;
+            if (resources->expected_total_output_frames > 0) {
+                expected_bytes = (unsigned long long)resources->expected_total_output_frames *
+                                 get_bytes_per_sample(config->output_format);
+            }
+            data->write_behind = file_writer_create(fd, (unsigned int)config->write_behind_depth,
+                                                    IO_OUTPUT_WRITER_CHUNK_SIZE, config->direct_io, expected_bytes);
+        }
+    }
+    #endif
+
     resources->output_module_private_data = data;
     return true;
 }
@@ -147,22 +171,33 @@ static void* raw_out_run_writer(ModuleContext* ctx) {
     AppResources* resources = ctx->resources;
     RawOutData* data = (RawOutData*)resources->output_module_private_data;
 
+    if (data->write_behind) {
+        file_writer_run_writer(ctx, data->write_behind, &data->total_bytes_written, "Writer (raw-file)");
+        log_debug("Raw-file output writer thread is exiting.");
+        return NULL;
+    }
+
     unsigned char* local_write_buffer = (unsigned char*)resources->writer_local_buffer;
     if (!local_write_buffer) {
         handle_fatal_thread_error("Writer (raw-file): Local write buffer is NULL.", resources);
         return NULL;
     }
 
+    unsigned long long stream_bytes_consumed = 0;
     while (true) {
         size_t bytes_read = ring_buffer_read(resources->writer_input_buffer, local_write_buffer, IO_OUTPUT_WRITER_CHUNK_SIZE);
         if (bytes_read == 0) {
             break; // End of stream
         }
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
 
         size_t written_bytes = fwrite(local_write_buffer, 1, bytes_read, data->handle);
         if (written_bytes > 0) {
             data->total_bytes_written += written_bytes;
         }
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER, written_bytes / resources->output_bytes_per_sample_pair);
+        stream_bytes_consumed += bytes_read;
+        telemetry_latency_index_advance(resources->telemetry, stream_bytes_consumed);
 
         if (written_bytes != bytes_read) {
             char error_buf[256];
@@ -173,9 +208,7 @@ static void* raw_out_run_writer(ModuleContext* ctx) {
 
         if (resources->progress_callback) {
             unsigned long long current_frames = data->total_bytes_written / resources->output_bytes_per_sample_pair;
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->total_output_frames = current_frames;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_store_explicit(&resources->total_output_frames, current_frames, memory_order_relaxed);
             resources->progress_callback(current_frames, resources->expected_total_output_frames, data->total_bytes_written, resources->progress_callback_udata);
         }
     }
@@ -188,6 +221,14 @@ static size_t raw_out_write_chunk(ModuleContext* ctx, const void* buffer, size_t
     RawOutData* data = (RawOutData*)resources->output_module_private_data;
     if (!data || !data->handle) return 0;
 
+    if (data->write_behind) {
+        if (!file_writer_write(data->write_behind, buffer, bytes_to_write)) {
+            return 0;
+        }
+        data->total_bytes_written += bytes_to_write;
+        return bytes_to_write;
+    }
+
     size_t written = fwrite(buffer, 1, bytes_to_write, data->handle);
     if (written > 0) {
         data->total_bytes_written += written;
@@ -195,11 +236,34 @@ static size_t raw_out_write_chunk(ModuleContext* ctx, const void* buffer, size_t
     return written;
 }
 
+static long long raw_out_copy_from_file(ModuleContext* ctx, int in_fd, unsigned long long offset, unsigned long long length) {
+    RawOutData* data = (RawOutData*)ctx->resources->output_module_private_data;
+    if (!data || !data->handle || data->write_behind || fflush(data->handle) != 0) {
+        return -1;
+    }
+    return file_splice_to_output(ctx, in_fd, offset, length, fileno(data->handle), &data->total_bytes_written, "Writer (raw-file)");
+}
+
+static long long raw_out_write_segments(ModuleContext* ctx) {
+    RawOutData* data = (RawOutData*)ctx->resources->output_module_private_data;
+    if (!data || !data->handle || data->write_behind || fflush(data->handle) != 0) {
+        return -1;
+    }
+    return segment_write_output(ctx, fileno(data->handle), 0, &data->total_bytes_written);
+}
+
 static void raw_out_finalize_output(ModuleContext* ctx) {
     AppResources* resources = ctx->resources;
     if (!resources->output_module_private_data) return;
     RawOutData* data = (RawOutData*)resources->output_module_private_data;
 
+    if (data->write_behind) {
+        if (!file_writer_finish(data->write_behind) && !resources->error_occurred) {
+            log_error("Failed to complete the output file: %s", strerror(errno));
+        }
+        file_writer_destroy(data->write_behind);
+        data->write_behind = NULL;
+    }
     if (data->handle) {
         fclose(data->handle);
         data->handle = NULL;
@@ -208,8 +272,11 @@ static void raw_out_finalize_output(ModuleContext* ctx) {
 }
 
 static void raw_out_get_summary_info(const ModuleContext* ctx, OutputSummaryInfo* info) {
-    (void)ctx;
+    const RawOutData* data = (const RawOutData*)ctx->resources->output_module_private_data;
     add_summary_item(info, "Output Type", "RAW");
+    if (data && data->write_behind) {
+        add_summary_item(info, "Output Writes", "Write-behind (%s)", file_writer_describe(data->write_behind));
+    }
 }
 
 // --- The V-Table ---
@@ -219,6 +286,8 @@ static OutputModuleInterface raw_output_module_api = {
     .initialize = raw_out_initialize,
     .run_writer = raw_out_run_writer,
     .write_chunk = raw_out_write_chunk,
+    .copy_from_file = raw_out_copy_from_file,
+    .write_segments = raw_out_write_segments,
     .finalize_output = raw_out_finalize_output,
     .get_summary_info = raw_out_get_summary_info,
 };
@@ -0,0 +1,198 @@
+/**
+ * @file output_segment.c
+ * @brief Implements the output module used by a --segments job.
+ */
+
+#include "output_segment.h"
+#include "module.h"
+#include "app_context.h"
+#include "constants.h"
+#include "log.h"
+#include "ring_buffer.h"
+#include "sample_convert.h"
+#include "signal_handler.h"
+#include "telemetry.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// --- Private Data ---
+typedef struct {
+    int fd;
+    unsigned long long skip_bytes;     ///< Warm-up output still to drop.
+    unsigned long long limit_bytes;    ///< Bytes to write, 0 for all.
+    long long total_bytes_written;
+    double last_report_time;
+} SegmentOutData;
+
+// --- Forward Declarations for Static Helper Functions ---
+static void _report(const ModuleContext* ctx, SegmentOutData* data, bool done);
+
+// --- Module Implementation ---
+
+static bool segment_out_initialize(ModuleContext* ctx) {
+#ifdef _WIN32
+    (void)ctx;
+    log_fatal("--segments is not supported on Windows.");
+    return false;
+#else
+    const AppConfig* config = ctx->config;
+    AppResources* resources = ctx->resources;
+    const SegmentJob* job = &config->segment_job;
+
+    SegmentOutData* data = (SegmentOutData*)mem_arena_alloc(&resources->setup_arena, sizeof(SegmentOutData), true);
+    if (!data) {
+        return false;
+    }
+
+    // The parent created the file and owns its header; never create or truncate it here.
+    data->fd = open(config->effective_output_filename, O_WRONLY | O_NOFOLLOW);
+    if (data->fd < 0) {
+        log_fatal("Segment %u: could not open output file %s: %s", job->index, config->effective_output_filename, strerror(errno));
+        return false;
+    }
+    size_t frame_bytes = get_bytes_per_sample(config->output_format);
+    data->skip_bytes = job->skip_frames * frame_bytes;
+    data->limit_bytes = job->write_frames * frame_bytes;
+
+    resources->output_module_private_data = data;
+    return true;
+#endif
+}
+
+static void* segment_out_run_writer(ModuleContext* ctx) {
+    AppResources* resources = ctx->resources;
+    SegmentOutData* data = (SegmentOutData*)resources->output_module_private_data;
+
+    unsigned char* local_write_buffer = (unsigned char*)resources->writer_local_buffer;
+    if (!local_write_buffer) {
+        handle_fatal_thread_error("Writer (segment): Local write buffer is NULL.", resources);
+        return NULL;
+    }
+
+    unsigned long long write_offset = ctx->config->segment_job.write_offset;
+    unsigned long long stream_bytes_consumed = 0;
+    while (true) {
+        size_t bytes_read = ring_buffer_read(resources->writer_input_buffer, local_write_buffer, IO_OUTPUT_WRITER_CHUNK_SIZE);
+        if (bytes_read == 0) {
+            break; // End of stream
+        }
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
+
+        // Drop the warm-up, then write up to the limit. The rest (the trailing
+        // warm-up) is drained so the pipeline can finish normally.
+        const unsigned char* p = local_write_buffer;
+        size_t bytes = bytes_read;
+        size_t skipped = (data->skip_bytes < bytes) ? (size_t)data->skip_bytes : bytes;
+        data->skip_bytes -= skipped;
+        p += skipped;
+        bytes -= skipped;
+        if (data->limit_bytes > 0) {
+            unsigned long long room = data->limit_bytes - (unsigned long long)data->total_bytes_written;
+            if (bytes > room) bytes = (size_t)room;
+        }
+
+        size_t written_bytes = 0;
+#ifndef _WIN32
+        while (written_bytes < bytes) {
+            ssize_t n = pwrite(data->fd, p + written_bytes, bytes - written_bytes,
+                               (off_t)(write_offset + (unsigned long long)data->total_bytes_written + written_bytes));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            written_bytes += (size_t)n;
+        }
+#endif
+        data->total_bytes_written += (long long)written_bytes;
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER, written_bytes / resources->output_bytes_per_sample_pair);
+        stream_bytes_consumed += bytes_read;
+        telemetry_latency_index_advance(resources->telemetry, stream_bytes_consumed);
+
+        if (written_bytes != bytes) {
+            char error_buf[256];
+            snprintf(error_buf, sizeof(error_buf), "Writer (segment): File write error: %s", strerror(errno));
+            handle_fatal_thread_error(error_buf, resources);
+            break;
+        }
+
+        atomic_store_explicit(&resources->total_output_frames,
+                              (unsigned long long)data->total_bytes_written / resources->output_bytes_per_sample_pair,
+                              memory_order_relaxed);
+        _report(ctx, data, false);
+    }
+    log_debug("Segment output writer thread is exiting.");
+    return NULL;
+}
+
+static void segment_out_finalize_output(ModuleContext* ctx) {
+    AppResources* resources = ctx->resources;
+    if (!resources->output_module_private_data) return;
+    SegmentOutData* data = (SegmentOutData*)resources->output_module_private_data;
+
+#ifndef _WIN32
+    if (data->fd >= 0) {
+        if (close(data->fd) != 0 && !resources->error_occurred) {
+            log_error("Error closing the output file: %s", strerror(errno));
+            atomic_store(&resources->error_occurred, true);
+        }
+        data->fd = -1;
+    }
+#endif
+    _report(ctx, data, !resources->error_occurred && !is_shutdown_requested());
+    resources->final_output_size_bytes = data->total_bytes_written;
+}
+
+static void segment_out_get_summary_info(const ModuleContext* ctx, OutputSummaryInfo* info) {
+    add_summary_item(info, "Output Type", "Segment %u", ctx->config->segment_job.index);
+}
+
+// --- Static Helper Function Implementations ---
+
+/**
+ * @brief Tells the parent how many frames this job has written, at most every SEGMENT_REPORT_POLL_MS.
+ *
+ * A report is one short line, so a single write() to the pipe is atomic.
+ */
+static void _report(const ModuleContext* ctx, SegmentOutData* data, bool done) {
+#ifdef _WIN32
+    (void)ctx;
+    (void)data;
+    (void)done;
+#else
+    double now = get_monotonic_time_sec();
+    if (!done && now - data->last_report_time < SEGMENT_REPORT_POLL_MS / 1000.0) {
+        return;
+    }
+    data->last_report_time = now;
+
+    const SegmentJob* job = &ctx->config->segment_job;
+    size_t frame_bytes = get_bytes_per_sample(ctx->config->output_format);
+    char line[96];
+    int len = snprintf(line, sizeof(line), "%u %llu %d\n", job->index,
+                       (unsigned long long)data->total_bytes_written / frame_bytes, done ? 1 : 0);
+    if (len > 0 && write(job->report_fd, line, (size_t)len) != len) {
+        log_debug("Segment %u: could not report progress: %s", job->index, strerror(errno));
+    }
+#endif
+}
+
+// --- The V-Table ---
+static OutputModuleInterface segment_output_module_api = {
+    .validate_options = NULL,
+    .get_cli_options = NULL,
+    .initialize = segment_out_initialize,
+    .run_writer = segment_out_run_writer,
+    .write_chunk = NULL,
+    .finalize_output = segment_out_finalize_output,
+    .get_summary_info = segment_out_get_summary_info,
+};
+
+// --- Public Getter ---
+OutputModuleInterface* get_segment_output_module_api(void) {
+    return &segment_output_module_api;
+}
@@ -1,23 +1,278 @@
 #include "output_stdout.h"
 #include "module.h"
 #include "app_context.h"
+#include "constants.h"
 #include "log.h"
 #include "platform.h"
 #include "queue.h"
 #include "signal_handler.h"
+#include "telemetry.h"
 #include "utils.h"
+#include "file_splice.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <errno.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(F_SETPIPE_SZ) && defined(SPLICE_F_GIFT)
+#define STDOUT_HAVE_PIPE_CONTROL 1
+#endif
+
 // --- Private Data ---
 typedef struct {
     long long total_bytes_written;
+#ifndef _WIN32
+    int       fd;
+    size_t    pipe_size;       ///< Capacity of the stdout pipe; 0 if stdout is not a pipe we can size.
+    size_t    page_size;
+    bool      zero_copy;       ///< --stdout-zero-copy is in effect.
+    bool      nowait;          ///< Writes to the pipe use RWF_NOWAIT.
+
+    // Chunks gifted with vmsplice() stay out of the free pool until the
+    // consumer has read them, because the pipe still points at their pages.
+    SampleChunk**       held;
+    unsigned long long* held_end;       ///< Stream offset just past each held chunk.
+    size_t              held_capacity;
+    size_t              held_head;
+    size_t              held_count;
+
+    unsigned long long stall_ns;         ///< Time spent waiting for room in a full pipe.
+    unsigned long long num_stalls;
+#endif
 } StdoutData;
 
+// --- Private Helper Functions ---
+
+#ifndef _WIN32
+
+/**
+ * @brief Reads the number of bytes written to the pipe that the consumer has not read yet.
+ * @return false if the pipe cannot report it (errno is set).
+ */
+static bool _pipe_queued(const StdoutData* data, size_t* queued_bytes) {
+    int queued = 0;
+    if (ioctl(data->fd, FIONREAD, &queued) != 0) {
+        return false;
+    }
+    if (queued < 0) {
+        errno = EINVAL;
+        return false;
+    }
+    *queued_bytes = (size_t)queued;
+    return true;
+}
+
+/**
+ * @brief Blocks until the pipe has room, adding the wait to the stall statistics.
+ */
+static void _wait_for_room(AppResources* resources, StdoutData* data, size_t frames_waiting) {
+    unsigned long long start = get_monotonic_time_ns();
+    unsigned long long step_start = telemetry_step_begin(resources->telemetry);
+    struct pollfd pfd = { .fd = data->fd, .events = POLLOUT, .revents = 0 };
+    while (!is_shutdown_requested()) {
+        int ready = poll(&pfd, 1, 100);
+        if (ready > 0 || (ready < 0 && errno != EINTR)) {
+            break; // Writable, or an error the next write will report.
+        }
+    }
+    data->stall_ns += get_monotonic_time_ns() - start;
+    data->num_stalls++;
+    telemetry_step_end(resources->telemetry, TELEMETRY_STEP_PIPE_STALL, step_start, frames_waiting);
+}
+
+/**
+ * @brief Returns gifted chunks to the free pool once the consumer has read past them.
+ */
+static void _release_consumed_chunks(AppResources* resources, StdoutData* data) {
+    if (data->held_count == 0) {
+        return;
+    }
+    size_t queued = 0;
+    if (!_pipe_queued(data, &queued)) {
+        // Without the fill level a held chunk may still be unread, so keep them
+        // all until the end of the stream and stop gifting new ones.
+        if (data->zero_copy) {
+            log_warn("Writer (stdout): Cannot read the pipe fill level (%s). Copying instead of zero-copy.", strerror(errno));
+            data->zero_copy = false;
+        }
+        return;
+    }
+    unsigned long long consumed = (unsigned long long)data->total_bytes_written - queued;
+    while (data->held_count > 0 && data->held_end[data->held_head] <= consumed) {
+        queue_enqueue(resources->free_sample_chunk_queue, data->held[data->held_head]);
+        data->held_head = (data->held_head + 1) % data->held_capacity;
+        data->held_count--;
+    }
+}
+
+/**
+ * @brief Writes a gathered batch, with writev() or (gift) vmsplice().
+ *
+ * On a pipe each call is non-blocking, so a full pipe shows up as a counted
+ * wait for POLLOUT rather than time hidden inside the write.
+ *
+ * @return false on a write error (errno is set).
+ */
+static bool _write_iov(AppResources* resources, StdoutData* data, struct iovec* iov, int iovcnt, bool gift) {
+    while (iovcnt > 0) {
+        ssize_t written;
+#ifdef STDOUT_HAVE_PIPE_CONTROL
+        if (gift) {
+            written = vmsplice(data->fd, iov, (unsigned long)iovcnt, SPLICE_F_GIFT | SPLICE_F_NONBLOCK);
+        } else
+#else
+        (void)gift;
+#endif
+#ifdef RWF_NOWAIT
+        if (data->nowait) {
+            written = pwritev2(data->fd, iov, iovcnt, -1, RWF_NOWAIT);
+            if (written < 0 && errno == EOPNOTSUPP) {
+                data->nowait = false; // Older kernel: fall back to blocking writes.
+                continue;
+            }
+        } else
+#endif
+        {
+            written = writev(data->fd, iov, iovcnt);
+        }
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                size_t bytes_waiting = 0;
+                for (int i = 0; i < iovcnt; i++) bytes_waiting += iov[i].iov_len;
+                _wait_for_room(resources, data, bytes_waiting / resources->output_bytes_per_sample_pair);
+                if (is_shutdown_requested()) {
+                    errno = EINTR;
+                    return false;
+                }
+                continue;
+            }
+            return false;
+        }
+        data->total_bytes_written += written;
+
+        size_t advance = (size_t)written;
+        while (advance > 0 && iovcnt > 0) {
+            if (advance >= iov[0].iov_len) {
+                advance -= iov[0].iov_len;
+                iov++;
+                iovcnt--;
+            } else {
+                iov[0].iov_base = (char*)iov[0].iov_base + advance;
+                iov[0].iov_len -= advance;
+                advance = 0;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a batch of chunks in one system call where possible, then recycles or holds them.
+ */
+static bool _write_batch(AppResources* resources, StdoutData* data, SampleChunk** batch, int count) {
+    struct iovec iov[IO_STDOUT_MAX_BATCH_CHUNKS];
+    unsigned long long chunk_end[IO_STDOUT_MAX_BATCH_CHUNKS];
+    unsigned long long stream_end = (unsigned long long)data->total_bytes_written;
+
+    // Gifting needs page-aligned buffers and room to hold the chunks until they are read.
+    _release_consumed_chunks(resources, data);
+    bool gift = data->zero_copy && (data->held_count + (size_t)count <= data->held_capacity);
+
+    for (int i = 0; i < count; i++) {
+        iov[i].iov_base = batch[i]->final_output_data;
+        iov[i].iov_len = batch[i]->frames_to_write * resources->output_bytes_per_sample_pair;
+        stream_end += iov[i].iov_len;
+        chunk_end[i] = stream_end;
+        if ((uintptr_t)batch[i]->final_output_data % data->page_size != 0) {
+            gift = false;
+        }
+    }
+
+    bool ok = _write_iov(resources, data, iov, count, gift);
+
+    for (int i = 0; i < count; i++) {
+        telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_WRITER, batch[i]->capture_time_ns);
+        if (gift && ok) {
+            size_t slot = (data->held_head + data->held_count) % data->held_capacity;
+            data->held[slot] = batch[i];
+            data->held_end[slot] = chunk_end[i];
+            data->held_count++;
+        } else {
+            queue_enqueue(resources->free_sample_chunk_queue, batch[i]);
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Waits for the consumer to read every gifted chunk, so the pool is not freed under the pipe.
+ *
+ * The wait ends early if the consumer closes its end, since then nothing will
+ * read the pages, and is bounded by IO_STDOUT_DRAIN_TIMEOUT_MS for a consumer
+ * that stops reading without closing.
+ */
+static void _drain_held_chunks(AppResources* resources, StdoutData* data) {
+    _release_consumed_chunks(resources, data);
+    unsigned long long deadline = get_monotonic_time_ns() + (unsigned long long)IO_STDOUT_DRAIN_TIMEOUT_MS * 1000000ULL;
+    struct pollfd pfd = { .fd = data->fd, .events = 0, .revents = 0 };
+    while (data->held_count > 0 && !is_shutdown_requested()) {
+        // The write end of a pipe reports POLLERR once every reader has gone.
+        int ready = poll(&pfd, 1, 1);
+        if (ready > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+            log_debug("Writer (stdout): The consumer closed the pipe with %zu gifted chunks unread.", data->held_count);
+            break;
+        }
+        if (get_monotonic_time_ns() >= deadline) {
+            log_warn("Writer (stdout): The consumer has not read the last %zu gifted chunks after %d ms. Not waiting any longer.",
+                     data->held_count, IO_STDOUT_DRAIN_TIMEOUT_MS);
+            break;
+        }
+        _release_consumed_chunks(resources, data);
+    }
+    while (data->held_count > 0) {
+        queue_enqueue(resources->free_sample_chunk_queue, data->held[data->held_head]);
+        data->held_head = (data->held_head + 1) % data->held_capacity;
+        data->held_count--;
+    }
+}
+
+#else // _WIN32
+
+static bool _write_batch(AppResources* resources, StdoutData* data, SampleChunk** batch, int count) {
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        size_t bytes = batch[i]->frames_to_write * resources->output_bytes_per_sample_pair;
+        if (ok) {
+            size_t written = fwrite(batch[i]->final_output_data, 1, bytes, stdout);
+            data->total_bytes_written += written;
+            ok = (written == bytes);
+        }
+        telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_WRITER, batch[i]->capture_time_ns);
+        queue_enqueue(resources->free_sample_chunk_queue, batch[i]);
+    }
+    return ok;
+}
+
+#endif // _WIN32
+
 // --- Module Implementation ---
 
 static bool stdout_out_initialize(ModuleContext* ctx) {
+    const AppConfig* config = ctx->config;
     AppResources* resources = ctx->resources;
 
     StdoutData* data = (StdoutData*)mem_arena_alloc(&resources->setup_arena, sizeof(StdoutData), true);
@@ -26,9 +281,29 @@ static bool stdout_out_initialize(ModuleContext* ctx) {
     }
 
 #ifdef _WIN32
+    (void)config;
     if (!set_stdout_binary()) {
         return false;
     }
+#else
+    data->fd = fileno(stdout);
+    long page_size = sysconf(_SC_PAGESIZE);
+    data->page_size = (page_size > 0) ? (size_t)page_size : 4096;
+
+    struct stat stat_buf;
+    bool is_pipe = (fstat(data->fd, &stat_buf) == 0 && S_ISFIFO(stat_buf.st_mode));
+    data->pipe_size = utils_grow_pipe(data->fd, config->stdout_pipe_size_bytes, "stdout");
+#ifdef RWF_NOWAIT
+    data->nowait = is_pipe;
+#endif
+    if (config->stdout_zero_copy) {
+        if (data->pipe_size == 0) {
+            log_warn("--stdout-zero-copy needs stdout to be a pipe%s. Copying instead.",
+                     is_pipe ? " on Linux" : "");
+        } else {
+            data->zero_copy = true;
+        }
+    }
 #endif
     resources->output_module_private_data = data;
     return true;
@@ -38,40 +313,77 @@ static void* stdout_out_run_writer(ModuleContext* ctx) {
     AppResources* resources = ctx->resources;
     StdoutData* data = (StdoutData*)resources->output_module_private_data;
 
-    while (true) {
-        SampleChunk* item = (SampleChunk*)queue_dequeue(resources->writer_input_queue);
-        if (!item) break; // Shutdown
-
-        if (item->stream_discontinuity_event) {
-            queue_enqueue(resources->free_sample_chunk_queue, item);
-            continue;
+#ifndef _WIN32
+    if (data->zero_copy) {
+        // Keep at least half of the pool circulating through the pipeline.
+        data->held_capacity = resources->pipeline_num_chunks / 2;
+        data->held = (SampleChunk**)calloc(data->held_capacity, sizeof(SampleChunk*));
+        data->held_end = (unsigned long long*)calloc(data->held_capacity, sizeof(unsigned long long));
+        if (!data->held || !data->held_end || data->held_capacity == 0) {
+            log_warn("Writer (stdout): Could not allocate the zero-copy bookkeeping. Copying instead.");
+            data->zero_copy = false;
         }
+    }
+#endif
 
-        if (item->is_last_chunk) {
-            queue_enqueue(resources->free_sample_chunk_queue, item);
-            break; // End of stream
-        }
+#ifndef _WIN32
+    fflush(stdout); // Chunks bypass stdio from here on.
+#endif
+    SampleChunk* batch[IO_STDOUT_MAX_BATCH_CHUNKS];
+    bool end_of_stream = false;
+    while (!end_of_stream) {
+        SampleChunk* item = (SampleChunk*)queue_dequeue(resources->writer_input_queue);
+        if (!item) break; // Shutdown
 
-        size_t output_bytes_this_chunk = item->frames_to_write * resources->output_bytes_per_sample_pair;
-        if (output_bytes_this_chunk > 0) {
-            size_t written_bytes = fwrite(item->final_output_data, 1, output_bytes_this_chunk, stdout);
-            if (written_bytes > 0) {
-                data->total_bytes_written += written_bytes;
+        // Gather whatever else is already waiting, so a burst goes out in one call.
+        int count = 0;
+        while (item) {
+            if (item->is_last_chunk) {
+                queue_enqueue(resources->free_sample_chunk_queue, item);
+                end_of_stream = true;
+                break;
             }
-            if (written_bytes != output_bytes_this_chunk) {
-                if (!is_shutdown_requested()) {
-                    log_debug("Writer (stdout): write error, consumer likely closed pipe: %s", strerror(errno));
-                    request_shutdown();
-                }
+            if (item->stream_discontinuity_event || item->frames_to_write == 0) {
                 queue_enqueue(resources->free_sample_chunk_queue, item);
+            } else {
+                batch[count++] = item;
+            }
+            if (count == IO_STDOUT_MAX_BATCH_CHUNKS) {
                 break;
             }
+            item = (SampleChunk*)queue_try_dequeue(resources->writer_input_queue);
+        }
+        if (count == 0) {
+            continue;
         }
 
-        if (!queue_enqueue(resources->free_sample_chunk_queue, item)) {
-            break; // Shutdown
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
+        long long bytes_before = data->total_bytes_written;
+        bool ok = _write_batch(resources, data, batch, count);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER,
+                                 (size_t)(data->total_bytes_written - bytes_before) / resources->output_bytes_per_sample_pair);
+        if (!ok) {
+            if (!is_shutdown_requested()) {
+                log_debug("Writer (stdout): write error, consumer likely closed pipe: %s", strerror(errno));
+                request_shutdown();
+            }
+            break;
         }
     }
+
+#ifndef _WIN32
+    if (data->zero_copy) {
+        _drain_held_chunks(resources, data);
+    }
+    free(data->held);
+    free(data->held_end);
+    data->held = NULL;
+    data->held_end = NULL;
+    if (data->pipe_size > 0) {
+        log_debug("Writer (stdout): waited %.3f s for room in a full pipe (%llu times).",
+                  (double)data->stall_ns / 1e9, data->num_stalls);
+    }
+#endif
     log_debug("Stdout output writer thread is exiting.");
     return NULL;
 }
@@ -88,6 +400,14 @@ static size_t stdout_out_write_chunk(ModuleContext* ctx, const void* buffer, siz
     return written;
 }
 
+static long long stdout_out_copy_from_file(ModuleContext* ctx, int in_fd, unsigned long long offset, unsigned long long length) {
+    StdoutData* data = (StdoutData*)ctx->resources->output_module_private_data;
+    if (!data || fflush(stdout) != 0) {
+        return -1;
+    }
+    return file_splice_to_output(ctx, in_fd, offset, length, fileno(stdout), &data->total_bytes_written, "Writer (stdout)");
+}
+
 static void stdout_out_finalize_output(ModuleContext* ctx) {
     AppResources* resources = ctx->resources;
     if (!resources->output_module_private_data) return;
@@ -98,8 +418,17 @@ static void stdout_out_finalize_output(ModuleContext* ctx) {
 }
 
 static void stdout_out_get_summary_info(const ModuleContext* ctx, OutputSummaryInfo* info) {
-    (void)ctx;
     add_summary_item(info, "Output Type", "RAW Stream");
+#ifndef _WIN32
+    const StdoutData* data = (const StdoutData*)ctx->resources->output_module_private_data;
+    if (data && data->pipe_size > 0) {
+        char size_buf[40];
+        add_summary_item(info, "Output Pipe", "%s%s", format_file_size((long long)data->pipe_size, size_buf, sizeof(size_buf)),
+                         data->zero_copy ? " (vmsplice zero-copy)" : "");
+    }
+#else
+    (void)ctx;
+#endif
 }
 
 // --- The V-Table ---
@@ -109,6 +438,7 @@ static OutputModuleInterface stdout_output_module_api = {
     .initialize = stdout_out_initialize,
     .run_writer = stdout_out_run_writer,
     .write_chunk = stdout_out_write_chunk,
+    .copy_from_file = stdout_out_copy_from_file,
     .finalize_output = stdout_out_finalize_output,
     .get_summary_info = stdout_out_get_summary_info,
 };
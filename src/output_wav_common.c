@@ -4,24 +4,48 @@
  */
 
 #include "output_wav_common.h"
-#include <sndfile.h>
 #include "app_context.h"
 #include "log.h"
 #include "platform.h"
 #include "ring_buffer.h"
+#include "sample_convert.h"
 #include "utils.h"
 #include "signal_handler.h"
+#include "telemetry.h"
+#include "segment.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
+#include <math.h>
+#include <time.h>
 
 #ifdef _WIN32
 #else
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #endif
 
+// --- Private Definitions ---
+
+#define WAVE_FORMAT_PCM        0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+
+// The ds64 chunk body: RIFF size, data size and sample count (64 bits each),
+// then an empty table. A plain WAV reserves the same space as a JUNK chunk,
+// so the header never changes size when it is upgraded to RF64.
+#define WAV_DS64_BODY_BYTES 28
+
+// The binary 'auxi' chunk written by SDR#, SDRuno and HDSDR: two Windows
+// SYSTEMTIMEs (start and stop of the recording), then 32-bit fields.
+#define AUXI_START_TIME_OFFSET  0
+#define AUXI_STOP_TIME_OFFSET   16
+#define AUXI_CENTER_FREQ_OFFSET 32
+#define AUXI_SAMPLE_RATE_OFFSET 36
+#define AUXI_BINARY_MIN_BYTES   40
+
 // --- Private Helper ---
 // This helper remains private to the common implementation.
 static bool prompt_for_overwrite(const char* path_for_messages) {
@@ -40,18 +64,255 @@ static bool prompt_for_overwrite(const char* path_for_messages) {
     return true;
 }
 
+static unsigned char* _put_id(unsigned char* p, const char* id) {
+    memcpy(p, id, 4);
+    return p + 4;
+}
+
+static unsigned char* _put_u16(unsigned char* p, uint16_t v) {
+    p[0] = (unsigned char)(v & 0xFF);
+    p[1] = (unsigned char)(v >> 8);
+    return p + 2;
+}
+
+static unsigned char* _put_u32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)((v >> (8 * i)) & 0xFF);
+    }
+    return p + 4;
+}
+
+static unsigned char* _put_u64(unsigned char* p, unsigned long long v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)((v >> (8 * i)) & 0xFF);
+    }
+    return p + 8;
+}
+
+static size_t _header_size(format_t format, size_t auxi_bytes) {
+    size_t size = 12;                                // RIFF/RF64 + size + WAVE
+    size += 8 + WAV_DS64_BODY_BYTES;                 // ds64 or JUNK
+    size += 8 + ((format == CF32) ? 18 : 16);        // fmt
+    if (format == CF32) {
+        size += 12;                                  // fact
+    }
+    if (auxi_bytes > 0) {
+        size += 8 + auxi_bytes + (auxi_bytes & 1);   // auxi, padded to an even size
+    }
+    size += 8;                                       // data chunk header
+    return size;
+}
+
+/**
+ * @brief Serializes the header for a given payload size into data->header.
+ * @return true if the file needs the RF64 layout.
+ */
+static bool _build_header(const WavCommonData* data, unsigned long long data_bytes) {
+    bool is_float = (data->format == CF32);
+    uint16_t block_align = (uint16_t)get_bytes_per_sample(data->format);
+    uint16_t bits_per_sample = (uint16_t)(block_align * 4); // Two channels per frame.
+    unsigned long long frames = data_bytes / block_align;
+    unsigned long long riff_bytes = data->header_bytes - 8 + data_bytes;
+    bool rf64 = (data->container == OUTPUT_TYPE_WAV_RF64) || riff_bytes > UINT32_MAX;
+    unsigned long long byte_rate = (unsigned long long)data->sample_rate * block_align;
+
+    unsigned char* p = data->header;
+    p = _put_id(p, rf64 ? "RF64" : "RIFF");
+    p = _put_u32(p, rf64 ? UINT32_MAX : (uint32_t)riff_bytes);
+    p = _put_id(p, "WAVE");
+
+    p = _put_id(p, rf64 ? "ds64" : "JUNK");
+    p = _put_u32(p, WAV_DS64_BODY_BYTES);
+    p = _put_u64(p, rf64 ? riff_bytes : 0);
+    p = _put_u64(p, rf64 ? data_bytes : 0);
+    p = _put_u64(p, rf64 ? frames : 0);
+    p = _put_u32(p, 0);
+
+    p = _put_id(p, "fmt ");
+    p = _put_u32(p, is_float ? 18 : 16);
+    p = _put_u16(p, is_float ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+    p = _put_u16(p, 2);
+    p = _put_u32(p, data->sample_rate);
+    p = _put_u32(p, (byte_rate > UINT32_MAX) ? UINT32_MAX : (uint32_t)byte_rate);
+    p = _put_u16(p, block_align);
+    p = _put_u16(p, bits_per_sample);
+    if (is_float) {
+        p = _put_u16(p, 0); // cbSize
+        p = _put_id(p, "fact");
+        p = _put_u32(p, 4);
+        p = _put_u32(p, rf64 ? UINT32_MAX : (uint32_t)frames);
+    }
+
+    if (data->auxi_chunk_bytes > 0) {
+        p = _put_id(p, "auxi");
+        p = _put_u32(p, (uint32_t)data->auxi_chunk_bytes);
+        memcpy(p, data->auxi_chunk, data->auxi_chunk_bytes);
+        p += data->auxi_chunk_bytes;
+        if (data->auxi_chunk_bytes & 1) {
+            *p++ = 0;
+        }
+    }
+
+    p = _put_id(p, "data");
+    p = _put_u32(p, rf64 ? UINT32_MAX : (uint32_t)data_bytes);
+    return rf64;
+}
+
+static uint16_t _get_u16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t _get_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Reads a SYSTEMTIME as UTC milliseconds since the Unix epoch.
+ */
+static bool _auxi_get_time(const unsigned char* p, long long* out_ms) {
+    struct tm t;
+    memset(&t, 0, sizeof(t));
+    t.tm_year = _get_u16(p) - 1900;
+    t.tm_mon = _get_u16(p + 2) - 1;
+    t.tm_mday = _get_u16(p + 6);
+    t.tm_hour = _get_u16(p + 8);
+    t.tm_min = _get_u16(p + 10);
+    t.tm_sec = _get_u16(p + 12);
+    unsigned int ms = _get_u16(p + 14);
+    if (t.tm_year < 70 || t.tm_mon < 0 || t.tm_mon > 11 || t.tm_mday < 1 || t.tm_mday > 31 || ms > 999) {
+        return false;
+    }
+    time_t seconds = utils_timegm(&t);
+    if (seconds == (time_t)-1) {
+        return false;
+    }
+    *out_ms = (long long)seconds * 1000 + ms;
+    return true;
+}
+
+/**
+ * @brief Writes UTC milliseconds since the Unix epoch as a SYSTEMTIME.
+ */
+static bool _auxi_put_time(unsigned char* p, long long ms) {
+    time_t seconds = (time_t)(ms / 1000);
+    struct tm t;
+#ifdef _WIN32
+    if (gmtime_s(&t, &seconds) != 0) return false;
+#else
+    if (!gmtime_r(&seconds, &t)) return false;
+#endif
+    p = _put_u16(p, (uint16_t)(t.tm_year + 1900));
+    p = _put_u16(p, (uint16_t)(t.tm_mon + 1));
+    p = _put_u16(p, (uint16_t)t.tm_wday);
+    p = _put_u16(p, (uint16_t)t.tm_mday);
+    p = _put_u16(p, (uint16_t)t.tm_hour);
+    p = _put_u16(p, (uint16_t)t.tm_min);
+    p = _put_u16(p, (uint16_t)t.tm_sec);
+    _put_u16(p, (uint16_t)(ms % 1000));
+    return true;
+}
+
+/**
+ * @brief Prepares the input's 'auxi' chunk for the output header.
+ *
+ * The chunk describes the recording it came from. When --start, --duration,
+ * a frequency shift or resampling changes what the output holds, the binary
+ * form is copied with its start and stop times, centre frequency and sample
+ * rate updated. Any other form (such as SDR Console's XML) cannot be updated
+ * and is dropped with a warning rather than copied with stale values.
+ */
+static bool _prepare_auxi_chunk(const AppConfig* config, AppResources* resources, WavCommonData* data) {
+    const unsigned char* src = resources->input_auxi_chunk;
+    size_t bytes = resources->input_auxi_chunk_bytes;
+    data->auxi_chunk = NULL;
+    data->auxi_chunk_bytes = 0;
+    if (!src || bytes == 0) {
+        return true;
+    }
+
+    double input_rate = (double)resources->source_info.samplerate;
+    double shift_hz = (resources->nco_shift_hz != 0.0) ? resources->nco_shift_hz : (double)config->freq_shift_hz_arg;
+    bool ranged = config->range_start.unit != RANGE_VALUE_UNSET || config->range_duration.unit != RANGE_VALUE_UNSET;
+    bool shifted = fabs(shift_hz) > 1e-9;
+    bool resampled = data->sample_rate != (uint32_t)(input_rate + 0.5);
+    if (!ranged && !shifted && !resampled) {
+        data->auxi_chunk = src;
+        data->auxi_chunk_bytes = bytes;
+        return true;
+    }
+
+    long long start_ms = 0;
+    if (bytes < AUXI_BINARY_MIN_BYTES || !_auxi_get_time(src + AUXI_START_TIME_OFFSET, &start_ms)) {
+        log_warn("The input's auxi metadata is not in a format that can be updated for this output. Not copying it.");
+        return true;
+    }
+
+    unsigned char* chunk = (unsigned char*)mem_arena_alloc(&resources->setup_arena, bytes, false);
+    if (!chunk) {
+        return false;
+    }
+    memcpy(chunk, src, bytes);
+
+    if (ranged && input_rate > 0.0) {
+        long long new_start_ms = start_ms + llround((double)resources->input_start_frame * 1000.0 / input_rate);
+        long long new_stop_ms = new_start_ms + llround((double)resources->source_info.frames * 1000.0 / input_rate);
+        if (!_auxi_put_time(chunk + AUXI_START_TIME_OFFSET, new_start_ms) ||
+            !_auxi_put_time(chunk + AUXI_STOP_TIME_OFFSET, new_stop_ms)) {
+            log_warn("Could not update the times in the input's auxi metadata. Not copying it.");
+            return true;
+        }
+    }
+    if (shifted) {
+        // Mixing up by the shift moves every signal up, so the output is centred that much lower.
+        uint32_t center_hz = _get_u32(chunk + AUXI_CENTER_FREQ_OFFSET);
+        double new_center_hz = (double)center_hz - shift_hz;
+        if (center_hz > 0 && new_center_hz > 0.0 && new_center_hz <= (double)UINT32_MAX) {
+            _put_u32(chunk + AUXI_CENTER_FREQ_OFFSET, (uint32_t)llround(new_center_hz));
+        }
+    }
+    if (resampled && _get_u32(chunk + AUXI_SAMPLE_RATE_OFFSET) > 0) {
+        _put_u32(chunk + AUXI_SAMPLE_RATE_OFFSET, data->sample_rate);
+    }
+
+    data->auxi_chunk = chunk;
+    data->auxi_chunk_bytes = bytes;
+    data->auxi_rewritten = true;
+    return true;
+}
+
+static const char* _encoding_name(format_t format) {
+    switch (format) {
+        case CU8:  return "8-bit unsigned PCM";
+        case CS16: return "16-bit PCM";
+        case CS24: return "24-bit PCM";
+        case CF32: return "32-bit IEEE float";
+        default:   return "unknown";
+    }
+}
+
 // --- Shared Implementation ---
 
 bool wav_common_validate_options(AppConfig* config) {
     // This logic is identical for both WAV and RF64.
-    if (config->output_format != CS16 && config->output_format != CU8) {
-        log_fatal("Invalid sample format '%s' for WAV/RF64 container. Only 'cs16' and 'cu8' are supported.", config->output_sample_format_name);
-        return false;
+    switch (config->output_format) {
+        case CU8:
+        case CS16:
+        case CS24:
+        case CF32:
+            return true;
+        case CS8:
+            // 8-bit WAV PCM is offset binary; a signed byte stream would be misread.
+            log_info("8-bit WAV samples are unsigned. Writing 'cu8' instead of 'cs8'.");
+            config->output_format = CU8;
+            config->output_sample_format_name = "cu8";
+            return true;
+        default:
+            log_fatal("Invalid sample format '%s' for WAV/RF64 container. Supported formats: cu8, cs8, cs16, cs24, cf32.", config->output_sample_format_name);
+            return false;
     }
-    return true;
 }
 
-bool wav_common_initialize(ModuleContext* ctx, int sf_format_flag) {
+bool wav_common_initialize(ModuleContext* ctx, OutputType container) {
     const AppConfig* config = ctx->config;
     AppResources* resources = ctx->resources;
 
@@ -89,30 +350,55 @@ bool wav_common_initialize(ModuleContext* ctx, int sf_format_flag) {
         }
     }
 
-    // Prepare the libsndfile info struct.
-    SF_INFO sfinfo;
-    memset(&sfinfo, 0, sizeof(SF_INFO));
-    sfinfo.samplerate = (int)config->target_rate;
-    sfinfo.channels = 2;
-    sfinfo.format = sf_format_flag; // Use the specific format flag passed by the wrapper.
-
-    switch (config->output_format) {
-        case CS16: sfinfo.format |= SF_FORMAT_PCM_16; break;
-        case CU8:  sfinfo.format |= SF_FORMAT_PCM_U8; break;
-        default: return false; // Should be caught by validation.
+    if (config->target_rate <= 0.0 || config->target_rate > (double)UINT32_MAX) {
+        log_fatal("Output sample rate %.0f Hz cannot be stored in a WAV header.", config->target_rate);
+        return false;
     }
 
-    // Verify that libsndfile supports this format combination.
-    if (!sf_format_check(&sfinfo)) { log_fatal("libsndfile does not support the requested format (Rate: %d, Format: 0x%08X).", sfinfo.samplerate, sfinfo.format); return false; }
+    data->container = container;
+    data->format = config->output_format;
+    data->sample_rate = (uint32_t)(config->target_rate + 0.5);
+    if (!_prepare_auxi_chunk(config, resources, data)) return false;
+    data->header_bytes = _header_size(data->format, data->auxi_chunk_bytes);
+    data->header = (unsigned char*)mem_arena_alloc(&resources->setup_arena, data->header_bytes, true);
+    if (!data->header) return false;
+    _build_header(data, 0);
 
     // Open the file using the appropriate platform-specific function.
     #ifdef _WIN32
-    data->handle = sf_wchar_open(config->effective_output_filename_w, SFM_WRITE, &sfinfo);
+    data->handle = _wfopen(config->effective_output_filename_w, L"wb");
     #else
-    data->handle = sf_open(out_path, SFM_WRITE, &sfinfo);
+    int fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW, 0666);
+    if (fd >= 0) {
+        data->handle = fdopen(fd, "wb");
+        if (!data->handle) {
+            close(fd);
+        }
+    }
+    #endif
+
+    if (!data->handle) { log_fatal("Error opening output WAV file %s: %s", out_path, strerror(errno)); return false; }
+
+    #ifndef _WIN32
+    if (config->write_behind_depth > 0) {
+        unsigned long long expected_bytes = 0;
+        if (resources->expected_total_output_frames > 0) {
+            expected_bytes = data->header_bytes + (unsigned long long)resources->expected_total_output_frames *
+                                                  get_bytes_per_sample(data->format);
+        }
+        data->write_behind = file_writer_create(fileno(data->handle), (unsigned int)config->write_behind_depth,
+                                                IO_OUTPUT_WRITER_CHUNK_SIZE, config->direct_io, expected_bytes);
+    }
     #endif
 
-    if (!data->handle) { log_fatal("Error opening output WAV file %s: %s", out_path, sf_strerror(NULL)); return false; }
+    // The header goes out first with placeholder sizes; finalize patches them.
+    bool header_written = data->write_behind
+                        ? file_writer_write(data->write_behind, data->header, data->header_bytes)
+                        : (fwrite(data->header, 1, data->header_bytes, data->handle) == data->header_bytes);
+    if (!header_written) {
+        log_fatal("Error writing WAV header to %s: %s", out_path, strerror(errno));
+        return false;
+    }
     return true;
 }
 
@@ -120,22 +406,33 @@ void* wav_common_run_writer(ModuleContext* ctx) {
     AppResources* resources = ctx->resources;
     WavCommonData* data = (WavCommonData*)resources->output_module_private_data;
 
+    if (data->write_behind) {
+        file_writer_run_writer(ctx, data->write_behind, &data->total_bytes_written, "WAV writer");
+        log_debug("Common WAV writer thread is exiting.");
+        return NULL;
+    }
+
     unsigned char* local_buffer = (unsigned char*)resources->writer_local_buffer;
     if (!local_buffer) { handle_fatal_thread_error("WAV writer: Local buffer is NULL.", resources); return NULL; }
 
     // Main writer loop: read from ring buffer, write to file.
+    unsigned long long stream_bytes_consumed = 0;
     while (true) {
         size_t bytes_read = ring_buffer_read(resources->writer_input_buffer, local_buffer, IO_OUTPUT_WRITER_CHUNK_SIZE);
         if (bytes_read == 0) break; // End of stream or shutdown signal.
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_WRITER);
 
-        sf_count_t written = sf_write_raw(data->handle, local_buffer, bytes_read);
+        size_t written = fwrite(local_buffer, 1, bytes_read, data->handle);
         if (written > 0) {
             data->total_bytes_written += written;
         }
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_WRITER, written / resources->output_bytes_per_sample_pair);
+        stream_bytes_consumed += bytes_read;
+        telemetry_latency_index_advance(resources->telemetry, stream_bytes_consumed);
 
-        if ((size_t)written != bytes_read) {
+        if (written != bytes_read) {
             char error_buf[256];
-            snprintf(error_buf, sizeof(error_buf), "WAV writer: File write error: %s", sf_strerror(data->handle));
+            snprintf(error_buf, sizeof(error_buf), "WAV writer: File write error: %s", strerror(errno));
             handle_fatal_thread_error(error_buf, resources);
             break;
         }
@@ -143,9 +440,7 @@ void* wav_common_run_writer(ModuleContext* ctx) {
         // Update and invoke the progress callback.
         if (resources->progress_callback) {
             unsigned long long current_frames = data->total_bytes_written / resources->output_bytes_per_sample_pair;
-            pthread_mutex_lock(&resources->progress_mutex);
-            resources->total_output_frames = current_frames;
-            pthread_mutex_unlock(&resources->progress_mutex);
+            atomic_store_explicit(&resources->total_output_frames, current_frames, memory_order_relaxed);
             resources->progress_callback(current_frames, resources->expected_total_output_frames, data->total_bytes_written, resources->progress_callback_udata);
         }
     }
@@ -157,18 +452,64 @@ size_t wav_common_write_chunk(ModuleContext* ctx, const void* buffer, size_t byt
     AppResources* resources = ctx->resources;
     WavCommonData* data = (WavCommonData*)resources->output_module_private_data;
     if (!data || !data->handle || bytes_to_write == 0) return 0;
-    sf_count_t written = sf_write_raw(data->handle, buffer, bytes_to_write);
+    if (data->write_behind) {
+        if (!file_writer_write(data->write_behind, buffer, bytes_to_write)) return 0;
+        data->total_bytes_written += bytes_to_write;
+        return bytes_to_write;
+    }
+    size_t written = fwrite(buffer, 1, bytes_to_write, data->handle);
     if (written > 0) data->total_bytes_written += written;
-    return (size_t)written;
+    return written;
+}
+
+long long wav_common_write_segments(ModuleContext* ctx) {
+    WavCommonData* data = (WavCommonData*)ctx->resources->output_module_private_data;
+    if (!data || !data->handle || data->write_behind || fflush(data->handle) != 0) {
+        return -1;
+    }
+    return segment_write_output(ctx, fileno(data->handle), data->header_bytes, &data->total_bytes_written);
 }
 
 void wav_common_finalize_output(ModuleContext* ctx) {
     AppResources* resources = ctx->resources;
     if (!resources->output_module_private_data) return;
     WavCommonData* data = (WavCommonData*)resources->output_module_private_data;
+
+    if (data->write_behind) {
+        if (!file_writer_finish(data->write_behind) && !resources->error_occurred) {
+            log_error("Failed to complete the output file: %s", strerror(errno));
+        }
+        file_writer_destroy(data->write_behind);
+        data->write_behind = NULL;
+    }
+
     if (data->handle) {
-        sf_close(data->handle);
+        // Patch the sizes now that the payload length is known.
+        bool rf64 = _build_header(data, (unsigned long long)data->total_bytes_written);
+        if (rf64 && data->container == OUTPUT_TYPE_WAV) {
+            log_warn("The output exceeds the 4 GB WAV limit; it was written as RF64.");
+        }
+        if (fflush(data->handle) != 0 || fseek(data->handle, 0, SEEK_SET) != 0 ||
+            fwrite(data->header, 1, data->header_bytes, data->handle) != data->header_bytes) {
+            log_error("Could not update the WAV header: %s", strerror(errno));
+        }
+        if (fclose(data->handle) != 0) {
+            log_error("Error closing the output WAV file: %s", strerror(errno));
+        }
         data->handle = NULL;
     }
     resources->final_output_size_bytes = data->total_bytes_written;
 }
+
+void wav_common_add_summary_items(const ModuleContext* ctx, OutputSummaryInfo* info) {
+    const WavCommonData* data = (const WavCommonData*)ctx->resources->output_module_private_data;
+    if (!data) return;
+    add_summary_item(info, "Output Encoding", "%s", _encoding_name(data->format));
+    if (data->auxi_chunk_bytes > 0) {
+        add_summary_item(info, "Output Metadata", "auxi chunk %s from input (%zu bytes)",
+                         data->auxi_rewritten ? "updated" : "copied", data->auxi_chunk_bytes);
+    }
+    if (data->write_behind) {
+        add_summary_item(info, "Output Writes", "Write-behind (%s)", file_writer_describe(data->write_behind));
+    }
+}
@@ -0,0 +1,200 @@
+/**
+ * @file perf_counters.c
+ * @brief Implements per-thread hardware performance counters via perf_event_open().
+ */
+
+#include "perf_counters.h"
+#include "constants.h"
+#include "log.h"
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdio.h>
+#endif
+
+// --- Private Data ---
+static bool              s_enabled = false;
+static pthread_mutex_t   s_results_mutex = PTHREAD_MUTEX_INITIALIZER;
+static PerfCounterResult s_results[PERF_COUNTERS_MAX_THREADS];
+static int               s_num_results = 0;
+
+#ifdef __linux__
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} s_event_defs[PERF_COUNTER_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+// --- Private Helper Functions ---
+
+static int _open_event(PerfCounterId id, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = s_event_defs[id].type;
+    attr.config = s_event_defs[id].config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;   // The leader starts the whole group.
+    attr.exclude_kernel = 1;                    // Permitted at perf_event_paranoid <= 2.
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid 0, cpu -1: the calling thread, on whichever CPU it runs.
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void _log_unavailable(int err) {
+    int paranoid = -1;
+    FILE* f = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+    if (f) {
+        if (fscanf(f, "%d", &paranoid) != 1) {
+            paranoid = -1;
+        }
+        fclose(f);
+    }
+    if ((err == EACCES || err == EPERM) && paranoid > 2) {
+        log_warn("Hardware performance counters are not permitted (kernel.perf_event_paranoid = %d). "
+                 "Set it to 2 or lower to use --perf-counters.", paranoid);
+    } else {
+        log_warn("Hardware performance counters are unavailable: %s. --perf-counters is disabled.", strerror(err));
+    }
+}
+
+#endif // __linux__
+
+// --- Public Function Implementations ---
+
+bool perf_counters_enable(void) {
+    pthread_mutex_lock(&s_results_mutex);
+    s_num_results = 0;
+    pthread_mutex_unlock(&s_results_mutex);
+
+#ifdef __linux__
+    // Probe with the group leader once, so a missing PMU produces one warning instead of one per thread.
+    int fd = _open_event(PERF_COUNTER_CYCLES, -1);
+    if (fd < 0) {
+        _log_unavailable(errno);
+        s_enabled = false;
+        return false;
+    }
+    close(fd);
+    s_enabled = true;
+    return true;
+#else
+    log_warn("Hardware performance counters are only supported on Linux. --perf-counters is disabled.");
+    s_enabled = false;
+    return false;
+#endif
+}
+
+void perf_counters_thread_begin(PerfThreadCounters* counters, const char* name) {
+    counters->name = name;
+    counters->group_fd = -1;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        counters->fds[i] = -1;
+    }
+    if (!s_enabled) {
+        return;
+    }
+
+#ifdef __linux__
+    counters->group_fd = _open_event(PERF_COUNTER_CYCLES, -1);
+    if (counters->group_fd < 0) {
+        log_debug("perf: could not open cycle counter for thread '%s': %s", name, strerror(errno));
+        counters->group_fd = -1;
+        return;
+    }
+    counters->fds[PERF_COUNTER_CYCLES] = counters->group_fd;
+
+    for (int i = PERF_COUNTER_CYCLES + 1; i < PERF_COUNTER_COUNT; i++) {
+        counters->fds[i] = _open_event((PerfCounterId)i, counters->group_fd);
+        if (counters->fds[i] < 0) {
+            counters->fds[i] = -1; // Not supported on this CPU; reported as unavailable.
+        }
+    }
+
+    ioctl(counters->group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(counters->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+void perf_counters_thread_end(PerfThreadCounters* counters) {
+    if (counters->group_fd < 0) {
+        return;
+    }
+
+#ifdef __linux__
+    ioctl(counters->group_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // Group read layout: nr, time_enabled, time_running, then {value, id} per event.
+    uint64_t data[3 + 2 * PERF_COUNTER_COUNT];
+    ssize_t bytes = read(counters->group_fd, data, sizeof(data));
+
+    uint64_t ids[PERF_COUNTER_COUNT];
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        ids[i] = 0;
+        if (counters->fds[i] >= 0 && ioctl(counters->fds[i], PERF_EVENT_IOC_ID, &ids[i]) != 0) {
+            ids[i] = 0;
+        }
+    }
+
+    PerfCounterResult result;
+    memset(&result, 0, sizeof(result));
+    result.name = counters->name;
+
+    if (bytes >= (ssize_t)(3 * sizeof(uint64_t)) && data[2] > 0) {
+        uint64_t nr = data[0];
+        // Scale up if the kernel multiplexed the group with other events.
+        double scale = (double)data[1] / (double)data[2];
+        for (uint64_t n = 0; n < nr && (ssize_t)((3 + 2 * n + 2) * sizeof(uint64_t)) <= bytes; n++) {
+            uint64_t value = data[3 + 2 * n];
+            uint64_t id = data[3 + 2 * n + 1];
+            for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+                if (counters->fds[i] >= 0 && ids[i] == id) {
+                    result.values[i] = (unsigned long long)((double)value * scale);
+                    result.valid[i] = true;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+        }
+    }
+    counters->group_fd = -1;
+
+    pthread_mutex_lock(&s_results_mutex);
+    if (s_num_results < PERF_COUNTERS_MAX_THREADS) {
+        s_results[s_num_results++] = result;
+    }
+    pthread_mutex_unlock(&s_results_mutex);
+#endif
+}
+
+int perf_counters_get_result_count(void) {
+    pthread_mutex_lock(&s_results_mutex);
+    int count = s_num_results;
+    pthread_mutex_unlock(&s_results_mutex);
+    return count;
+}
+
+const PerfCounterResult* perf_counters_get_result(int index) {
+    if (index < 0 || index >= perf_counters_get_result_count()) {
+        return NULL;
+    }
+    return &s_results[index];
+}
@@ -27,14 +27,21 @@
 #include "filter.h"
 #include "agc.h" // Added for Output AGC
 #include "sample_convert.h"
+#include "transcode.h"
 #include "queue.h"
 #include "ring_buffer.h"
 #include "sdr_packet_serializer.h"
+#include "buffer_alloc.h"
+#include "analysis_tap.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "perf_counters.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -43,11 +50,30 @@
 #include <time.h>
 #endif
 
+// --- Private Type Definitions ---
+
+/**
+ * @struct ChunkLayout
+ * @brief The size of each buffer carved out of one SampleChunk's slice of the data pool.
+ */
+typedef struct {
+    size_t max_out_samples;
+    size_t raw_input_bytes;
+    size_t complex_bytes;
+    size_t final_output_bytes;
+    size_t total_bytes;
+} ChunkLayout;
+
 // --- Private Function Prototypes for Setup Helpers ---
 static bool _init_queues_and_buffers(AppConfig* config, AppResources* resources);
 static void _destroy_queues_and_buffers(AppResources* resources);
 static bool _allocate_processing_buffers(AppConfig *config, AppResources *resources, float resample_ratio);
+static bool _calculate_chunk_layout(const AppConfig *config, const AppResources *resources, size_t chunk_samples, float resample_ratio, ChunkLayout* layout);
+static bool _plan_pipeline_memory(AppConfig *config, AppResources *resources, float resample_ratio, ChunkLayout* layout);
+static void _log_memory_plan(const AppConfig *config, const AppResources *resources);
 static bool _create_dsp_components(AppConfig* config, AppResources* resources, float resample_ratio);
+static bool _create_transcoder(const AppConfig* config, AppResources* resources);
+static bool _create_telemetry(AppResources* resources, const char* json_path);
 static void _destroy_dsp_components(AppResources* resources);
 
 
@@ -75,6 +101,7 @@ bool pipeline_run(PipelineContext* context) {
     }
 
     // --- Step 2: Allocate all memory pools ---
+    buffer_alloc_configure(config->use_huge_pages, config->lock_memory);
     if (!_allocate_processing_buffers(config, resources, resources->resample_ratio)) {
         log_fatal("Failed to allocate processing buffers.");
         _destroy_dsp_components(resources);
@@ -89,18 +116,58 @@ bool pipeline_run(PipelineContext* context) {
         return false;
     }
 
+    if (!_create_telemetry(resources, config->stats_json_path)) {
+        _destroy_queues_and_buffers(resources);
+        _destroy_dsp_components(resources);
+        return false;
+    }
+
+    if (config->trace_path && !trace_init(config->trace_path)) {
+        telemetry_destroy(resources->telemetry);
+        resources->telemetry = NULL;
+        _destroy_queues_and_buffers(resources);
+        _destroy_dsp_components(resources);
+        return false;
+    }
+
+    if (config->perf_counters) {
+        perf_counters_enable();
+    }
+
     // --- Step 4: Initialize the generic thread manager ---
     ThreadManager manager;
     thread_manager_init(&manager, context);
 
+    // Page faults are counted from here on, so that setup is not attributed to
+    // processing. The buffers above are only mapped, not touched (unless
+    // --lock-memory locked them in), so the first touch of each of their pages
+    // still lands in the count. That share is bounded by their size in pages.
+    unsigned long long faults_minor_start = 0, faults_major_start = 0;
+    resources->page_faults_available = utils_get_page_fault_counts(&faults_minor_start, &faults_major_start);
+    resources->page_faults_first_touch_max = 0;
+#ifndef _WIN32
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0) {
+        size_t buffer_bytes = resources->pipeline_chunk_pool_bytes + resources->sdr_input_buffer_bytes +
+                              resources->writer_input_buffer_bytes;
+        resources->page_faults_first_touch_max = (buffer_bytes + (size_t)page_size - 1) / (size_t)page_size;
+    }
+#endif
+
     // --- Step 5: Spawn threads based on configuration (Direct Command Model) ---
     log_debug("Spawning pipeline threads...");
     bool threads_ok = true;
+    if (resources->telemetry && !telemetry_start(resources->telemetry)) {
+        telemetry_destroy(resources->telemetry);
+        resources->telemetry = NULL;
+    }
     if (resources->pipeline_mode == PIPELINE_MODE_BUFFERED_SDR) {
         if (!thread_manager_spawn_thread(&manager, "SDR Capture", sdr_capture_thread_func)) threads_ok = false;
     }
     if (threads_ok && !thread_manager_spawn_thread(&manager, "Reader", reader_thread_func)) threads_ok = false;
-    if (threads_ok && !config->raw_passthrough) {
+    if (threads_ok && (resources->transcoder || config->raw_passthrough)) {
+        if (!thread_manager_spawn_thread(&manager, "Transcoder", transcoder_thread_func)) threads_ok = false;
+    } else if (threads_ok && !config->raw_passthrough) {
         if (!thread_manager_spawn_thread(&manager, "Pre-Processor", pre_processor_thread_func)) threads_ok = false;
         if (threads_ok && !config->no_resample) {
             if (!thread_manager_spawn_thread(&manager, "Resampler", resampler_thread_func)) threads_ok = false;
@@ -122,9 +189,31 @@ bool pipeline_run(PipelineContext* context) {
 
     // --- Step 6: Wait for all spawned threads to complete ---
     thread_manager_join_all(&manager);
+    unsigned long long faults_minor_end, faults_major_end;
+    if (resources->page_faults_available && utils_get_page_fault_counts(&faults_minor_end, &faults_major_end)) {
+        resources->page_faults_minor = faults_minor_end - faults_minor_start;
+        resources->page_faults_major = faults_major_end - faults_major_start;
+    } else {
+        resources->page_faults_available = false;
+    }
     log_debug("All pipeline threads have completed.");
     success = !resources->error_occurred;
 
+    trace_finish();
+
+    if (resources->telemetry) {
+        telemetry_stop(resources->telemetry);
+        resources->latency_available = telemetry_get_latency_ms(resources->telemetry, TELEMETRY_STAGE_WRITER,
+                                                                &resources->latency_p50_ms,
+                                                                &resources->latency_p99_ms,
+                                                                &resources->latency_p999_ms);
+        telemetry_destroy(resources->telemetry);
+        resources->telemetry = NULL;
+        if (config->stats_json_path) {
+            log_info("Pipeline statistics written to %s", config->stats_json_path);
+        }
+    }
+
     // --- Step 7: Clean up all pipeline-specific resources ---
     _destroy_queues_and_buffers(resources);
     _destroy_dsp_components(resources);
@@ -143,10 +232,42 @@ static bool _create_dsp_components(AppConfig* config, AppResources* resources, f
     if (!resources->resampler && !resources->is_passthrough) return false;
     if (!filter_create(config, resources, &resources->setup_arena)) return false;
     if (!agc_create(config, resources)) return false;
+    if (!_create_transcoder(config, resources)) return false;
+    return true;
+}
+
+/**
+ * @brief Plans the format-only fast path.
+ *
+ * When no resampling and no DSP stage is requested, the only work left is the
+ * sample format conversion. The pre-processor, resampler and post-processor
+ * threads are then replaced by a single transcoder thread, which converts each
+ * chunk without the intermediate cf32 buffers or the two extra queue hops.
+ */
+static bool _create_transcoder(const AppConfig* config, AppResources* resources) {
+    bool format_only = !config->raw_passthrough && config->no_resample &&
+                       !resources->user_filter_object &&
+                       !resources->pre_resample_nco && !resources->post_resample_nco &&
+                       !config->dc_block.enable && !config->iq_correction.enable &&
+                       !config->output_agc.enable;
+    if (!format_only) {
+        return true;
+    }
+
+    resources->transcoder = transcode_create(resources->input_format, config->output_format, config->gain);
+    if (!resources->transcoder) {
+        return false;
+    }
+    log_info("No DSP stages enabled; converting %s to %s directly (%s).",
+             utils_get_format_description_string(resources->input_format),
+             utils_get_format_description_string(config->output_format),
+             transcode_describe(resources->transcoder));
     return true;
 }
 
 static void _destroy_dsp_components(AppResources* resources) {
+    transcode_destroy(resources->transcoder);
+    resources->transcoder = NULL;
     agc_destroy(resources);
     filter_destroy(resources);
     destroy_resampler(resources->resampler);
@@ -159,43 +280,53 @@ static void _destroy_dsp_components(AppResources* resources) {
 static bool _init_queues_and_buffers(AppConfig* config, AppResources* resources) {
     MemoryArena* arena = &resources->setup_arena;
     Queue* last_output_queue = NULL;
+    size_t num_chunks = resources->pipeline_num_chunks;
+    bool run_dsp_stages = !config->raw_passthrough && !resources->transcoder;
 
     resources->reader_output_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
-    if (!resources->reader_output_queue || !queue_init(resources->reader_output_queue, PIPELINE_NUM_CHUNKS, arena)) return false;
+    if (!resources->reader_output_queue || !queue_init(resources->reader_output_queue, num_chunks, arena)) return false;
     last_output_queue = resources->reader_output_queue;
 
-    if (!config->raw_passthrough) {
+    // With --raw-passthrough the transcoder stage only hands the reader's chunks to the writer.
+    if (resources->transcoder || config->raw_passthrough) {
+        resources->transcoder_input_queue = last_output_queue;
+        resources->transcoder_output_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
+        if (!resources->transcoder_output_queue || !queue_init(resources->transcoder_output_queue, num_chunks, arena)) return false;
+        last_output_queue = resources->transcoder_output_queue;
+    }
+
+    if (run_dsp_stages) {
         resources->pre_processor_input_queue = last_output_queue;
         resources->pre_processor_output_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
-        if (!resources->pre_processor_output_queue || !queue_init(resources->pre_processor_output_queue, PIPELINE_NUM_CHUNKS, arena)) return false;
+        if (!resources->pre_processor_output_queue || !queue_init(resources->pre_processor_output_queue, num_chunks, arena)) return false;
         last_output_queue = resources->pre_processor_output_queue;
     }
 
-    if (!config->raw_passthrough && !config->no_resample) {
+    if (run_dsp_stages && !config->no_resample) {
         resources->resampler_input_queue = last_output_queue;
         resources->resampler_output_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
-        if (!resources->resampler_output_queue || !queue_init(resources->resampler_output_queue, PIPELINE_NUM_CHUNKS, arena)) return false;
+        if (!resources->resampler_output_queue || !queue_init(resources->resampler_output_queue, num_chunks, arena)) return false;
         last_output_queue = resources->resampler_output_queue;
     }
 
-    if (!config->raw_passthrough) {
+    if (run_dsp_stages) {
         resources->post_processor_input_queue = last_output_queue;
         resources->post_processor_output_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
-        if (!resources->post_processor_output_queue || !queue_init(resources->post_processor_output_queue, PIPELINE_NUM_CHUNKS, arena)) return false;
+        if (!resources->post_processor_output_queue || !queue_init(resources->post_processor_output_queue, num_chunks, arena)) return false;
         last_output_queue = resources->post_processor_output_queue;
     }
 
     resources->writer_input_queue = last_output_queue;
 
     resources->free_sample_chunk_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
-    if (!queue_init(resources->free_sample_chunk_queue, PIPELINE_NUM_CHUNKS, arena)) return false;
+    if (!queue_init(resources->free_sample_chunk_queue, num_chunks, arena)) return false;
 
     if (config->iq_correction.enable) {
-        resources->iq_optimization_data_queue = (Queue*)mem_arena_alloc(arena, sizeof(Queue), true);
-        if (!queue_init(resources->iq_optimization_data_queue, PIPELINE_NUM_CHUNKS, arena)) return false;
+        resources->iq_analysis_tap = analysis_tap_create(IQ_CORRECTION_FFT_SIZE, IQ_CORRECTION_TAP_INTERVAL_MS);
+        if (!resources->iq_analysis_tap) return false;
     }
 
-    for (size_t i = 0; i < PIPELINE_NUM_CHUNKS; ++i) {
+    for (size_t i = 0; i < num_chunks; ++i) {
         if (!queue_enqueue(resources->free_sample_chunk_queue, &resources->sample_chunk_pool[i])) {
             log_fatal("Failed to initially populate free item queue.");
             return false;
@@ -203,18 +334,41 @@ static bool _init_queues_and_buffers(AppConfig* config, AppResources* resources)
     }
 
     if (resources->pipeline_mode == PIPELINE_MODE_BUFFERED_SDR) {
-        resources->sdr_input_buffer = ring_buffer_create(IO_SDR_INPUT_BUFFER_BYTES);
+        resources->sdr_input_buffer = ring_buffer_create(resources->sdr_input_buffer_bytes);
         if (!resources->sdr_input_buffer) return false;
     }
     
     if (resources->pacing_is_required) {
-        resources->writer_input_buffer = ring_buffer_create(IO_OUTPUT_WRITER_BUFFER_BYTES);
+        resources->writer_input_buffer = ring_buffer_create(resources->writer_input_buffer_bytes);
         if (!resources->writer_input_buffer) return false;
     }
 
     return true;
 }
 
+/**
+ * @brief Creates the telemetry collector and registers every queue and ring buffer.
+ *
+ * The collector always tracks stage timing and chunk latency; json_path
+ * (--stats-json) additionally enables occupancy sampling and the file export.
+ */
+static bool _create_telemetry(AppResources* resources, const char* json_path) {
+    Telemetry* tel = telemetry_create(json_path);
+    if (!tel) {
+        return false;
+    }
+    telemetry_register_ring_buffer(tel, "sdr_input_buffer", resources->sdr_input_buffer);
+    telemetry_register_queue(tel, "free_chunks", resources->free_sample_chunk_queue);
+    telemetry_register_queue(tel, "reader_output", resources->reader_output_queue);
+    telemetry_register_queue(tel, "pre_processor_output", resources->pre_processor_output_queue);
+    telemetry_register_queue(tel, "resampler_output", resources->resampler_output_queue);
+    telemetry_register_queue(tel, "post_processor_output", resources->post_processor_output_queue);
+    telemetry_register_queue(tel, "transcoder_output", resources->transcoder_output_queue);
+    telemetry_register_ring_buffer(tel, "writer_input_buffer", resources->writer_input_buffer);
+    resources->telemetry = tel;
+    return true;
+}
+
 static void _destroy_queues_and_buffers(AppResources* resources) {
     if (!resources) return;
 
@@ -226,13 +380,43 @@ static void _destroy_queues_and_buffers(AppResources* resources) {
     if(resources->pre_processor_output_queue) queue_destroy(resources->pre_processor_output_queue);
     if(resources->resampler_output_queue) queue_destroy(resources->resampler_output_queue);
     if(resources->post_processor_output_queue) queue_destroy(resources->post_processor_output_queue);
-    if(resources->iq_optimization_data_queue) queue_destroy(resources->iq_optimization_data_queue);
+    if(resources->transcoder_output_queue) queue_destroy(resources->transcoder_output_queue);
+    if (resources->iq_analysis_tap) {
+        analysis_tap_destroy(resources->iq_analysis_tap);
+        resources->iq_analysis_tap = NULL;
+    }
 }
 
-static bool _allocate_processing_buffers(AppConfig *config, AppResources *resources, float resample_ratio) {
-    if (!config || !resources) return false;
+static size_t _align_up(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief The alignment of every chunk sub-buffer.
+ *
+ * Cache lines by default. --stdout-zero-copy gifts the output buffers' pages to
+ * the stdout pipe with vmsplice(), so they must then start on a page boundary.
+ */
+static size_t _chunk_alignment(const AppConfig *config) {
+#ifndef _WIN32
+    if (config->stdout_zero_copy) {
+        long page_size = sysconf(_SC_PAGESIZE);
+        if (page_size > BUFFER_ALLOC_ALIGNMENT) {
+            return (size_t)page_size;
+        }
+    }
+#else
+    (void)config;
+#endif
+    return BUFFER_ALLOC_ALIGNMENT;
+}
 
-    size_t max_pre_resample_chunk_size = PIPELINE_CHUNK_BASE_SAMPLES;
+/**
+ * @brief Calculates the per-chunk buffer sizes for a given chunk size.
+ * @return false if the configuration needs a buffer larger than MAX_ALLOWED_FFT_BLOCK_SIZE.
+ */
+static bool _calculate_chunk_layout(const AppConfig *config, const AppResources *resources, size_t chunk_samples, float resample_ratio, ChunkLayout* layout) {
+    size_t max_pre_resample_chunk_size = chunk_samples;
     bool is_pre_fft_filter = (resources->user_filter_object && !config->apply_user_filter_post_resample &&
                              (resources->user_filter_type_actual == FILTER_IMPL_FFT_SYMMETRIC ||
                               resources->user_filter_type_actual == FILTER_IMPL_FFT_ASYMMETRIC));
@@ -262,49 +446,317 @@ static bool _allocate_processing_buffers(AppConfig *config, AppResources *resour
         return false;
     }
 
-    resources->max_out_samples = required_capacity;
+    // Every sub-buffer is padded so that each one starts on a cache line (or page).
+    size_t alignment = _chunk_alignment(config);
+    layout->max_out_samples = required_capacity;
+    // A memory-mapped input hands each chunk a pointer into the page cache, so
+    // the chunk needs no raw input buffer of its own.
+    layout->raw_input_bytes = resources->input_is_mapped ? 0 : _align_up(chunk_samples * resources->input_bytes_per_sample_pair, alignment);
+    layout->complex_bytes = _align_up(required_capacity * sizeof(complex_float_t), alignment);
+    layout->final_output_bytes = _align_up(required_capacity * get_bytes_per_sample(config->output_format), alignment);
+    layout->total_bytes = layout->raw_input_bytes +
+                          (layout->complex_bytes * 2) + // ping-pong complex buffers
+                          layout->final_output_bytes;
+    return true;
+}
+
+/**
+ * @brief The smallest writer ring that can absorb every chunk in flight.
+ *
+ * The reader checks for back-pressure before it fills a chunk, so every chunk
+ * already in the pipeline can still land in the ring after the reader pauses.
+ * The ring must have room for all of them on top of the back-pressure threshold.
+ */
+static size_t _writer_ring_minimum(size_t num_chunks, const ChunkLayout* layout) {
+    size_t minimum = num_chunks * layout->final_output_bytes * 2;
+    return (minimum > IO_MIN_RING_BUFFER_BYTES) ? minimum : IO_MIN_RING_BUFFER_BYTES;
+}
+
+/**
+ * @brief Shrinks the chunk pool until the writer ring can absorb every chunk in flight.
+ *
+ * The chunk count shrinks first (down to PIPELINE_MIN_NUM_CHUNKS) and only then
+ * the chunk size, as in the --memory-budget path. Sizes the user fixed are kept.
+ * @return false only if the chunk layout cannot be recalculated.
+ */
+static bool _fit_pool_to_writer_ring(const AppConfig *config, const AppResources *resources, float resample_ratio,
+                                     size_t writer_ring, bool chunks_fixed, bool samples_fixed,
+                                     size_t* num_chunks, size_t* chunk_samples, ChunkLayout* layout) {
+    size_t original_chunks = *num_chunks;
+    size_t original_samples = *chunk_samples;
+    while (writer_ring < _writer_ring_minimum(*num_chunks, layout)) {
+        if (!chunks_fixed) {
+            size_t fitting_chunks = writer_ring / (layout->final_output_bytes * 2);
+            if (fitting_chunks < PIPELINE_MIN_NUM_CHUNKS) fitting_chunks = PIPELINE_MIN_NUM_CHUNKS;
+            if (fitting_chunks < *num_chunks) {
+                *num_chunks = fitting_chunks;
+                continue;
+            }
+        }
+        if (samples_fixed || *chunk_samples / 2 < PIPELINE_MIN_CHUNK_SAMPLES) {
+            break; // Reported by the caller.
+        }
+        *chunk_samples /= 2;
+        if (!_calculate_chunk_layout(config, resources, *chunk_samples, resample_ratio, layout)) return false;
+    }
+    if (*num_chunks != original_chunks || *chunk_samples != original_samples) {
+        log_debug("Reduced the chunk pool from %zu x %zu to %zu x %zu samples to fit the writer buffer.",
+                  original_chunks, original_samples, *num_chunks, *chunk_samples);
+    }
+    return true;
+}
+
+/**
+ * @brief The smallest SDR ring that still holds several full-size capture packets.
+ */
+static size_t _sdr_ring_minimum(size_t chunk_samples, const AppResources *resources) {
+    size_t minimum = chunk_samples * resources->input_bytes_per_sample_pair * 4;
+    return (minimum > IO_MIN_RING_BUFFER_BYTES) ? minimum : IO_MIN_RING_BUFFER_BYTES;
+}
+
+/**
+ * @brief The setup arena bytes _allocate_processing_buffers() takes after planning.
+ */
+static size_t _setup_arena_reserve(size_t num_chunks, size_t chunk_samples) {
+    return _align_up(num_chunks * sizeof(SampleChunk), MEM_ARENA_ALIGNMENT) +
+           _align_up(chunk_samples * sizeof(short) * COMPLEX_SAMPLE_COMPONENTS, MEM_ARENA_ALIGNMENT) +
+           _align_up(IO_OUTPUT_WRITER_CHUNK_SIZE, MEM_ARENA_ALIGNMENT);
+}
+
+/**
+ * @brief Resolves the chunk count, chunk size and ring buffer sizes for this run.
+ *
+ * Explicit command-line overrides are used as given. When --memory-budget is set
+ * and the defaults do not fit, the remaining budget (after the setup arena and any
+ * overridden buffers) is shared between the other buffers in proportion to their
+ * default sizes. The chunk pool shrinks its depth first and only then its chunk size.
+ *
+ * The setup arena is counted at its current capacity, including any blocks the
+ * DSP components chained, plus what the chunk headers and writer buffers still
+ * need from it. It is then capped at whatever the plan leaves of the budget.
+ * The per-thread scratch arenas are not counted.
+ */
+static bool _plan_pipeline_memory(AppConfig *config, AppResources *resources, float resample_ratio, ChunkLayout* layout) {
+    bool chunks_fixed = (config->pipeline_chunks_arg > 0);
+    bool samples_fixed = (config->chunk_samples_arg > 0);
+    bool needs_sdr_ring = (resources->pipeline_mode == PIPELINE_MODE_BUFFERED_SDR);
+    bool needs_writer_ring = resources->pacing_is_required;
+    char buf_a[40], buf_b[40], buf_c[40];
+
+    size_t num_chunks = chunks_fixed ? (size_t)config->pipeline_chunks_arg : PIPELINE_NUM_CHUNKS;
+    size_t chunk_samples = resources->pipeline_chunk_base_samples;
+    // The pool only ever shrinks below, so this reserve is an upper bound.
+    size_t arena_bytes = resources->setup_arena.capacity + _setup_arena_reserve(num_chunks, chunk_samples);
+    size_t sdr_ring = 0;
+    size_t writer_ring = 0;
+    if (needs_sdr_ring) {
+        sdr_ring = config->sdr_buffer_size_bytes ? config->sdr_buffer_size_bytes : IO_SDR_INPUT_BUFFER_BYTES;
+    }
+    if (needs_writer_ring) {
+        writer_ring = config->writer_buffer_size_bytes ? config->writer_buffer_size_bytes : IO_OUTPUT_WRITER_BUFFER_BYTES;
+    }
+
+    if (!_calculate_chunk_layout(config, resources, chunk_samples, resample_ratio, layout)) return false;
+
+    if (config->memory_budget_bytes > 0) {
+        if (config->memory_budget_bytes <= arena_bytes) {
+            log_fatal("--memory-budget of %s does not even cover the %s setup arena.",
+                      format_file_size((long long)config->memory_budget_bytes, buf_a, sizeof(buf_a)),
+                      format_file_size((long long)arena_bytes, buf_b, sizeof(buf_b)));
+            return false;
+        }
+        unsigned long long available = config->memory_budget_bytes - arena_bytes;
+        unsigned long long pool_bytes = (unsigned long long)num_chunks * layout->total_bytes;
+
+        if (pool_bytes + sdr_ring + writer_ring > available) {
+            bool pool_flexible = !(chunks_fixed && samples_fixed);
+            bool sdr_flexible = needs_sdr_ring && config->sdr_buffer_size_bytes == 0;
+            bool writer_flexible = needs_writer_ring && config->writer_buffer_size_bytes == 0;
+
+            unsigned long long fixed_bytes = 0;
+            unsigned long long flexible_bytes = 0;
+            if (pool_flexible) flexible_bytes += pool_bytes; else fixed_bytes += pool_bytes;
+            if (sdr_flexible) flexible_bytes += sdr_ring; else fixed_bytes += sdr_ring;
+            if (writer_flexible) flexible_bytes += writer_ring; else fixed_bytes += writer_ring;
+
+            if (fixed_bytes >= available || flexible_bytes == 0) {
+                log_fatal("The explicit buffer sizes (%s) do not fit in --memory-budget %s.",
+                          format_file_size((long long)(fixed_bytes + arena_bytes), buf_a, sizeof(buf_a)),
+                          format_file_size((long long)config->memory_budget_bytes, buf_b, sizeof(buf_b)));
+                return false;
+            }
+            double scale = (double)(available - fixed_bytes) / (double)flexible_bytes;
+
+            if (sdr_flexible) {
+                size_t target = (size_t)((double)sdr_ring * scale);
+                size_t minimum = _sdr_ring_minimum(chunk_samples, resources);
+                sdr_ring = (target > minimum) ? target : minimum;
+            }
+
+            if (pool_flexible) {
+                unsigned long long pool_target = (unsigned long long)((double)pool_bytes * scale);
+                while (true) {
+                    if (!chunks_fixed) {
+                        size_t fitting_chunks = (size_t)(pool_target / layout->total_bytes);
+                        if (fitting_chunks < PIPELINE_MIN_NUM_CHUNKS) fitting_chunks = PIPELINE_MIN_NUM_CHUNKS;
+                        if (fitting_chunks < num_chunks) num_chunks = fitting_chunks;
+                    }
+                    bool pool_fits = ((unsigned long long)num_chunks * layout->total_bytes <= pool_target);
+                    if (pool_fits || samples_fixed || chunk_samples / 2 < PIPELINE_MIN_CHUNK_SAMPLES) {
+                        break;
+                    }
+                    chunk_samples /= 2;
+                    if (!_calculate_chunk_layout(config, resources, chunk_samples, resample_ratio, layout)) return false;
+                }
+            }
+
+            if (writer_flexible) {
+                // The writer ring takes whatever is left over, but never less
+                // than it needs to absorb every chunk in flight.
+                unsigned long long used = (unsigned long long)num_chunks * layout->total_bytes + sdr_ring;
+                unsigned long long left = (used < available) ? (available - used) : 0;
+                size_t minimum = _writer_ring_minimum(num_chunks, layout);
+                if (left < writer_ring) writer_ring = (size_t)left;
+                if (writer_ring < minimum) writer_ring = minimum;
+            }
+
+            unsigned long long planned = (unsigned long long)num_chunks * layout->total_bytes + sdr_ring + writer_ring;
+            if (planned > available) {
+                log_fatal("--memory-budget of %s is too small for this configuration. The smallest plan needs %s (including the %s setup arena).",
+                          format_file_size((long long)config->memory_budget_bytes, buf_a, sizeof(buf_a)),
+                          format_file_size((long long)(planned + arena_bytes), buf_b, sizeof(buf_b)),
+                          format_file_size((long long)arena_bytes, buf_c, sizeof(buf_c)));
+                return false;
+            }
+        }
+    }
+
+    // Trim a pool the user did not size to the writer ring, rather than refuse
+    // a configuration (e.g., a large upsampling ratio) the defaults cannot hold.
+    if (needs_writer_ring && writer_ring < _writer_ring_minimum(num_chunks, layout)) {
+        if (!_fit_pool_to_writer_ring(config, resources, resample_ratio, writer_ring, chunks_fixed, samples_fixed,
+                                      &num_chunks, &chunk_samples, layout)) {
+            return false;
+        }
+    }
+    if (needs_writer_ring && writer_ring < _writer_ring_minimum(num_chunks, layout)) {
+        log_fatal("Writer buffer of %s cannot absorb %zu chunks in flight. At least %s is required.",
+                  format_file_size((long long)writer_ring, buf_a, sizeof(buf_a)), num_chunks,
+                  format_file_size((long long)_writer_ring_minimum(num_chunks, layout), buf_b, sizeof(buf_b)));
+        return false;
+    }
+    if (needs_sdr_ring && sdr_ring < _sdr_ring_minimum(chunk_samples, resources)) {
+        log_fatal("SDR buffer of %s is too small for %zu-sample chunks. At least %s is required.",
+                  format_file_size((long long)sdr_ring, buf_a, sizeof(buf_a)), chunk_samples,
+                  format_file_size((long long)_sdr_ring_minimum(chunk_samples, resources), buf_b, sizeof(buf_b)));
+        return false;
+    }
+
+    resources->pipeline_num_chunks = num_chunks;
+    resources->pipeline_chunk_base_samples = chunk_samples;
+    resources->pipeline_chunk_pool_bytes = num_chunks * layout->total_bytes;
+    resources->sdr_input_buffer_bytes = sdr_ring;
+    resources->writer_input_buffer_bytes = writer_ring;
+
+    // Pause the reader early enough that every chunk in flight still fits.
+    size_t in_flight_bytes = num_chunks * layout->final_output_bytes;
+    size_t threshold = (size_t)((double)writer_ring * IO_WRITER_BUFFER_HIGH_WATER_MARK);
+    if (writer_ring > in_flight_bytes && threshold > writer_ring - in_flight_bytes) {
+        threshold = writer_ring - in_flight_bytes;
+    }
+    resources->writer_backpressure_threshold_bytes = threshold;
+
+    if (config->memory_budget_bytes > 0) {
+        unsigned long long buffers = (unsigned long long)resources->pipeline_chunk_pool_bytes + sdr_ring + writer_ring;
+        unsigned long long arena_limit = config->memory_budget_bytes - buffers;
+        mem_arena_set_limit(&resources->setup_arena, (arena_limit < SIZE_MAX) ? (size_t)arena_limit : SIZE_MAX);
+    }
+    return true;
+}
+
+/**
+ * @brief Prints the resolved memory plan. It is shown at info level when the
+ *        user asked for a budget or override, and at debug level otherwise.
+ */
+static void _log_memory_plan(const AppConfig *config, const AppResources *resources) {
+    bool user_sized = (config->memory_budget_bytes > 0 || config->pipeline_chunks_arg > 0 ||
+                       config->chunk_samples_arg > 0 || config->sdr_buffer_size_bytes > 0 ||
+                       config->writer_buffer_size_bytes > 0 || config->arena_size_bytes > 0);
+    int level = user_sized ? LOG_INFO : LOG_DEBUG;
+    char pool_buf[40], sdr_buf[40], writer_buf[40], arena_buf[40], total_buf[40], budget_buf[40];
+
+    size_t total = resources->setup_arena.capacity + resources->pipeline_chunk_pool_bytes +
+                   resources->sdr_input_buffer_bytes + resources->writer_input_buffer_bytes;
+
+    format_file_size((long long)resources->pipeline_chunk_pool_bytes, pool_buf, sizeof(pool_buf));
+    format_file_size((long long)resources->sdr_input_buffer_bytes, sdr_buf, sizeof(sdr_buf));
+    format_file_size((long long)resources->writer_input_buffer_bytes, writer_buf, sizeof(writer_buf));
+    format_file_size((long long)resources->setup_arena.capacity, arena_buf, sizeof(arena_buf));
+    format_file_size((long long)total, total_buf, sizeof(total_buf));
+
+    log_log(level, __FILE__, __LINE__, "Memory plan: %zu chunks x %zu samples (%s pool), SDR buffer %s, writer buffer %s, arena %s.",
+            resources->pipeline_num_chunks, resources->pipeline_chunk_base_samples,
+            pool_buf, resources->sdr_input_buffer_bytes ? sdr_buf : "unused",
+            resources->writer_input_buffer_bytes ? writer_buf : "unused", arena_buf);
+    if (config->memory_budget_bytes > 0) {
+        format_file_size((long long)config->memory_budget_bytes, budget_buf, sizeof(budget_buf));
+        log_log(level, __FILE__, __LINE__, "Memory plan: %s total of %s budget.", total_buf, budget_buf);
+    } else {
+        log_log(level, __FILE__, __LINE__, "Memory plan: %s total.", total_buf);
+    }
+}
+
+static bool _allocate_processing_buffers(AppConfig *config, AppResources *resources, float resample_ratio) {
+    if (!config || !resources) return false;
+
+    ChunkLayout layout;
+    if (!_plan_pipeline_memory(config, resources, resample_ratio, &layout)) {
+        return false;
+    }
+
+    resources->max_out_samples = (unsigned int)layout.max_out_samples;
     log_debug("Calculated required processing buffer capacity: %u samples.", resources->max_out_samples);
 
-    size_t raw_input_bytes_per_chunk = PIPELINE_CHUNK_BASE_SAMPLES * resources->input_bytes_per_sample_pair;
-    size_t complex_bytes_per_chunk = resources->max_out_samples * sizeof(complex_float_t);
     resources->output_bytes_per_sample_pair = get_bytes_per_sample(config->output_format);
-    size_t final_output_bytes_per_chunk = resources->max_out_samples * resources->output_bytes_per_sample_pair;
-
-    size_t total_bytes_per_chunk = raw_input_bytes_per_chunk +
-                                   (complex_bytes_per_chunk * 2) + // ping-pong complex buffers
-                                   final_output_bytes_per_chunk;
 
-    resources->pipeline_chunk_data_pool = malloc(PIPELINE_NUM_CHUNKS * total_bytes_per_chunk);
+    // buffer_alloc() only guarantees BUFFER_ALLOC_ALIGNMENT, so a stricter
+    // chunk alignment is reached by skipping into an over-sized pool.
+    size_t alignment = _chunk_alignment(config);
+    size_t pool_padding = alignment - BUFFER_ALLOC_ALIGNMENT;
+    resources->pipeline_chunk_data_pool = buffer_alloc(resources->pipeline_chunk_pool_bytes + pool_padding);
     if (!resources->pipeline_chunk_data_pool) {
         log_fatal("Error: Failed to allocate the main pipeline chunk data pool.");
         return false;
     }
+    char* pool_start = (char*)_align_up((size_t)(uintptr_t)resources->pipeline_chunk_data_pool, alignment);
 
-    resources->sample_chunk_pool = (SampleChunk*)mem_arena_alloc(&resources->setup_arena, PIPELINE_NUM_CHUNKS * sizeof(SampleChunk), true);
+    resources->sample_chunk_pool = (SampleChunk*)mem_arena_alloc(&resources->setup_arena, resources->pipeline_num_chunks * sizeof(SampleChunk), true);
     if (!resources->sample_chunk_pool) return false;
 
-    resources->sdr_deserializer_buffer_size = PIPELINE_CHUNK_BASE_SAMPLES * sizeof(short) * COMPLEX_SAMPLE_COMPONENTS;
+    resources->sdr_deserializer_buffer_size = resources->pipeline_chunk_base_samples * sizeof(short) * COMPLEX_SAMPLE_COMPONENTS;
     resources->sdr_deserializer_temp_buffer = mem_arena_alloc(&resources->setup_arena, resources->sdr_deserializer_buffer_size, false);
     if (!resources->sdr_deserializer_temp_buffer) return false;
 
     resources->writer_local_buffer = mem_arena_alloc(&resources->setup_arena, IO_OUTPUT_WRITER_CHUNK_SIZE, false);
     if (!resources->writer_local_buffer) return false;
 
-    for (size_t i = 0; i < PIPELINE_NUM_CHUNKS; ++i) {
+    for (size_t i = 0; i < resources->pipeline_num_chunks; ++i) {
         SampleChunk* item = &resources->sample_chunk_pool[i];
-        char* chunk_base = (char*)resources->pipeline_chunk_data_pool + i * total_bytes_per_chunk;
+        char* chunk_base = pool_start + i * layout.total_bytes;
 
-        item->raw_input_data = chunk_base;
-        item->complex_sample_buffer_a = (complex_float_t*)(chunk_base + raw_input_bytes_per_chunk);
-        item->complex_sample_buffer_b = (complex_float_t*)(chunk_base + raw_input_bytes_per_chunk + complex_bytes_per_chunk);
-        item->final_output_data = (unsigned char*)(chunk_base + raw_input_bytes_per_chunk + (complex_bytes_per_chunk * 2));
+        item->raw_input_data = (layout.raw_input_bytes > 0) ? chunk_base : NULL;
+        item->complex_sample_buffer_a = (complex_float_t*)(chunk_base + layout.raw_input_bytes);
+        item->complex_sample_buffer_b = (complex_float_t*)(chunk_base + layout.raw_input_bytes + layout.complex_bytes);
+        item->final_output_data = (unsigned char*)(chunk_base + layout.raw_input_bytes + (layout.complex_bytes * 2));
 
-        item->raw_input_capacity_bytes = raw_input_bytes_per_chunk;
+        item->raw_input_capacity_bytes = layout.raw_input_bytes;
         item->complex_buffer_capacity_samples = resources->max_out_samples;
-        item->final_output_capacity_bytes = final_output_bytes_per_chunk;
+        item->final_output_capacity_bytes = layout.final_output_bytes;
         item->input_bytes_per_sample_pair = resources->input_bytes_per_sample_pair;
     }
 
+    // Logged last so the arena figure includes everything the setup took from it.
+    _log_memory_plan(config, resources);
     return true;
 }
 
@@ -360,6 +812,8 @@ void* reader_thread_func(void* arg) {
                     resources->sdr_deserializer_buffer_size
                 );
 
+                telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_READER);
+
                 if (frames_read < 0) {
                     handle_fatal_thread_error("Reader: Fatal error parsing SDR buffer stream.", resources);
                     queue_enqueue(resources->free_sample_chunk_queue, item);
@@ -373,15 +827,20 @@ void* reader_thread_func(void* arg) {
                     break;
                 }
 
+                // --raw-passthrough hands chunks straight to the writer, which reads final_output_data.
+                if (config->raw_passthrough && frames_read > 0) {
+                    memcpy(item->final_output_data, item->raw_input_data, (size_t)frames_read * resources->input_bytes_per_sample_pair);
+                }
+
                 item->frames_read = frames_read;
                 item->stream_discontinuity_event = is_reset;
                 item->is_last_chunk = false;
 
                 if (item->frames_read > 0) {
-                    pthread_mutex_lock(&resources->progress_mutex);
-                    resources->total_frames_read += item->frames_read;
-                    pthread_mutex_unlock(&resources->progress_mutex);
+                    atomic_fetch_add_explicit(&resources->total_frames_read, item->frames_read, memory_order_relaxed);
                 }
+                telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_READER, item->frames_read);
+                telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_READER, item->capture_time_ns);
 
                 if (!queue_enqueue(resources->reader_output_queue, item)) {
                     queue_enqueue(resources->free_sample_chunk_queue, item);
@@ -401,7 +860,7 @@ void* reader_thread_func(void* arg) {
 
     if (!is_shutdown_requested()) {
         log_debug("Reader thread finished naturally. End of stream reached.");
-        resources->end_of_stream_reached = true;
+        atomic_store(&resources->end_of_stream_reached, true);
     } else {
         SampleChunk *last_item = (SampleChunk*)queue_try_dequeue(resources->free_sample_chunk_queue);
         if (last_item) {
@@ -442,15 +901,12 @@ void* pre_processor_thread_func(void* arg) {
 
     PipelineContext* args = (PipelineContext*)arg;
     AppResources* resources = args->resources;
-    AppConfig* config = args->config;
 
     SampleChunk* item;
     while ((item = (SampleChunk*)queue_dequeue(resources->pre_processor_input_queue)) != NULL) {
 
         if (item->is_last_chunk) {
-            if (resources->iq_optimization_data_queue) {
-                queue_signal_shutdown(resources->iq_optimization_data_queue);
-            }
+            analysis_tap_close(resources->iq_analysis_tap);
             queue_enqueue(resources->pre_processor_output_queue, item);
             break;
         }
@@ -463,16 +919,22 @@ void* pre_processor_thread_func(void* arg) {
             continue;
         }
  
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_PRE_PROCESSOR);
         pre_processor_apply_chain(resources, item);
 
-        if (config->iq_correction.enable) {
-            if (item->frames_read >= IQ_CORRECTION_FFT_SIZE && !item->stream_discontinuity_event) {
-                SampleChunk* opt_item = (SampleChunk*)queue_try_dequeue(resources->free_sample_chunk_queue);
-                if (opt_item) {
-                    memcpy(opt_item->complex_sample_buffer_a, item->complex_sample_buffer_a, IQ_CORRECTION_FFT_SIZE * sizeof(complex_float_t));
-                    queue_enqueue(resources->iq_optimization_data_queue, opt_item);
-                }
-            }
+        // Feed side-channel consumers from a snapshot ring, never from the chunk pool.
+        if (resources->iq_analysis_tap) {
+            analysis_tap_publish(resources->iq_analysis_tap, item->complex_sample_buffer_a, item->frames_read);
+        }
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_PRE_PROCESSOR, item->frames_read);
+        telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_PRE_PROCESSOR, item->capture_time_ns);
+
+        // With --no-resample there is no resampler thread, so leave the chunk
+        // the way it would: the data in buffer_a is the next stage's input.
+        if (args->config->no_resample) {
+            item->frames_to_write = item->frames_read;
+            item->current_input_buffer = item->complex_sample_buffer_a;
+            item->current_output_buffer = item->complex_sample_buffer_b;
         }
 
         if (item->frames_read > 0) {
@@ -508,6 +970,9 @@ void* resampler_thread_func(void* arg) {
             continue;
         }
 
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_RESAMPLER);
+        unsigned long long step_start = telemetry_step_begin(resources->telemetry);
+
         // Set up the state pointers for this stage
         item->current_input_buffer = item->complex_sample_buffer_a;
         item->current_output_buffer = item->complex_sample_buffer_b;
@@ -521,6 +986,9 @@ void* resampler_thread_func(void* arg) {
             resampler_execute(resources->resampler, item->current_input_buffer, (unsigned int)item->frames_read, item->current_output_buffer, &output_frames_this_chunk);
         }
         item->frames_to_write = output_frames_this_chunk;
+        telemetry_step_end(resources->telemetry, TELEMETRY_STEP_RESAMPLE, step_start, item->frames_read);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_RESAMPLER, item->frames_read);
+        telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_RESAMPLER, item->capture_time_ns);
 
         // --- CRITICAL PING-PONG SWAP ---
         // The output of this stage becomes the input for the next stage.
@@ -546,6 +1014,8 @@ void* post_processor_thread_func(void* arg) {
     PipelineContext* args = (PipelineContext*)arg;
     AppResources* resources = args->resources;
 
+    unsigned long long writer_stream_bytes = 0;
+
     SampleChunk* item;
     while ((item = (SampleChunk*)queue_dequeue(resources->post_processor_input_queue)) != NULL) {
 
@@ -570,7 +1040,10 @@ void* post_processor_thread_func(void* arg) {
             continue;
         }
 
+        telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_POST_PROCESSOR);
         post_processor_apply_chain(resources, item);
+        telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_POST_PROCESSOR, item->frames_to_write);
+        telemetry_record_latency(resources->telemetry, TELEMETRY_STAGE_POST_PROCESSOR, item->capture_time_ns);
 
         if (item->frames_to_write > 0) {
             // If we are NOT using a paced buffer, pass the chunk directly to the writer thread's queue.
@@ -581,6 +1054,9 @@ void* post_processor_thread_func(void* arg) {
             } else { // Otherwise, write the data to the ring buffer and return the chunk to the free pool.
                 if (resources->writer_input_buffer) {
                     size_t bytes_to_write = item->frames_to_write * resources->output_bytes_per_sample_pair;
+                    // Index the chunk before writing it, so the writer can never consume its bytes first.
+                    writer_stream_bytes += bytes_to_write;
+                    telemetry_latency_index_push(resources->telemetry, writer_stream_bytes, item->capture_time_ns);
                     ring_buffer_write(resources->writer_input_buffer, item->final_output_data, bytes_to_write);
                 }
                 queue_enqueue(resources->free_sample_chunk_queue, item);
@@ -593,3 +1069,84 @@ void* post_processor_thread_func(void* arg) {
     log_debug("Post-processor thread is exiting.");
     return NULL;
 }
+
+void* transcoder_thread_func(void* arg) {
+#ifdef _WIN32
+    if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL)) {
+        log_warn("Failed to set transcoder thread priority.");
+    }
+#endif
+
+    PipelineContext* args = (PipelineContext*)arg;
+    AppResources* resources = args->resources;
+    Telemetry* tel = resources->telemetry;
+
+    unsigned long long writer_stream_bytes = 0;
+
+    SampleChunk* item;
+    while ((item = (SampleChunk*)queue_dequeue(resources->transcoder_input_queue)) != NULL) {
+
+        if (item->is_last_chunk) {
+            if (!resources->pacing_is_required) {
+                queue_enqueue(resources->writer_input_queue, item);
+            } else {
+                if (resources->writer_input_buffer) {
+                    ring_buffer_signal_end_of_stream(resources->writer_input_buffer);
+                }
+                queue_enqueue(resources->free_sample_chunk_queue, item);
+            }
+            break;
+        }
+
+        // The conversion keeps no state between chunks, so a stream reset only
+        // needs to reach writers that act on it.
+        if (item->stream_discontinuity_event) {
+            if (!resources->pacing_is_required) {
+                if (!queue_enqueue(resources->writer_input_queue, item)) {
+                    break;
+                }
+            } else {
+                queue_enqueue(resources->free_sample_chunk_queue, item);
+            }
+            continue;
+        }
+
+        telemetry_stage_begin_work(tel, TELEMETRY_STAGE_TRANSCODER);
+        unsigned long long step_start = telemetry_step_begin(tel);
+
+        // Without a transcoder (--raw-passthrough), the reader has already
+        // placed the samples in final_output_data.
+        const void* raw_data = item->mapped_input_data ? item->mapped_input_data : item->raw_input_data;
+        item->frames_to_write = item->frames_read;
+        if (resources->transcoder && item->frames_read > 0 &&
+            !transcode_block(resources->transcoder, raw_data, item->packet_sample_format,
+                             item->final_output_data, item->frames_read)) {
+            handle_fatal_thread_error("Transcoder: Failed to convert samples.", resources);
+            item->frames_to_write = 0;
+        }
+        telemetry_step_end(tel, TELEMETRY_STEP_TRANSCODE, step_start, item->frames_to_write);
+        telemetry_stage_end_work(tel, TELEMETRY_STAGE_TRANSCODER, item->frames_to_write);
+        telemetry_record_latency(tel, TELEMETRY_STAGE_TRANSCODER, item->capture_time_ns);
+
+        if (item->frames_to_write > 0) {
+            if (!resources->pacing_is_required) {
+                if (!queue_enqueue(resources->writer_input_queue, item)) {
+                    break;
+                }
+            } else {
+                if (resources->writer_input_buffer) {
+                    size_t bytes_to_write = item->frames_to_write * resources->output_bytes_per_sample_pair;
+                    writer_stream_bytes += bytes_to_write;
+                    telemetry_latency_index_push(tel, writer_stream_bytes, item->capture_time_ns);
+                    ring_buffer_write(resources->writer_input_buffer, item->final_output_data, bytes_to_write);
+                }
+                queue_enqueue(resources->free_sample_chunk_queue, item);
+            }
+        } else {
+            queue_enqueue(resources->free_sample_chunk_queue, item);
+        }
+    }
+
+    log_debug("Transcoder thread is exiting.");
+    return NULL;
+}
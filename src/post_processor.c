@@ -5,11 +5,15 @@
 #include "sample_convert.h"
 #include "signal_handler.h"
 #include "log.h"
+#include "telemetry.h"
 
 void post_processor_apply_chain(AppResources* resources, SampleChunk* item) {
     AppConfig* config = (AppConfig*)resources->config;
+    Telemetry* tel = resources->telemetry;
 
     if (item->frames_to_write > 0) {
+        unsigned long long t = telemetry_step_begin(tel);
+
         // --- Stage Setup ---
         // The resampler thread has already set up the pointers for us:
         // - item->current_input_buffer points to the resampled data.
@@ -24,7 +28,9 @@ void post_processor_apply_chain(AppResources* resources, SampleChunk* item) {
             bool is_fft_filter = (resources->user_filter_type_actual == FILTER_IMPL_FFT_SYMMETRIC ||
                                   resources->user_filter_type_actual == FILTER_IMPL_FFT_ASYMMETRIC);
 
+            size_t frames_in = item->frames_to_write;
             item->frames_to_write = filter_apply(resources, item, true);
+            t = telemetry_step_end(tel, TELEMETRY_STEP_POST_FILTER, t, frames_in);
 
             // --- CRITICAL FIX ---
             // If an out-of-place filter ran, its output is now in the 'output' buffer.
@@ -50,11 +56,15 @@ void post_processor_apply_chain(AppResources* resources, SampleChunk* item) {
  
             // The result is now in the destination buffer, so we update our local pointer.
             current_data_ptr = destination_buffer;
+            t = telemetry_step_end(tel, TELEMETRY_STEP_POST_FREQ_SHIFT, t, item->frames_to_write);
         }
 
         // Step 3: Output Automatic Gain Control (if enabled)
         // This runs in-place on the current data pointer.
         agc_apply(resources, current_data_ptr, item->frames_to_write);
+        if (config->output_agc.enable) {
+            t = telemetry_step_end(tel, TELEMETRY_STEP_AGC, t, item->frames_to_write);
+        }
 
         // Step 4: Final Sample Format Conversion
         // The current_data_ptr now points to the final, fully processed complex float data.
@@ -66,6 +76,7 @@ void post_processor_apply_chain(AppResources* resources, SampleChunk* item) {
             // Mark the chunk as having zero frames to prevent writing bad data
             item->frames_to_write = 0;
         }
+        telemetry_step_end(tel, TELEMETRY_STEP_CONVERT_OUTPUT, t, item->frames_to_write);
     }
 }
 
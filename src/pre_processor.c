@@ -6,9 +6,12 @@
 #include "filter.h"
 #include "signal_handler.h"
 #include "log.h"
+#include "telemetry.h"
 
 void pre_processor_apply_chain(AppResources* resources, SampleChunk* item) {
     AppConfig* config = (AppConfig*)resources->config;
+    Telemetry* tel = resources->telemetry;
+    unsigned long long t = telemetry_step_begin(tel);
 
     // --- Stage Setup ---
     // For the pre-processor, all operations happen in the first buffer.
@@ -18,21 +21,25 @@ void pre_processor_apply_chain(AppResources* resources, SampleChunk* item) {
     item->current_output_buffer = item->complex_sample_buffer_a;
 
     // Step 1: Convert sample block to complex float
-    if (!convert_block_to_cf32(item->raw_input_data, item->current_output_buffer,
+    const void* raw_data = item->mapped_input_data ? item->mapped_input_data : item->raw_input_data;
+    if (!convert_block_to_cf32(raw_data, item->current_output_buffer,
                                item->frames_read, item->packet_sample_format, config->gain)) {
         handle_fatal_thread_error("Pre-Processor: Failed to convert samples.", resources);
         item->frames_read = 0;
         return;
     }
+    t = telemetry_step_end(tel, TELEMETRY_STEP_CONVERT_INPUT, t, item->frames_read);
 
     // Step 2: DC Blocking (if enabled)
     if (config->dc_block.enable) {
         dc_block_apply(resources, item->current_output_buffer, item->frames_read);
+        t = telemetry_step_end(tel, TELEMETRY_STEP_DC_BLOCK, t, item->frames_read);
     }
 
     // Step 3: I/Q Imbalance Correction (if enabled)
     if (config->iq_correction.enable) {
         iq_correct_apply(resources, item->current_output_buffer, item->frames_read);
+        t = telemetry_step_end(tel, TELEMETRY_STEP_IQ_CORRECT, t, item->frames_read);
     }
 
     // Step 4: Pre-Resample Frequency Shifting (if enabled)
@@ -43,6 +50,7 @@ void pre_processor_apply_chain(AppResources* resources, SampleChunk* item) {
                          item->current_output_buffer,
                          item->current_output_buffer,
                          item->frames_read);
+        t = telemetry_step_end(tel, TELEMETRY_STEP_PRE_FREQ_SHIFT, t, item->frames_read);
     }
 
     // Step 5: Pre-Resample Filtering (if enabled)
@@ -50,7 +58,9 @@ void pre_processor_apply_chain(AppResources* resources, SampleChunk* item) {
         // filter_apply will now correctly handle its internal state, whether
         // it's an in-place FIR or an out-of-place FFT. The thread function
         // is responsible for the final ping-pong swap if needed.
+        size_t frames_in = item->frames_read;
         item->frames_read = filter_apply(resources, item, false);
+        telemetry_step_end(tel, TELEMETRY_STEP_PRE_FILTER, t, frames_in);
     }
 }
 
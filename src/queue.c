@@ -1,6 +1,8 @@
 #include "queue.h"
 #include "log.h"
 #include "memory_arena.h" // For mem_arena_alloc
+#include "trace.h"
+#include "utils.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
@@ -63,6 +65,10 @@ bool queue_enqueue(Queue* queue, void* item) {
 
     pthread_mutex_lock(&queue->mutex);
 
+    unsigned long long wait_start = 0;
+    if (queue->count == queue->capacity && trace_is_enabled()) {
+        wait_start = get_monotonic_time_ns();
+    }
     while (queue->count == queue->capacity && !queue->shutting_down) {
         pthread_cond_wait(&queue->not_full_cond, &queue->mutex);
     }
@@ -79,6 +85,9 @@ bool queue_enqueue(Queue* queue, void* item) {
     pthread_cond_signal(&queue->not_empty_cond);
     pthread_mutex_unlock(&queue->mutex);
 
+    if (wait_start) {
+        trace_span("wait", "enqueue wait (back-pressure)", wait_start, get_monotonic_time_ns(), 0);
+    }
     return true;
 }
 
@@ -87,6 +96,10 @@ void* queue_dequeue(Queue* queue) {
 
     pthread_mutex_lock(&queue->mutex);
 
+    unsigned long long wait_start = 0;
+    if (queue->count == 0 && trace_is_enabled()) {
+        wait_start = get_monotonic_time_ns();
+    }
     while (queue->count == 0 && !queue->shutting_down) {
         pthread_cond_wait(&queue->not_empty_cond, &queue->mutex);
     }
@@ -103,6 +116,9 @@ void* queue_dequeue(Queue* queue) {
     pthread_cond_signal(&queue->not_full_cond);
     pthread_mutex_unlock(&queue->mutex);
 
+    if (wait_start) {
+        trace_span("wait", "dequeue wait", wait_start, get_monotonic_time_ns(), 0);
+    }
     return item;
 }
 
@@ -137,3 +153,11 @@ void queue_signal_shutdown(Queue* queue) {
 
     pthread_mutex_unlock(&queue->mutex);
 }
+
+size_t queue_get_count(Queue* queue) {
+    if (!queue) return 0;
+    pthread_mutex_lock(&queue->mutex);
+    size_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
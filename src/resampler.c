@@ -46,6 +46,10 @@ void resampler_reset(resampler_t* resampler) {
     }
 }
 
+float resampler_get_delay(resampler_t* resampler) {
+    return resampler ? msresamp_crcf_get_delay((msresamp_crcf)resampler) : 0.0f;
+}
+
 void resampler_execute(resampler_t* resampler, complex_float_t* input, unsigned int num_input_frames, complex_float_t* output, unsigned int* num_output_frames) {
     if (resampler) {
         msresamp_crcf_execute((msresamp_crcf)resampler, (liquid_float_complex*)input, num_input_frames, (liquid_float_complex*)output, num_output_frames);
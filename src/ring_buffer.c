@@ -4,6 +4,9 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include "log.h"
+#include "buffer_alloc.h"
+#include "trace.h"
+#include "utils.h"
 
 // The full definition of the opaque RingBuffer struct from the header file.
 struct RingBuffer {
@@ -28,7 +31,7 @@ RingBuffer* ring_buffer_create(size_t capacity) {
         return NULL;
     }
 
-    iob->buffer = (unsigned char*)malloc(capacity);
+    iob->buffer = (unsigned char*)buffer_alloc(capacity);
     if (!iob->buffer) {
         log_fatal("Failed to allocate memory for RingBuffer data buffer of size %zu bytes.", capacity);
         free(iob);
@@ -56,7 +59,7 @@ void ring_buffer_destroy(RingBuffer* iob) {
     
     pthread_mutex_destroy(&iob->mutex);
     pthread_cond_destroy(&iob->data_available_cond);
-    free(iob->buffer);
+    buffer_free(iob->buffer);
     free(iob);
 }
 
@@ -101,6 +104,7 @@ size_t ring_buffer_read(RingBuffer* iob, void* buffer, size_t max_bytes) {
     pthread_mutex_lock(&iob->mutex);
 
     size_t available_data;
+    unsigned long long wait_start = 0;
 
     while (true) {
         available_data = (iob->write_pos >= iob->read_pos) ? (iob->write_pos - iob->read_pos) : (iob->capacity - (iob->read_pos - iob->write_pos));
@@ -108,9 +112,15 @@ size_t ring_buffer_read(RingBuffer* iob, void* buffer, size_t max_bytes) {
         if (available_data > 0 || iob->shutting_down || iob->end_of_stream) {
             break;
         }
+        if (wait_start == 0 && trace_is_enabled()) {
+            wait_start = get_monotonic_time_ns();
+        }
         
         pthread_cond_wait(&iob->data_available_cond, &iob->mutex);
     }
+    if (wait_start) {
+        trace_span("wait", "ring buffer read wait", wait_start, get_monotonic_time_ns(), 0);
+    }
 
     if (iob->shutting_down) {
         pthread_mutex_unlock(&iob->mutex);
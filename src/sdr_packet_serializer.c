@@ -4,6 +4,8 @@
 #include "app_context.h"
 #include "pipeline_types.h"
 #include "ring_buffer.h"
+#include "telemetry.h"
+#include "utils.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -19,6 +21,7 @@ typedef struct {
     uint32_t num_samples;
     uint8_t  flags;
     uint8_t  format_id;
+    uint64_t timestamp_ns; // Monotonic capture time, carried through to SampleChunk::capture_time_ns
 } SdrInputChunkHeader;
 #pragma pack(pop)
 
@@ -69,6 +72,7 @@ bool sdr_packet_serializer_write_deinterleaved_chunk(RingBuffer* buffer, uint32_
     header.num_samples = num_samples;
     header.flags = 0; // De-interleaved (interleaved flag is NOT set)
     header.format_id = (uint8_t)format;
+    header.timestamp_ns = get_monotonic_time_ns();
 
     size_t bytes_per_plane = num_samples * sizeof(short);
     
@@ -85,6 +89,7 @@ bool sdr_packet_serializer_write_interleaved_chunk(RingBuffer* buffer, uint32_t
     header.num_samples = num_samples;
     header.flags = SDR_CHUNK_FLAG_INTERLEAVED;
     header.format_id = (uint8_t)format;
+    header.timestamp_ns = get_monotonic_time_ns();
 
     size_t data_bytes = num_samples * bytes_per_sample_pair;
 
@@ -94,12 +99,17 @@ bool sdr_packet_serializer_write_interleaved_chunk(RingBuffer* buffer, uint32_t
     return true;
 }
 
+size_t sdr_packet_serializer_packet_bytes(uint32_t num_samples, size_t bytes_per_sample_pair) {
+    return sizeof(SdrInputChunkHeader) + (size_t)num_samples * bytes_per_sample_pair;
+}
+
 bool sdr_packet_serializer_write_reset_event(RingBuffer* buffer) {
     SdrInputChunkHeader header;
     header.magic = IQPK_MAGIC; // --- MODIFIED ---
     header.num_samples = 0;
     header.flags = SDR_CHUNK_FLAG_STREAM_RESET;
     header.format_id = (uint8_t)FORMAT_UNKNOWN;
+    header.timestamp_ns = 0;
 
     return (ring_buffer_write(buffer, &header, sizeof(header)) == sizeof(header));
 }
@@ -181,6 +191,7 @@ int64_t sdr_packet_serializer_read_packet(RingBuffer* buffer,
     }
     
     target_chunk->packet_sample_format = (format_t)header.format_id;
+    target_chunk->capture_time_ns = header.timestamp_ns;
     if (header.flags & SDR_CHUNK_FLAG_STREAM_RESET) {
         *is_reset_event = true;
     }
@@ -188,7 +199,7 @@ int64_t sdr_packet_serializer_read_packet(RingBuffer* buffer,
         log_error("SDR stream corrupted: received data packet with FORMAT_UNKNOWN.");
         return -1;
     }
-    if (header.num_samples > (PIPELINE_CHUNK_BASE_SAMPLES * 2)) {
+    if (header.num_samples > (target_chunk->raw_input_capacity_bytes / target_chunk->input_bytes_per_sample_pair) * 2) {
         log_error("SDR stream corrupted: received impossibly large packet length (%u).", header.num_samples);
         return -1;
     }
@@ -208,10 +219,11 @@ int64_t sdr_packet_serializer_read_packet(RingBuffer* buffer,
 
 static int64_t _read_interleaved_payload(RingBuffer* buffer, SampleChunk* target_chunk, uint32_t num_samples) {
     uint32_t samples_to_read = num_samples;
-    if (samples_to_read > PIPELINE_CHUNK_BASE_SAMPLES) {
-        log_warn("SDR chunk (%u samples) exceeds buffer capacity (%d). Truncating.",
-                 samples_to_read, PIPELINE_CHUNK_BASE_SAMPLES);
-        samples_to_read = PIPELINE_CHUNK_BASE_SAMPLES;
+    const uint32_t chunk_capacity = (uint32_t)(target_chunk->raw_input_capacity_bytes / target_chunk->input_bytes_per_sample_pair);
+    if (samples_to_read > chunk_capacity) {
+        log_warn("SDR chunk (%u samples) exceeds buffer capacity (%u). Truncating.",
+                 samples_to_read, chunk_capacity);
+        samples_to_read = chunk_capacity;
     }
 
     size_t bytes_to_read = samples_to_read * target_chunk->input_bytes_per_sample_pair;
@@ -227,10 +239,11 @@ static int64_t _read_interleaved_payload(RingBuffer* buffer, SampleChunk* target
 
 static int64_t _read_and_reinterleave_payload(RingBuffer* buffer, SampleChunk* target_chunk, uint32_t num_samples, void* temp_buffer, size_t temp_buffer_size) {
     uint32_t samples_to_read = num_samples;
-    if (samples_to_read > PIPELINE_CHUNK_BASE_SAMPLES) {
-        log_warn("SDR chunk (%u samples) exceeds buffer capacity (%d). Truncating.",
-                 samples_to_read, PIPELINE_CHUNK_BASE_SAMPLES);
-        samples_to_read = PIPELINE_CHUNK_BASE_SAMPLES;
+    const uint32_t chunk_capacity = (uint32_t)(target_chunk->raw_input_capacity_bytes / target_chunk->input_bytes_per_sample_pair);
+    if (samples_to_read > chunk_capacity) {
+        log_warn("SDR chunk (%u samples) exceeds buffer capacity (%u). Truncating.",
+                 samples_to_read, chunk_capacity);
+        samples_to_read = chunk_capacity;
     }
 
     size_t bytes_per_plane = samples_to_read * sizeof(short);
@@ -271,10 +284,12 @@ void sdr_write_interleaved_chunks(AppResources* resources, const unsigned char*
     uint32_t samples_processed = 0;
     const unsigned char* current_buffer_pos = data;
 
+    telemetry_stage_begin_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE);
+
     while (samples_processed < total_samples_in_transfer) {
         uint32_t samples_this_chunk = total_samples_in_transfer - samples_processed;
-        if (samples_this_chunk > PIPELINE_CHUNK_BASE_SAMPLES) {
-            samples_this_chunk = PIPELINE_CHUNK_BASE_SAMPLES;
+        if (samples_this_chunk > resources->pipeline_chunk_base_samples) {
+            samples_this_chunk = (uint32_t)resources->pipeline_chunk_base_samples;
         }
 
         if (!sdr_packet_serializer_write_interleaved_chunk(
@@ -291,4 +306,5 @@ void sdr_write_interleaved_chunks(AppResources* resources, const unsigned char*
         samples_processed += samples_this_chunk;
         current_buffer_pos += (samples_this_chunk * bytes_per_sample_pair);
     }
+    telemetry_stage_end_work(resources->telemetry, TELEMETRY_STAGE_SDR_CAPTURE, samples_processed);
 }
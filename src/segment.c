@@ -0,0 +1,509 @@
+/**
+ * @file segment.c
+ * @brief Implements parallel segmented processing of one file input (--segments).
+ */
+
+#include "segment.h"
+#include "constants.h"
+#include "app_context.h"
+#include "pipeline.h"
+#include "pipeline_context.h"
+#include "resampler.h"
+#include "filter.h"
+#include "sample_convert.h"
+#include "signal_handler.h"
+#include "log.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+#ifdef _WIN32
+
+// --- Windows: not supported, validate_segment_options() turns --segments off ---
+
+bool segment_run(AppConfig* config, AppResources* resources, int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    PipelineContext pipeline_context = { .config = config, .resources = resources };
+    return pipeline_run(&pipeline_context);
+}
+
+long long segment_write_output(ModuleContext* ctx, int out_fd, unsigned long long payload_offset,
+                               long long* total_bytes_written) {
+    (void)ctx;
+    (void)out_fd;
+    (void)payload_offset;
+    (void)total_bytes_written;
+    return -1;
+}
+
+#else
+
+// --- Private Definitions ---
+
+/**
+ * @struct SegmentPlan
+ * @brief How the input of a --segments run is divided between the jobs.
+ *
+ * Frame numbers are counted from the first frame of the run (the --start
+ * frame, if one was given). The jobs' write offsets are relative to the
+ * start of the payload.
+ */
+typedef struct {
+    unsigned int       count;
+    unsigned long long first_frame;     ///< Absolute input frame the run starts at.
+    unsigned long long input_frames;    ///< Input frames in the run.
+    unsigned long long segment_frames;  ///< Input frames per segment, a whole number of resampler periods.
+    unsigned long long warmup_frames;   ///< Extra input frames run before and after a segment.
+    unsigned long long in_period;       ///< Input frames per resampler period, 1 if the rates are not integral.
+    unsigned long long out_period;      ///< Output frames per resampler period, 0 if the rates are not integral.
+    double             ratio;           ///< Output rate / input rate.
+    size_t             output_frame_bytes;
+    unsigned long long job_budget_bytes; ///< --memory-budget share per job, 0 if none was given.
+    SegmentJob         jobs[SEGMENT_MAX_JOBS];
+    unsigned long long job_input_frames[SEGMENT_MAX_JOBS];
+    int                argc;
+    char**             argv;
+} SegmentPlan;
+
+/**
+ * @struct SegmentStatus
+ * @brief What the parent has heard from one job.
+ */
+typedef struct {
+    pid_t              pid;
+    unsigned long long frames_written;
+    bool               done;       ///< The job reported that its output is complete.
+    bool               exited_ok;  ///< The job exited with status 0.
+} SegmentStatus;
+
+static SegmentPlan s_plan;
+
+// --- Forward Declarations for Static Helper Functions ---
+static bool _plan_segments(AppConfig* config, AppResources* resources, int argc, char* argv[], SegmentPlan* plan);
+static double _warmup_input_frames(AppConfig* config, AppResources* resources, double ratio);
+static unsigned long long _output_index(const SegmentPlan* plan, unsigned long long input_frame);
+static unsigned long long _gcd(unsigned long long a, unsigned long long b);
+static pid_t _spawn_job(const SegmentPlan* plan, unsigned int index, int report_fd, unsigned long long payload_offset);
+static void _parse_reports(char* buffer, size_t* buffered, SegmentStatus* status, unsigned int count);
+static void _reserve_payload(int out_fd, unsigned long long payload_offset, unsigned long long bytes);
+
+// --- Public Function Implementations ---
+
+bool segment_run(AppConfig* config, AppResources* resources, int argc, char* argv[]) {
+    ModuleContext ctx = { .config = config, .resources = resources };
+    PipelineContext pipeline_context = { .config = config, .resources = resources };
+
+    if (!_plan_segments(config, resources, argc, argv, &s_plan)) {
+        atomic_store(&resources->error_occurred, true);
+        return false;
+    }
+    if (s_plan.count <= 1) {
+        log_info("The input is too short to split into segments. Processing it in one pass.");
+        return pipeline_run(&pipeline_context);
+    }
+
+    const OutputModuleInterface* output_api = resources->selected_output_module_api;
+    if (!output_api->write_segments) {
+        log_fatal("The '%s' output cannot be written by parallel segments.", config->output_module_str);
+        atomic_store(&resources->error_occurred, true);
+        return false;
+    }
+
+    resources->output_bytes_per_sample_pair = s_plan.output_frame_bytes;
+    long long payload_bytes = output_api->write_segments(&ctx);
+
+    unsigned long long frames_written = (payload_bytes > 0) ? (unsigned long long)payload_bytes / s_plan.output_frame_bytes : 0;
+    atomic_store_explicit(&resources->total_output_frames, frames_written, memory_order_relaxed);
+    if (payload_bytes < 0) {
+        atomic_store(&resources->error_occurred, true);
+        return false;
+    }
+    if (!is_shutdown_requested()) {
+        atomic_store_explicit(&resources->total_frames_read, s_plan.input_frames, memory_order_relaxed);
+        atomic_store(&resources->end_of_stream_reached, true);
+    }
+    return true;
+}
+
+long long segment_write_output(ModuleContext* ctx, int out_fd, unsigned long long payload_offset,
+                               long long* total_bytes_written) {
+    AppResources* resources = ctx->resources;
+    const SegmentPlan* plan = &s_plan;
+    SegmentStatus status[SEGMENT_MAX_JOBS];
+    memset(status, 0, sizeof(status));
+
+    struct stat stat_buf;
+    bool regular_file = (fstat(out_fd, &stat_buf) == 0 && S_ISREG(stat_buf.st_mode));
+    if (regular_file) {
+        _reserve_payload(out_fd, payload_offset, _output_index(plan, plan->input_frames) * plan->output_frame_bytes);
+    }
+
+    // The jobs inherit the write end; the read end stays with the parent.
+    int report_pipe[2];
+    if (pipe(report_pipe) != 0) {
+        log_fatal("Could not create the segment report pipe: %s", strerror(errno));
+        return -1;
+    }
+    fcntl(report_pipe[0], F_SETFD, FD_CLOEXEC);
+
+    log_info("Processing %u segments of %llu frames in parallel (%llu warm-up frames each side).",
+             plan->count, plan->segment_frames, plan->warmup_frames);
+
+    unsigned int spawned = 0;
+    for (; spawned < plan->count; spawned++) {
+        status[spawned].pid = _spawn_job(plan, spawned, report_pipe[1], payload_offset);
+        if (status[spawned].pid <= 0) {
+            break;
+        }
+    }
+    close(report_pipe[1]);
+    bool spawn_failed = (spawned < plan->count);
+    bool jobs_signalled = false;
+    if (spawn_failed) {
+        for (unsigned int i = 0; i < spawned; i++) {
+            kill(status[i].pid, SIGTERM);
+        }
+        jobs_signalled = true;
+    }
+
+    // Collect progress until every job has closed its end of the pipe.
+    char report_buffer[1024];
+    size_t buffered = 0;
+    while (true) {
+        struct pollfd pfd = { .fd = report_pipe[0], .events = POLLIN, .revents = 0 };
+        int ready = poll(&pfd, 1, SEGMENT_REPORT_POLL_MS);
+        if (ready < 0 && errno != EINTR) {
+            log_error("Polling the segment jobs failed: %s", strerror(errno));
+            break;
+        }
+        if (ready > 0) {
+            ssize_t n = read(report_pipe[0], report_buffer + buffered, sizeof(report_buffer) - 1 - buffered);
+            if (n == 0) {
+                break;
+            }
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN) continue;
+                log_error("Reading the segment reports failed: %s", strerror(errno));
+                break;
+            }
+            buffered += (size_t)n;
+            _parse_reports(report_buffer, &buffered, status, plan->count);
+            if (buffered == sizeof(report_buffer) - 1) {
+                buffered = 0; // Not a report line; drop it.
+            }
+        }
+
+        if (is_shutdown_requested() && !jobs_signalled) {
+            for (unsigned int i = 0; i < spawned; i++) {
+                kill(status[i].pid, SIGTERM);
+            }
+            jobs_signalled = true;
+        }
+
+        if (resources->progress_callback) {
+            unsigned long long frames = 0;
+            for (unsigned int i = 0; i < spawned; i++) {
+                frames += status[i].frames_written;
+            }
+            atomic_store_explicit(&resources->total_output_frames, frames, memory_order_relaxed);
+            resources->progress_callback(frames, resources->expected_total_output_frames,
+                                         frames * plan->output_frame_bytes, resources->progress_callback_udata);
+        }
+    }
+    close(report_pipe[0]);
+
+    for (unsigned int i = 0; i < spawned; i++) {
+        int wait_status = 0;
+        while (waitpid(status[i].pid, &wait_status, 0) < 0 && errno == EINTR) {
+        }
+        status[i].exited_ok = WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0;
+    }
+
+    // Keep the output a single run would have left: every complete segment up to
+    // the first incomplete one, and whatever that one wrote.
+    bool success = !spawn_failed;
+    unsigned long long contiguous_frames = 0;
+    bool contiguous = true;
+    for (unsigned int i = 0; i < plan->count; i++) {
+        const SegmentJob* job = &plan->jobs[i];
+        bool complete = i < spawned && status[i].exited_ok && status[i].done &&
+                        (job->write_frames == 0 || status[i].frames_written == job->write_frames);
+        if (!complete && !is_shutdown_requested()) {
+            success = false;
+            if (i < spawned && status[i].exited_ok) {
+                log_error("Segment %u produced %llu of %llu output frames.", i, status[i].frames_written, job->write_frames);
+            } else if (i < spawned) {
+                log_error("Segment job %u failed.", i);
+            }
+        }
+        if (contiguous) {
+            contiguous_frames += status[i].frames_written;
+            contiguous = complete;
+        }
+    }
+
+    unsigned long long payload_bytes = contiguous_frames * plan->output_frame_bytes;
+    if (regular_file && ftruncate(out_fd, (off_t)(payload_offset + payload_bytes)) != 0) {
+        log_error("Could not trim the output file: %s", strerror(errno));
+        success = false;
+    }
+    *total_bytes_written += (long long)payload_bytes;
+    resources->final_output_size_bytes = *total_bytes_written;
+    return success ? (long long)payload_bytes : -1;
+}
+
+// --- Static Helper Function Implementations ---
+
+/**
+ * @brief Divides the run between the jobs.
+ *
+ * With integral rates a segment boundary falls on a whole resampler period
+ * (in_rate / gcd input frames), where a single run's output index is exact.
+ * Otherwise the output index is rounded, and a join may be a frame off.
+ */
+static bool _plan_segments(AppConfig* config, AppResources* resources, int argc, char* argv[], SegmentPlan* plan) {
+    memset(plan, 0, sizeof(*plan));
+    plan->argc = argc;
+    plan->argv = argv;
+    plan->first_frame = resources->input_start_frame;
+    plan->input_frames = (resources->source_info.frames > 0) ? (unsigned long long)resources->source_info.frames : 0;
+    plan->output_frame_bytes = get_bytes_per_sample(config->output_format);
+
+    double in_rate = (double)resources->source_info.samplerate;
+    double out_rate = resources->is_passthrough ? in_rate : config->target_rate;
+    plan->ratio = out_rate / in_rate;
+
+    double warmup = _warmup_input_frames(config, resources, plan->ratio);
+    if (warmup < 0.0) {
+        return false;
+    }
+
+    unsigned int count = (unsigned int)config->segments;
+    unsigned long long min_frames = (unsigned long long)ceil(SEGMENT_MIN_SECONDS * in_rate);
+    while (count > 1) {
+        unsigned long long raw_frames = (plan->input_frames + count - 1) / count;
+        plan->in_period = 1;
+        plan->out_period = 0;
+        if (out_rate == floor(out_rate) && out_rate > 0.0) {
+            unsigned long long in = (unsigned long long)resources->source_info.samplerate;
+            unsigned long long out = (unsigned long long)out_rate;
+            unsigned long long g = _gcd(in, out);
+            if (in / g <= raw_frames / 4) {
+                plan->in_period = in / g;
+                plan->out_period = out / g;
+            }
+        }
+        unsigned long long period = plan->in_period;
+        plan->segment_frames = (raw_frames + period - 1) / period * period;
+        if (plan->segment_frames >= min_frames && (count - 1) * plan->segment_frames < plan->input_frames) {
+            break;
+        }
+        count--;
+    }
+    plan->count = count;
+    if (count <= 1) {
+        return true;
+    }
+    if (count < (unsigned int)config->segments) {
+        log_warn("The input is only long enough for %u segments.", count);
+    }
+
+    unsigned long long period = plan->in_period;
+    plan->warmup_frames = ((unsigned long long)ceil(warmup) + period - 1) / period * period;
+    if (config->memory_budget_bytes > 0) {
+        plan->job_budget_bytes = config->memory_budget_bytes / count;
+        if (plan->job_budget_bytes == 0) plan->job_budget_bytes = 1;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        bool last = (i == count - 1);
+        unsigned long long start = (unsigned long long)i * plan->segment_frames;
+        unsigned long long end = last ? plan->input_frames : start + plan->segment_frames;
+        unsigned long long run_start = (start > plan->warmup_frames) ? start - plan->warmup_frames : 0;
+        unsigned long long run_end = last ? plan->input_frames : end + plan->warmup_frames;
+        if (run_end > plan->input_frames) run_end = plan->input_frames;
+
+        SegmentJob* job = &plan->jobs[i];
+        job->index = i;
+        job->input_origin = run_start;
+        job->output_origin = _output_index(plan, run_start);
+        job->skip_frames = _output_index(plan, start) - job->output_origin;
+        job->write_frames = last ? 0 : _output_index(plan, end) - _output_index(plan, start);
+        job->write_offset = _output_index(plan, start) * plan->output_frame_bytes;
+        plan->job_input_frames[i] = run_end - run_start;
+    }
+    return true;
+}
+
+/**
+ * @brief Estimates the input frames the stateful stages need to settle.
+ *
+ * A 1st-order DC block decays by e^-1 per time constant. The resampler and
+ * the user filter are built just to read their delay and length.
+ *
+ * @return The warm-up in input frames, or a negative value on failure.
+ */
+static double _warmup_input_frames(AppConfig* config, AppResources* resources, double ratio) {
+    double in_rate = (double)resources->source_info.samplerate;
+    double frames = 0.0;
+
+    if (config->dc_block.enable) {
+        frames += SEGMENT_DC_BLOCK_TIME_CONSTANTS * in_rate / (2.0 * M_PI * DC_BLOCK_CUTOFF_HZ);
+    }
+    if (!resources->is_passthrough) {
+        resampler_t* resampler = create_resampler(config, resources, resources->resample_ratio);
+        if (!resampler) {
+            return -1.0;
+        }
+        frames += SEGMENT_RESAMPLER_DELAY_FACTOR * (double)resampler_get_delay(resampler) * fmax(1.0, 1.0 / ratio);
+        destroy_resampler(resampler);
+    }
+    if (!filter_create(config, resources, &resources->setup_arena)) {
+        return -1.0;
+    }
+    if (resources->user_filter_taps > 0) {
+        double taps = (double)resources->user_filter_taps;
+        frames += config->apply_user_filter_post_resample ? taps / ratio : taps;
+    }
+    filter_destroy(resources);
+    return frames;
+}
+
+/**
+ * @brief Returns the index of the output frame a single run produces at an input frame.
+ */
+static unsigned long long _output_index(const SegmentPlan* plan, unsigned long long input_frame) {
+    if (plan->out_period > 0) {
+        unsigned long long q = plan->in_period;
+        unsigned long long p = plan->out_period;
+        return input_frame / q * p + input_frame % q * p / q;
+    }
+    return (unsigned long long)llround((double)input_frame * plan->ratio);
+}
+
+static unsigned long long _gcd(unsigned long long a, unsigned long long b) {
+    while (b != 0) {
+        unsigned long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief Starts one job: this program, with the original arguments and the job's range appended.
+ * @return The job's process ID, or -1 on failure.
+ */
+static pid_t _spawn_job(const SegmentPlan* plan, unsigned int index, int report_fd, unsigned long long payload_offset) {
+    const SegmentJob* job = &plan->jobs[index];
+    char start_arg[64];
+    char duration_arg[64];
+    char budget_arg[64];
+    char job_arg[256];
+    snprintf(start_arg, sizeof(start_arg), "--start=%llu", plan->first_frame + job->input_origin);
+    snprintf(duration_arg, sizeof(duration_arg), "--duration=%llu", plan->job_input_frames[index]);
+    snprintf(budget_arg, sizeof(budget_arg), "--memory-budget=%llu", plan->job_budget_bytes);
+    snprintf(job_arg, sizeof(job_arg), "--segment-job=%u:%llu:%llu:%llu:%llu:%llu:%d",
+             job->index, job->input_origin, job->output_origin, job->skip_frames, job->write_frames,
+             payload_offset + job->write_offset, report_fd);
+
+    // The appended options come last, so they override any given by the user.
+    char** args = (char**)malloc(((size_t)plan->argc + 5) * sizeof(char*));
+    if (!args) {
+        log_fatal("Out of memory starting segment job %u.", index);
+        return -1;
+    }
+    int n = 0;
+    for (int i = 0; i < plan->argc; i++) {
+        args[n++] = plan->argv[i];
+    }
+    args[n++] = start_arg;
+    args[n++] = duration_arg;
+    if (plan->job_budget_bytes > 0) {
+        args[n++] = budget_arg;
+    }
+    args[n++] = job_arg;
+    args[n] = NULL;
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+    pid_t pid = -1;
+#ifdef __linux__
+    int rc = posix_spawn(&pid, "/proc/self/exe", &actions, NULL, args, environ);
+#else
+    int rc = posix_spawnp(&pid, plan->argv[0], &actions, NULL, args, environ);
+#endif
+    posix_spawn_file_actions_destroy(&actions);
+    free(args);
+
+    if (rc != 0) {
+        log_fatal("Could not start segment job %u: %s", index, strerror(rc));
+        return -1;
+    }
+    log_debug("Segment %u: input frames %llu+%llu, pid %d.", index, job->input_origin,
+              plan->job_input_frames[index], (int)pid);
+    return pid;
+}
+
+/**
+ * @brief Consumes the complete "<index> <frames written> <done>" lines in the buffer.
+ */
+static void _parse_reports(char* buffer, size_t* buffered, SegmentStatus* status, unsigned int count) {
+    buffer[*buffered] = '\0';
+    char* line = buffer;
+    char* newline;
+    while ((newline = strchr(line, '\n')) != NULL) {
+        *newline = '\0';
+        unsigned int index;
+        unsigned long long frames;
+        int done;
+        if (sscanf(line, "%u %llu %d", &index, &frames, &done) == 3 && index < count) {
+            status[index].frames_written = frames;
+            status[index].done = (done != 0);
+        }
+        line = newline + 1;
+    }
+    size_t remaining = *buffered - (size_t)(line - buffer);
+    memmove(buffer, line, remaining);
+    *buffered = remaining;
+}
+
+/**
+ * @brief Reserves the payload region, so the jobs' writes do not fragment the file.
+ *
+ * Best effort: the file is trimmed to the payload actually written afterwards.
+ */
+static void _reserve_payload(int out_fd, unsigned long long payload_offset, unsigned long long bytes) {
+    if (bytes == 0) {
+        return;
+    }
+#ifdef __linux__
+    if (fallocate(out_fd, 0, (off_t)payload_offset, (off_t)bytes) == 0) {
+        return;
+    }
+#endif
+    if (ftruncate(out_fd, (off_t)(payload_offset + bytes)) != 0) {
+        log_debug("Could not extend the output file ahead of the jobs: %s", strerror(errno));
+    }
+}
+
+#endif // _WIN32
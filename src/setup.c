@@ -5,8 +5,10 @@
 #include "log.h"
 #include "module.h"
 #include "module_manager.h"
+#include "output_segment.h"
 #include "pipeline.h"
 #include "app_context.h"
+#include "buffer_alloc.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -266,6 +268,13 @@ bool initialize_application(AppConfig *config, AppResources *resources) {
     // This is the correct place for this decision.
     resources->pacing_is_required = selected_output_module->requires_output_path;
 
+    // --- STEP 3: Resolve the chunk size before any input module sizes its buffers ---
+    // The memory planner in pipeline.c may still shrink this to fit --memory-budget,
+    // but it never grows it, so buffers sized from this value stay large enough.
+    resources->pipeline_chunk_base_samples = (config->chunk_samples_arg > 0)
+                                           ? (size_t)config->chunk_samples_arg
+                                           : PIPELINE_CHUNK_BASE_SAMPLES;
+
     // --- The rest of the setup proceeds as before ---
 
     log_info("Attempting to initialize the '%s' input module...", config->input_type_str);
@@ -288,6 +297,11 @@ bool initialize_application(AppConfig *config, AppResources *resources) {
         }
     }
 
+    // A --segments job writes into the parent's file instead of creating its own.
+    if (config->segment_job.active) {
+        resources->selected_output_module_api = get_segment_output_module_api();
+    }
+
     if (resources->selected_input_module_api->pre_stream_iq_correction) {
         if (!resources->selected_input_module_api->pre_stream_iq_correction(&ctx)) {
             return false;
@@ -298,7 +312,7 @@ bool initialize_application(AppConfig *config, AppResources *resources) {
         return false;
     }
 
-    if (resources->pacing_is_required) {
+    if (resources->pacing_is_required && !config->segment_job.active) {
         print_configuration_summary(config, resources);
         fprintf(stderr, "\n"); 
     }
@@ -324,7 +338,7 @@ void cleanup_application(AppConfig *config, AppResources *resources) {
     }
 
     if (resources->pipeline_chunk_data_pool) {
-        free(resources->pipeline_chunk_data_pool);
+        buffer_free(resources->pipeline_chunk_data_pool);
         resources->pipeline_chunk_data_pool = NULL;
     }
     
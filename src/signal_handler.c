@@ -4,6 +4,7 @@
 #include "module.h"      // Provides ModuleContext
 #include "queue.h"             // Provides queue_signal_shutdown
 #include "ring_buffer.h" // Provides ring_buffer_signal_shutdown
+#include "analysis_tap.h" // Provides analysis_tap_close
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -132,9 +133,10 @@ void request_shutdown(void) {
             queue_signal_shutdown(r->resampler_output_queue);
         if (r->post_processor_output_queue)
             queue_signal_shutdown(r->post_processor_output_queue);
+        if (r->transcoder_output_queue)
+            queue_signal_shutdown(r->transcoder_output_queue);
         // Note: writer_input_queue is just a pointer to one of the above, so no need to signal it separately.
-        if (r->iq_optimization_data_queue)
-            queue_signal_shutdown(r->iq_optimization_data_queue);
+        analysis_tap_close(r->iq_analysis_tap);
         
         // Signal all ring buffers to wake up any waiting threads
         if (r->writer_input_buffer)
@@ -147,13 +149,10 @@ void request_shutdown(void) {
 }
 
 void handle_fatal_thread_error(const char* context_msg, AppResources* resources) {
-    pthread_mutex_lock(&resources->progress_mutex);
-    if (resources->error_occurred) {
-        pthread_mutex_unlock(&resources->progress_mutex);
+    // Only the first thread to report an error logs it and requests shutdown.
+    if (atomic_exchange(&resources->error_occurred, true)) {
         return;
     }
-    resources->error_occurred = true;
-    pthread_mutex_unlock(&resources->progress_mutex);
 
     log_fatal("%s", context_msg);
     request_shutdown();
@@ -0,0 +1,496 @@
+/**
+ * @file telemetry.c
+ * @brief Implements per-stage pipeline telemetry and its JSON Lines export.
+ */
+
+#include "telemetry.h"
+#include "constants.h"
+#include "queue.h"
+#include "ring_buffer.h"
+#include "utils.h"
+#include "trace.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// --- Private Definitions ---
+
+/**
+ * @struct StageCounters
+ * @brief Counters for one pipeline stage.
+ *
+ * Only the stage's own thread writes them; the sampler thread reads them,
+ * so relaxed atomics are sufficient. `last_ns` is private to the stage thread.
+ */
+typedef struct {
+    atomic_ullong      busy_ns;
+    atomic_ullong      blocked_ns;
+    atomic_ullong      chunks;
+    atomic_ullong      samples;
+    unsigned long long last_ns;
+    unsigned long long prev_snapshot_samples;   ///< Sampler-private, for per-interval rates.
+} StageCounters;
+
+typedef struct {
+    atomic_ullong ns;
+    atomic_ullong samples;
+} StepCounters;
+
+#define LATENCY_SUB_BUCKETS (1 << TELEMETRY_LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_NUM_BUCKETS (TELEMETRY_LATENCY_MAJOR_BUCKETS * LATENCY_SUB_BUCKETS)
+
+/**
+ * @struct LatencyHistogram
+ * @brief Log-linear histogram of chunk latency (capture to stage exit) in nanoseconds.
+ *
+ * Written only by the stage's own thread, read by the sampler thread.
+ */
+typedef struct {
+    atomic_ullong buckets[LATENCY_NUM_BUCKETS];
+    atomic_ullong count;
+    atomic_ullong max_ns;
+} LatencyHistogram;
+
+/**
+ * @struct LatencyIndexEntry
+ * @brief Maps the end of one chunk's bytes in the writer ring buffer to its capture timestamp.
+ */
+typedef struct {
+    unsigned long long stream_end_bytes;
+    unsigned long long capture_ns;
+} LatencyIndexEntry;
+
+typedef struct {
+    const char*        name;
+    Queue*             queue;
+    struct RingBuffer* ring;
+    size_t             capacity;
+    size_t             last_level;
+    unsigned long long num_samples;
+    double             occupancy_sum;
+    unsigned long long histogram[TELEMETRY_HISTOGRAM_BUCKETS];
+} OccupancyTracker;
+
+struct Telemetry {
+    FILE*              file;
+    StageCounters      stages[TELEMETRY_STAGE_COUNT];
+    StepCounters       steps[TELEMETRY_STEP_COUNT];
+    LatencyHistogram   latency[TELEMETRY_STAGE_COUNT];
+    LatencyIndexEntry  latency_index[TELEMETRY_LATENCY_INDEX_SIZE];
+    atomic_ullong      latency_index_head;    ///< Written by the post-processor.
+    atomic_ullong      latency_index_tail;    ///< Written by the writer.
+    OccupancyTracker   trackers[TELEMETRY_MAX_TRACKED_BUFFERS];
+    int                num_trackers;
+    unsigned long long start_ns;
+    unsigned long long last_snapshot_ns;
+    pthread_t          sampler_thread;
+    bool               sampler_running;
+    atomic_bool        stop_requested;
+};
+
+static const char* const s_stage_names[TELEMETRY_STAGE_COUNT] = {
+    "sdr_capture", "reader", "pre_processor", "resampler", "post_processor", "transcoder", "writer"
+};
+
+// Span names used in the --trace output.
+static const char* const s_stage_trace_names[TELEMETRY_STAGE_COUNT] = {
+    "capture", "read", "pre-process", "resample", "post-process", "transcode", "write"
+};
+
+static const char* const s_step_names[TELEMETRY_STEP_COUNT] = {
+    "convert_input", "dc_block", "iq_correct", "pre_freq_shift", "pre_filter",
+    "resample", "post_filter", "post_freq_shift", "agc", "convert_output", "transcode",
+    "pipe_stall"
+};
+
+// --- Private Helper Functions ---
+
+static void _sleep_ms(unsigned int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    usleep(ms * 1000);
+#endif
+}
+
+static int _latency_bucket(unsigned long long ns) {
+    if (ns < LATENCY_SUB_BUCKETS) {
+        return (int)ns;
+    }
+    int msb = 0;
+    for (unsigned long long v = ns; v > 1; v >>= 1) {
+        msb++;
+    }
+    int shift = msb - TELEMETRY_LATENCY_SUB_BUCKET_BITS;
+    int major = shift + 1;
+    if (major >= TELEMETRY_LATENCY_MAJOR_BUCKETS) {
+        return LATENCY_NUM_BUCKETS - 1;
+    }
+    int sub = (int)((ns >> shift) & (LATENCY_SUB_BUCKETS - 1));
+    return major * LATENCY_SUB_BUCKETS + sub;
+}
+
+/**
+ * @brief Returns the midpoint of a latency bucket in nanoseconds.
+ */
+static double _latency_bucket_value(int bucket) {
+    int major = bucket / LATENCY_SUB_BUCKETS;
+    int sub = bucket % LATENCY_SUB_BUCKETS;
+    if (major == 0) {
+        return (double)sub;
+    }
+    double width = (double)(1ULL << (major - 1));
+    return ((double)(LATENCY_SUB_BUCKETS + sub) + 0.5) * width;
+}
+
+static void _latency_record(LatencyHistogram* h, unsigned long long capture_ns, unsigned long long now_ns) {
+    unsigned long long ns = (now_ns > capture_ns) ? now_ns - capture_ns : 0;
+    atomic_fetch_add_explicit(&h->buckets[_latency_bucket(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    if (ns > atomic_load_explicit(&h->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&h->max_ns, ns, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Computes the given percentiles (0-1, ascending) from a latency histogram, in nanoseconds.
+ * @return The number of recorded samples. The outputs are untouched if it is 0.
+ */
+static unsigned long long _latency_percentiles(const LatencyHistogram* h, const double* fractions, double* out_ns, int count) {
+    unsigned long long total = atomic_load_explicit(&h->count, memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+
+    int next = 0;
+    unsigned long long seen = 0;
+    for (int b = 0; b < LATENCY_NUM_BUCKETS && next < count; b++) {
+        seen += atomic_load_explicit(&h->buckets[b], memory_order_relaxed);
+        while (next < count && (double)seen >= fractions[next] * (double)total) {
+            out_ns[next++] = _latency_bucket_value(b);
+        }
+    }
+    // Buckets may have been incremented after 'count' was read; report the max for the rest.
+    unsigned long long max_ns = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (next < count) {
+        out_ns[next++] = (double)max_ns;
+    }
+    // A bucket midpoint can overshoot the largest value actually seen.
+    for (int i = 0; i < count; i++) {
+        if (out_ns[i] > (double)max_ns) out_ns[i] = (double)max_ns;
+    }
+    return total;
+}
+
+static void _sample_occupancy(Telemetry* tel) {
+    for (int i = 0; i < tel->num_trackers; i++) {
+        OccupancyTracker* t = &tel->trackers[i];
+        size_t level = t->queue ? queue_get_count(t->queue) : ring_buffer_get_size(t->ring);
+        double fraction = (t->capacity > 0) ? (double)level / (double)t->capacity : 0.0;
+        int bucket = (int)(fraction * TELEMETRY_HISTOGRAM_BUCKETS);
+        if (bucket >= TELEMETRY_HISTOGRAM_BUCKETS) bucket = TELEMETRY_HISTOGRAM_BUCKETS - 1;
+        if (bucket < 0) bucket = 0;
+        t->histogram[bucket]++;
+        t->occupancy_sum += fraction;
+        t->num_samples++;
+        t->last_level = level;
+    }
+}
+
+/**
+ * @brief Appends one JSON object (a snapshot or the summary) as a single line.
+ */
+static void _write_record(Telemetry* tel, const char* type, unsigned long long now_ns) {
+    FILE* f = tel->file;
+    double elapsed_s = (double)(now_ns - tel->start_ns) / 1e9;
+    double interval_s = (double)(now_ns - tel->last_snapshot_ns) / 1e9;
+
+    fprintf(f, "{\"type\":\"%s\",\"elapsed_s\":%.3f,\"stages\":{", type, elapsed_s);
+
+    bool first = true;
+    const char* bottleneck = NULL;
+    double bottleneck_utilization = -1.0;
+    for (int s = 0; s < TELEMETRY_STAGE_COUNT; s++) {
+        StageCounters* c = &tel->stages[s];
+        unsigned long long busy = atomic_load_explicit(&c->busy_ns, memory_order_relaxed);
+        unsigned long long blocked = atomic_load_explicit(&c->blocked_ns, memory_order_relaxed);
+        unsigned long long chunks = atomic_load_explicit(&c->chunks, memory_order_relaxed);
+        unsigned long long samples = atomic_load_explicit(&c->samples, memory_order_relaxed);
+        if (chunks == 0 && busy == 0 && blocked == 0) {
+            continue; // Stage not present in this pipeline configuration.
+        }
+
+        double utilization = (busy + blocked > 0) ? (double)busy / (double)(busy + blocked) : 0.0;
+        double msps = (elapsed_s > 0.0) ? (double)samples / elapsed_s / 1e6 : 0.0;
+        double interval_msps = (interval_s > 0.0) ? (double)(samples - c->prev_snapshot_samples) / interval_s / 1e6 : 0.0;
+        c->prev_snapshot_samples = samples;
+
+        if (utilization > bottleneck_utilization) {
+            bottleneck_utilization = utilization;
+            bottleneck = s_stage_names[s];
+        }
+
+        fprintf(f, "%s\"%s\":{\"chunks\":%llu,\"samples\":%llu,\"busy_s\":%.6f,\"blocked_s\":%.6f,"
+                   "\"utilization\":%.4f,\"msps\":%.3f,\"interval_msps\":%.3f}",
+                first ? "" : ",", s_stage_names[s], chunks, samples,
+                (double)busy / 1e9, (double)blocked / 1e9, utilization, msps, interval_msps);
+        first = false;
+    }
+
+    fprintf(f, "},\"steps\":{");
+    first = true;
+    for (int s = 0; s < TELEMETRY_STEP_COUNT; s++) {
+        unsigned long long ns = atomic_load_explicit(&tel->steps[s].ns, memory_order_relaxed);
+        unsigned long long samples = atomic_load_explicit(&tel->steps[s].samples, memory_order_relaxed);
+        if (samples == 0) {
+            continue;
+        }
+        fprintf(f, "%s\"%s\":{\"samples\":%llu,\"total_s\":%.6f,\"ns_per_sample\":%.3f}",
+                first ? "" : ",", s_step_names[s], samples, (double)ns / 1e9, (double)ns / (double)samples);
+        first = false;
+    }
+
+    fprintf(f, "},\"latency_ms\":{");
+    first = true;
+    static const double fractions[] = { 0.50, 0.99, 0.999 };
+    for (int s = 0; s < TELEMETRY_STAGE_COUNT; s++) {
+        double p_ns[3];
+        unsigned long long n = _latency_percentiles(&tel->latency[s], fractions, p_ns, 3);
+        if (n == 0) {
+            continue;
+        }
+        unsigned long long max_ns = atomic_load_explicit(&tel->latency[s].max_ns, memory_order_relaxed);
+        fprintf(f, "%s\"%s\":{\"chunks\":%llu,\"p50\":%.3f,\"p99\":%.3f,\"p99_9\":%.3f,\"max\":%.3f}",
+                first ? "" : ",", s_stage_names[s], n, p_ns[0] / 1e6, p_ns[1] / 1e6, p_ns[2] / 1e6, (double)max_ns / 1e6);
+        first = false;
+    }
+
+    fprintf(f, "},\"buffers\":{");
+    for (int i = 0; i < tel->num_trackers; i++) {
+        const OccupancyTracker* t = &tel->trackers[i];
+        double mean = (t->num_samples > 0) ? t->occupancy_sum / (double)t->num_samples : 0.0;
+        fprintf(f, "%s\"%s\":{\"kind\":\"%s\",\"capacity\":%zu,\"current\":%zu,\"mean_occupancy\":%.4f,\"histogram\":[",
+                i == 0 ? "" : ",", t->name, t->queue ? "queue" : "ring_buffer", t->capacity, t->last_level, mean);
+        for (int b = 0; b < TELEMETRY_HISTOGRAM_BUCKETS; b++) {
+            fprintf(f, "%s%llu", b == 0 ? "" : ",", t->histogram[b]);
+        }
+        fprintf(f, "]}");
+    }
+    fprintf(f, "}");
+
+    if (bottleneck) {
+        fprintf(f, ",\"busiest_stage\":\"%s\"", bottleneck);
+    }
+    fprintf(f, "}\n");
+    fflush(f);
+
+    tel->last_snapshot_ns = now_ns;
+}
+
+static void* _sampler_thread_func(void* arg) {
+    Telemetry* tel = (Telemetry*)arg;
+
+    while (!atomic_load_explicit(&tel->stop_requested, memory_order_acquire)) {
+        _sleep_ms(TELEMETRY_OCCUPANCY_SAMPLE_MS);
+        _sample_occupancy(tel);
+
+        unsigned long long now = get_monotonic_time_ns();
+        if (now - tel->last_snapshot_ns >= (unsigned long long)TELEMETRY_SNAPSHOT_INTERVAL_MS * 1000000ULL) {
+            _write_record(tel, "snapshot", now);
+        }
+    }
+    return NULL;
+}
+
+static void _register(Telemetry* tel, const char* name, Queue* queue, struct RingBuffer* ring, size_t capacity) {
+    if (tel->num_trackers >= TELEMETRY_MAX_TRACKED_BUFFERS) {
+        log_warn("Telemetry: too many buffers registered, not tracking '%s'.", name);
+        return;
+    }
+    OccupancyTracker* t = &tel->trackers[tel->num_trackers++];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->queue = queue;
+    t->ring = ring;
+    t->capacity = capacity;
+}
+
+// --- Public Function Implementations ---
+
+Telemetry* telemetry_create(const char* json_path) {
+    Telemetry* tel = (Telemetry*)calloc(1, sizeof(Telemetry));
+    if (!tel) {
+        log_fatal("Failed to allocate memory for pipeline telemetry.");
+        return NULL;
+    }
+
+    if (json_path) {
+        tel->file = fopen(json_path, "w");
+        if (!tel->file) {
+            log_fatal("Failed to open stats file '%s': %s", json_path, strerror(errno));
+            free(tel);
+            return NULL;
+        }
+    }
+
+    for (int s = 0; s < TELEMETRY_STAGE_COUNT; s++) {
+        atomic_init(&tel->stages[s].busy_ns, 0);
+        atomic_init(&tel->stages[s].blocked_ns, 0);
+        atomic_init(&tel->stages[s].chunks, 0);
+        atomic_init(&tel->stages[s].samples, 0);
+    }
+    for (int s = 0; s < TELEMETRY_STEP_COUNT; s++) {
+        atomic_init(&tel->steps[s].ns, 0);
+        atomic_init(&tel->steps[s].samples, 0);
+    }
+    for (int s = 0; s < TELEMETRY_STAGE_COUNT; s++) {
+        for (int b = 0; b < LATENCY_NUM_BUCKETS; b++) {
+            atomic_init(&tel->latency[s].buckets[b], 0);
+        }
+        atomic_init(&tel->latency[s].count, 0);
+        atomic_init(&tel->latency[s].max_ns, 0);
+    }
+    atomic_init(&tel->latency_index_head, 0);
+    atomic_init(&tel->latency_index_tail, 0);
+    atomic_init(&tel->stop_requested, false);
+    return tel;
+}
+
+void telemetry_register_queue(Telemetry* tel, const char* name, Queue* queue) {
+    if (!tel || !queue) return;
+    _register(tel, name, queue, NULL, queue->capacity);
+}
+
+void telemetry_register_ring_buffer(Telemetry* tel, const char* name, struct RingBuffer* ring) {
+    if (!tel || !ring) return;
+    _register(tel, name, NULL, ring, ring_buffer_get_capacity(ring));
+}
+
+bool telemetry_start(Telemetry* tel) {
+    tel->start_ns = get_monotonic_time_ns();
+    tel->last_snapshot_ns = tel->start_ns;
+    for (int s = 0; s < TELEMETRY_STAGE_COUNT; s++) {
+        tel->stages[s].last_ns = tel->start_ns;
+    }
+
+    if (!tel->file) {
+        return true; // Counters only; nothing to sample or export.
+    }
+
+    int ret = pthread_create(&tel->sampler_thread, NULL, _sampler_thread_func, tel);
+    if (ret != 0) {
+        log_error("Failed to start telemetry sampler thread: %s", strerror(ret));
+        return false;
+    }
+    tel->sampler_running = true;
+    return true;
+}
+
+void telemetry_stop(Telemetry* tel) {
+    if (!tel || !tel->sampler_running) return;
+
+    atomic_store_explicit(&tel->stop_requested, true, memory_order_release);
+    pthread_join(tel->sampler_thread, NULL);
+    tel->sampler_running = false;
+
+    _write_record(tel, "summary", get_monotonic_time_ns());
+}
+
+void telemetry_destroy(Telemetry* tel) {
+    if (!tel) return;
+    if (tel->file) {
+        fclose(tel->file);
+    }
+    free(tel);
+}
+
+void telemetry_stage_begin_work(Telemetry* tel, TelemetryStage stage) {
+    if (!tel) return;
+    StageCounters* c = &tel->stages[stage];
+    unsigned long long now = get_monotonic_time_ns();
+    atomic_fetch_add_explicit(&c->blocked_ns, now - c->last_ns, memory_order_relaxed);
+    c->last_ns = now;
+}
+
+void telemetry_stage_end_work(Telemetry* tel, TelemetryStage stage, size_t samples) {
+    if (!tel) return;
+    StageCounters* c = &tel->stages[stage];
+    unsigned long long now = get_monotonic_time_ns();
+    atomic_fetch_add_explicit(&c->busy_ns, now - c->last_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&c->chunks, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&c->samples, samples, memory_order_relaxed);
+    trace_span("stage", s_stage_trace_names[stage], c->last_ns, now, samples);
+    c->last_ns = now;
+}
+
+unsigned long long telemetry_step_begin(const Telemetry* tel) {
+    return tel ? get_monotonic_time_ns() : 0;
+}
+
+unsigned long long telemetry_step_end(Telemetry* tel, TelemetryStep step, unsigned long long start_ns, size_t samples) {
+    if (!tel) return 0;
+    unsigned long long now = get_monotonic_time_ns();
+    atomic_fetch_add_explicit(&tel->steps[step].ns, now - start_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tel->steps[step].samples, samples, memory_order_relaxed);
+    trace_span("step", s_step_names[step], start_ns, now, samples);
+    return now;
+}
+
+void telemetry_record_latency(Telemetry* tel, TelemetryStage stage, unsigned long long capture_ns) {
+    if (!tel || capture_ns == 0) return;
+    _latency_record(&tel->latency[stage], capture_ns, get_monotonic_time_ns());
+}
+
+void telemetry_latency_index_push(Telemetry* tel, unsigned long long stream_end_bytes, unsigned long long capture_ns) {
+    if (!tel || capture_ns == 0) return;
+    unsigned long long head = atomic_load_explicit(&tel->latency_index_head, memory_order_relaxed);
+    unsigned long long tail = atomic_load_explicit(&tel->latency_index_tail, memory_order_acquire);
+    if (head - tail >= TELEMETRY_LATENCY_INDEX_SIZE) {
+        return; // The writer is far behind; skip this chunk rather than block.
+    }
+    LatencyIndexEntry* e = &tel->latency_index[head % TELEMETRY_LATENCY_INDEX_SIZE];
+    e->stream_end_bytes = stream_end_bytes;
+    e->capture_ns = capture_ns;
+    atomic_store_explicit(&tel->latency_index_head, head + 1, memory_order_release);
+}
+
+void telemetry_latency_index_advance(Telemetry* tel, unsigned long long stream_bytes_written) {
+    if (!tel) return;
+    unsigned long long tail = atomic_load_explicit(&tel->latency_index_tail, memory_order_relaxed);
+    unsigned long long head = atomic_load_explicit(&tel->latency_index_head, memory_order_acquire);
+    if (tail == head) return;
+
+    unsigned long long now = get_monotonic_time_ns();
+    while (tail != head) {
+        const LatencyIndexEntry* e = &tel->latency_index[tail % TELEMETRY_LATENCY_INDEX_SIZE];
+        if (e->stream_end_bytes > stream_bytes_written) {
+            break; // This chunk has not been fully written yet.
+        }
+        _latency_record(&tel->latency[TELEMETRY_STAGE_WRITER], e->capture_ns, now);
+        tail++;
+    }
+    atomic_store_explicit(&tel->latency_index_tail, tail, memory_order_release);
+}
+
+bool telemetry_get_latency_ms(const Telemetry* tel, TelemetryStage stage, double* p50_ms, double* p99_ms, double* p999_ms) {
+    if (!tel) return false;
+    static const double fractions[] = { 0.50, 0.99, 0.999 };
+    double p_ns[3];
+    if (_latency_percentiles(&tel->latency[stage], fractions, p_ns, 3) == 0) {
+        return false;
+    }
+    *p50_ms = p_ns[0] / 1e6;
+    *p99_ms = p_ns[1] / 1e6;
+    *p999_ms = p_ns[2] / 1e6;
+    return true;
+}
@@ -5,9 +5,26 @@
 
 #include "thread_manager.h"
 #include "log.h"
+#include "trace.h"
+#include "perf_counters.h"
 #include <string.h>
 #include <errno.h>
 
+/**
+ * @brief Entry point for every managed thread: names it in the trace and
+ *        brackets the task with its hardware counters.
+ */
+static void* _thread_trampoline(void* arg) {
+    const ManagedThreadStart* start = (const ManagedThreadStart*)arg;
+    PerfThreadCounters counters;
+
+    trace_set_thread_name(start->name);
+    perf_counters_thread_begin(&counters, start->name);
+    void* result = start->func(start->context);
+    perf_counters_thread_end(&counters);
+    return result;
+}
+
 /**
  * @brief Initializes the thread manager.
  * @param manager A pointer to the ThreadManager struct to initialize.
@@ -28,7 +45,7 @@ void thread_manager_init(ThreadManager* manager, void* context) {
  * This function immediately creates a new thread to execute the given function.
  *
  * @param manager A pointer to the initialized ThreadManager.
- * @param name The name of the thread for logging.
+ * @param name The name of the thread for logging and the --trace output. Must outlive the thread.
  * @param func The function pointer for the thread to execute.
  * @return true if the thread was spawned successfully, false otherwise.
  */
@@ -43,7 +60,12 @@ bool thread_manager_spawn_thread(ThreadManager* manager, const char* name, void*
         return false;
     }
 
-    int ret = pthread_create(&manager->thread_handles[manager->num_threads_started], NULL, func, manager->thread_context);
+    ManagedThreadStart* start = &manager->thread_starts[manager->num_threads_started];
+    start->name = name;
+    start->func = func;
+    start->context = manager->thread_context;
+
+    int ret = pthread_create(&manager->thread_handles[manager->num_threads_started], NULL, _thread_trampoline, start);
     if (ret != 0) {
         log_fatal("Failed to create '%s' thread: %s", name, strerror(ret));
         // Do not increment num_threads_started on failure.
@@ -0,0 +1,209 @@
+/**
+ * @file trace.c
+ * @brief Implements the per-thread Chrome trace-event recorder.
+ */
+
+#include "trace.h"
+#include "constants.h"
+#include "utils.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+// --- Private Definitions ---
+
+typedef struct {
+    const char*        category;
+    const char*        name;
+    unsigned long long start_ns;
+    unsigned long long duration_ns;
+    unsigned long long samples;
+} TraceEvent;
+
+/**
+ * @struct TraceThreadBuffer
+ * @brief One thread's events. Only the owning thread appends to it.
+ *
+ * Buffers are kept on a global list rather than freed at thread exit, because
+ * they are only serialized after every thread has been joined.
+ */
+typedef struct TraceThreadBuffer {
+    struct TraceThreadBuffer* next;
+    int                       tid;
+    const char*               thread_name;
+    TraceEvent*               events;
+    size_t                    count;
+    unsigned long long        dropped;
+} TraceThreadBuffer;
+
+// --- Private Data ---
+static atomic_bool        s_enabled = false;
+static FILE*              s_file = NULL;
+static char               s_path[MAX_PATH_BUFFER];
+static unsigned long long s_origin_ns = 0;
+static pthread_key_t      s_buffer_key;
+static pthread_once_t     s_buffer_key_once = PTHREAD_ONCE_INIT;
+static bool               s_buffer_key_valid = false;
+static pthread_mutex_t    s_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TraceThreadBuffer* s_buffers = NULL;
+static int                s_next_tid = 1;
+
+// --- Private Helper Functions ---
+
+static void _buffer_key_create(void) {
+    s_buffer_key_valid = (pthread_key_create(&s_buffer_key, NULL) == 0);
+}
+
+/**
+ * @brief Returns the calling thread's buffer, creating and registering it on first use.
+ * @return The buffer, or NULL if it could not be allocated (events are then dropped silently).
+ */
+static TraceThreadBuffer* _get_thread_buffer(void) {
+    pthread_once(&s_buffer_key_once, _buffer_key_create);
+    if (!s_buffer_key_valid) {
+        return NULL;
+    }
+
+    TraceThreadBuffer* buf = (TraceThreadBuffer*)pthread_getspecific(s_buffer_key);
+    if (buf) {
+        return buf;
+    }
+
+    buf = (TraceThreadBuffer*)calloc(1, sizeof(TraceThreadBuffer));
+    if (!buf) {
+        return NULL;
+    }
+    buf->events = (TraceEvent*)malloc(TRACE_EVENTS_PER_THREAD * sizeof(TraceEvent));
+    if (!buf->events) {
+        free(buf);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s_registry_mutex);
+    buf->tid = s_next_tid++;
+    buf->next = s_buffers;
+    s_buffers = buf;
+    pthread_mutex_unlock(&s_registry_mutex);
+
+    pthread_setspecific(s_buffer_key, buf);
+    return buf;
+}
+
+static double _to_trace_us(unsigned long long ns) {
+    return (double)ns / 1000.0;
+}
+
+// --- Public Function Implementations ---
+
+bool trace_init(const char* path) {
+    s_file = fopen(path, "w");
+    if (!s_file) {
+        log_fatal("Failed to create trace file '%s': %s", path, strerror(errno));
+        return false;
+    }
+    snprintf(s_path, sizeof(s_path), "%s", path);
+    s_origin_ns = get_monotonic_time_ns();
+    atomic_store_explicit(&s_enabled, true, memory_order_release);
+    return true;
+}
+
+bool trace_is_enabled(void) {
+    return atomic_load_explicit(&s_enabled, memory_order_relaxed);
+}
+
+void trace_set_thread_name(const char* name) {
+    if (!trace_is_enabled()) return;
+    TraceThreadBuffer* buf = _get_thread_buffer();
+    if (buf) {
+        buf->thread_name = name;
+    }
+}
+
+void trace_span(const char* category, const char* name, unsigned long long start_ns, unsigned long long end_ns, size_t samples) {
+    if (!trace_is_enabled()) return;
+
+    TraceThreadBuffer* buf = _get_thread_buffer();
+    if (!buf) return;
+
+    if (buf->count >= TRACE_EVENTS_PER_THREAD) {
+        buf->dropped++;
+        return;
+    }
+
+    TraceEvent* e = &buf->events[buf->count++];
+    e->category = category;
+    e->name = name;
+    e->start_ns = start_ns;
+    e->duration_ns = (end_ns > start_ns) ? end_ns - start_ns : 0;
+    e->samples = samples;
+}
+
+bool trace_finish(void) {
+    if (!trace_is_enabled()) return true;
+    atomic_store_explicit(&s_enabled, false, memory_order_release);
+
+    FILE* f = s_file;
+    unsigned long long total_events = 0;
+    unsigned long long total_dropped = 0;
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"%s\"}}", APP_NAME);
+
+    pthread_mutex_lock(&s_registry_mutex);
+    TraceThreadBuffer* buf = s_buffers;
+    while (buf) {
+        if (buf->thread_name) {
+            fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    buf->tid, buf->thread_name);
+        } else {
+            fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}",
+                    buf->tid, buf->tid);
+        }
+
+        for (size_t i = 0; i < buf->count; i++) {
+            const TraceEvent* e = &buf->events[i];
+            double ts_us = _to_trace_us(e->start_ns >= s_origin_ns ? e->start_ns - s_origin_ns : 0);
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                    e->name, e->category, buf->tid, ts_us, _to_trace_us(e->duration_ns));
+            if (e->samples > 0) {
+                fprintf(f, ",\"args\":{\"samples\":%llu}", e->samples);
+            }
+            fprintf(f, "}");
+        }
+        total_events += buf->count;
+        total_dropped += buf->dropped;
+
+        TraceThreadBuffer* next = buf->next;
+        free(buf->events);
+        free(buf);
+        buf = next;
+    }
+    s_buffers = NULL;
+    pthread_mutex_unlock(&s_registry_mutex);
+
+    // Every other recording thread has exited; forget the caller's freed buffer too.
+    if (s_buffer_key_valid) {
+        pthread_setspecific(s_buffer_key, NULL);
+    }
+
+    fprintf(f, "\n]}\n");
+    bool ok = (ferror(f) == 0);
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    s_file = NULL;
+
+    if (!ok) {
+        log_error("Failed to write trace file '%s'.", s_path);
+        return false;
+    }
+    if (total_dropped > 0) {
+        log_warn("Trace buffers filled up; %llu events were dropped.", total_dropped);
+    }
+    log_info("Wrote %llu trace events to %s", total_events, s_path);
+    return true;
+}
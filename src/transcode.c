@@ -0,0 +1,278 @@
+/**
+ * @file transcode.c
+ * @brief Implements the direct sample format conversion used when no DSP stage is enabled.
+ *
+ * The cf32 path quantizes with slightly different scales on the way in and
+ * out (e.g. 1/128 when reading cs8 and 127 when writing it), so the result
+ * of a format change is not a simple shift. Rather than re-deriving that
+ * arithmetic in integer form, every kernel here is built from the cf32
+ * conversions themselves, which keeps the two paths identical by construction:
+ *
+ * - Most pairs run the vectorized convert_block_to_cf32() and
+ *   convert_cf32_to_block() over blocks small enough to stay in L1, so the
+ *   cf32 samples never reach memory.
+ * - cs24 output is packed byte by byte and does not vectorize, so for 8- and
+ *   16-bit inputs it is a lookup table filled by the cf32 path once.
+ */
+
+#include "transcode.h"
+#include "sample_convert.h"
+#include "constants.h"
+#include "log.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Private Type Definitions ---
+
+/**
+ * @enum TranscodeKernel
+ * @brief How the current input format is converted.
+ */
+typedef enum {
+    TRANSCODE_KERNEL_NONE,     ///< No input format prepared yet.
+    TRANSCODE_KERNEL_COPY,     ///< The cf32 round trip leaves every value unchanged.
+    TRANSCODE_KERNEL_TABLE,    ///< One table lookup per I or Q component (cs24 output).
+    TRANSCODE_KERNEL_TO_CF32,  ///< The output is cf32, so the input is converted straight into it.
+    TRANSCODE_KERNEL_BLOCKED,  ///< Through cf32, one L1-sized block at a time.
+} TranscodeKernel;
+
+struct Transcoder {
+    format_t        output_format;
+    float           gain;
+    format_t        input_format;        ///< The input format the kernel was prepared for.
+    TranscodeKernel kernel;
+    size_t          in_component_bytes;  ///< Bytes per I or Q component of the input.
+    size_t          out_component_bytes; ///< Bytes per I or Q component of the output.
+    uint32_t*       table;               ///< Indexed by an input component's bit pattern.
+    complex_float_t* block;              ///< TRANSCODE_BLOCK_FRAMES samples of cf32 scratch.
+};
+
+// Tables map each component independently; entries hold the 24-bit value.
+#define TRANSCODE_TABLE_LOOKUP_24(IN_TYPE) \
+    do { \
+        const IN_TYPE* in = (const IN_TYPE*)input_buffer; \
+        unsigned char* out = (unsigned char*)output_buffer; \
+        for (size_t i = 0; i < num_components; ++i) { \
+            uint32_t v = tc->table[in[i]]; \
+            out[0] = (unsigned char)(v & 0xFF); \
+            out[1] = (unsigned char)((v >> 8) & 0xFF); \
+            out[2] = (unsigned char)((v >> 16) & 0xFF); \
+            out += 3; \
+        } \
+    } while (0)
+
+// --- Private Helper Functions ---
+
+static bool _is_table_input(format_t format) {
+    switch (format) {
+        case CS8:
+        case CU8:
+        case CS16:
+        case CU16:
+        case SC16Q11:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Converts frames through the cf32 path, TRANSCODE_BLOCK_FRAMES at a time.
+ */
+static bool _convert_via_block(Transcoder* tc, const unsigned char* input, format_t input_format,
+                               unsigned char* output, size_t num_frames) {
+    const size_t in_pair_bytes = tc->in_component_bytes * COMPLEX_SAMPLE_COMPONENTS;
+    const size_t out_pair_bytes = tc->out_component_bytes * COMPLEX_SAMPLE_COMPONENTS;
+    for (size_t done = 0; done < num_frames; done += TRANSCODE_BLOCK_FRAMES) {
+        size_t n = (num_frames - done < TRANSCODE_BLOCK_FRAMES) ? (num_frames - done) : TRANSCODE_BLOCK_FRAMES;
+        if (!convert_block_to_cf32(input + done * in_pair_bytes, tc->block, n, input_format, tc->gain) ||
+            !convert_cf32_to_block(tc->block, output + done * out_pair_bytes, n, tc->output_format)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Runs every value of an 8- or 16-bit input format through the cf32 path.
+ *
+ * Fills tc->table when the output is cs24. When the input and output formats
+ * are the same, also reports whether the round trip is the identity, in which
+ * case the caller can copy instead.
+ */
+static bool _scan_input_values(Transcoder* tc, format_t input_format, bool build_table, bool* out_is_identity) {
+    const size_t in_bytes = tc->in_component_bytes;
+    const size_t out_bytes = tc->out_component_bytes;
+    const size_t entries = (size_t)1 << (in_bytes * 8);
+    const size_t batch = TRANSCODE_BLOCK_FRAMES;
+
+    uint32_t* table = build_table ? (uint32_t*)malloc(entries * sizeof(uint32_t)) : NULL;
+    unsigned char* raw = (unsigned char*)malloc(batch * in_bytes * COMPLEX_SAMPLE_COMPONENTS);
+    unsigned char* packed = (unsigned char*)malloc(batch * out_bytes * COMPLEX_SAMPLE_COMPONENTS);
+    bool ok = ((table || !build_table) && raw && packed);
+    if (!ok) {
+        log_error("Transcoder: Failed to allocate a %zu-entry lookup table.", entries);
+    }
+
+    bool is_identity = (input_format == tc->output_format);
+    for (size_t base = 0; ok && base < entries; base += batch) {
+        size_t n = (entries - base < batch) ? (entries - base) : batch;
+
+        // Both components of frame i carry input value base + i.
+        for (size_t i = 0; i < n; ++i) {
+            unsigned char* frame = raw + i * in_bytes * COMPLEX_SAMPLE_COMPONENTS;
+            if (in_bytes == 1) {
+                frame[0] = frame[1] = (unsigned char)(base + i);
+            } else {
+                uint16_t v = (uint16_t)(base + i);
+                memcpy(frame, &v, sizeof(v));
+                memcpy(frame + sizeof(v), &v, sizeof(v));
+            }
+        }
+
+        ok = _convert_via_block(tc, raw, input_format, packed, n);
+
+        for (size_t i = 0; ok && i < n; ++i) {
+            const unsigned char* in_value = raw + i * in_bytes * COMPLEX_SAMPLE_COMPONENTS;
+            const unsigned char* out_value = packed + i * out_bytes * COMPLEX_SAMPLE_COMPONENTS;
+            if (table) {
+                table[base + i] = (uint32_t)out_value[0] | ((uint32_t)out_value[1] << 8) | ((uint32_t)out_value[2] << 16);
+            }
+            if (is_identity && memcmp(in_value, out_value, in_bytes) != 0) {
+                is_identity = false;
+            }
+        }
+    }
+
+    free(raw);
+    free(packed);
+    if (!ok) {
+        free(table);
+        return false;
+    }
+    tc->table = table;
+    *out_is_identity = is_identity;
+    return true;
+}
+
+/**
+ * @brief Selects the kernel for an input format, building its table if needed.
+ */
+static bool _prepare_kernel(Transcoder* tc, format_t input_format) {
+    free(tc->table);
+    tc->table = NULL;
+    tc->kernel = TRANSCODE_KERNEL_NONE;
+
+    size_t in_pair_bytes = get_bytes_per_sample(input_format);
+    size_t out_pair_bytes = get_bytes_per_sample(tc->output_format);
+    if (in_pair_bytes == 0 || out_pair_bytes == 0) {
+        log_error("Transcoder: Unhandled format pair (%d to %d).", input_format, tc->output_format);
+        return false;
+    }
+    tc->input_format = input_format;
+    tc->in_component_bytes = in_pair_bytes / COMPLEX_SAMPLE_COMPONENTS;
+    tc->out_component_bytes = out_pair_bytes / COMPLEX_SAMPLE_COMPONENTS;
+
+    if (tc->output_format == CF32) {
+        tc->kernel = TRANSCODE_KERNEL_TO_CF32;
+        return true;
+    }
+
+    tc->kernel = TRANSCODE_KERNEL_BLOCKED;
+    bool build_table = (tc->output_format == CS24);
+    if (DSP_REFERENCE_KERNELS || !_is_table_input(input_format) ||
+        (!build_table && input_format != tc->output_format)) {
+        return true;
+    }
+
+    bool is_identity = false;
+    if (!_scan_input_values(tc, input_format, build_table, &is_identity)) {
+        tc->kernel = TRANSCODE_KERNEL_NONE;
+        return false;
+    }
+    if (is_identity) {
+        free(tc->table);
+        tc->table = NULL;
+        tc->kernel = TRANSCODE_KERNEL_COPY;
+    } else if (tc->table) {
+        tc->kernel = TRANSCODE_KERNEL_TABLE;
+    }
+    return true;
+}
+
+// --- Public Function Implementations ---
+
+Transcoder* transcode_create(format_t input_format, format_t output_format, float gain) {
+    Transcoder* tc = (Transcoder*)calloc(1, sizeof(Transcoder));
+    if (!tc) {
+        log_error("Transcoder: Failed to allocate state.");
+        return NULL;
+    }
+    tc->output_format = output_format;
+    tc->gain = gain;
+    tc->kernel = TRANSCODE_KERNEL_NONE;
+    tc->block = (complex_float_t*)malloc(TRANSCODE_BLOCK_FRAMES * sizeof(complex_float_t));
+    if (!tc->block) {
+        log_error("Transcoder: Failed to allocate state.");
+        transcode_destroy(tc);
+        return NULL;
+    }
+    if (!_prepare_kernel(tc, input_format)) {
+        transcode_destroy(tc);
+        return NULL;
+    }
+    return tc;
+}
+
+bool transcode_block(Transcoder* tc, const void* restrict input_buffer, format_t input_format,
+                     void* restrict output_buffer, size_t num_frames) {
+    if (tc->kernel == TRANSCODE_KERNEL_NONE || tc->input_format != input_format) {
+        if (!_prepare_kernel(tc, input_format)) {
+            return false;
+        }
+    }
+
+    const size_t num_components = num_frames * COMPLEX_SAMPLE_COMPONENTS;
+    switch (tc->kernel) {
+        case TRANSCODE_KERNEL_COPY:
+            memcpy(output_buffer, input_buffer, num_components * tc->in_component_bytes);
+            return true;
+
+        case TRANSCODE_KERNEL_TABLE:
+            if (tc->in_component_bytes == 1) {
+                TRANSCODE_TABLE_LOOKUP_24(uint8_t);
+            } else {
+                TRANSCODE_TABLE_LOOKUP_24(uint16_t);
+            }
+            return true;
+
+        case TRANSCODE_KERNEL_TO_CF32:
+            return convert_block_to_cf32(input_buffer, (complex_float_t*)output_buffer, num_frames, input_format, tc->gain);
+
+        case TRANSCODE_KERNEL_BLOCKED:
+            return _convert_via_block(tc, (const unsigned char*)input_buffer, input_format,
+                                      (unsigned char*)output_buffer, num_frames);
+
+        case TRANSCODE_KERNEL_NONE:
+        default:
+            return false;
+    }
+}
+
+const char* transcode_describe(const Transcoder* tc) {
+    switch (tc->kernel) {
+        case TRANSCODE_KERNEL_COPY:     return "copy";
+        case TRANSCODE_KERNEL_TABLE:    return "lookup table";
+        case TRANSCODE_KERNEL_TO_CF32:  return "direct to cf32";
+        case TRANSCODE_KERNEL_BLOCKED:  return "cache-blocked via cf32";
+        default:                        return "not prepared";
+    }
+}
+
+void transcode_destroy(Transcoder* tc) {
+    if (!tc) return;
+    free(tc->table);
+    free(tc->block);
+    free(tc);
+}
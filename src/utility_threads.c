@@ -19,6 +19,7 @@
 #include "log.h"
 #include "iq_correct.h"
 #include "queue.h"
+#include "analysis_tap.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -27,7 +28,8 @@
  * @brief The I/Q optimization thread's main function.
  *
  * This optional, lower-priority thread periodically runs the I/Q imbalance
- * correction algorithm to refine the correction factors.
+ * correction algorithm to refine the correction factors. It reads sample
+ * windows from the I/Q analysis tap, so it never holds pipeline chunks.
  *
  * @param arg A void pointer to the PipelineContext struct.
  * @return NULL.
@@ -35,17 +37,44 @@
 void* iq_optimization_thread_func(void* arg) {
     PipelineContext* args = (PipelineContext*)arg;
     AppResources* resources = args->resources;
+    AnalysisTap* tap = resources->iq_analysis_tap;
+    complex_float_t* window = resources->iq_correction.optimization_accum_buffer;
 
-    SampleChunk* item;
-    while ((item = (SampleChunk*)queue_dequeue(resources->iq_optimization_data_queue)) != NULL) {
-        iq_correct_run_optimization(resources, item->complex_sample_buffer_a);
-        // Return the chunk to the free pool for reuse
-        queue_enqueue(resources->free_sample_chunk_queue, item);
+    AnalysisTapReader reader;
+    analysis_tap_subscribe(tap, &reader);
+
+    while (analysis_tap_wait_read(tap, &reader, window) == ANALYSIS_TAP_READ_OK) {
+        iq_correct_run_optimization(resources, window);
     }
-    log_debug("I/Q optimization thread is exiting.");
+    log_debug("I/Q optimization thread is exiting (%llu analysis windows skipped).", reader.dropped);
     return NULL;
 }
 
+/**
+ * @brief Sleeps for the given time in short slices.
+ *
+ * A stream that ends on its own (e.g. a sim-sdr run with --sim-duration) stops
+ * sending heartbeats too, so the watchdog must notice the end of the stream
+ * promptly rather than mistaking it for a hung driver.
+ *
+ * @return false if a shutdown was requested or the stream ended while sleeping.
+ */
+static bool _watchdog_sleep(const AppResources* resources, unsigned int ms) {
+    const unsigned int slice_ms = 100;
+    for (unsigned int slept_ms = 0; slept_ms < ms; slept_ms += slice_ms) {
+        if (is_shutdown_requested() || atomic_load(&resources->end_of_stream_reached)) {
+            return false;
+        }
+#ifdef _WIN32
+        Sleep(slice_ms);
+#else
+        struct timespec sleep_time = {0, (long)slice_ms * 1000000L};
+        nanosleep(&sleep_time, NULL);
+#endif
+    }
+    return !is_shutdown_requested() && !atomic_load(&resources->end_of_stream_reached);
+}
+
 /**
  * @brief The SDR watchdog thread's main function.
  *
@@ -61,28 +90,16 @@ void* watchdog_thread_func(void* arg) {
     AppConfig* config = args->config;
 
     // Give the SDR a moment to start up before we start checking
-#ifdef _WIN32
-    Sleep(WATCHDOG_TIMEOUT_MS);
-#else
-    sleep(WATCHDOG_TIMEOUT_MS / 1000);
-#endif
-
-    while (!is_shutdown_requested()) {
-#ifdef _WIN32
-        Sleep(WATCHDOG_INTERVAL_MS);
-#else
-        sleep(WATCHDOG_INTERVAL_MS / 1000);
-#endif
-
-        double current_time = get_monotonic_time_sec();
-        bool timed_out = false;
+    if (!_watchdog_sleep(resources, WATCHDOG_TIMEOUT_MS)) {
+        log_debug("SDR watchdog thread is exiting.");
+        return NULL;
+    }
 
-        pthread_mutex_lock(&resources->progress_mutex);
-        double last_heartbeat = resources->last_sdr_heartbeat_time;
-        if (last_heartbeat > 0 && (current_time - last_heartbeat) > (WATCHDOG_TIMEOUT_MS / 1000.0)) {
-            timed_out = true;
-        }
-        pthread_mutex_unlock(&resources->progress_mutex);
+    while (_watchdog_sleep(resources, WATCHDOG_INTERVAL_MS)) {
+        unsigned long long current_time_ms = get_monotonic_time_coarse_ms();
+        unsigned long long last_heartbeat_ms = atomic_load_explicit(&resources->last_sdr_heartbeat_ms, memory_order_relaxed);
+        bool timed_out = (last_heartbeat_ms > 0 && current_time_ms > last_heartbeat_ms &&
+                          (current_time_ms - last_heartbeat_ms) > WATCHDOG_TIMEOUT_MS);
 
         if (timed_out) {
             const char* input_device_name = config->input_type_str ? config->input_type_str : "SDR";
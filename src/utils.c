@@ -9,6 +9,7 @@
 #include <ctype.h>
 #include <time.h>
 #include <stdlib.h>
+#include <errno.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,6 +18,9 @@
 #else
 #include <libgen.h>
 #include <strings.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #endif
 
 // --- The Single Source of Truth for Sample Formats ---
@@ -64,6 +68,44 @@ double get_monotonic_time_sec(void) {
 #endif
 }
 
+unsigned long long get_monotonic_time_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    if (freq.QuadPart == 0 && !QueryPerformanceFrequency(&freq)) {
+        return (unsigned long long)GetTickCount64() * 1000000ULL;
+    }
+    QueryPerformanceCounter(&count);
+    // Split the conversion to avoid overflowing 64 bits on long uptimes.
+    unsigned long long seconds = (unsigned long long)(count.QuadPart / freq.QuadPart);
+    unsigned long long remainder = (unsigned long long)(count.QuadPart % freq.QuadPart);
+    return seconds * 1000000000ULL + remainder * 1000000000ULL / (unsigned long long)freq.QuadPart;
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+    }
+    return (unsigned long long)time(NULL) * 1000000000ULL;
+#endif
+}
+
+unsigned long long get_monotonic_time_coarse_ms(void) {
+#ifdef _WIN32
+    return (unsigned long long)GetTickCount64();
+#else
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0) {
+        return (unsigned long long)ts.tv_sec * 1000ULL + (unsigned long long)ts.tv_nsec / 1000000ULL;
+    }
+#endif
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return (unsigned long long)ts.tv_sec * 1000ULL + (unsigned long long)ts.tv_nsec / 1000000ULL;
+    }
+    return (unsigned long long)time(NULL) * 1000ULL;
+#endif
+}
+
 void clear_stdin_buffer(void) {
     int c;
     while ((c = getchar()) != '\n' && c != EOF);
@@ -221,3 +263,114 @@ bool utils_check_file_exists(const char* full_path) {
     }
     return false;
 }
+
+bool utils_parse_size_string(const char* str, unsigned long long* out_bytes) {
+    if (!str || !out_bytes) return false;
+
+    char* endptr;
+    errno = 0;
+    double value = strtod(str, &endptr);
+    if (endptr == str || errno != 0 || !isfinite(value) || value < 0.0) {
+        return false;
+    }
+
+    double multiplier = 1.0;
+    switch (toupper((unsigned char)*endptr)) {
+        case 'K': multiplier = 1024.0; endptr++; break;
+        case 'M': multiplier = 1024.0 * 1024.0; endptr++; break;
+        case 'G': multiplier = 1024.0 * 1024.0 * 1024.0; endptr++; break;
+        case 'T': multiplier = 1024.0 * 1024.0 * 1024.0 * 1024.0; endptr++; break;
+        default: break;
+    }
+    // Accept an optional "B" or "iB" after the unit (e.g., "512MB", "2GiB").
+    if (multiplier > 1.0 && toupper((unsigned char)*endptr) == 'I') endptr++;
+    if (toupper((unsigned char)*endptr) == 'B') endptr++;
+    if (*endptr != '\0') {
+        return false;
+    }
+
+    double bytes = value * multiplier;
+    if (bytes >= 18446744073709551616.0) { // 2^64. UINT64_MAX itself rounds up to this as a double.
+        return false;
+    }
+    *out_bytes = (unsigned long long)bytes;
+    return true;
+}
+
+time_t utils_timegm(struct tm* tm) {
+    if (!tm) return (time_t)-1;
+    tm->tm_isdst = 0;
+#ifdef _WIN32
+    return _mkgmtime(tm);
+#else
+    return timegm(tm);
+#endif
+}
+
+uint64_t utils_rng_next(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+bool utils_get_page_fault_counts(unsigned long long* minor_faults, unsigned long long* major_faults) {
+#ifdef _WIN32
+    (void)minor_faults;
+    (void)major_faults;
+    return false;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return false;
+    }
+    *minor_faults = (unsigned long long)usage.ru_minflt;
+    *major_faults = (unsigned long long)usage.ru_majflt;
+    return true;
+#endif
+}
+
+size_t utils_grow_pipe(int fd, size_t wanted_bytes, const char* name) {
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) != 0 || !S_ISFIFO(stat_buf.st_mode)) {
+        return 0;
+    }
+    int current = fcntl(fd, F_GETPIPE_SZ);
+    if (current <= 0) {
+        return 0;
+    }
+    if ((size_t)current >= wanted_bytes) {
+        return (size_t)current;
+    }
+
+    int result = fcntl(fd, F_SETPIPE_SZ, (int)wanted_bytes);
+    if (result < 0 && errno == EPERM) {
+        FILE* f = fopen("/proc/sys/fs/pipe-max-size", "r");
+        long max_size = 0;
+        if (f) {
+            if (fscanf(f, "%ld", &max_size) != 1) max_size = 0;
+            fclose(f);
+        }
+        if (max_size > current) {
+            result = fcntl(fd, F_SETPIPE_SZ, (int)max_size);
+        }
+    }
+
+    char size_buf[40];
+    if (result < 0) {
+        log_warn("Could not grow the %s pipe: %s. Keeping %s.", name, strerror(errno),
+                 format_file_size(current, size_buf, sizeof(size_buf)));
+        return (size_t)current;
+    }
+    log_debug("Grew the %s pipe to %s.", name, format_file_size(result, size_buf, sizeof(size_buf)));
+    return (size_t)result;
+#else
+    (void)fd;
+    (void)wanted_bytes;
+    (void)name;
+    return 0;
+#endif
+}